@@ -59,13 +59,26 @@ public:
   //! Ticks the director.
   void Tick();
 
+  //! Returns the wakeup of the director, signalled when work is queued to the director.
+  //! @returns Reference to the wakeup.
+  [[nodiscard]] Wakeup& GetWakeup();
+  //! Returns the time point of when the director needs to tick next,
+  //! regardless of being woken up.
+  //! @returns Time point of the next tick, or empty if the director has no work queued.
+  [[nodiscard]] std::optional<Scheduler::Clock::time_point> GetNextTickTime();
+
   //! Requests a load of user data.
   //! @param userName Name of the user.
-  void RequestLoadUserData(const std::string& userName);
+  //! @param loadWakeup Wakeup to signal once the load completes or times out, may be null.
+  void RequestLoadUserData(const std::string& userName, Wakeup* loadWakeup = nullptr);
   //! Requests a load of character data.
   //! @param userName Name of the user.
   //! @param characterUid UID of the character.
-  void RequestLoadCharacterData(const std::string& userName, data::Uid characterUid);
+  //! @param loadWakeup Wakeup to signal once the load completes or times out, may be null.
+  void RequestLoadCharacterData(
+    const std::string& userName,
+    data::Uid characterUid,
+    Wakeup* loadWakeup = nullptr);
 
   //! Returns whether the data of a user (either user data or character data) are being loaded.
   //! @param userName name of the user.
@@ -137,6 +150,8 @@ private:
   //! An underlying data source of the data director.
   std::unique_ptr<DataSource> _primaryDataSource;
 
+  //! A wakeup of the director.
+  Wakeup _wakeup;
   Scheduler _scheduler;
 
   struct UserDataContext
@@ -154,9 +169,17 @@ private:
     std::string debugMessage;
     //! The time point when loading or unloading times out.
     Scheduler::Clock::time_point timeout;
+    //! A wakeup to signal once the load completes, may be null.
+    std::atomic<Wakeup*> loadWakeup = nullptr;
   };
   std::unordered_map<std::string, UserDataContext> _userDataContext;
 
+  //! Marks the load as finished and signals the load wakeup.
+  //! @param userDataContext Context of the user data.
+  void FinishLoad(UserDataContext& userDataContext);
+  //! Returns whether any of the storages has operations queued.
+  //! @returns `true` if there are operations queued, `false` otherwise.
+  [[nodiscard]] bool HasQueuedStorageOperations() const noexcept;
   void ScheduleUserLoad(UserDataContext& userDataContext, const std::string& userName);
   void ScheduleCharacterLoad(UserDataContext& userDataContext, data::Uid characterUid);
 
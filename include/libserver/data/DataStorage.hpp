@@ -21,6 +21,7 @@
 #define DATASTORAGE_HPP
 
 #include "libserver/data/Record.hpp"
+#include "libserver/util/Wakeup.hpp"
 
 #include <atomic>
 #include <functional>
@@ -59,6 +60,23 @@ public:
   {
   }
 
+  //! Sets the wakeup signalled when an operation is queued.
+  //! Must be set before the storage is used.
+  //! @param wakeup Wakeup of the owner.
+  void SetWakeup(Wakeup& wakeup)
+  {
+    _wakeup = &wakeup;
+  }
+
+  //! Returns whether there are any operations queued.
+  //! @returns `true` if there are operations queued, `false` otherwise.
+  [[nodiscard]] bool HasQueuedOperations() const noexcept
+  {
+    return _retrieveQueue.dataFlag.load(std::memory_order::relaxed)
+      || _storeQueue.dataFlag.load(std::memory_order::relaxed)
+      || _deleteQueue.dataFlag.load(std::memory_order::relaxed);
+  }
+
   void Terminate()
   {
     {
@@ -230,23 +248,38 @@ public:
 private:
   void RequestRetrieve(const Key& key)
   {
-    std::scoped_lock lock(_retrieveQueue.mutex);
-    _retrieveQueue.data.insert(key);
-    _retrieveQueue.dataFlag.store(true, std::memory_order::relaxed);
+    {
+      std::scoped_lock lock(_retrieveQueue.mutex);
+      _retrieveQueue.data.insert(key);
+      _retrieveQueue.dataFlag.store(true, std::memory_order::relaxed);
+    }
+
+    if (_wakeup != nullptr)
+      _wakeup->Signal();
   }
 
   void RequestStore(const Key& key)
   {
-    std::scoped_lock lock(_storeQueue.mutex);
-    _storeQueue.data.insert(key);
-    _storeQueue.dataFlag.store(true, std::memory_order::relaxed);
+    {
+      std::scoped_lock lock(_storeQueue.mutex);
+      _storeQueue.data.insert(key);
+      _storeQueue.dataFlag.store(true, std::memory_order::relaxed);
+    }
+
+    if (_wakeup != nullptr)
+      _wakeup->Signal();
   }
 
   void RequestDelete(const Key& key)
   {
-    std::scoped_lock lock(_deleteQueue.mutex);
-    _deleteQueue.data.insert(key);
-    _deleteQueue.dataFlag.store(true, std::memory_order::relaxed);
+    {
+      std::scoped_lock lock(_deleteQueue.mutex);
+      _deleteQueue.data.insert(key);
+      _deleteQueue.dataFlag.store(true, std::memory_order::relaxed);
+    }
+
+    if (_wakeup != nullptr)
+      _wakeup->Signal();
   }
 
   void ProcessRetrieveQueue()
@@ -330,6 +363,9 @@ private:
   DataSourceRetrieveListener _dataSourceRetrieveListener;
   DataSourceStoreListener _dataSourceStoreListener;
   DataSourceDeleteListener _dataSourceDeleteListener;
+
+  //! Wakeup of the owner, may be null.
+  Wakeup* _wakeup{nullptr};
 };
 
 } // namespace server
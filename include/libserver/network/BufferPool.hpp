@@ -0,0 +1,89 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#ifndef BUFFER_POOL_HPP
+#define BUFFER_POOL_HPP
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace server::network
+{
+
+//! A buffer of serialized data.
+using Buffer = std::vector<std::byte>;
+
+//! A shared handle to a pooled buffer.
+//! The buffer is returned to its pool when the last handle is released.
+using BufferHandle = std::shared_ptr<Buffer>;
+
+//! A shared handle to an immutable buffer ready to be written.
+using WriteBuffer = std::shared_ptr<const Buffer>;
+
+//! A thread-safe pool of reusable buffers.
+class BufferPool final
+{
+public:
+  //! Constructor.
+  //! @param maxBufferCount Max count of the idle buffers retained by the pool.
+  //! @param maxBufferCapacity Max capacity of a buffer retained by the pool.
+  //!                          Larger buffers are freed when released.
+  explicit BufferPool(
+    std::size_t maxBufferCount = 1024,
+    std::size_t maxBufferCapacity = 16 * 1024);
+
+  //! Acquires an empty buffer from the pool.
+  //! The buffer keeps the capacity it had when it was released.
+  //! @returns Handle to the buffer.
+  [[nodiscard]] BufferHandle Acquire();
+
+  //! Returns the count of idle buffers retained by the pool.
+  //! @returns Count of idle buffers.
+  [[nodiscard]] std::size_t GetIdleBufferCount() const;
+
+  //! Returns the pool shared by the network.
+  //! @returns Global pool.
+  static BufferPool& Global();
+
+private:
+  //! Storage of the pool. Shared with the outstanding buffer handles,
+  //! so that the buffers may be released after the pool is destroyed.
+  struct Storage
+  {
+    //! Returns the buffer to the storage.
+    //! @param buffer Buffer.
+    void Release(Buffer* buffer) noexcept;
+
+    std::size_t maxBufferCount;
+    std::size_t maxBufferCapacity;
+
+    //! A mutex for the idle buffers.
+    std::mutex mutex;
+    //! Idle buffers.
+    std::vector<std::unique_ptr<Buffer>> buffers;
+  };
+
+  std::shared_ptr<Storage> _storage;
+};
+
+} // namespace server::network
+
+#endif // BUFFER_POOL_HPP
@@ -0,0 +1,179 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#ifndef CAPTURE_HPP
+#define CAPTURE_HPP
+
+#include "NetworkDefinitions.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <span>
+#include <vector>
+
+namespace server::network
+{
+
+//! Protocol of the captured commands.
+enum class CaptureProtocol : uint8_t
+{
+  //! Commands of the lobby, ranch and race servers.
+  Command = 0,
+  //! Commands of the messenger and chat servers.
+  Chatter = 1,
+};
+
+//! Header of a capture file.
+struct CaptureHeader
+{
+  //! Magic with which every capture file begins.
+  static constexpr std::array<char, 4> Magic{'A', 'L', 'C', 'P'};
+  //! Version of the capture file format.
+  static constexpr uint16_t Version = 1;
+
+  //! Protocol of the captured commands.
+  CaptureProtocol protocol{};
+  //! Port the server listened on.
+  uint16_t port{};
+  //! Time the capture began at.
+  std::chrono::system_clock::time_point beginTime{};
+};
+
+//! A record of a capture file.
+struct CaptureRecord
+{
+  enum class Type : uint8_t
+  {
+    //! The client connected.
+    Connected = 0,
+    //! The client disconnected.
+    Disconnected = 1,
+    //! The client sent a command. The data are the unscrambled command data.
+    Command = 2,
+    //! The server changed the XOR code of the client. The data are the new code.
+    CodeChanged = 3,
+  };
+
+  Type type{};
+  //! Time of the record since the beginning of the capture.
+  std::chrono::microseconds time{};
+  //! ID of the client.
+  ClientId clientId{};
+  //! ID of the command, if the record is a command.
+  uint16_t commandId{};
+  //! Data of the record.
+  std::vector<std::byte> data{};
+};
+
+//! Writer of the inbound traffic of a server to a capture file.
+//! The file starts with the header, followed by the records,
+//! each a fixed-size record header followed by its data.
+//! Thread-safe, the records may be written from multiple network threads.
+class CaptureWriter final
+{
+public:
+  //! Constructor. Creates the capture file and writes its header.
+  //! @param path Path of the capture file.
+  //! @param protocol Protocol of the captured commands.
+  //! @param port Port the server listens on.
+  //! @throws std::runtime_error If the file can't be created.
+  CaptureWriter(
+    const std::filesystem::path& path,
+    CaptureProtocol protocol,
+    uint16_t port);
+
+  //! Records the connection of the client.
+  //! @param clientId ID of the client.
+  void WriteConnected(ClientId clientId);
+
+  //! Records the disconnection of the client.
+  //! @param clientId ID of the client.
+  void WriteDisconnected(ClientId clientId);
+
+  //! Records the command received from the client.
+  //! @param clientId ID of the client.
+  //! @param commandId ID of the command.
+  //! @param data Unscrambled command data.
+  void WriteCommand(
+    ClientId clientId,
+    uint16_t commandId,
+    std::span<const std::byte> data);
+
+  //! Records the change of the client's XOR code.
+  //! @param clientId ID of the client.
+  //! @param code New XOR code.
+  void WriteCodeChanged(
+    ClientId clientId,
+    std::span<const std::byte> code);
+
+  //! Flushes the buffered records to the file.
+  void Flush();
+
+  //! Returns the path of a new capture file in the directory,
+  //! named after the port and the current time.
+  //! @param directory Directory of the capture files.
+  //! @param port Port the server listens on.
+  //! @returns Path of the capture file.
+  [[nodiscard]] static std::filesystem::path MakePath(
+    const std::filesystem::path& directory,
+    uint16_t port);
+
+private:
+  void Write(
+    CaptureRecord::Type type,
+    ClientId clientId,
+    uint16_t commandId,
+    std::span<const std::byte> data);
+
+  std::mutex _mutex;
+  std::ofstream _file;
+  std::chrono::steady_clock::time_point _beginTime;
+};
+
+//! Reader of a capture file.
+class CaptureReader final
+{
+public:
+  //! Constructor. Opens the capture file and reads its header.
+  //! @param path Path of the capture file.
+  //! @throws std::runtime_error If the file can't be opened or is not a capture file.
+  explicit CaptureReader(const std::filesystem::path& path);
+
+  //! Returns the header of the capture file.
+  //! @returns Header.
+  [[nodiscard]] const CaptureHeader& GetHeader() const noexcept;
+
+  //! Reads the next record.
+  //! @param record Record to read to.
+  //! @returns `true` if a record was read, `false` at the end of the file.
+  //! @throws std::runtime_error If the record is truncated.
+  bool Read(CaptureRecord& record);
+
+private:
+  std::ifstream _file;
+  CaptureHeader _header{};
+};
+
+} // namespace server::network
+
+#endif // CAPTURE_HPP
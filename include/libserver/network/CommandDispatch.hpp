@@ -0,0 +1,158 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+
+#ifndef COMMAND_DISPATCH_HPP
+#define COMMAND_DISPATCH_HPP
+
+#include "NetworkDefinitions.hpp"
+#include "libserver/util/Arena.hpp"
+#include "libserver/util/Stream.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <vector>
+
+namespace server::network
+{
+
+//! A command received from a client, unscrambled and decoded on the network thread
+//! of the client and handled on the strand of the director.
+//! The command data and the decoded command live in the dispatch until it is released,
+//! so the decoded command may borrow from the command data.
+//! Dispatches are pooled, so that dispatching a command does not allocate.
+class CommandDispatch final
+{
+public:
+  //! ID of the client which sent the command.
+  ClientId clientId{};
+  //! ID of the command.
+  uint16_t commandId{};
+
+  CommandDispatch() = default;
+  ~CommandDispatch();
+
+  CommandDispatch(const CommandDispatch&) = delete;
+  CommandDispatch& operator=(const CommandDispatch&) = delete;
+
+  //! Prepares space for the command data.
+  //! @param size Size of the space.
+  //! @returns Space for the command data.
+  [[nodiscard]] std::span<std::byte> PrepareData(std::size_t size);
+
+  //! Commits the command data written to the prepared space.
+  //! @param size Size of the command data.
+  void CommitData(std::size_t size) noexcept;
+
+  //! Returns the command data.
+  //! @returns Command data.
+  [[nodiscard]] std::span<const std::byte> GetData() const noexcept;
+
+  //! Decodes the command from the command data to the arena of the dispatch.
+  //! @returns Size of the command data read.
+  //! @throws std::exception If the command data are malformed.
+  template <ReadableStruct C>
+  std::size_t Decode()
+  {
+    assert(_command == nullptr);
+
+    auto* const command = _arena.New<C>();
+    _command = command;
+    _destroyCommand = [](void* command) noexcept
+    {
+      std::destroy_at(static_cast<C*>(command));
+    };
+
+    SourceStream source(GetData());
+    source.Read(*command);
+    return source.GetCursor();
+  }
+
+  //! Returns the decoded command.
+  //! @returns Decoded command.
+  template <ReadableStruct C>
+  [[nodiscard]] const C& GetCommand() const noexcept
+  {
+    assert(_command != nullptr);
+    return *static_cast<const C*>(_command);
+  }
+
+  //! Destroys the decoded command and releases the arena and the command data.
+  void Reset() noexcept;
+
+private:
+  friend class CommandDispatchPool;
+
+  std::unique_ptr<std::byte[]> _data;
+  std::size_t _dataCapacity{};
+  std::size_t _dataSize{};
+
+  //! Arena of the decoded command.
+  Arena _arena;
+  //! Decoded command, if any.
+  void* _command{};
+  //! Destroys the decoded command.
+  void (*_destroyCommand)(void*) noexcept{};
+
+  //! Index of the dispatch in its pool.
+  std::size_t _poolIdx{};
+};
+
+//! A thread-safe pool of the command dispatches.
+//! The pool owns all of its dispatches, including the acquired ones.
+class CommandDispatchPool final
+{
+public:
+  //! Constructor.
+  //! @param maxIdleCount Max count of the idle dispatches retained by the pool.
+  explicit CommandDispatchPool(std::size_t maxIdleCount = 256);
+
+  CommandDispatchPool(const CommandDispatchPool&) = delete;
+  CommandDispatchPool& operator=(const CommandDispatchPool&) = delete;
+
+  //! Acquires a dispatch from the pool.
+  //! @returns Dispatch, owned by the pool.
+  [[nodiscard]] CommandDispatch& Acquire();
+
+  //! Resets the dispatch and returns it to the pool.
+  //! @param dispatch Dispatch acquired from the pool.
+  void Release(CommandDispatch& dispatch) noexcept;
+
+  //! Returns the count of the idle dispatches retained by the pool.
+  //! @returns Count of the idle dispatches.
+  [[nodiscard]] std::size_t GetIdleCount() const;
+
+private:
+  std::size_t _maxIdleCount;
+
+  //! A mutex for the dispatches.
+  mutable std::mutex _mutex;
+  //! All the dispatches of the pool.
+  std::vector<std::unique_ptr<CommandDispatch>> _dispatches;
+  //! Idle dispatches.
+  std::vector<CommandDispatch*> _idleDispatches;
+};
+
+} // namespace server::network
+
+#endif // COMMAND_DISPATCH_HPP
@@ -5,12 +5,14 @@
 #ifndef ALICIA_SERVER_NETWORKDEFINITIONS_HPP
 #define ALICIA_SERVER_NETWORKDEFINITIONS_HPP
 
-#include <cstddef>
+#include <cstdint>
 
 namespace server::network
 {
 
-using ClientId = size_t;
+//! ID of a client, holding the index of its slot and the generation of the slot.
+//! 64-bit on every platform, so that both fit.
+using ClientId = uint64_t;
 
 } // namespace server::network
 
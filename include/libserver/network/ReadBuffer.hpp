@@ -0,0 +1,90 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#ifndef READ_BUFFER_HPP
+#define READ_BUFFER_HPP
+
+#include <cstddef>
+#include <memory>
+#include <span>
+
+namespace server::network
+{
+
+//! A reusable buffer of received data with an adaptive read size.
+//! The read size grows toward the max read size while the reads keep filling
+//! the prepared space and shrinks back toward the min read size when they do not.
+//! Consuming all the data rewinds the buffer without moving any data.
+//! Unconsumed data are moved to the front only when there is not enough space after them.
+class ReadBuffer final
+{
+public:
+  //! Constructor. No storage is allocated until the first read is prepared.
+  //! @param minReadSize Min size of a read.
+  //! @param maxReadSize Max size of a read.
+  ReadBuffer(std::size_t minReadSize, std::size_t maxReadSize);
+
+  //! Prepares contiguous space for the next read.
+  //! @returns Space for the read.
+  //! @throws std::length_error If there is more unconsumed data than the max read size.
+  [[nodiscard]] std::span<std::byte> Prepare();
+
+  //! Commits the data read to the prepared space.
+  //! @param size Size of the data read.
+  void Commit(std::size_t size);
+
+  //! Returns the data which were not consumed yet.
+  //! @returns Unconsumed data.
+  [[nodiscard]] std::span<const std::byte> GetData() const noexcept;
+
+  //! Consumes the data.
+  //! @param size Size of the data to consume.
+  void Consume(std::size_t size);
+
+  //! Releases the storage and resets the read size,
+  //! if there are no unconsumed data.
+  void Trim() noexcept;
+
+  //! Returns the size of the next read.
+  //! @returns Read size.
+  [[nodiscard]] std::size_t GetReadSize() const noexcept;
+
+  //! Returns the size of the allocated storage.
+  //! @returns Capacity.
+  [[nodiscard]] std::size_t GetCapacity() const noexcept;
+
+private:
+  std::size_t _minReadSize;
+  std::size_t _maxReadSize;
+  //! Size of the next read.
+  std::size_t _readSize;
+  //! Size of the space prepared for the last read.
+  std::size_t _preparedSize{};
+
+  std::unique_ptr<std::byte[]> _storage;
+  std::size_t _capacity{};
+  //! Offset of the first unconsumed byte.
+  std::size_t _begin{};
+  //! Offset past the last received byte.
+  std::size_t _end{};
+};
+
+} // namespace server::network
+
+#endif // READ_BUFFER_HPP
@@ -20,15 +20,29 @@
 #ifndef SERVER_HPP
 #define SERVER_HPP
 
+#include "BufferPool.hpp"
 #include "NetworkDefinitions.hpp"
+#include "ReadBuffer.hpp"
+#include "SlotMap.hpp"
+#include "TimingWheel.hpp"
 
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <cstdint>
 #include <deque>
+#include <filesystem>
 #include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <queue>
 #include <span>
+#include <stdexcept>
+#include <thread>
+#include <typeinfo>
 #include <unordered_map>
+#include <vector>
 
 #include <boost/asio.hpp>
 
@@ -37,8 +51,73 @@ namespace server::network
 
 namespace asio = boost::asio;
 
-//! A write handler.
-using WriteSupplier = std::function<size_t(asio::streambuf&)>;
+//! Key of a droppable write.
+//! Writes with the same non-zero key carry the same state, a newer one
+//! supersedes the older one. Zero key marks a write which must not be dropped.
+using CoalescingKey = uint64_t;
+
+//! Makes a non-zero coalescing key.
+//! @param type Type of the state, for example a command ID.
+//! @param subject Subject of the state, for example an object ID.
+//! @returns Coalescing key.
+constexpr CoalescingKey MakeCoalescingKey(uint32_t type, uint32_t subject) noexcept
+{
+  return CoalescingKey{1} << 63
+    | static_cast<CoalescingKey>(type & 0x7FFF'FFFF) << 32
+    | subject;
+}
+
+//! Limits of a client's write queue.
+struct WriteQueueLimits
+{
+  //! Max count of the writes queued or being written. Zero disables the limit.
+  std::size_t maxWriteCount{4096};
+  //! Max size of the writes queued or being written, in bytes. Zero disables the limit.
+  std::size_t maxByteCount{4 * 1024 * 1024};
+  //! For how long may the queue stay over the limits before the client is disconnected.
+  std::chrono::milliseconds overLimitTimeout{std::chrono::seconds(10)};
+};
+
+//! Limits of a client's read buffer.
+struct ReadBufferLimits
+{
+  //! Min size of a read. Reads start at this size.
+  std::size_t minReadSize{1024};
+  //! Max size of a read. Reads grow toward this size while they keep filling the buffer.
+  std::size_t maxReadSize{64 * 1024};
+  //! For how long may a client not send any data before its read buffer is released.
+  //! Zero disables the release.
+  std::chrono::seconds trimTimeout{30};
+};
+
+//! Limits of the connections accepted by the server.
+struct ConnectionLimits
+{
+  //! Max count of the active connections of the server.
+  //! Also sizes the registry of the clients.
+  std::size_t maxConnections{8192};
+  //! Max count of the active connections from an address.
+  std::size_t maxConnectionsPerAddress{3};
+  //! Max count of the connection attempts from an address within the rate window.
+  std::size_t maxConnectRatePerAddress{10};
+  //! Window of the connection rate.
+  std::chrono::seconds rateWindow{30};
+};
+
+//! Metrics of a client's write queue.
+struct WriteQueueMetrics
+{
+  //! Count of the writes queued or being written.
+  std::size_t writeCount{};
+  //! Size of the writes queued or being written, in bytes.
+  std::size_t byteCount{};
+  //! Peak size of the writes queued or being written, in bytes.
+  std::size_t peakByteCount{};
+  //! Count of the droppable writes superseded by a newer write.
+  std::size_t coalescedWriteCount{};
+  //! Count of the droppable writes dropped.
+  std::size_t droppedWriteCount{};
+};
 
 //!
 class EventHandlerInterface
@@ -73,21 +152,101 @@ class Client : public std::enable_shared_from_this<Client>
 public:
   //! Default constructor.
   //! @param socket Underlying socket (remote address is read from it).
+  //!               All the I/O of the client is serialized through the socket's executor,
+  //!               which is expected to be a strand.
+  //! @param writeQueueLimits Limits of the write queue.
+  //! @param readBufferLimits Limits of the read buffer.
   explicit Client(
     ClientId clientId,
     asio::ip::tcp::socket&& socket,
-    EventHandlerInterface& networkEventHandler) noexcept;
+    EventHandlerInterface& networkEventHandler,
+    const WriteQueueLimits& writeQueueLimits = {},
+    const ReadBufferLimits& readBufferLimits = {}) noexcept;
 
   //! Begins the client's asynchronous read loop.
   void Begin();
   //! Ends the client's asynchronous read loop.
   void End();
-  //! Queues a write.
-  void QueueWrite(WriteSupplier writeSupplier);
+  //! Queues a write of serialized data.
+  //! Thread-safe, the write is performed on the client's strand.
+  //! The buffers queued in the meantime are written together.
+  //! When the write queue is over its limits, a droppable write supersedes
+  //! the queued write with the same key, or is dropped if there is none.
+  //! Only the writes still queued are superseded, a write with the same key
+  //! which is already being sent is not replaced and the new write is dropped.
+  //! Other writes are queued regardless, but if the queue stays over
+  //! the limits for too long, the client is disconnected.
+  //! @param buffer Buffer with the data to write.
+  //! @param coalescingKey Key of a droppable write, zero if the write must not be dropped.
+  void QueueWrite(WriteBuffer buffer, CoalescingKey coalescingKey = 0);
+  //! Disconnects the client if its write queue stayed over the limits for too long.
+  void EnforceWriteQueueLimits();
+  //! Returns the metrics of the write queue.
+  //! @returns Write queue metrics.
+  [[nodiscard]] WriteQueueMetrics GetWriteQueueMetrics() const;
+  //! Releases the read buffer if the client did not send any data
+  //! for longer than the trim timeout of the read buffer.
+  //! Thread-safe, performed on the client's strand.
+  void TrimReadBuffer();
+  //! Returns the time point of the last data received from the client,
+  //! or of the connection if the client did not send any data yet.
+  //! @returns Time point of the last activity.
+  [[nodiscard]] std::chrono::steady_clock::time_point GetLastActivity() const noexcept;
+  //! Returns the ID of the client.
+  //! @returns Client ID.
+  [[nodiscard]] ClientId GetId() const noexcept;
   //!
   asio::ip::address_v4 GetAddress() const noexcept;
 
+  //! Attaches the state of a protocol layer to the client.
+  //! The state can be attached only once, it is expected to be attached
+  //! when the client connects, before any of its data are read,
+  //! the state then lives as long as the client. Thread-safe, the state
+  //! is published to the threads calling `GetUserData` once constructed.
+  //! @returns Reference to the attached state.
+  //! @throws std::logic_error if a state is already attached.
+  template <typename T, typename... Args>
+  T& EmplaceUserData(Args&&... args)
+  {
+    if (_isUserDataEmplaced.exchange(true, std::memory_order::relaxed))
+      throw std::logic_error("Client state is already attached");
+
+    auto userData = std::make_shared<T>(std::forward<Args>(args)...);
+    T& reference = *userData;
+    _userData = std::move(userData);
+    // Publish the state, the type is read before the state.
+    _userDataType.store(&typeid(T), std::memory_order::release);
+    return reference;
+  }
+
+  //! Returns the state of a protocol layer attached to the client.
+  //! Thread-safe, the state itself is not synchronized by the client.
+  //! @returns Pointer to the attached state,
+  //!          or null if no state of the type is attached yet.
+  template <typename T>
+  [[nodiscard]] T* GetUserData() const noexcept
+  {
+    const auto* const userDataType = _userDataType.load(std::memory_order::acquire);
+    if (userDataType == nullptr || *userDataType != typeid(T))
+      return nullptr;
+    return static_cast<T*>(_userData.get());
+  }
+
 private:
+  //! A write in the write queue.
+  struct QueuedWrite
+  {
+    WriteBuffer buffer;
+    CoalescingKey coalescingKey{};
+  };
+
+  //! Checks whether the write queue of the specified size is over the limits.
+  [[nodiscard]] bool IsOverWriteQueueLimits(std::size_t writeCount, std::size_t byteCount) const noexcept;
+  //! Tracks for how long the write queue is over the limits.
+  //! Expects the write mutex to be held.
+  //! @returns `true` if the queue stayed over the limits for too long, `false` otherwise.
+  bool UpdateWriteQueueLimitState();
+
   void WriteLoop() noexcept;
   //! Read loop.
   void ReadLoop() noexcept;
@@ -95,17 +254,30 @@ private:
   //! Indicates whether the client should process I/O.
   std::atomic<bool> _shouldRun = false;
 
-  //! A mutex for write buffer.
-  std::mutex _writeMutex;
-  //! A queue of write suppliers.
-  std::queue<WriteSupplier> _writeQueue{};
-  std::condition_variable _writeCv{};
-  //! A write buffer.
-  asio::streambuf _writeBuffer{};
+  //! Limits of the write queue.
+  WriteQueueLimits _writeQueueLimits;
+  //! A mutex for the write queue and its metrics.
+  mutable std::mutex _writeMutex;
+  //! A queue of writes pending.
+  std::vector<QueuedWrite> _writeQueue{};
+  //! Writes being written. Accessed only on the client's strand.
+  std::vector<QueuedWrite> _sendingWrites{};
+  //! Metrics of the write queue.
+  WriteQueueMetrics _writeQueueMetrics{};
+  //! Time point since which the write queue is over the limits.
+  std::optional<std::chrono::steady_clock::time_point> _writeQueueOverLimitSince;
+  //! Buffer sequence of the buffers being written.
+  std::vector<asio::const_buffer> _sendingBufferSequence{};
   std::atomic<bool> _isSending = false;
 
-  //! A read buffer.
-  asio::streambuf _readBuffer{};
+  //! Limits of the read buffer.
+  ReadBufferLimits _readBufferLimits;
+  //! A read buffer. Accessed only on the client's strand.
+  ReadBuffer _readBuffer;
+  //! Whether the read buffer was released and no data were received since.
+  std::atomic<bool> _isReadBufferTrimmed = false;
+  //! Time since epoch of the last data received from the client.
+  std::atomic<std::chrono::steady_clock::rep> _lastActivity;
 
   //! A unique-identifier of the client.
   ClientId _clientId;
@@ -115,6 +287,40 @@ private:
   asio::ip::tcp::socket _socket;
   //! A network event handling interface
   EventHandlerInterface& _networkEventHandler;
+
+  //! Whether the state of the protocol layer was attached.
+  std::atomic<bool> _isUserDataEmplaced{false};
+  //! State of the protocol layer attached to the client.
+  //! Written once, before its type is published.
+  std::shared_ptr<void> _userData;
+  //! Type of the attached state, null until the state is published.
+  std::atomic<const std::type_info*> _userDataType{nullptr};
+};
+
+//! Settings of a server.
+struct ServerSettings
+{
+  //! Count of threads performing the I/O of the server.
+  //! Every thread runs its own I/O context and the accepted
+  //! clients are distributed between them.
+  std::size_t ioThreadCount{1};
+  //! Count of acceptors listening on the port of the server.
+  //! Multiple acceptors share the port through `SO_REUSEPORT`
+  //! and the kernel balances the incoming connections between them.
+  //! Each acceptor is driven by its own I/O context.
+  std::size_t acceptorCount{1};
+  //! Limits of the write queue of every client.
+  WriteQueueLimits writeQueueLimits{};
+  //! Limits of the read buffer of every client.
+  ReadBufferLimits readBufferLimits{};
+  //! Limits of the connections of the server and from a single address.
+  ConnectionLimits connectionLimits{};
+  //! For how long may a client stay connected without sending any data
+  //! before it is disconnected. Zero disables the timeout.
+  std::chrono::seconds idleTimeout{0};
+  //! Directory the inbound commands are captured to, for the replay tool.
+  //! Empty disables the capture.
+  std::filesystem::path captureDirectory{};
 };
 
 //! Server with event-driven acceptor, reads and writes.
@@ -130,15 +336,21 @@ public:
   //!
   //! @param address Address of the interface to bind to.
   //! @param port Port to bind to.
+  //! @param settings Settings of the server.
   //! @throw std::runtime_error
   void Begin(
     const asio::ip::address& address,
-    uint16_t port);
+    uint16_t port,
+    const ServerSettings& settings = {});
 
   //! Ends the server.
   void End();
 
   //! Get client.
+  //! Thread-safe and lock-free.
+  //! @param clientId ID of the client.
+  //! @returns Client.
+  //! @throws std::runtime_error If the client does not exist.
   std::shared_ptr<Client> GetClient(ClientId clientId);
 
   void HandleNetworkTick() override;
@@ -153,19 +365,48 @@ private:
     std::deque<std::chrono::steady_clock::time_point> connectionTimestamps;
   };
 
-  void AcceptLoop() noexcept;
+  void AcceptLoop(asio::ip::tcp::acceptor& acceptor) noexcept;
   void TickLoop() noexcept;
+  //! Disconnects the clients which stayed idle for longer than the idle timeout.
+  void ReapIdleClients() noexcept;
   bool IsConnectionThrottled(const asio::ip::address_v4& address) noexcept;
   void OnThrottleDisconnect(const asio::ip::address_v4& address) noexcept;
+  //! Returns the I/O context to which the next client should be bound.
+  //! The contexts are picked in a round-robin fashion.
+  //! @returns Reference to the I/O context.
+  asio::io_context& NextIoContext() noexcept;
 
+  //! A primary I/O context driving the first acceptor and the tick timer.
+  //! Runs on the thread which began the server.
   asio::io_context _io_ctx;
-  asio::ip::tcp::acceptor _acceptor;
   asio::steady_timer _timer;
 
-  //! Sequential client ID.
-  ClientId _client_id = 0;
-  //! Map of clients.
-  std::unordered_map<ClientId, std::shared_ptr<Client>> _clients;
+  //! Additional I/O contexts of the I/O thread pool.
+  std::vector<std::unique_ptr<asio::io_context>> _workerIoContexts;
+  //! Threads running the additional I/O contexts.
+  std::vector<std::thread> _workerThreads;
+  //! Index of the next I/O context to bind a client to.
+  std::atomic<std::size_t> _nextIoContextIdx = 0;
+  //! Acceptors listening on the port of the server.
+  std::vector<std::unique_ptr<asio::ip::tcp::acceptor>> _acceptors;
+  //! Settings of the server.
+  ServerSettings _settings;
+
+  //! Registry of the clients, addressed by generation-tagged client IDs.
+  //! Created once the server begins, sized from the connection limits.
+  std::unique_ptr<SlotMap<Client>> _clients;
+  //! A mutex for the idle timing wheel.
+  std::mutex _idleWheelMutex;
+  //! Idle deadlines of the clients, advanced by the tick loop.
+  //! A client is rescheduled from its last activity when its deadline expires,
+  //! the entries of the disconnected clients expire harmlessly.
+  TimingWheel _idleWheel;
+  //! IDs of the clients whose idle deadline expired on the tick.
+  std::vector<ClientId> _expiredIdleClients;
+  //! A mutex for the address states and the count of active connections.
+  std::mutex _addressStatesMutex;
+  //! Count of active connections across all the acceptors.
+  std::size_t _activeConnections = 0;
   //! Per-address state for connection throttling.
   std::unordered_map<asio::ip::address_v4, AddressState> _addressStates;
 
@@ -0,0 +1,263 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#ifndef SLOT_MAP_HPP
+#define SLOT_MAP_HPP
+
+#include "NetworkDefinitions.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace server::network
+{
+
+//! A fixed-capacity map of shared values addressed by generation-tagged IDs.
+//! The lower 32 bits of an ID are the index of the slot, the upper 32 bits are
+//! the generation of the slot. The generation changes whenever a value is erased,
+//! so stale IDs do not resolve to the value which reused the slot.
+//!
+//! Lookups are O(1) and lock-free. A lookup registers as a reader of the slot
+//! in the state word of the slot, which also holds the generation of the slot
+//! and whether it is occupied, and copies the value only if the slot is occupied
+//! with the requested generation.
+//! Insertions and erasures are serialized between each other. An erasure invalidates
+//! the slot first and then waits for the registered readers before it takes the value.
+template <typename T>
+class SlotMap final
+{
+public:
+  //! Constructor.
+  //! @param capacity Max count of the values.
+  explicit SlotMap(std::size_t capacity)
+    : _slots(std::make_unique<Slot[]>(capacity))
+    , _capacity(capacity)
+  {
+    _freeSlots.reserve(capacity);
+    // Free slots are popped from the back, hand out the lower indices first.
+    for (std::size_t slotIdx = capacity; slotIdx > 0; --slotIdx)
+      _freeSlots.emplace_back(static_cast<uint32_t>(slotIdx - 1));
+  }
+
+  //! Emplaces a value created by the factory.
+  //! @param factory Factory creating the value from its ID.
+  //!                Called while the insertions are blocked.
+  //! @returns Emplaced value. Null if there is no free slot.
+  template <typename Factory>
+  std::shared_ptr<T> Emplace(Factory&& factory)
+  {
+    std::scoped_lock lock(_mutex);
+    if (_freeSlots.empty())
+      return nullptr;
+
+    const uint32_t slotIdx = _freeSlots.back();
+    auto& slot = _slots[slotIdx];
+
+    std::shared_ptr<T> value = factory(
+      MakeId(slotIdx, GetStateGeneration(slot.state.load(std::memory_order::relaxed))));
+    if (not value)
+      return nullptr;
+
+    _freeSlots.pop_back();
+
+    // The readers do not access the value of an unoccupied slot,
+    // the value is published by marking the slot occupied.
+    slot.value = value;
+    slot.state.fetch_or(OccupiedBit, std::memory_order::release);
+    _size.fetch_add(1, std::memory_order::relaxed);
+
+    return value;
+  }
+
+  //! Gets the value.
+  //! @param id ID of the value.
+  //! @returns Value. Null if the ID is not valid or is stale.
+  [[nodiscard]] std::shared_ptr<T> Get(ClientId id) const noexcept
+  {
+    const auto slotIdx = GetSlotIndex(id);
+    if (slotIdx >= _capacity)
+      return nullptr;
+
+    const auto& slot = _slots[slotIdx];
+    std::shared_ptr<T> value;
+
+    // Register as a reader, so that the value is not taken
+    // by an erasure while it is being copied.
+    const uint64_t state = slot.state.fetch_add(1, std::memory_order::acquire);
+    if ((state & OccupiedBit) != 0
+      && GetStateGeneration(state) == GetGeneration(id))
+    {
+      value = slot.value;
+    }
+    slot.state.fetch_sub(1, std::memory_order::release);
+
+    return value;
+  }
+
+  //! Erases the value.
+  //! @param id ID of the value.
+  //! @returns `true` if the value was erased, `false` if the ID is not valid or is stale.
+  bool Erase(ClientId id)
+  {
+    const auto slotIdx = GetSlotIndex(id);
+    if (slotIdx >= _capacity)
+      return false;
+
+    std::shared_ptr<T> value;
+
+    {
+      std::scoped_lock lock(_mutex);
+
+      auto& slot = _slots[slotIdx];
+      uint64_t state = slot.state.load(std::memory_order::relaxed);
+      if ((state & OccupiedBit) == 0
+        || GetStateGeneration(state) != GetGeneration(id))
+      {
+        return false;
+      }
+
+      // Invalidate the ID, so that no new reader copies the value.
+      // Only the readers change the state concurrently.
+      const uint64_t invalidatedState = MakeState(NextGeneration(GetStateGeneration(state)));
+      while (not slot.state.compare_exchange_weak(
+        state,
+        invalidatedState | (state & ReaderMask),
+        std::memory_order::relaxed))
+      {
+      }
+
+      // Wait for the readers which might still be copying the value.
+      while ((slot.state.load(std::memory_order::acquire) & ReaderMask) != 0)
+        std::this_thread::yield();
+
+      value = std::move(slot.value);
+      _freeSlots.emplace_back(slotIdx);
+      _size.fetch_sub(1, std::memory_order::relaxed);
+    }
+
+    // The value is released outside of the lock.
+    return true;
+  }
+
+  //! Invokes the function for every value.
+  //! Values inserted or erased concurrently may or may not be visited.
+  //! @param function Function invoked with the shared value.
+  template <typename Function>
+  void ForEach(Function&& function) const
+  {
+    for (std::size_t slotIdx = 0; slotIdx < _capacity; ++slotIdx)
+    {
+      const auto& slot = _slots[slotIdx];
+      std::shared_ptr<T> value;
+
+      const uint64_t state = slot.state.fetch_add(1, std::memory_order::acquire);
+      if ((state & OccupiedBit) != 0)
+        value = slot.value;
+      slot.state.fetch_sub(1, std::memory_order::release);
+
+      if (value)
+        function(value);
+    }
+  }
+
+  //! Returns the count of the values.
+  //! @returns Count of the values.
+  [[nodiscard]] std::size_t GetSize() const noexcept
+  {
+    return _size.load(std::memory_order::relaxed);
+  }
+
+  //! Returns the max count of the values.
+  //! @returns Capacity.
+  [[nodiscard]] std::size_t GetCapacity() const noexcept
+  {
+    return _capacity;
+  }
+
+  //! Returns the generation following the generation of a slot.
+  //! Zero is skipped when the generation wraps, so that zero is never a valid ID.
+  //! @param generation Generation of the slot.
+  //! @returns Next generation.
+  [[nodiscard]] static constexpr uint32_t NextGeneration(uint32_t generation) noexcept
+  {
+    const uint32_t nextGeneration = generation + 1;
+    return nextGeneration == 0 ? 1 : nextGeneration;
+  }
+
+private:
+  //! Mask of the count of the readers in the state of a slot.
+  static constexpr uint64_t ReaderMask = 0x7FFF'FFFF;
+  //! Bit of the state of a slot set while the slot is occupied.
+  static constexpr uint64_t OccupiedBit = 0x8000'0000;
+
+  struct Slot
+  {
+    //! State of the slot. The upper 32 bits are the generation of the slot,
+    //! bit 31 is set while the slot is occupied and the lower bits count the readers.
+    //! The generation starts at one, so that zero is never a valid ID.
+    mutable std::atomic<uint64_t> state{MakeState(1)};
+    //! Value of the slot. Accessed by the readers only while the slot is occupied,
+    //! modified only while the slot is not occupied and has no readers.
+    std::shared_ptr<T> value;
+  };
+
+  [[nodiscard]] static constexpr uint64_t MakeState(uint32_t generation) noexcept
+  {
+    return static_cast<uint64_t>(generation) << 32;
+  }
+
+  [[nodiscard]] static constexpr uint32_t GetStateGeneration(uint64_t state) noexcept
+  {
+    return static_cast<uint32_t>(state >> 32);
+  }
+
+  [[nodiscard]] static constexpr ClientId MakeId(uint32_t slotIdx, uint32_t generation) noexcept
+  {
+    return static_cast<ClientId>(generation) << 32 | slotIdx;
+  }
+
+  [[nodiscard]] static constexpr std::size_t GetSlotIndex(ClientId id) noexcept
+  {
+    return static_cast<uint32_t>(id & 0xFFFF'FFFF);
+  }
+
+  [[nodiscard]] static constexpr uint32_t GetGeneration(ClientId id) noexcept
+  {
+    return static_cast<uint32_t>(id >> 32);
+  }
+
+  static_assert(sizeof(ClientId) == sizeof(uint64_t), "Client ID must fit the slot index and the generation");
+
+  std::unique_ptr<Slot[]> _slots;
+  std::size_t _capacity;
+  std::atomic<std::size_t> _size = 0;
+
+  //! A mutex for the insertions and the erasures.
+  std::mutex _mutex;
+  //! Indices of the free slots.
+  std::vector<uint32_t> _freeSlots;
+};
+
+} // namespace server::network
+
+#endif // SLOT_MAP_HPP
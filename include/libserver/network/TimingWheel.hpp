@@ -0,0 +1,76 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#ifndef TIMING_WHEEL_HPP
+#define TIMING_WHEEL_HPP
+
+#include "NetworkDefinitions.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace server::network
+{
+
+//! A hashed timing wheel of client deadlines, advanced by a periodic tick.
+//! Scheduling and expiry are constant-time, independent of the count of clients.
+//! Entries can't be cancelled, the owner is expected to tolerate the expiry
+//! of a client which no longer exists. Not thread-safe.
+class TimingWheel final
+{
+public:
+  //! Constructor.
+  //! @param slotCount Count of the slots of the wheel.
+  //!                  Deadlines further than the count of slots take more rounds of the wheel.
+  explicit TimingWheel(std::size_t slotCount = 512);
+
+  //! Schedules the expiry of the client.
+  //! @param clientId ID of the client.
+  //! @param delay Count of ticks after which the client expires, at least one.
+  void Schedule(ClientId clientId, uint64_t delay);
+
+  //! Advances the wheel by one tick.
+  //! @param expired Vector to which the IDs of the expired clients are appended.
+  void Advance(std::vector<ClientId>& expired);
+
+  //! Returns the count of ticks the wheel advanced by.
+  //! @returns Current tick.
+  [[nodiscard]] uint64_t GetTick() const noexcept;
+
+  //! Returns the count of the scheduled clients.
+  //! @returns Count of the scheduled clients.
+  [[nodiscard]] std::size_t GetSize() const noexcept;
+
+private:
+  //! A scheduled client.
+  struct Entry
+  {
+    ClientId clientId{};
+    //! Count of full rounds of the wheel left until the expiry.
+    uint64_t rounds{};
+  };
+
+  std::vector<std::vector<Entry>> _slots;
+  uint64_t _tick{};
+  std::size_t _size{};
+};
+
+} // namespace server::network
+
+#endif // TIMING_WHEEL_HPP
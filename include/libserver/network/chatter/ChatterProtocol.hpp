@@ -20,12 +20,24 @@
 #ifndef CHATTERPROTOCOL_HPP
 #define CHATTERPROTOCOL_HPP
 
+#include <array>
+#include <cstddef>
 #include <cstdint>
+#include <span>
 #include <string_view>
+#include <vector>
 
 namespace server::protocol
 {
 
+//! The XOR code with which the whole command, including the header, is scrambled.
+//! Unlike the command protocol, the code does not roll.
+constexpr std::array<std::byte, 4> ChatterXorCode{
+  static_cast<std::byte>(0x2B),
+  static_cast<std::byte>(0xFE),
+  static_cast<std::byte>(0xB8),
+  static_cast<std::byte>(0x02)};
+
 struct ChatterCommandHeader
 {
   //! A length of the command payload.
@@ -105,11 +117,24 @@ enum class ChatterCommand : uint16_t
   ChatCmdChannelInfoGuildRoomAckOk = 0x46,
 
   ChatCmdChangeLetterOption = 0x4B,
-  ChatCmdChangeLetterOptionAckOk = 0x4C
+  ChatCmdChangeLetterOptionAckOk = 0x4C,
+  Count = 0x4D
 };
 
 std::string_view GetChatterCommandName(server::protocol::ChatterCommand command);
 
+//! Appends the command the way a game client sends it to the server,
+//! the header followed by the command data, scrambled with the XOR code.
+//! Used by the tools acting as the clients.
+//!
+//! @param commandId ID of the command.
+//! @param commandData Command data.
+//! @param output Buffer to append the command to.
+void WriteClientChatterCommand(
+  uint16_t commandId,
+  std::span<const std::byte> commandData,
+  std::vector<std::byte>& output);
+
 } // namespace server::protocol
 
 #endif //CHATTERPROTOCOL_HPP
@@ -20,17 +20,25 @@
 #ifndef CHATTER_SERVER_HPP
 #define CHATTER_SERVER_HPP
 
+#include "libserver/network/Capture.hpp"
+#include "libserver/network/CommandDispatch.hpp"
 #include "libserver/network/Server.hpp"
+#include "libserver/util/Executor.hpp"
+#include "libserver/util/Profiler.hpp"
 #include "libserver/util/Stream.hpp"
 #include "libserver/Constants.hpp"
 #include "libserver/util/Util.hpp"
+#include "libserver/util/Xor.hpp"
 
 #include "proto/ChatterMessageDefinitions.hpp"
 
 #include <spdlog/spdlog.h>
 
+#include <concepts>
 #include <functional>
-#include <unordered_map>
+#include <memory>
+#include <span>
+#include <vector>
 
 namespace server
 {
@@ -46,7 +54,14 @@ public:
 };
 
 //! A raw command handler.
-using RawChatterCommandHandler = std::function<void(network::ClientId, SourceStream&)>;
+//! The decoding runs on the network thread of the client, the handling on the handler strand.
+struct RawChatterCommandHandler
+{
+  //! Decodes the command from the command data of the dispatch to its arena.
+  void (*decode)(network::CommandDispatch&){};
+  //! Handles the command decoded to the dispatch.
+  std::function<void(network::ClientId, const network::CommandDispatch&)> handle;
+};
 
 //! Concept for readable command structs.
 template <typename T>
@@ -59,103 +74,54 @@ class ChatterServer final
   : public network::EventHandlerInterface
 {
 public:
-  explicit ChatterServer(IChatterServerEventsHandler& chatterServerEventsHandler);
+  //! Constructor.
+  //! @param chatterServerEventsHandler Handler of the server events.
+  //! @param handlerStrand Strand the command handlers and the server events run on.
+  ChatterServer(
+    IChatterServerEventsHandler& chatterServerEventsHandler,
+    Executor::Strand& handlerStrand);
   ~ChatterServer();
 
-  void BeginHost(network::asio::ip::address_v4 address, uint16_t port);
+  void BeginHost(
+    network::asio::ip::address_v4 address,
+    uint16_t port,
+    const network::ServerSettings& settings = {});
   void EndHost();
 
   network::asio::ip::address_v4 GetClientAddress(const network::ClientId clientId);
   void DisconnectClient(network::ClientId clientId);
 
   //! Registers a command handler.
-  template <ReadableChatterCommandStruct C>
-  void RegisterCommandHandler(
-    std::function<void(network::ClientId clientId, const C& command)> handler)
+  //! The command is decoded on the network thread of the client to a pooled dispatch
+  //! and the handler is called with the dispatched command on the handler strand.
+  template <ReadableChatterCommandStruct C, typename Handler>
+    requires std::invocable<Handler&, network::ClientId, const C&>
+  void RegisterCommandHandler(Handler handler)
   {
-    _handlers[static_cast<uint16_t>(C::GetCommand())] = 
-      [handler](network::ClientId clientId, SourceStream& source)
-      {
-        C command;
-        C::Read(command, source);
-        handler(clientId, command);
-      };
+    auto& rawHandler = _handlers[static_cast<std::size_t>(C::GetCommand())];
+    rawHandler.decode = [](network::CommandDispatch& dispatch)
+    {
+      std::ignore = dispatch.Decode<C>();
+    };
+    rawHandler.handle = [handler](
+      network::ClientId clientId,
+      const network::CommandDispatch& dispatch) mutable
+    {
+      handler(clientId, dispatch.GetCommand<C>());
+    };
+    RegisterHandlerSection(C::GetCommand());
   }
 
   template<typename T>
   void QueueCommand(network::ClientId clientId, std::function<T()> commandSupplier)
   {
-    _server.GetClient(clientId)->QueueWrite([this, commandSupplier = std::move(commandSupplier)](
-      network::asio::streambuf& buf)
-    {
-      // todo: this templated function should just write the bytes to the buffer,
-      //       rest of the logic should be moved to non-templated function which deals with buffer directly.
-
-      const auto buffer = buf.prepare(4092);
-      SinkStream bufferSink({
-        static_cast<std::byte*>(buffer.data()),
-        buffer.size()});
-
-      // reserve the space for the header
-      bufferSink.Write(0);
-
-      // write the command data
-      T command = commandSupplier();
-      bufferSink.Write(command);
-
-      const protocol::ChatterCommandHeader header {
-        .length = static_cast<uint16_t>(bufferSink.GetCursor()),
-        .commandId = static_cast<uint16_t>(T::GetCommand()),};
-
-      if (debugOutgoingCommandData)
+    SendCommand(
+      clientId,
+      T::GetCommand(),
+      [&commandSupplier](SinkStream& sink)
       {
-        spdlog::debug("Write data for command '{}' (0x{:X}),\n\n"
-          "Command data size: {} \n"
-          "Data dump: \n\n{}\n",
-          GetChatterCommandName(T::GetCommand()),
-          static_cast<uint16_t>(T::GetCommand()),
-          header.length,
-          util::GenerateByteDump(
-            std::span(
-              static_cast<std::byte*>(buffer.data()) + sizeof(protocol::ChatterCommandHeader),
-              header.length - sizeof(protocol::ChatterCommandHeader))));
-      }
-
-      bufferSink.Seek(0);
-      bufferSink.Write(header.length)
-        .Write(header.commandId);
-
-      // scramble the message
-      SourceStream bufferSource({
-        static_cast<std::byte*>(buffer.data()),
-        header.length});
-
-      bufferSink.Seek(0);
-
-      constexpr std::array XorCode{
-        static_cast<std::byte>(0x2B),
-        static_cast<std::byte>(0xFE),
-        static_cast<std::byte>(0xB8),
-        static_cast<std::byte>(0x02)};
-
-      while (bufferSource.GetCursor() != bufferSource.Size())
-      {
-        std::byte val;
-        bufferSource.Read(val);
-        val ^= XorCode[(bufferSource.GetCursor() - 1) % 4];
-        bufferSink.Write(val);
-      }
-      
-      if (debugCommands)
-      {
-        spdlog::debug("Sent chatter command message '{}' (0x{:X})",
-          GetChatterCommandName(T::GetCommand()),
-          static_cast<uint16_t>(T::GetCommand()));
-      }
-
-      buf.commit(bufferSource.GetCursor());
-      return bufferSource.GetCursor();
-    });
+        sink.Write(commandSupplier());
+      });
   }
 
 private:
@@ -164,8 +130,45 @@ private:
   void OnClientDisconnected(network::ClientId clientId) override;
   size_t OnClientData(network::ClientId clientId, const std::span<const std::byte>& data) override;
 
+  //! Handles the dispatched command and releases the dispatch.
+  //! Runs on the handler strand.
+  //! @param dispatch Dispatch of the command.
+  void HandleDispatch(network::CommandDispatch& dispatch);
+
+  //! Registers the profiler section of the command handler.
+  //! @param commandId ID of the command.
+  void RegisterHandlerSection(protocol::ChatterCommand commandId);
+
+  //! Serializes the command to a pooled payload.
+  //! @param commandId ID of the command.
+  //! @param writer Writer of the command data.
+  //! @returns Serialized and scrambled command.
+  network::WriteBuffer SerializeCommand(
+    protocol::ChatterCommand commandId,
+    const std::function<void(SinkStream&)>& writer);
+
+  //! Serializes the command on the calling thread and queues it for sending.
+  //! A command which fails to serialize is logged and dropped.
+  //! @param clientId ID of the client to send the command to.
+  //! @param commandId ID of the command.
+  //! @param writer Writer of the command data.
+  void SendCommand(
+    network::ClientId clientId,
+    protocol::ChatterCommand commandId,
+    const std::function<void(SinkStream&)>& writer);
+
   IChatterServerEventsHandler& _chatterServerEventsHandler;
-  std::unordered_map<uint16_t, RawChatterCommandHandler> _handlers{};
+  //! Command handlers indexed by the command IDs.
+  std::vector<RawChatterCommandHandler> _handlers;
+  //! Pool of the dispatches of the decoded commands.
+  network::CommandDispatchPool _dispatchPool;
+  //! Profiler sections of the command handlers indexed by the command IDs.
+  std::vector<Profiler::SectionId> _handlerSections;
+  //! Strand the command handlers and the server events run on,
+  //! serialized with the ticks of the director owning the server.
+  Executor::Strand& _handlerStrand;
+  //! Capture of the inbound commands, if enabled.
+  std::unique_ptr<network::CaptureWriter> _capture;
 
   network::Server _server;
   std::thread _serverThread;
@@ -25,6 +25,7 @@
 #include <libserver/util/Stream.hpp>
 
 #include <cstdint>
+#include <memory_resource>
 #include <string>
 #include <vector>
 
@@ -1094,7 +1095,16 @@ struct ChatCmdLeaveBuddyTrs
 
 struct ChatCmdChat
 {
-  std::string message{};
+  //! The message is decoded to the allocator of the command.
+  using allocator_type = std::pmr::polymorphic_allocator<>;
+
+  ChatCmdChat() = default;
+  explicit ChatCmdChat(const allocator_type& allocator)
+    : message(allocator)
+  {
+  }
+
+  std::pmr::string message{};
   //! Role of the character. `User` and `GameMaster` get sent but `Op` never works.
   enum class Role : uint8_t
   {
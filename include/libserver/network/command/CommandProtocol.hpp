@@ -21,7 +21,9 @@
 #define COMMAND_PROTOCOL_HPP
 
 #include <array>
+#include <cstddef>
 #include <cstdint>
+#include <span>
 #include <string_view>
 
 namespace server::protocol
@@ -71,6 +73,27 @@ MessageMagic decode_message_magic(uint32_t value);
 //! @return Encoded message magic value.
 uint32_t encode_message_magic(MessageMagic magic);
 
+//! Applies the XOR code to the source data and writes the result to the sink.
+//! The operation is symmetric, the same call both scrambles and unscrambles the data.
+//! The sink may be the same memory as the source.
+//!
+//! @param code XOR code.
+//! @param source Source data.
+//! @param sink Sink of the data. Must be at least as large as the source.
+//! @throws std::invalid_argument If the sink is smaller than the source.
+void ApplyXorCode(
+  const XorCode& code,
+  std::span<const std::byte> source,
+  std::span<std::byte> sink);
+
+//! Applies the XOR code to the data in-place.
+//!
+//! @param code XOR code.
+//! @param data Data.
+void ApplyXorCode(
+  const XorCode& code,
+  std::span<std::byte> data);
+
 //! IDs of the commands in the protocol.
 enum class Command : uint16_t
 {
@@ -22,11 +22,26 @@
 
 #include "CommandProtocol.hpp"
 #include "libserver/Constants.hpp"
+#include "libserver/network/Capture.hpp"
+#include "libserver/network/CommandDispatch.hpp"
 #include "libserver/network/Server.hpp"
+#include "libserver/util/Executor.hpp"
+#include "libserver/util/Profiler.hpp"
+#include "libserver/util/Schema.hpp"
 #include "libserver/util/Stream.hpp"
 
+#include <cassert>
+#include <concepts>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <mutex>
 #include <queue>
-#include <unordered_map>
+#include <ranges>
+#include <span>
+#include <vector>
+
+#include <spdlog/spdlog.h>
 
 namespace server
 {
@@ -35,7 +50,14 @@ namespace asio = network::asio;
 using ClientId = network::ClientId;
 
 //! A command handler.
-using RawCommandHandler = std::function<void(ClientId, SourceStream&)>;
+//! The decoding runs on the network thread of the client, the handling on the handler strand.
+struct RawCommandHandler
+{
+  //! Decodes the command from the command data of the dispatch to its arena.
+  void (*decode)(network::CommandDispatch&){};
+  //! Handles the command decoded to the dispatch.
+  std::function<void(ClientId, const network::CommandDispatch&)> handle;
+};
 
 //! A command supplier.
 using CommandSupplier = std::function<void(SinkStream&)>;
@@ -50,6 +72,18 @@ public:
   [[nodiscard]] const protocol::XorCode& GetRollingCode() const;
   [[nodiscard]] int32_t GetRollingCodeInt() const;
 
+  //! Appends the command the way a game client sends it to the server.
+  //! Rolls the code if there are command data, pads the data and scrambles them
+  //! with the code and prefixes them with the message magic.
+  //! Used by the tools acting as the clients.
+  //! @param commandId ID of the command.
+  //! @param commandData Command data.
+  //! @param output Buffer to append the command to.
+  void WriteClientCommand(
+    uint16_t commandId,
+    std::span<const std::byte> commandData,
+    std::vector<std::byte>& output);
+
 private:
   std::queue<CommandSupplier> _commandQueue;
   protocol::XorCode _rollingCode{};
@@ -80,15 +114,22 @@ public:
     virtual void HandleClientDisconnected(ClientId clientId) = 0;
   };
 
-  //! Default constructor;
-  explicit CommandServer(
-    EventHandlerInterface& events);
+  //! Constructor.
+  //! @param events Handler of the server events.
+  //! @param handlerStrand Strand the command handlers and the server events run on.
+  CommandServer(
+    EventHandlerInterface& events,
+    Executor::Strand& handlerStrand);
   ~CommandServer();
 
   //! Begins the server.
   //! @param address Address.
   //! @param port Port.
-  void BeginHost(const asio::ip::address& address, uint16_t port);
+  //! @param settings Settings of the network server.
+  void BeginHost(
+    const asio::ip::address& address,
+    uint16_t port,
+    const network::ServerSettings& settings = {});
 
   //! Ends the server.
   void EndHost();
@@ -97,18 +138,28 @@ public:
   void DisconnectClient(ClientId clientId);
 
   //! Registers a command handler.
-  //! @param commandId ID of the command to register the handler for.
+  //! The handler is stored in the dispatch table without another layer of type erasure,
+  //! handlers capturing only `this` are stored without an allocation.
+  //! The command is decoded on the network thread of the client to a pooled dispatch
+  //! and the handler is called with the dispatched command on the handler strand.
   //! @param handler Handler of the command.
-  template <ReadableCommandStruct C>
-  void RegisterCommandHandler(
-    std::function<void(ClientId clientId, const C& command)> handler)
+  template <ReadableCommandStruct C, typename Handler>
+    requires std::invocable<Handler&, ClientId, const C&>
+  void RegisterCommandHandler(Handler handler)
   {
-    _handlers[C::GetCommand()] = [handler](ClientId clientId, SourceStream& source)
+    auto& rawHandler = _handlers[static_cast<std::size_t>(C::GetCommand())];
+    rawHandler.decode = [](network::CommandDispatch& dispatch)
     {
-      C command;
-      C::Read(command, source);
-      handler(clientId, command);
+      [[maybe_unused]] const auto readSize = dispatch.Decode<C>();
+      assert(readSize == dispatch.GetData().size());
     };
+    rawHandler.handle = [handler](
+      ClientId clientId,
+      const network::CommandDispatch& dispatch) mutable
+    {
+      handler(clientId, dispatch.GetCommand<C>());
+    };
+    RegisterHandlerSection(C::GetCommand());
   }
 
   //! Queues a command for sending.
@@ -120,14 +171,103 @@ public:
     ClientId clientId,
     std::function<C()> supplier)
   {
-    SendCommand(clientId, C::GetCommand(), [supplier](SinkStream& sink){
-      C::Write(supplier(), sink);
-    });
+    if constexpr (SizedSchemaStruct<C>)
+    {
+      // The size of the command is known ahead,
+      // so the command is serialized directly to an exactly sized payload.
+      const C command = supplier();
+      SendCommand(
+        clientId,
+        C::GetCommand(),
+        [&command](SinkStream& sink){
+          sink.Write(command);
+        },
+        C::Schema::SerializedSize(command));
+    }
+    else
+    {
+      SendCommand(clientId, C::GetCommand(), [supplier](SinkStream& sink){
+        sink.Write(supplier());
+      });
+    }
+  }
+
+  //! Queues a command for sending to multiple clients.
+  //! The command is serialized only once and the serialized payload
+  //! is shared between all the recipients.
+  //! @param clientIds IDs of the clients to send the command to.
+  //! @param command Command.
+  //! @param coalescingKey Key of a droppable command, which may be superseded
+  //!                      or dropped for the clients not keeping up with their writes.
+  //!                      Zero if the command must not be dropped.
+  template <WritableCommandStruct C, std::ranges::input_range R>
+  void BroadcastCommand(
+    R&& clientIds,
+    const C& command,
+    network::CoalescingKey coalescingKey = 0)
+  {
+    CommandPayload payload;
+
+    for (const ClientId clientId : clientIds)
+    {
+      // Serialize the command lazily, only if there is a recipient.
+      if (not payload)
+      {
+        try
+        {
+          std::optional<std::size_t> commandDataSize;
+          if constexpr (SizedSchemaStruct<C>)
+            commandDataSize = C::Schema::SerializedSize(command);
+
+          payload = SerializeCommand(
+            C::GetCommand(),
+            [&command](SinkStream& sink){
+              sink.Write(command);
+            },
+            commandDataSize);
+        }
+        catch (const std::exception& x)
+        {
+          spdlog::error(
+            "Unhandled exception serializing command '{}' (0x{:X}) for client {}: {}",
+            GetCommandName(C::GetCommand()),
+            static_cast<uint32_t>(C::GetCommand()),
+            clientId,
+            x.what());
+          return;
+        }
+      }
+
+      SendCommandPayload(clientId, C::GetCommand(), payload, coalescingKey);
+    }
   }
 
   void SetCode(ClientId client, protocol::XorCode code);
 
+  //! Returns the metrics of the client's write queue.
+  //! @param clientId ID of the client.
+  //! @returns Write queue metrics.
+  [[nodiscard]] network::WriteQueueMetrics GetClientWriteQueueMetrics(ClientId clientId);
+
 private:
+  //! A serialized command shared between its recipients.
+  using CommandPayload = network::WriteBuffer;
+
+  //! Protocol state of a client, attached to its connection.
+  struct ClientState
+  {
+    //! A mutex for the rolling code, which is rolled on the client's network thread
+    //! and reset by the command handlers on the director threads.
+    std::mutex mutex;
+    CommandClient client;
+  };
+
+  //! Returns the protocol state of the client.
+  //! @param clientId ID of the client.
+  //! @returns Protocol state, sharing the ownership of the client.
+  //! @throws std::runtime_error If the client does not exist or did not connect yet.
+  std::shared_ptr<ClientState> GetClientState(ClientId clientId);
+
   class NetworkEventHandler
     : public network::EventHandlerInterface
   {
@@ -140,25 +280,80 @@ private:
     size_t OnClientData(network::ClientId clientId, const std::span<const std::byte>& data) override;
 
   private:
+    //! Handles the dispatched command and releases the dispatch.
+    //! Runs on the handler strand.
+    //! @param dispatch Dispatch of the command.
+    void HandleDispatch(network::CommandDispatch& dispatch);
+
     CommandServer& _commandServer;
   };
 
-  //!
+  //! Registers the profiler section of the command handler.
+  //! @param commandId ID of the command.
+  void RegisterHandlerSection(protocol::Command commandId);
+
+  //! Writes the whole command, including the message magic, to the buffer.
+  //! @param buffer Buffer to write the command to.
+  //! @param commandId ID of the command.
+  //! @param supplier Supplier of the command data.
+  //! @returns Size of the command written.
+  std::size_t WriteCommand(
+    std::span<std::byte> buffer,
+    protocol::Command commandId,
+    const CommandSupplier& supplier);
+
+  //! Serializes the command to a pooled payload shareable between recipients.
+  //! @param commandId ID of the command.
+  //! @param supplier Supplier of the command data.
+  //! @param commandDataSize Size of the command data, or its upper bound, if known ahead.
+  //!                        The command is then serialized directly to the payload.
+  //! @returns Serialized command.
+  CommandPayload SerializeCommand(
+    protocol::Command commandId,
+    const CommandSupplier& supplier,
+    std::optional<std::size_t> commandDataSize = std::nullopt);
+
+  //! Serializes the command on the calling thread and queues it for sending.
+  //! @param clientId ID of the client to send the command to.
+  //! @param commandId ID of the command.
+  //! @param supplier Supplier of the command data.
+  //! @param commandDataSize Size of the command data, or its upper bound, if known ahead.
   void SendCommand(
     ClientId clientId,
     protocol::Command commandId,
-    CommandSupplier supplier);
+    const CommandSupplier& supplier,
+    std::optional<std::size_t> commandDataSize = std::nullopt);
+
+  //! Queues a serialized command for sending.
+  //! @param clientId ID of the client to send the command to.
+  //! @param commandId ID of the command.
+  //! @param payload Serialized command.
+  //! @param coalescingKey Key of a droppable command, zero if the command must not be dropped.
+  void SendCommandPayload(
+    ClientId clientId,
+    protocol::Command commandId,
+    CommandPayload payload,
+    network::CoalescingKey coalescingKey = 0);
 
   bool debugIncomingCommandData = constants::DebugCommands;
   bool debugOutgoingCommandData = constants::DebugCommands;
   bool debugCommands = constants::DebugCommands;
 
-  std::unordered_map<protocol::Command, RawCommandHandler> _handlers{};
-  std::unordered_map<ClientId, CommandClient> _clients{};
-
+  //! Command handlers indexed by the command IDs.
+  std::vector<RawCommandHandler> _handlers;
+  //! Pool of the dispatches of the decoded commands.
+  network::CommandDispatchPool _dispatchPool;
+  //! Profiler sections of the command handlers indexed by the command IDs.
+  std::vector<Profiler::SectionId> _handlerSections;
   EventHandlerInterface& _eventHandler;
+  //! Strand the command handlers and the server events run on,
+  //! serialized with the ticks of the director owning the server.
+  Executor::Strand& _handlerStrand;
   NetworkEventHandler _serverNetworkEventHandler;
 
+  //! Capture of the inbound commands, if enabled.
+  std::unique_ptr<network::CaptureWriter> _capture;
+
   network::Server _server;
   std::thread _serverThread;
 };
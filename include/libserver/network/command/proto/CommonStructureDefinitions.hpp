@@ -20,6 +20,7 @@
 #ifndef DATA_DEFINES_HPP
 #define DATA_DEFINES_HPP
 
+#include "libserver/util/Schema.hpp"
 #include "libserver/util/Stream.hpp"
 
 #include <array>
@@ -58,8 +59,11 @@ struct Item
   uint32_t expiresAt{};
   uint32_t count{};
 
-  static void Write(const Item& item, SinkStream& stream);
-  static void Read(Item& item, SourceStream& stream);
+  using Schema = server::Schema<
+    Field<&Item::uid>,
+    Field<&Item::tid>,
+    Field<&Item::expiresAt>,
+    Field<&Item::count>>;
 };
 
 struct StoredItem
@@ -90,8 +94,17 @@ struct StoredItem
   //! [minute] [hour] [day] [month] [year]
   uint32_t dateAndTime{};
 
-  static void Write(const StoredItem& item, SinkStream& stream);
-  static void Read(StoredItem& item, SourceStream& stream);
+  using Schema = server::Schema<
+    Field<&StoredItem::uid>,
+    Field<&StoredItem::goodsSq>,
+    Field<&StoredItem::status>,
+    Field<&StoredItem::val3>,
+    Field<&StoredItem::val4>,
+    Field<&StoredItem::carrots>,
+    Field<&StoredItem::priceId>,
+    Field<&StoredItem::sender>,
+    Field<&StoredItem::message>,
+    Field<&StoredItem::dateAndTime>>;
 };
 
 //!
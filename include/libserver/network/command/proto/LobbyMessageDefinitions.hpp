@@ -26,6 +26,7 @@
 
 #include <array>
 #include <cstdint>
+#include <memory_resource>
 #include <string>
 #include <vector>
 
@@ -48,19 +49,13 @@ struct AcCmdCLLogin
     return Command::AcCmdCLLogin;
   }
 
-  //! Writes the command to a provided sink stream.
-  //! @param command Command.
-  //! @param stream Sink stream.
-  static void Write(
-    const AcCmdCLLogin& command,
-    SinkStream& stream);
-
-  //! Reader a command from a provided source stream.
-  //! @param command Command.
-  //! @param stream Source stream.
-  static void Read(
-    AcCmdCLLogin& command,
-    SourceStream& stream);
+  using Schema = server::Schema<
+    Field<&AcCmdCLLogin::constant0>,
+    Field<&AcCmdCLLogin::constant1>,
+    Field<&AcCmdCLLogin::loginId>,
+    Field<&AcCmdCLLogin::memberNo>,
+    Field<&AcCmdCLLogin::authKey>,
+    Field<&AcCmdCLLogin::val0>>;
 };
 
 struct LobbyCommandLoginOK
@@ -772,9 +767,19 @@ struct LobbyCommandRoomListOK
 //! Serverbound make room command.
 struct AcCmdCLMakeRoom
 {
+  //! The name and the password are decoded to the allocator of the command.
+  using allocator_type = std::pmr::polymorphic_allocator<>;
+
+  AcCmdCLMakeRoom() = default;
+  explicit AcCmdCLMakeRoom(const allocator_type& allocator)
+    : name(allocator)
+    , password(allocator)
+  {
+  }
+
   // presumably
-  std::string name;
-  std::string password;
+  std::pmr::string name;
+  std::pmr::string password;
   uint8_t playerCount;
   GameMode gameMode;
   TeamMode teamMode;
@@ -29,7 +29,9 @@
 #include "libserver/util/Util.hpp"
 
 #include <cstdint>
+#include <memory_resource>
 #include <optional>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -224,10 +226,20 @@ struct AcCmdCREnterRoomNotify
 
 struct AcCmdCRChangeRoomOptions
 {
+  //! The name and the password are decoded to the allocator of the command.
+  using allocator_type = std::pmr::polymorphic_allocator<>;
+
+  AcCmdCRChangeRoomOptions() = default;
+  explicit AcCmdCRChangeRoomOptions(const allocator_type& allocator)
+    : name(allocator)
+    , password(allocator)
+  {
+  }
+
   RoomOptionType optionsBitfield{};
-  std::string name{};
+  std::pmr::string name{};
   uint8_t playerCount{};
-  std::string password{};
+  std::pmr::string password{};
   GameMode gameMode{};
   uint16_t mapBlockId{};
   uint8_t npcDifficulty{};
@@ -717,7 +729,16 @@ struct AcCmdCRLoadingCompleteNotify
 
 struct AcCmdCRChat
 {
-  std::string message;
+  //! The message is decoded to the allocator of the command.
+  using allocator_type = std::pmr::polymorphic_allocator<>;
+
+  AcCmdCRChat() = default;
+  explicit AcCmdCRChat(const allocator_type& allocator)
+    : message(allocator)
+  {
+  }
+
+  std::pmr::string message;
   uint8_t unknown{};
 
   static Command GetCommand()
@@ -1521,19 +1542,14 @@ struct AcCmdUserRaceUpdatePos
     return Command::AcCmdUserRaceUpdatePos;
   }
 
-  //! Writes the command to a provided sink stream.
-  //! @param command Command.
-  //! @param stream Sink stream.
-  static void Write(
-    const AcCmdUserRaceUpdatePos& command,
-    SinkStream& stream);
-
-  //! Reader a command from a provided source stream.
-  //! @param command Command.
-  //! @param stream Source stream.
-  static void Read(
-    AcCmdUserRaceUpdatePos& command,
-    SourceStream& stream);
+  using Schema = server::Schema<
+    Field<&AcCmdUserRaceUpdatePos::oid>,
+    Field<&AcCmdUserRaceUpdatePos::member2>,
+    Field<&AcCmdUserRaceUpdatePos::member3>,
+    Field<&AcCmdUserRaceUpdatePos::member4>,
+    Field<&AcCmdUserRaceUpdatePos::member5>,
+    Field<&AcCmdUserRaceUpdatePos::member6>,
+    Field<&AcCmdUserRaceUpdatePos::member7>>;
 };
 
 struct AcCmdRCRoomCountdown
@@ -1711,6 +1727,30 @@ struct AcCmdCRRelay
     SourceStream& stream);
 };
 
+//! A view of `AcCmdCRRelay` borrowing the payload from the command data,
+//! without parsing it. Valid only while the command is being handled.
+struct AcCmdCRRelayView
+{
+  //! Relay packet origin racer oid.
+  uint16_t fromOid{};
+  //! Relay packet destination racer oid.
+  //! Can be 0, which indicates broadcast.
+  uint16_t toOid{};
+  protocol::relay::RelayCommandId payloadType{};
+  std::span<const uint8_t> data;
+
+  static Command GetCommand()
+  {
+    return Command::AcCmdCRRelay;
+  }
+
+  using Schema = server::Schema<
+    Field<&AcCmdCRRelayView::fromOid>,
+    Field<&AcCmdCRRelayView::toOid>,
+    Field<&AcCmdCRRelayView::payloadType>,
+    List<uint16_t, &AcCmdCRRelayView::data>>;
+};
+
 struct AcCmdCRRelayNotify
 {
   //! Relay packet origin racer oid.
@@ -1719,26 +1759,19 @@ struct AcCmdCRRelayNotify
   //! Can be 0, which indicates broadcast.
   uint16_t toOid;
   protocol::relay::RelayCommandId payloadType;
-  std::vector<uint8_t> data;
+  //! Relayed payload, referenced until the notify is serialized.
+  std::span<const uint8_t> data;
 
   static Command GetCommand()
   {
     return Command::AcCmdCRRelayNotify;
   }
 
-  //! Writes the command to a provided sink stream.
-  //! @param command Command.
-  //! @param stream Sink stream.
-  static void Write(
-    const AcCmdCRRelayNotify& command,
-    SinkStream& stream);
-
-  //! Reader a command from a provided source stream.
-  //! @param command Command.
-  //! @param stream Source stream.
-  static void Read(
-    AcCmdCRRelayNotify& command,
-    SourceStream& stream);
+  using Schema = server::Schema<
+    Field<&AcCmdCRRelayNotify::fromOid>,
+    Field<&AcCmdCRRelayNotify::toOid>,
+    Field<&AcCmdCRRelayNotify::payloadType>,
+    List<uint16_t, &AcCmdCRRelayNotify::data>>;
 };
 
 struct AcCmdRCTeamSpurGauge
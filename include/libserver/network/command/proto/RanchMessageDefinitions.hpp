@@ -26,7 +26,9 @@
 
 #include <array>
 #include <cstdint>
+#include <memory_resource>
 #include <optional>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -254,7 +256,16 @@ struct AcCmdCRLeaveRanchNotify
 
 struct AcCmdCRRanchChat
 {
-  std::string message;
+  //! The message is decoded to the allocator of the command.
+  using allocator_type = std::pmr::polymorphic_allocator<>;
+
+  AcCmdCRRanchChat() = default;
+  explicit AcCmdCRRanchChat(const allocator_type& allocator)
+    : message(allocator)
+  {
+  }
+
+  std::pmr::string message;
   uint8_t unknown{};
   uint8_t unknown2{};
 
@@ -326,8 +337,16 @@ struct AcCmdCRRanchSnapshot
     float velocityY{};
     float velocityZ{};
 
-    static void Write(const FullSpatial& structure, SinkStream& stream);
-    static void Read(FullSpatial& structure, SourceStream& stream);
+    using Schema = server::Schema<
+      Field<&FullSpatial::ranchIndex>,
+      Field<&FullSpatial::time>,
+      Field<&FullSpatial::action>,
+      Field<&FullSpatial::timer>,
+      Field<&FullSpatial::member4>,
+      Field<&FullSpatial::matrix>,
+      Field<&FullSpatial::velocityX>,
+      Field<&FullSpatial::velocityY>,
+      Field<&FullSpatial::velocityZ>>;
   };
 
   struct PartialSpatial
@@ -340,8 +359,13 @@ struct AcCmdCRRanchSnapshot
     std::array<std::byte, 12> member4{};
     std::array<std::byte, 16> matrix{};
 
-    static void Write(const PartialSpatial& structure, SinkStream& stream);
-    static void Read(PartialSpatial& structure, SourceStream& stream);
+    using Schema = server::Schema<
+      Field<&PartialSpatial::ranchIndex>,
+      Field<&PartialSpatial::time>,
+      Field<&PartialSpatial::action>,
+      Field<&PartialSpatial::timer>,
+      Field<&PartialSpatial::member4>,
+      Field<&PartialSpatial::matrix>>;
   };
 
   Type type{};
@@ -368,6 +392,36 @@ struct AcCmdCRRanchSnapshot
     SourceStream& stream);
 };
 
+//! A view of `AcCmdCRRanchSnapshot` borrowing the spatial from the command data.
+//! Valid only while the command is being handled.
+struct AcCmdCRRanchSnapshotView
+{
+  AcCmdCRRanchSnapshot::Type type{};
+  //! Index of the entity the spatial belongs to.
+  uint16_t ranchIndex{};
+  //! Serialized `FullSpatial` or `PartialSpatial`, depending on the type.
+  std::span<const std::byte> spatial;
+
+  static Command GetCommand()
+  {
+    return Command::AcCmdCRRanchSnapshot;
+  }
+
+  //! Writes the command to a provided sink stream.
+  //! @param command Command.
+  //! @param stream Sink stream.
+  static void Write(
+    const AcCmdCRRanchSnapshotView& command,
+    SinkStream& stream);
+
+  //! Reader a command from a provided source stream.
+  //! @param command Command.
+  //! @param stream Source stream.
+  static void Read(
+    AcCmdCRRanchSnapshotView& command,
+    SourceStream& stream);
+};
+
 struct RanchCommandRanchSnapshotNotify
 {
   uint16_t ranchIndex{};
@@ -396,6 +450,25 @@ struct RanchCommandRanchSnapshotNotify
     SourceStream& stream);
 };
 
+//! A notify of a snapshot forwarding the serialized spatial of the snapshot as it is.
+struct RanchCommandRanchSnapshotNotifyView
+{
+  uint16_t ranchIndex{};
+  AcCmdCRRanchSnapshot::Type type{};
+  //! Serialized `FullSpatial` or `PartialSpatial`, depending on the type.
+  std::span<const std::byte> spatial;
+
+  static Command GetCommand()
+  {
+    return Command::AcCmdCRRanchSnapshotNotify;
+  }
+
+  using Schema = server::Schema<
+    Field<&RanchCommandRanchSnapshotNotifyView::ranchIndex>,
+    Field<&RanchCommandRanchSnapshotNotifyView::type>,
+    Field<&RanchCommandRanchSnapshotNotifyView::spatial>>;
+};
+
 struct AcCmdCREnterBreedingMarket
 {
   static Command GetCommand()
@@ -1680,19 +1753,10 @@ struct AcCmdCRGetItemFromStorageOK
     return Command::AcCmdCRGetItemFromStorageOK;
   }
 
-  //! Writes the command to a provided sink stream.
-  //! @param command Command.
-  //! @param stream Sink stream.
-  static void Write(
-    const AcCmdCRGetItemFromStorageOK& command,
-    SinkStream& stream);
-
-  //! Reader a command from a provided source stream.
-  //! @param command Command.
-  //! @param stream Source stream.
-  static void Read(
-    AcCmdCRGetItemFromStorageOK& command,
-    SourceStream& stream);
+  using Schema = server::Schema<
+    Field<&AcCmdCRGetItemFromStorageOK::storageItemUid>,
+    List<uint8_t, &AcCmdCRGetItemFromStorageOK::items>,
+    Field<&AcCmdCRGetItemFromStorageOK::updatedCarrots>>;
 };
 
 struct AcCmdCRGetItemFromStorageCancel
@@ -1705,19 +1769,9 @@ struct AcCmdCRGetItemFromStorageCancel
     return Command::AcCmdCRGetItemFromStorageCancel;
   }
 
-  //! Writes the command to a provided sink stream.
-  //! @param command Command.
-  //! @param stream Sink stream.
-  static void Write(
-    const AcCmdCRGetItemFromStorageCancel& command,
-    SinkStream& stream);
-
-  //! Reader a command from a provided source stream.
-  //! @param command Command.
-  //! @param stream Source stream.
-  static void Read(
-    AcCmdCRGetItemFromStorageCancel& command,
-    SourceStream& stream);
+  using Schema = server::Schema<
+    Field<&AcCmdCRGetItemFromStorageCancel::storageItemUid>,
+    Field<&AcCmdCRGetItemFromStorageCancel::status>>;
 };
 
 struct RanchCommandCheckStorageItem
@@ -1775,19 +1829,9 @@ struct RanchCommandRequestNpcDressListOK
     return Command::AcCmdCRRequestNpcDressListOK;
   }
 
-  //! Writes the command to a provided sink stream.
-  //! @param command Command.
-  //! @param stream Sink stream.
-  static void Write(
-    const RanchCommandRequestNpcDressListOK& command,
-    SinkStream& stream);
-
-  //! Reader a command from a provided source stream.
-  //! @param command Command.
-  //! @param stream Source stream.
-  static void Read(
-    RanchCommandRequestNpcDressListOK& command,
-    SourceStream& stream);
+  using Schema = server::Schema<
+    Field<&RanchCommandRequestNpcDressListOK::unk0>,
+    List<uint8_t, &RanchCommandRequestNpcDressListOK::dressList>>;
 };
 
 struct RanchCommandRequestNpcDressListCancel
@@ -4779,8 +4823,17 @@ struct AcCmdCRConfirmSetItemCancel
 
 struct AcCmdCRBuyOwnItem
 {
+  //! The orders are decoded to the allocator of the command.
+  using allocator_type = std::pmr::polymorphic_allocator<>;
+
+  AcCmdCRBuyOwnItem() = default;
+  explicit AcCmdCRBuyOwnItem(const allocator_type& allocator)
+    : orders(allocator)
+  {
+  }
+
   //! Max 32 (0x20) items.
-  std::vector<ShopOrder> orders{};
+  std::pmr::vector<ShopOrder> orders{};
 
   static Command GetCommand()
   {
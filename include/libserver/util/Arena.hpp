@@ -0,0 +1,80 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+
+namespace server
+{
+
+//! Checks whether the type allocates its members from a polymorphic allocator
+//! passed on construction, and so can be allocated in an arena.
+template <typename T>
+concept ArenaAllocated = std::uses_allocator_v<T, std::pmr::polymorphic_allocator<>>;
+
+//! A monotonic arena for short-lived allocations, which are all released at once.
+//! Allocations are served from an inline buffer first, then from the upstream resource.
+//! Not thread-safe, meant to be used by a single thread at a time.
+class Arena final
+{
+public:
+  //! Size of the inline buffer.
+  static constexpr std::size_t InlineSize = 4 * 1024;
+
+  Arena();
+
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  //! Returns the memory resource of the arena.
+  //! @returns Memory resource.
+  [[nodiscard]] std::pmr::memory_resource& GetResource() noexcept;
+
+  //! Releases all the allocations of the arena,
+  //! including the upstream ones, and rewinds it to the inline buffer.
+  //! The values constructed in the arena must be destroyed before.
+  void Release() noexcept;
+
+  //! Constructs a value in the arena, which also serves the allocations
+  //! of the value, if the type supports it.
+  //! @returns Constructed value, valid until the arena is released.
+  template <typename T>
+  [[nodiscard]] T* New()
+  {
+    auto* const storage = static_cast<T*>(_resource.allocate(sizeof(T), alignof(T)));
+    if constexpr (ArenaAllocated<T>)
+      return std::construct_at(storage, typename T::allocator_type{&_resource});
+    else
+      return std::construct_at(storage);
+  }
+
+private:
+  alignas(std::max_align_t) std::array<std::byte, InlineSize> _buffer;
+  std::pmr::monotonic_buffer_resource _resource;
+};
+
+} // namespace server
+
+#endif // ARENA_HPP
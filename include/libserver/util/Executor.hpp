@@ -0,0 +1,183 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#ifndef SERVER_EXECUTOR_HPP
+#define SERVER_EXECUTOR_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace server
+{
+
+//! Executor running the tasks on a pool of worker threads.
+//! Every worker has its own task queue, a worker which runs out of tasks
+//! steals them from the queues of the other workers.
+class Executor final
+{
+public:
+  //! A task to perform.
+  using Task = std::function<void()>;
+  //! An alias for the standard steady-clock.
+  using Clock = std::chrono::steady_clock;
+
+  //! Serializes the tasks posted to it, so that no two of them run at the same time.
+  //! The tasks run in the order they were posted in, on any of the workers.
+  class Strand final
+  {
+  public:
+    explicit Strand(Executor& executor);
+
+    //! Posts the task to the strand. Thread-safe.
+    //! @param task Task to post.
+    void Post(Task task);
+
+    //! Posts the task to the strand once the time point is reached. Thread-safe.
+    //! @param when Time point of when to post the task.
+    //! @param task Task to post.
+    void PostAt(Clock::time_point when, Task task);
+
+  private:
+    //! Runs the next task of the strand and reposts the strand if there are more.
+    void Run();
+
+    Executor& _executor;
+    //! A mutex for the tasks.
+    std::mutex _tasksMutex;
+    //! Tasks posted to the strand.
+    std::deque<Task> _tasks;
+    //! Whether the strand is posted to the executor or running.
+    bool _isScheduled{false};
+  };
+
+  Executor() = default;
+  ~Executor();
+
+  Executor(const Executor&) = delete;
+  Executor& operator=(const Executor&) = delete;
+
+  //! Begins the workers.
+  //! @param workerCount Count of the worker threads, zero for the count of the hardware threads.
+  void Begin(std::size_t workerCount = 0);
+
+  //! Ends the workers, waiting for the running tasks to finish.
+  //! The tasks not started yet are never run.
+  void End();
+
+  //! Posts the task to the executor. Thread-safe.
+  //! Tasks posted from a worker are queued on that worker.
+  //! @param task Task to post.
+  //! @throws std::runtime_error If the executor was not begun.
+  void Post(Task task);
+
+  //! Posts the task to the executor once the time point is reached. Thread-safe.
+  //! @param when Time point of when to post the task.
+  //! @param task Task to post.
+  void PostAt(Clock::time_point when, Task task);
+
+  //! Returns the count of the worker threads.
+  //! @returns Count of the workers.
+  [[nodiscard]] std::size_t GetWorkerCount() const noexcept;
+
+private:
+  struct Worker
+  {
+    //! A mutex for the task queue.
+    std::mutex tasksMutex;
+    //! Queue of the tasks. The worker takes them from the front,
+    //! the other workers steal them from the back.
+    std::deque<Task> tasks;
+    std::thread thread;
+  };
+
+  //! A task posted once its time point is reached.
+  struct TimedTask
+  {
+    Clock::time_point when{};
+    //! Orders the tasks with the same time point by their posting.
+    uint64_t sequence{};
+    Task task;
+
+    //! Orders the tasks so that the earliest one is at the front of the heap.
+    bool operator>(const TimedTask& other) const noexcept
+    {
+      if (when != other.when)
+        return when > other.when;
+      return sequence > other.sequence;
+    }
+  };
+
+  //! Loop of a worker thread.
+  //! @param workerIdx Index of the worker.
+  void WorkerLoop(std::size_t workerIdx);
+
+  //! Takes a task from the queue of the worker or steals one from the other workers.
+  //! @param workerIdx Index of the worker.
+  //! @returns Task, if there was any.
+  std::optional<Task> TakeTask(std::size_t workerIdx);
+
+  //! Moves the timed tasks which are due to the worker queues.
+  //! Expects the idle mutex to be held.
+  //! @returns `true` if any of the tasks were due, `false` otherwise.
+  bool PostDueTimedTasks();
+
+  //! Updates the time point of the earliest timed task.
+  //! Expects the idle mutex to be held.
+  void UpdateEarliestTimedTaskTime() noexcept;
+
+  //! Queues the task on the worker without waking any of the workers.
+  void QueueTask(std::size_t workerIdx, Task task);
+
+  //! Workers of the executor.
+  std::vector<std::unique_ptr<Worker>> _workers;
+  //! Index of the worker the next task posted from outside the workers is queued on.
+  std::atomic<std::size_t> _nextWorkerIdx{0};
+  //! Count of the tasks queued on the workers.
+  std::atomic<std::size_t> _queuedTaskCount{0};
+
+  //! A mutex for the idle workers, the timed tasks and the run flag.
+  std::mutex _idleMutex;
+  //! Condition the idle workers wait on.
+  std::condition_variable _idleCondition;
+  //! Min-heap of the timed tasks.
+  std::vector<TimedTask> _timedTasks;
+  //! Time point of the earliest timed task, as ticks since the clock epoch.
+  //! Checked by the busy workers without the idle mutex, so that the timed tasks
+  //! are posted even if the workers never run out of tasks.
+  std::atomic<Clock::rep> _earliestTimedTaskTime{
+    std::numeric_limits<Clock::rep>::max()};
+  //! Sequence of the last timed task.
+  uint64_t _timedTaskSequence{0};
+  //! Whether the workers should run.
+  bool _shouldRun{false};
+};
+
+} // namespace server
+
+#endif // SERVER_EXECUTOR_HPP
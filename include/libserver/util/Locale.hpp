@@ -21,6 +21,7 @@
 #define LOCALE_HPP
 
 #include <string>
+#include <string_view>
 
 namespace server
 {
@@ -28,17 +29,37 @@ namespace server
 namespace locale
 {
 
+//! Checks whether the string consists of ASCII characters only.
+//! ASCII strings are the same in the EUC-KR and the UTF-8 encodings.
+//! @param input Input string.
+//! @returns `true` if the string is ASCII, `false` otherwise.
+[[nodiscard]] bool IsAscii(std::string_view input) noexcept;
+
+//! Converts EUC-KR encoded string into a UTF-8 encoded string.
+//! The conversion stops at the first null character.
+//! @param input Input string in the EUC-KR encoding.
+//! @param output Output string encoded in UTF8 encoding. Its storage is reused.
+//! @throws std::runtime_error If the conversion fails for any reason.
+void ToUtf8(std::string_view input, std::string& output);
+
 //! Converts EUC-KR encoded string into a UTF-8 encoded string.
 //! @param input Input string in the EUC-KR encoding.
 //! @returns Output string encoded in UTF8 encoding.
 //! @throws std::runtime_error If the conversion fails for any reason.
-[[nodiscard]] std::string ToUtf8(const std::string& input);
+[[nodiscard]] std::string ToUtf8(std::string_view input);
+
+//! Converts UTF-8 encoded string into a EUC-KR encoded string.
+//! The conversion stops at the first null character.
+//! @param input Input string in the UTF8 encoding.
+//! @param output Output string encoded in EUC-KR encoding. Its storage is reused.
+//! @throws std::runtime_error If the conversion fails for any reason.
+void FromUtf8(std::string_view input, std::string& output);
 
 //! Converts UTF-8 encoded string into a EUC-KR encoded string.
 //! @param input Input string in the UTF8 encoding.
 //! @returns Output string encoded in EUC-KR encoding.
 //! @throws std::runtime_error If the conversion fails for any reason.
-[[nodiscard]] std::string FromUtf8(const std::string& input);
+[[nodiscard]] std::string FromUtf8(std::string_view input);
 
 //! Validates UTF-8 encoded string representing a name (a character name, a horse name, a pet name or a guild name).
 //! The input string must conform to the following conditions:
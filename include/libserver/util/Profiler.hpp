@@ -0,0 +1,186 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#ifndef SERVER_PROFILER_HPP
+#define SERVER_PROFILER_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace server
+{
+
+//! Profiler recording the call counts and the latency histograms of the profiled sections
+//! (e.g. the command handlers and the director ticks).
+//! The records are counted per thread without any synchronization between the threads
+//! and are merged when the profile is collected.
+class Profiler final
+{
+public:
+  //! An alias for the standard steady-clock.
+  using Clock = std::chrono::steady_clock;
+  //! ID of a profiled section.
+  using SectionId = uint32_t;
+
+  //! Count of the latency buckets. The first bucket holds the latencies under 1us,
+  //! the bucket N holds the latencies in [2^(N-1), 2^N) us, the last bucket holds the rest.
+  static constexpr std::size_t BucketCount = 24;
+  //! Max count of the sections.
+  static constexpr std::size_t MaxSectionCount = 4096;
+
+  //! Latency histogram of a section.
+  struct Histogram
+  {
+    //! Count of the calls.
+    uint64_t count{};
+    //! Total duration of the calls.
+    std::chrono::nanoseconds totalDuration{};
+    //! Count of the calls in each of the latency buckets.
+    std::array<uint64_t, BucketCount> buckets{};
+
+    //! Returns the mean duration of the calls.
+    //! @returns Mean duration, or zero if there were no calls.
+    [[nodiscard]] std::chrono::nanoseconds GetMeanDuration() const noexcept;
+    //! Returns the upper bound of the bucket the percentile of the calls falls in.
+    //! @param percentile Percentile in the range (0, 100].
+    //! @returns Upper bound of the duration, or zero if there were no calls.
+    [[nodiscard]] std::chrono::microseconds GetPercentileDuration(double percentile) const noexcept;
+
+    //! Subtracts the earlier histogram of the same section, leaving the calls in between.
+    Histogram& operator-=(const Histogram& other) noexcept;
+  };
+
+  //! A profiled section with its histogram.
+  struct Section
+  {
+    //! Name of the section.
+    std::string name;
+    //! Histogram of the section.
+    Histogram histogram;
+  };
+
+  //! Measures the duration of the scope and records it to the section.
+  class Scope final
+  {
+  public:
+    Scope(Profiler& profiler, SectionId sectionId) noexcept;
+    ~Scope();
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+  private:
+    Profiler& _profiler;
+    SectionId _sectionId;
+    Clock::time_point _begin;
+  };
+
+  Profiler();
+  ~Profiler();
+
+  Profiler(const Profiler&) = delete;
+  Profiler& operator=(const Profiler&) = delete;
+
+  //! Returns the profiler of the process.
+  //! @returns Reference to the profiler.
+  [[nodiscard]] static Profiler& Global();
+
+  //! Registers a section. Thread-safe.
+  //! @param name Name of the section.
+  //! @returns ID of the section, the same ID for the same name.
+  //! @throws std::length_error If there are too many sections.
+  SectionId RegisterSection(std::string_view name);
+
+  //! Records a call of the section. Thread-safe, the calling thread records to its own counters.
+  //! @param sectionId ID of the section.
+  //! @param duration Duration of the call.
+  void Record(SectionId sectionId, Clock::duration duration) noexcept;
+
+  //! Collects the profile merged from the records of all the threads. Thread-safe.
+  //! The histograms are cumulative, subtract an earlier profile to get the calls in between.
+  //! @returns Sections indexed by their ID.
+  [[nodiscard]] std::vector<Section> Collect() const;
+
+  //! Subtracts the earlier profile from the profile.
+  //! @param profile Profile to subtract from.
+  //! @param earlierProfile Earlier profile of the same profiler.
+  static void Subtract(std::vector<Section>& profile, const std::vector<Section>& earlierProfile);
+
+  //! Formats the sections which were called, by their total duration in descending order.
+  //! @param profile Profile to format.
+  //! @param limit Max count of the sections to format.
+  //! @returns Formatted sections.
+  [[nodiscard]] static std::vector<std::string> Format(
+    const std::vector<Section>& profile,
+    std::size_t limit = MaxSectionCount);
+
+private:
+  //! Count of the sections in a chunk of the thread counters.
+  static constexpr std::size_t SectionsPerChunk = 64;
+
+  //! Counters of a section, written only by the owning thread.
+  struct Counters
+  {
+    std::atomic_uint64_t count{};
+    std::atomic_uint64_t totalDuration{};
+    std::array<std::atomic_uint64_t, BucketCount> buckets{};
+  };
+  using Chunk = std::array<Counters, SectionsPerChunk>;
+
+  //! Counters of a thread, allocated in chunks as the sections are recorded.
+  struct ThreadCounters
+  {
+    ThreadCounters() = default;
+    ~ThreadCounters();
+
+    std::array<std::atomic<Chunk*>, MaxSectionCount / SectionsPerChunk> chunks{};
+  };
+
+  //! Returns the counters of the calling thread, creating them if necessary.
+  //! @returns Pointer to the counters, or null if they could not be created.
+  ThreadCounters* GetThreadCounters() noexcept;
+
+  //! Serial number of the profiler, identifying it in the thread caches.
+  const uint64_t _serial;
+
+  //! A mutex for the sections.
+  mutable std::mutex _sectionsMutex;
+  //! Names of the sections, indexed by their ID.
+  std::vector<std::string> _sectionNames;
+  //! IDs of the sections, by their name.
+  std::unordered_map<std::string, SectionId> _sectionIds;
+
+  //! A mutex for the threads.
+  mutable std::mutex _threadsMutex;
+  //! Counters of the threads which recorded to the profiler.
+  std::unordered_map<std::thread::id, std::unique_ptr<ThreadCounters>> _threadCounters;
+};
+
+} // namespace server
+
+#endif // SERVER_PROFILER_HPP
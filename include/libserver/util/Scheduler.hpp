@@ -20,51 +20,124 @@
 #ifndef SERVER_SCHEDULER_HPP
 #define SERVER_SCHEDULER_HPP
 
+#include "libserver/util/Wakeup.hpp"
+
 #include <chrono>
+#include <cstdint>
 #include <functional>
-#include <list>
 #include <mutex>
+#include <optional>
+#include <queue>
+#include <unordered_map>
+#include <vector>
 
 namespace server
 {
 
-//!
+//! Scheduler of the tasks to execute on the ticks of its owner.
+//! The jobs are kept in a min-heap ordered by their time point.
 class Scheduler final
 {
 public:
-  //! A task to perform.
-  using Task = std::function<void()>;
   //! An alias for the standard steady-clock.
   using Clock = std::chrono::steady_clock;
+  //! ID of a queued job. Zero is never a valid job ID.
+  using JobId = uint64_t;
+  //! A task to perform.
+  using Task = std::function<void()>;
+  //! A task to perform, receiving the ID of its job.
+  using JobTask = std::function<void(JobId)>;
 
-  Scheduler();
+  Scheduler() = default;
+  //! Constructor.
+  //! @param wakeup Wakeup of the owner, signalled when a queued job
+  //!               becomes the earliest one.
+  explicit Scheduler(Wakeup& wakeup);
 
   //! Tick the scheduler.
+  //! Executes every job which is due at the beginning of the tick, in the order
+  //! of their time points and then of their queueing. The jobs queued during the tick
+  //! are executed on the next tick at the earliest, which bounds the work of a tick.
+  //! If a task throws the exception is rethrown and the remaining jobs are left
+  //! for the next tick.
   void Tick();
 
   //! Queue a task to be executed in the next tick.
+  //! Thread-safe, may be called from within a task.
+  //! @param task Task to queue execution of.
+  //! @param when A time point of when to execute the task. Defaults to immediate execution.
+  //! @returns ID of the job, with which the job may be cancelled.
+  JobId Queue(
+    Task task,
+    Clock::time_point when = Clock::now());
+
+  //! Queue a task receiving the ID of its job to be executed in the next tick.
+  //! Once the task executes the job can no longer be cancelled, the task may compare
+  //! the ID it receives with the one it was queued under to detect being superseded.
+  //! Thread-safe, may be called from within a task.
   //! @param task Task to queue execution of.
   //! @param when A time point of when to execute the task. Defaults to immediate execution.
-  void Queue(
-    const Task& task,
+  //! @returns ID of the job, with which the job may be cancelled.
+  JobId Queue(
+    JobTask task,
     Clock::time_point when = Clock::now());
 
+  //! Cancel a queued job. Thread-safe, may be called from within a task.
+  //! @param jobId ID of the job.
+  //! @returns `true` if the job was cancelled,
+  //!          `false` if it is executing, was already executed, cancelled, or never existed.
+  bool Cancel(JobId jobId);
+
+  //! Returns the time point of the earliest job queued.
+  //! @returns Time point of the earliest job, or empty if no jobs are queued.
+  [[nodiscard]] std::optional<Clock::time_point> GetNextJobTime();
+
+  //! Returns the count of the jobs queued.
+  //! @returns Count of the jobs.
+  [[nodiscard]] std::size_t GetJobCount();
+
 protected:
-  //! A job.
-  struct Job
+  //! An entry of the job heap.
+  struct ScheduledJob
   {
     //! A time point of when the job should execute.
     Clock::time_point when{};
-    //! A task the job has to execute.
-    Task task{};
+    //! ID of the job, which also orders the jobs queued for the same time point.
+    JobId jobId{};
+
+    //! Orders the entries so that the earliest one is at the top of the heap.
+    bool operator>(const ScheduledJob& other) const noexcept
+    {
+      if (when != other.when)
+        return when > other.when;
+      return jobId > other.jobId;
+    }
   };
 
-  //! A mutex to the job list.
+  //! A mutex to the jobs.
   std::mutex _jobsMutex;
-  //! A job list.
-  std::list<Job> _jobs;
-  //! An iterator to the job to execute in the next tick cycle.
-  decltype(_jobs)::const_iterator _jobIterator;
+  //! A min-heap of the jobs, by their time points.
+  //! Entries of the cancelled jobs are discarded once they reach the top.
+  std::priority_queue<ScheduledJob, std::vector<ScheduledJob>, std::greater<>> _jobHeap;
+  //! A task of a job, either one of the tasks is set.
+  struct QueuedTask
+  {
+    Task task;
+    JobTask jobTask;
+  };
+
+  //! Queues the task of a job.
+  //! @param task Task of the job.
+  //! @param when A time point of when to execute the task.
+  //! @returns ID of the job.
+  JobId QueueTask(QueuedTask task, Clock::time_point when);
+
+  //! Tasks of the jobs which were not executed or cancelled yet.
+  std::unordered_map<JobId, QueuedTask> _tasks;
+  //! ID of the last job queued.
+  JobId _lastJobId{0};
+  //! Wakeup of the owner, may be null.
+  Wakeup* _wakeup{nullptr};
 };
 
 } // namespace server
@@ -0,0 +1,471 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#ifndef SCHEMA_HPP
+#define SCHEMA_HPP
+
+#include "libserver/util/Locale.hpp"
+#include "libserver/util/Stream.hpp"
+
+#include <array>
+#include <cstring>
+#include <format>
+#include <limits>
+#include <memory_resource>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+
+namespace server
+{
+
+namespace detail
+{
+
+//! Traits of a pointer to a data member.
+template <typename T>
+struct MemberTraits;
+
+template <typename Owner, typename Value>
+struct MemberTraits<Value Owner::*>
+{
+  using OwnerType = Owner;
+  using ValueType = Value;
+};
+
+//! Traits of a fixed-size array.
+template <typename T>
+struct ArrayTraits
+{
+  static constexpr bool IsArray = false;
+};
+
+template <typename Element, std::size_t Size>
+struct ArrayTraits<std::array<Element, Size>>
+{
+  static constexpr bool IsArray = true;
+  using ElementType = Element;
+};
+
+//! Traits of a view of the elements borrowed from a buffer.
+template <typename T>
+struct ViewTraits
+{
+  static constexpr bool IsView = false;
+};
+
+template <typename Element>
+struct ViewTraits<std::span<const Element>>
+{
+  static constexpr bool IsView = true;
+  using ElementType = Element;
+};
+
+//! Returns the serialized size of the values of the type if it is fixed.
+//! @returns Serialized size if fixed, otherwise `std::nullopt`.
+template <typename T>
+consteval std::optional<std::size_t> GetFixedSize()
+{
+  if constexpr (Numeric<T>)
+  {
+    return sizeof(T);
+  }
+  else if constexpr (ArrayTraits<T>::IsArray)
+  {
+    constexpr auto elementSize = GetFixedSize<typename ArrayTraits<T>::ElementType>();
+    if constexpr (elementSize.has_value())
+      return *elementSize * std::tuple_size_v<T>;
+    else
+      return std::nullopt;
+  }
+  else if constexpr (SchemaStruct<T>)
+  {
+    return T::Schema::FixedSize;
+  }
+  else
+  {
+    return std::nullopt;
+  }
+}
+
+//! Checks whether the serialized size of the values of the type can be computed.
+template <typename T>
+consteval bool IsSized()
+{
+  if constexpr (Numeric<T> || std::is_same_v<T, std::string> || std::is_same_v<T, std::pmr::string>)
+    return true;
+  else if constexpr (ArrayTraits<T>::IsArray)
+    return IsSized<typename ArrayTraits<T>::ElementType>();
+  else if constexpr (ViewTraits<T>::IsView)
+    return Numeric<typename ViewTraits<T>::ElementType>;
+  else if constexpr (SchemaStruct<T>)
+    return T::Schema::IsSized;
+  else
+    return false;
+}
+
+//! Returns the serialized size of the value.
+//! Exact for everything but the non-ASCII strings, for which it is an upper bound.
+template <typename T>
+std::size_t GetSize(const T& value)
+{
+  if constexpr (constexpr auto fixedSize = GetFixedSize<T>(); fixedSize.has_value())
+  {
+    return *fixedSize;
+  }
+  else if constexpr (std::is_same_v<T, std::string> || std::is_same_v<T, std::pmr::string>)
+  {
+    // Every character takes at most two bytes in EUC-KR, with the null-terminator.
+    return (locale::IsAscii(value) ? value.size() : value.size() * 2) + 1;
+  }
+  else if constexpr (ArrayTraits<T>::IsArray)
+  {
+    std::size_t size = 0;
+    for (const auto& element : value)
+      size += GetSize(element);
+    return size;
+  }
+  else if constexpr (ViewTraits<T>::IsView)
+  {
+    return value.size_bytes();
+  }
+  else
+  {
+    return T::Schema::SerializedSize(value);
+  }
+}
+
+//! Writes the value to the stream.
+template <typename T>
+void WriteValue(const T& value, SinkStream& stream)
+{
+  if constexpr (ArrayTraits<T>::IsArray)
+  {
+    using Element = typename ArrayTraits<T>::ElementType;
+    if constexpr (Numeric<Element>)
+    {
+      stream.Write(std::span(value));
+    }
+    else
+    {
+      for (const auto& element : value)
+        stream.Write(element);
+    }
+  }
+  else if constexpr (ViewTraits<T>::IsView)
+  {
+    static_assert(Numeric<typename ViewTraits<T>::ElementType>, "Only views of numeric elements are written");
+    stream.Write(value);
+  }
+  else
+  {
+    stream.Write(value);
+  }
+}
+
+//! Reads the value from the stream.
+template <typename T>
+void ReadValue(T& value, SourceStream& stream)
+{
+  if constexpr (ArrayTraits<T>::IsArray)
+  {
+    using Element = typename ArrayTraits<T>::ElementType;
+    if constexpr (Numeric<Element>)
+    {
+      stream.Read(std::span(value));
+    }
+    else
+    {
+      for (auto& element : value)
+        stream.Read(element);
+    }
+  }
+  else
+  {
+    static_assert(not ViewTraits<T>::IsView, "Views are read as lists, which carry their size");
+    stream.Read(value);
+  }
+}
+
+//! Stores the fixed-size value to the buffer and advances the buffer.
+template <typename T>
+void StoreValue(const T& value, std::byte*& buffer) noexcept
+{
+  if constexpr (Numeric<T>)
+  {
+    std::memcpy(buffer, &value, sizeof(T));
+    buffer += sizeof(T);
+  }
+  else if constexpr (ArrayTraits<T>::IsArray)
+  {
+    for (const auto& element : value)
+      StoreValue(element, buffer);
+  }
+  else
+  {
+    T::Schema::Store(value, buffer);
+  }
+}
+
+//! Loads the fixed-size value from the buffer and advances the buffer.
+template <typename T>
+void LoadValue(T& value, const std::byte*& buffer) noexcept
+{
+  if constexpr (Numeric<T>)
+  {
+    std::memcpy(&value, buffer, sizeof(T));
+    buffer += sizeof(T);
+  }
+  else if constexpr (ArrayTraits<T>::IsArray)
+  {
+    for (auto& element : value)
+      LoadValue(element, buffer);
+  }
+  else
+  {
+    T::Schema::Load(value, buffer);
+  }
+}
+
+} // namespace detail
+
+//! A field of a schema, serialized the same way as the data member it points to.
+//! Fixed-size arrays are serialized element by element, without their size.
+//! @tparam Member Pointer to the data member.
+template <auto Member>
+struct Field
+{
+  using Value = typename detail::MemberTraits<decltype(Member)>::ValueType;
+
+  static constexpr std::optional<std::size_t> FixedSize = detail::GetFixedSize<Value>();
+  static constexpr bool IsSized = detail::IsSized<Value>();
+
+  template <typename T>
+  static void Write(const T& value, SinkStream& stream)
+  {
+    detail::WriteValue(value.*Member, stream);
+  }
+
+  template <typename T>
+  static void Read(T& value, SourceStream& stream)
+  {
+    detail::ReadValue(value.*Member, stream);
+  }
+
+  template <typename T>
+  static std::size_t Size(const T& value)
+  {
+    return detail::GetSize(value.*Member);
+  }
+
+  template <typename T>
+  static void Store(const T& value, std::byte*& buffer) noexcept
+  {
+    detail::StoreValue(value.*Member, buffer);
+  }
+
+  template <typename T>
+  static void Load(T& value, const std::byte*& buffer) noexcept
+  {
+    detail::LoadValue(value.*Member, buffer);
+  }
+};
+
+//! A field of a schema holding a list of elements, serialized
+//! as the count of the elements followed by the elements.
+//! A list held in a view of bytes is read without a copy,
+//! the view borrows the elements from the storage of the source stream.
+//! @tparam Length Type of the count of the elements.
+//! @tparam Member Pointer to the data member holding the elements.
+template <Numeric Length, auto Member>
+struct List
+{
+  using Value = typename detail::MemberTraits<decltype(Member)>::ValueType;
+  using Element = typename Value::value_type;
+
+  static constexpr std::optional<std::size_t> FixedSize = std::nullopt;
+  static constexpr bool IsSized = detail::IsSized<Element>();
+
+  template <typename T>
+  static void Write(const T& value, SinkStream& stream)
+  {
+    const auto& elements = value.*Member;
+    if (elements.size() > std::numeric_limits<Length>::max())
+    {
+      throw std::overflow_error(std::format(
+        "Couldn't write {} elements, the count is limited to {}.",
+        elements.size(),
+        std::numeric_limits<Length>::max()));
+    }
+
+    stream.Write(static_cast<Length>(elements.size()));
+    if constexpr (Numeric<Element> && std::ranges::contiguous_range<Value>)
+    {
+      stream.Write(std::span(elements));
+    }
+    else
+    {
+      for (const auto& element : elements)
+        detail::WriteValue(element, stream);
+    }
+  }
+
+  template <typename T>
+  static void Read(T& value, SourceStream& stream)
+  {
+    Length length{};
+    stream.Read(length);
+
+    auto& elements = value.*Member;
+    if constexpr (detail::ViewTraits<Value>::IsView)
+    {
+      static_assert(sizeof(Element) == 1, "Only views of bytes are borrowed, wider elements may be misaligned");
+      const auto view = stream.ReadView(length);
+      elements = Value(reinterpret_cast<const Element*>(view.data()), view.size());
+    }
+    else if constexpr (Numeric<Element> && std::ranges::contiguous_range<Value>)
+    {
+      elements.resize(length);
+      stream.Read(std::span(elements));
+    }
+    else
+    {
+      elements.resize(length);
+      for (auto& element : elements)
+        detail::ReadValue(element, stream);
+    }
+  }
+
+  template <typename T>
+  static std::size_t Size(const T& value)
+  {
+    const auto& elements = value.*Member;
+
+    constexpr auto elementSize = detail::GetFixedSize<Element>();
+    if constexpr (elementSize.has_value())
+    {
+      return sizeof(Length) + elements.size() * *elementSize;
+    }
+    else
+    {
+      std::size_t size = sizeof(Length);
+      for (const auto& element : elements)
+        size += detail::GetSize(element);
+      return size;
+    }
+  }
+};
+
+//! A schema of a serialized structure, listing its fields in the order of serialization.
+//! The structure declares the schema as its `Schema` member type
+//! and the streams read and write it through the schema.
+//! A schema of only fixed-size fields is read and written with a single bounds check.
+//! @tparam Fields Fields of the structure, `Field` or `List`.
+template <typename... Fields>
+struct Schema
+{
+  //! Serialized size of the structure if all of the fields have a fixed size.
+  static constexpr std::optional<std::size_t> FixedSize =
+    (Fields::FixedSize.has_value() && ...)
+      ? std::optional<std::size_t>((std::size_t{0} + ... + Fields::FixedSize.value_or(0)))
+      : std::nullopt;
+
+  //! Whether the serialized size of the structure can be computed.
+  static constexpr bool IsSized = (Fields::IsSized && ...);
+
+  //! Writes the structure to the stream.
+  //! @param value Structure.
+  //! @param stream Sink stream.
+  template <typename T>
+  static void Write(const T& value, SinkStream& stream)
+  {
+    if constexpr (FixedSize.has_value())
+    {
+      std::array<std::byte, *FixedSize> buffer;
+      std::byte* cursor = buffer.data();
+      Store(value, cursor);
+      stream.Write(buffer.data(), buffer.size());
+    }
+    else
+    {
+      (Fields::Write(value, stream), ...);
+    }
+  }
+
+  //! Reads the structure from the stream.
+  //! @param value Structure.
+  //! @param stream Source stream.
+  template <typename T>
+  static void Read(T& value, SourceStream& stream)
+  {
+    if constexpr (FixedSize.has_value())
+    {
+      std::array<std::byte, *FixedSize> buffer;
+      stream.Read(buffer.data(), buffer.size());
+      const std::byte* cursor = buffer.data();
+      Load(value, cursor);
+    }
+    else
+    {
+      (Fields::Read(value, stream), ...);
+    }
+  }
+
+  //! Returns the serialized size of the structure.
+  //! Exact unless the structure contains non-ASCII strings, for which it is an upper bound.
+  //! @param value Structure.
+  //! @returns Serialized size.
+  template <typename T>
+    requires IsSized
+  static std::size_t SerializedSize(const T& value)
+  {
+    if constexpr (FixedSize.has_value())
+      return *FixedSize;
+    else
+      return (std::size_t{0} + ... + Fields::Size(value));
+  }
+
+  //! Stores the fixed-size structure to the buffer and advances the buffer.
+  template <typename T>
+    requires (FixedSize.has_value())
+  static void Store(const T& value, std::byte*& buffer) noexcept
+  {
+    (Fields::Store(value, buffer), ...);
+  }
+
+  //! Loads the fixed-size structure from the buffer and advances the buffer.
+  template <typename T>
+    requires (FixedSize.has_value())
+  static void Load(T& value, const std::byte*& buffer) noexcept
+  {
+    (Fields::Load(value, buffer), ...);
+  }
+};
+
+//! Checks whether the serialized size of the structure can be computed from its schema.
+template <typename T>
+concept SizedSchemaStruct = SchemaStruct<T> && T::Schema::IsSized;
+
+} // namespace server
+
+#endif // SCHEMA_HPP
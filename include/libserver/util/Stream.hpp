@@ -21,8 +21,10 @@
 #define STREAM_HPP
 
 #include <format>
+#include <memory_resource>
 #include <span>
 #include <stdexcept>
+#include <string>
 #include <type_traits>
 
 namespace server
@@ -86,13 +88,19 @@ concept Container = requires(T a) {
   { a.end() } -> std::input_or_output_iterator;
 };
 
+//! A structure serialized through its schema, see `Schema`.
 template <typename T>
-concept WritableStruct = requires(T value, SinkStream& stream) {
+concept SchemaStruct = requires {
+  typename T::Schema;
+};
+
+template <typename T>
+concept WritableStruct = SchemaStruct<T> || requires(T value, SinkStream& stream) {
   { T::Write(value, stream) };
 };
 
 template <typename T>
-concept ReadableStruct = requires(T value, SourceStream& stream) {
+concept ReadableStruct = SchemaStruct<T> || requires(T value, SourceStream& stream) {
   { T::Read(value, stream) };
 };
 
@@ -138,16 +146,40 @@ public:
     return *this;
   }
 
+  //! Write a contiguous range of values to the sink stream as is.
+  //!
+  //! @param values Values to write.
+  //! @tparam T Type of values.
+  //! @return Reference to this.
+  template <typename T, std::size_t Extent>
+    requires std::is_trivially_copyable_v<T> && (not WritableStruct<std::remove_cv_t<T>>)
+  SinkStream& Write(std::span<T, Extent> values)
+  {
+    Write(reinterpret_cast<const void*>(values.data()), values.size_bytes());
+    return *this;
+  }
+
   //! Write a string to the stream.
-  //! Fails if the operation can'
+  //! Fails if the operation can't be completed wholly.
   SinkStream& Write(const std::string& value);
 
+  //! Write a string to the stream.
+  //! Fails if the operation can't be completed wholly.
+  SinkStream& Write(const std::pmr::string& value);
+
   template <WritableStruct T>
   SinkStream& Write(const T& value)
   {
-    T::Write(value, *this);
+    if constexpr (SchemaStruct<T>)
+      T::Schema::Write(value, *this);
+    else
+      T::Write(value, *this);
     return *this;
   }
+
+private:
+  //! Writes the UTF-8 string in the EUC-KR encoding, with its null-terminator.
+  void WriteString(std::string_view value);
 };
 
 //! Buffered stream source.
@@ -192,14 +224,49 @@ public:
     return *this;
   }
 
+  //! Read a contiguous range of values from the source stream as is.
+  //!
+  //! @param values Values to read.
+  //! @tparam T Type of values.
+  //! @return Reference to this.
+  template <typename T, std::size_t Extent>
+    requires std::is_trivially_copyable_v<T> && (not ReadableStruct<T>) && (not std::is_const_v<T>)
+  SourceStream& Read(std::span<T, Extent> values)
+  {
+    Read(reinterpret_cast<void*>(values.data()), values.size_bytes());
+    return *this;
+  }
+
+  //! Read a view of the bytes in the storage of the source stream, without a copy.
+  //! The view is valid as long as the storage.
+  //! Fails if the operation can't be completed wholly.
+  //! @param size Count of the bytes.
+  //! @returns View of the bytes.
+  [[nodiscard]] std::span<const std::byte> ReadView(std::size_t size);
+
+  //! Read a null-terminated string from the source stream.
+  //! Fails if the string is not terminated within the stream.
   SourceStream& Read(std::string& value);
 
+  //! Read a null-terminated string from the source stream
+  //! to the allocator of the string.
+  //! Fails if the string is not terminated within the stream.
+  SourceStream& Read(std::pmr::string& value);
+
   template <ReadableStruct T>
   SourceStream& Read(T& value)
   {
-    T::Read(value, *this);
+    if constexpr (SchemaStruct<T>)
+      T::Schema::Read(value, *this);
+    else
+      T::Read(value, *this);
     return *this;
   }
+
+private:
+  //! Reads a null-terminated string, still in the EUC-KR encoding.
+  //! @returns View of the string in the storage.
+  std::string_view ReadString();
 };
 
 } // namespace server
@@ -0,0 +1,74 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#ifndef SERVER_WAKEUP_HPP
+#define SERVER_WAKEUP_HPP
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+
+namespace server
+{
+
+//! A wakeup signalled when work is queued to its owner.
+//! The signals are coalesced, the handler is invoked once for any number of signals
+//! until the owner resets the wakeup to take the work.
+class Wakeup final
+{
+public:
+  //! A handler invoked when the wakeup is signalled.
+  using Handler = std::function<void()>;
+
+  Wakeup() = default;
+
+  Wakeup(const Wakeup&) = delete;
+  Wakeup& operator=(const Wakeup&) = delete;
+
+  //! Sets the handler of the wakeup. Thread-safe.
+  //! Once the handler is replaced the previous handler is no longer invoked.
+  //! @param handler Handler to invoke when signalled, may be empty.
+  void SetHandler(Handler handler);
+
+  //! Signals the wakeup. Thread-safe.
+  //! Invokes the handler if the wakeup was not already signalled.
+  //! The handler must not signal the same wakeup.
+  void Signal();
+
+  //! Resets the wakeup, so that the next signal invokes the handler again.
+  //! Should be called before the owner takes the queued work.
+  //! @returns `true` if the wakeup was signalled, `false` otherwise.
+  bool Reset() noexcept;
+
+  //! Returns whether the wakeup is signalled.
+  //! @returns `true` if the wakeup is signalled, `false` otherwise.
+  [[nodiscard]] bool IsSignalled() const noexcept;
+
+private:
+  //! A flag indicating whether the wakeup is signalled.
+  std::atomic_bool _isSignalled{false};
+  //! A mutex to the handler.
+  std::mutex _handlerMutex;
+  //! A handler of the wakeup.
+  Handler _handler;
+};
+
+} // namespace server
+
+#endif // SERVER_WAKEUP_HPP
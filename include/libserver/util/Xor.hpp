@@ -0,0 +1,93 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#ifndef SERVER_XOR_HPP
+#define SERVER_XOR_HPP
+
+#include <array>
+#include <cstddef>
+#include <span>
+
+namespace server::util
+{
+
+//! A repeating 4-byte XOR key.
+using XorKey = std::array<std::byte, 4>;
+
+//! Implementations of the XOR operation.
+enum class XorKernel
+{
+  //! Portable implementation processing the data in 64-bit words.
+  Scalar,
+  //! Implementation using the SSE2 instruction set.
+  Sse2,
+  //! Implementation using the AVX2 instruction set.
+  Avx2,
+};
+
+//! Checks whether the kernel is supported by the processor.
+//!
+//! @param kernel Kernel.
+//! @returns `true` if the kernel is supported, `false` otherwise.
+bool IsXorKernelSupported(XorKernel kernel);
+
+//! Returns the fastest kernel supported by the processor.
+//! The kernel is selected once, on the first call.
+//!
+//! @returns Kernel.
+XorKernel GetXorKernel();
+
+//! XORs the source data with the repeating key using the specified kernel
+//! and writes the result to the sink. Byte at index `i` of the source
+//! is XORed with the key byte at index `(keyOffset + i) % 4`.
+//! The sink may be the same memory as the source, but must not partially overlap it.
+//!
+//! @param kernel Kernel to use. Must be supported by the processor.
+//! @param key Key.
+//! @param source Source data.
+//! @param sink Sink of the data. Must be at least as large as the source.
+//! @param keyOffset Index of the key byte the first byte of the source is XORed with.
+//! @throws std::invalid_argument If the sink is smaller than the source.
+void XorWithKey(
+  XorKernel kernel,
+  const XorKey& key,
+  std::span<const std::byte> source,
+  std::span<std::byte> sink,
+  std::size_t keyOffset = 0);
+
+//! XORs the source data with the repeating key using the fastest kernel
+//! supported by the processor and writes the result to the sink.
+//! @see XorWithKey(XorKernel, const XorKey&, std::span<const std::byte>, std::span<std::byte>, std::size_t)
+void XorWithKey(
+  const XorKey& key,
+  std::span<const std::byte> source,
+  std::span<std::byte> sink,
+  std::size_t keyOffset = 0);
+
+//! XORs the data with the repeating key in-place using the fastest kernel
+//! supported by the processor.
+//! @see XorWithKey(XorKernel, const XorKey&, std::span<const std::byte>, std::span<std::byte>, std::size_t)
+void XorWithKey(
+  const XorKey& key,
+  std::span<std::byte> data,
+  std::size_t keyOffset = 0);
+
+} // namespace server::util
+
+#endif // SERVER_XOR_HPP
@@ -20,6 +20,10 @@
 #ifndef CONFIG_HPP
 #define CONFIG_HPP
 
+#include <libserver/network/Server.hpp>
+
+#include <chrono>
+
 #include <nlohmann/json.hpp>
 #include <boost/asio/ip/address.hpp>
 
@@ -46,6 +50,8 @@ public:
   {
     std::string brand;
     std::string notice;
+    //! Count of the worker threads running the directors, zero for the count of the hardware threads.
+    std::size_t workerThreads{0};
   } general{};
 
   //!
@@ -72,12 +78,56 @@ public:
     } postgres{};
   } telemetry{};
 
+  //! Settings of the time-driven ticks of a director.
+  struct DirectorTicks
+  {
+    //! Rate of the time-driven ticks, in ticks per second.
+    uint32_t tickRate{50};
+    //! Whether the tick rate lowers while the ticks take longer than their budget
+    //! and recovers once they fit in it again.
+    bool adaptive{false};
+    //! The lowest rate of the adaptive ticks, in ticks per second.
+    uint32_t minTickRate{10};
+    //! Whether the late ticks are caught up with by ticking back to back,
+    //! otherwise they are skipped.
+    bool catchUp{false};
+  };
+
+  //! Tick settings of the ticked directors.
+  //! The messenger, chat and ranch directors are not ticked and have no settings.
+  struct Directors
+  {
+    DirectorTicks authentication{};
+    DirectorTicks data{};
+    DirectorTicks lobby{};
+    DirectorTicks race{};
+    DirectorTicks telemetry{
+      .tickRate = 1,
+      .minTickRate = 1};
+  } directors{};
+
+  //! Settings of the profiler of the command handlers and the director ticks.
+  struct Profiler
+  {
+    //! Interval of the profile reports logged periodically.
+    //! Zero disables the reports.
+    std::chrono::seconds reportInterval{60};
+    //! Max count of the sections in a report, by their total duration.
+    std::size_t reportLimit{10};
+  } profiler{};
+
+  //! Network settings shared by all the listeners.
+  server::network::ServerSettings network{};
+
   //!
   struct Lobby
   {
     bool enabled{true};
     Listen listen{
       .port = 10030};
+    //! For how long may a client stay connected without sending any data.
+    //! Zero disables the timeout.
+    std::chrono::seconds idleTimeout{1800};
 
     struct Advertisement
     {
@@ -108,6 +158,9 @@ public:
     bool enabled{true};
     Listen listen{
       .port = 10031};
+    //! For how long may a client stay connected without sending any data.
+    //! Zero disables the timeout.
+    std::chrono::seconds idleTimeout{1800};
   } ranch{};
 
   //!
@@ -116,6 +169,9 @@ public:
     bool enabled{true};
     Listen listen{
       .port = 10032};
+    //! For how long may a client stay connected without sending any data.
+    //! Zero disables the timeout.
+    std::chrono::seconds idleTimeout{1800};
   } race{};
 
   //!
@@ -124,6 +180,9 @@ public:
     bool enabled{true};
     Listen listen{
       .port = 10033};
+    //! For how long may a client stay connected without sending any data.
+    //! Zero disables the timeout.
+    std::chrono::seconds idleTimeout{0};
   } messenger{};
 
   //!
@@ -132,6 +191,9 @@ public:
     bool enabled{true};
     Listen listen{
       .port = 10034};
+    //! For how long may a client stay connected without sending any data.
+    //! Zero disables the timeout.
+    std::chrono::seconds idleTimeout{0};
   } allChat{};
 
   struct PrivateChat
@@ -139,6 +201,9 @@ public:
     bool enabled{true};
     Listen listen{
       .port = 10035};
+    //! For how long may a client stay connected without sending any data.
+    //! Zero disables the timeout.
+    std::chrono::seconds idleTimeout{0};
   } privateChat{};
 
   //!
@@ -45,6 +45,9 @@
 #include <libserver/registry/MagicRegistry.hpp>
 #include <libserver/registry/PetRegistry.hpp>
 #include <libserver/registry/SystemContentRegistry.hpp>
+#include <libserver/util/Executor.hpp>
+#include <libserver/util/Profiler.hpp>
+#include <libserver/util/Wakeup.hpp>
 
 #include <spdlog/spdlog.h>
 
@@ -160,45 +163,188 @@ public:
   //! @returns Reference to the settings.
   Config& GetSettings();
 
-private:
+  //! Returns reference to the executor running the directors.
+  //! @returns Reference to the executor.
+  Executor& GetExecutor();
+
+  //! Returns reference to the strand of the lobby director.
+  //! Tasks posted to the strand run serialized with the ticks of the director.
+  //! @returns Reference to the strand.
+  Executor::Strand& GetLobbyDirectorStrand();
+  //! Returns reference to the strand of the messenger director.
+  //! @returns Reference to the strand.
+  Executor::Strand& GetMessengerDirectorStrand();
+  //! Returns reference to the strand of the all chat director.
+  //! @returns Reference to the strand.
+  Executor::Strand& GetAllChatDirectorStrand();
+  //! Returns reference to the strand of the private chat director.
+  //! @returns Reference to the strand.
+  Executor::Strand& GetPrivateChatDirectorStrand();
+  //! Returns reference to the strand of the ranch director.
+  //! @returns Reference to the strand.
+  Executor::Strand& GetRanchDirectorStrand();
+  //! Returns reference to the strand of the race director.
+  //! @returns Reference to the strand.
+  Executor::Strand& GetRaceDirectorStrand();
+
+  //! Statistics of the ticks of a director.
+  struct DirectorStatistics
+  {
+    //! Name of the director.
+    std::string name;
+    //! Current rate of the time-driven ticks, in ticks per second.
+    uint32_t tickRate{};
+    //! Count of the ticks.
+    uint64_t tickCount{};
+    //! Count of the ticks which took longer than their budget.
+    uint64_t overrunCount{};
+    //! Count of the time-driven ticks skipped because the director fell behind.
+    uint64_t skippedTickCount{};
+    //! Total duration of the ticks.
+    std::chrono::microseconds totalTickDuration{};
+    //! Duration of the longest tick.
+    std::chrono::microseconds maxTickDuration{};
+  };
+
+  //! Collects the statistics of the director ticks since the last collection.
+  //! @returns Statistics of the running directors.
+  [[nodiscard]] std::vector<DirectorStatistics> CollectDirectorStatistics();
 
+private:
+  //! A director run on its strand.
+  struct DirectorRun
+  {
+    //! Name of the director, for the logs.
+    std::string name;
+    //! Strand the director runs on.
+    Executor::Strand& strand;
+    std::function<void()> initialize;
+    std::function<void()> tick;
+    std::function<void()> terminate;
+    //! Wakeup of the director, null if the director is not woken up by work queued to it.
+    Wakeup* wakeup{nullptr};
+    //! Returns the time point of the next time-driven tick of the director, may be empty.
+    std::function<std::optional<Executor::Clock::time_point>()> nextTickTime;
+    //! Tick settings of the director.
+    Config::DirectorTicks ticks{};
+    //! Whether the director is ticked, which it is if it has a wakeup or the next tick time.
+    //! A director which is not ticked is only initialized and terminated.
+    bool isTicked{false};
+    //! Profiler section of the ticks.
+    Profiler::SectionId profilerSection{};
+
+    //! Current interval between the time-driven ticks.
+    Executor::Clock::duration tickInterval{};
+    //! Count of the consecutive ticks which fit in half of their budget, for the adaptive tick rate.
+    std::size_t fittingTickCount{0};
+    //! Time point the last tick was due at, the time-driven ticks which catch up follow it.
+    Executor::Clock::time_point lastDueTickTime{};
+    //! Time point of the last warning about skipped ticks.
+    Executor::Clock::time_point lastSkipWarningTime{};
+    //! Time point of the last tick.
+    Executor::Clock::time_point lastTickTime{};
+    //! Count of the ticks following the last tick sooner than the tick interval.
+    std::size_t immediateTickCount{0};
+    //! Time point the timer of the next tick is armed for, empty if not armed.
+    std::optional<Executor::Clock::time_point> timerTime;
+    //! Generation of the timer, a timer of an older generation is discarded.
+    uint64_t timerGeneration{0};
+    //! A flag indicating whether the director was terminated.
+    bool isTerminated{false};
+
+    //! A mutex to the statistics.
+    std::mutex statisticsMutex;
+    //! Statistics of the ticks since the last collection.
+    DirectorStatistics statistics{};
+  };
+
+  //! Runs the director on its strand.
+  //! The director is initialized, ticked until the server should stop and then terminated.
+  //! A director providing `GetWakeup()` is ticked when its wakeup is signalled
+  //! and a director providing `GetNextTickTime()` is ticked once the returned time point is due,
+  //! a director providing neither is not ticked and has no tick settings.
+  //! @param name Name of the director, for the logs.
+  //! @param director Director to run.
+  //! @param strand Strand to run the director on.
+  //! @param ticks Tick settings of the director.
   template<typename T>
-  void RunDirectorTaskLoop(T& director)
+  void RunDirector(
+    std::string name,
+    T& director,
+    Executor::Strand& strand,
+    const Config::DirectorTicks& ticks)
   {
-    using Clock = std::chrono::steady_clock;
-
-    constexpr uint64_t TicksPerSecond = 50;
-    constexpr uint64_t millisPerTick = 1000ull / TicksPerSecond;
-
-    Clock::time_point lastTick;
-    while (_shouldRun.load(std::memory_order::relaxed))
+    // The run is not movable, it is initialized in place.
+    std::shared_ptr<DirectorRun> directorRun(new DirectorRun{
+      .name = std::move(name),
+      .strand = strand,
+      .initialize = [&director]() { director.Initialize(); },
+      .tick = [&director]() { director.Tick(); },
+      .terminate = [&director]() { director.Terminate(); },
+      .ticks = ticks});
+
+    if constexpr (requires { director.GetWakeup(); })
     {
-      const auto timeNow = Clock::now();
-      // Time delta between ticks [ms].
-      const auto tickDelta = std::chrono::duration_cast<
-        std::chrono::milliseconds>(timeNow - lastTick);
+      directorRun->wakeup = &director.GetWakeup();
+    }
 
-      if (tickDelta < std::chrono::milliseconds(millisPerTick))
+    if constexpr (requires { director.GetNextTickTime(); })
+    {
+      directorRun->nextTickTime = [&director]() -> std::optional<Executor::Clock::time_point>
       {
-        const auto sleepMs = millisPerTick - tickDelta.count();
-        std::this_thread::sleep_for(
-          std::chrono::milliseconds(sleepMs));
-        continue;
-      }
+        return director.GetNextTickTime();
+      };
+    }
 
-      lastTick = timeNow;
+    RunDirector(std::move(directorRun));
+  }
 
-      try
-      {
-        director.Tick();
-      }
-      catch (const std::exception& x)
-      {
-        spdlog::error("Exception in tick loop: {}", x.what());
-      }
-    }
+  //! Runs the director which is not ticked on its strand.
+  //! The director is only initialized and terminated.
+  //! @param name Name of the director, for the logs.
+  //! @param director Director to run.
+  //! @param strand Strand to run the director on.
+  template<typename T>
+  void RunDirector(
+    std::string name,
+    T& director,
+    Executor::Strand& strand)
+  {
+    static_assert(
+      not requires { director.GetWakeup(); } && not requires { director.GetNextTickTime(); },
+      "A ticked director requires its tick settings");
+    RunDirector(std::move(name), director, strand, Config::DirectorTicks{});
   }
 
+  void RunDirector(std::shared_ptr<DirectorRun> directorRun);
+  //! Ticks the director and arms the timer of its next tick,
+  //! or terminates it if the server should stop.
+  //! Executes on the strand of the director.
+  //! @param directorRun Director to tick.
+  //! @param dueTickTime Time point the time-driven tick was due at,
+  //!                    empty if the director was woken up.
+  void TickDirector(
+    const std::shared_ptr<DirectorRun>& directorRun,
+    std::optional<Executor::Clock::time_point> dueTickTime = std::nullopt);
+  //! Updates the statistics and the adaptive tick rate of the director after its tick.
+  //! @param directorRun Director which ticked.
+  //! @param tickDuration Duration of the tick.
+  void OnDirectorTicked(
+    DirectorRun& directorRun,
+    Executor::Clock::duration tickDuration);
+  //! Arms the timer of the next tick of the director, unless it is armed sooner already.
+  //! Executes on the strand of the director.
+  //! @param directorRun Director to arm the timer of.
+  //! @param tickTime Time point of the tick.
+  void ArmDirectorTimer(
+    const std::shared_ptr<DirectorRun>& directorRun,
+    Executor::Clock::time_point tickTime);
+  //! Marks the director as no longer running.
+  void OnDirectorFinished();
+  //! Schedules the report of the profile recorded over the next report interval.
+  //! @param earlierProfile Profile at the beginning of the interval.
+  void ScheduleProfileReport(std::vector<Profiler::Section> earlierProfile);
+
   //! Atomic flag indicating whether the server should run.
   std::atomic_bool _shouldRun{false};
 
@@ -207,43 +353,54 @@ private:
   //! A config.
   Config _config;
 
-  //! A thread of the authentication service.
-  std::thread _authenticationThread;
+  //! An executor running the directors.
+  Executor _executor;
+  //! A mutex for the count of the running directors.
+  std::mutex _runningDirectorsMutex;
+  //! Condition signalled when a director finishes running.
+  std::condition_variable _runningDirectorsCondition;
+  //! Count of the directors running on the executor.
+  std::size_t _runningDirectorCount{0};
+  //! Directors running on the executor, woken up on termination.
+  std::vector<std::shared_ptr<DirectorRun>> _directorRuns;
+
+  //! A strand of the authentication service.
+  Executor::Strand _authenticationStrand;
   //! An authentication service.
   AuthenticationService _authenticationService;
 
-  //! A thread of the data director.
-  std::thread _dataDirectorThread;
+  //! A strand of the data director.
+  Executor::Strand _dataDirectorStrand;
   //! A data director.
   DataDirector _dataDirector;
 
-  //! A thread of the lobby director.
-  std::thread _lobbyDirectorThread;
+  //! A strand of the lobby director.
+  Executor::Strand _lobbyDirectorStrand;
   //! A lobby director.
   LobbyDirector _lobbyDirector;
 
-  //! A thread for the messenger director.
-  std::thread _messengerThread;
+  //! A strand of the messenger director.
+  Executor::Strand _messengerStrand;
   //! A messenger director.
   MessengerDirector _messengerDirector;
 
-  //! A thread for the all chat director.
-  std::thread _allChatDirectorThread;
+  //! A strand of the all chat director.
+  Executor::Strand _allChatDirectorStrand;
   //! An all chat director.
   AllChatDirector _allChatDirector;
 
-  //! A thread for the private chat director.
-  std::thread _privateChatDirectorThread;
+  //! A strand of the private chat director.
+  Executor::Strand _privateChatDirectorStrand;
   //! A private chat director.
   PrivateChatDirector _privateChatDirector;
 
-  //! A thread of the ranch director.
-  std::thread _ranchDirectorThread;
+  //! A strand of the ranch director.
+  Executor::Strand _ranchDirectorStrand;
   //! A ranch director.
   RanchDirector _ranchDirector;
 
-  //! A thread of the race director.
-  std::thread _raceDirectorThread;
+  //! A strand of the race director.
+  Executor::Strand _raceDirectorStrand;
   //! A race director.
   RaceDirector _raceDirector;
 
@@ -277,8 +434,8 @@ private:
   //! A matchmaking system.
   MatchmakingSystem _matchmakingSystem;
 
-  //! A thread for telemetry.
-  std::thread _telemetryThread;
+  //! A strand of telemetry.
+  Executor::Strand _telemetryStrand;
   //! Telemetry.
   Telemetry _telemetry;
 };
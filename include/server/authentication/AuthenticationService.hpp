@@ -22,9 +22,13 @@
 
 #include "AuthenticationBackend.hpp"
 
+#include <libserver/util/Wakeup.hpp>
+
 #include <atomic>
+#include <chrono>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <queue>
 #include <string>
 
@@ -48,6 +52,14 @@ public:
   void Terminate() noexcept;
   void Tick() noexcept;
 
+  //! Returns the wakeup of the service, signalled when an authentication is queued.
+  //! @returns Reference to the wakeup.
+  [[nodiscard]] Wakeup& GetWakeup() noexcept;
+  //! Returns the time point of when the service needs to tick next,
+  //! regardless of being woken up.
+  //! @returns Time point of the next tick, or empty if no authentications are queued.
+  [[nodiscard]] std::optional<std::chrono::steady_clock::time_point> GetNextTickTime() noexcept;
+
   //! Thread safe
   void QueueAuthentication(
     const std::string& userName,
@@ -68,6 +80,8 @@ private:
 
   ServerInstance& _serverInstance;
 
+  Wakeup _wakeup;
+
   std::mutex _queueMutex;
   std::queue<Authentication> _queue{};
 
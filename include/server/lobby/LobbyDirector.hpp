@@ -82,6 +82,14 @@ public:
   //! Tick the director.
   void Tick();
 
+  //! Get the wakeup of the director, signalled when work is queued to the director.
+  //! @return Wakeup of the director.
+  [[nodiscard]] Wakeup& GetWakeup();
+  //! Get the time point of when the director needs to tick next,
+  //! regardless of being woken up.
+  //! @return Time point of the next tick, or empty if the director has no work queued.
+  [[nodiscard]] std::optional<Scheduler::Clock::time_point> GetNextTickTime();
+
   bool QueueClientConnect(
     network::ClientId clientId);
   size_t QueueClientLogin(
@@ -175,8 +183,14 @@ private:
     bool userCharacterLoadRequested{false};
   };
 
-  void ProcessLoginRequest();
-  void ProcesLoginResponse();
+  //! Processes the login at the front of the request queue.
+  //! @return `true` if the login progressed and the queue can be processed again right away,
+  //!         `false` if the login waits for the authentication or for the data.
+  bool ProcessLoginRequest();
+  //! Processes the login at the front of the response queue.
+  //! @return `true` if the login progressed and the queue can be processed again right away,
+  //!         `false` if the login waits for the data.
+  bool ProcesLoginResponse();
 
   std::unordered_map<network::ClientId, QueuedLogin> _clientLogins;
 
@@ -189,6 +203,8 @@ private:
 
   //! A server instance.
   ServerInstance& _serverInstance;
+  //! A wakeup.
+  Wakeup _wakeup;
   //! A scheduler.
   Scheduler _scheduler;
   //! A shop manager.
@@ -58,6 +58,14 @@ public:
   void Terminate();
   void Tick();
 
+  //! Returns the wakeup of the director, signalled when work is queued to the director.
+  //! @returns Reference to the wakeup.
+  [[nodiscard]] Wakeup& GetWakeup();
+  //! Returns the time point of when the director needs to tick next,
+  //! regardless of being woken up. The director ticks periodically while any race is in progress.
+  //! @returns Time point of the next tick, or empty if the director has no work queued.
+  [[nodiscard]] std::optional<Scheduler::Clock::time_point> GetNextTickTime();
+
   bool IsRoomRacing(uint32_t uid)
   {
     std::scoped_lock lock(_raceInstancesMutex);
@@ -268,7 +276,7 @@ private:
 
   void HandleRelay(
     ClientId clientId,
-    const protocol::AcCmdCRRelay& command);
+    const protocol::AcCmdCRRelayView& command);
 
   void HandleUserRaceActivateInteractiveEvent(
     ClientId clientId,
@@ -346,6 +354,8 @@ private:
   std::thread test;
   std::atomic_bool run_test{true};
 
+  //! A wakeup instance.
+  Wakeup _wakeup;
   //! A scheduler instance.
   Scheduler _scheduler;
   //! A server instance.
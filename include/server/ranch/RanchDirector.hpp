@@ -171,7 +171,7 @@ private:
 
   void HandleSnapshot(
     ClientId clientId,
-    const protocol::AcCmdCRRanchSnapshot& command);
+    const protocol::AcCmdCRRanchSnapshotView& command);
 
   void HandleEnterBreedingMarket(
     ClientId clientId,
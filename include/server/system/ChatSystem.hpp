@@ -24,6 +24,7 @@
 
 #include <functional>
 #include <string>
+#include <string_view>
 #include <span>
 #include <unordered_map>
 
@@ -79,7 +80,7 @@ public:
   //! @param message Message that was sent.
   [[nodiscard]] ChatVerdict ProcessChatMessage(
     data::Uid characterUid,
-    const std::string& message) noexcept;
+    std::string_view message) noexcept;
 
   [[nodiscard]] CommandVerdict ProcessCommandMessage(
     data::Uid characterUid,
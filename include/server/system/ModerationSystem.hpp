@@ -23,6 +23,7 @@
 #include <filesystem>
 #include <regex>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace server
@@ -42,7 +43,7 @@ public:
   //! Moderates an input message and presents a verdict.
   //! @param input Message to validate.
   //! @return Moderation verdict.
-  [[nodiscard]] Verdict Moderate(const std::string& input) const noexcept;
+  [[nodiscard]] Verdict Moderate(std::string_view input) const noexcept;
 
 private:
   struct Word
@@ -23,7 +23,9 @@
 #include <libserver/util/Scheduler.hpp>
 #include <libserver/util/TimeSeriesData.hpp>
 
+#include <map>
 #include <optional>
+#include <string>
 
 #include <pqxx/pqxx>
 
@@ -41,12 +43,38 @@ public:
   void Terminate();
   void Tick();
 
+  //! Returns the wakeup of the telemetry, signalled when a job is queued.
+  //! @returns Reference to the wakeup.
+  [[nodiscard]] Wakeup& GetWakeup();
+  //! Returns the time point of the next collection or synchronization.
+  //! @returns Time point of the next tick, or empty if no jobs are queued.
+  [[nodiscard]] std::optional<Scheduler::Clock::time_point> GetNextTickTime();
+
 private:
   //! Time series data tracking the player count.
   TimeSeriesData<size_t, 3600> _playerCountMetric;
   //! Time series data tracking the race count.
   TimeSeriesData<size_t, 3600> _roomCountMetric;
 
+  //! Tick metric of a director, over the collection interval.
+  struct DirectorTickMetric
+  {
+    //! Rate of the time-driven ticks, in ticks per second.
+    uint32_t tickRate{};
+    //! Count of the ticks.
+    uint64_t tickCount{};
+    //! Count of the ticks which took longer than their budget.
+    uint64_t overrunCount{};
+    //! Count of the skipped ticks.
+    uint64_t skippedTickCount{};
+    //! Mean duration of the ticks, in microseconds.
+    int64_t meanTickDuration{};
+    //! Duration of the longest tick, in microseconds.
+    int64_t maxTickDuration{};
+  };
+  //! Time series data tracking the ticks of the directors, by the name of the director.
+  std::map<std::string, TimeSeriesData<DirectorTickMetric, 3600>> _directorTickMetrics;
+
   //! Flag indicating whether telemetry is enabled.
   bool enabled = false;
 
@@ -60,6 +88,8 @@ private:
 
   //! Reference to server instance.
   ServerInstance& _serverInstance;
+  //! Wakeup.
+  Wakeup _wakeup;
   //! Job scheduler.
   Scheduler _scheduler;
 
@@ -24,6 +24,7 @@
 
 #include <libserver/data/DataDefinitions.hpp>
 #include <libserver/network/command/proto/CommonStructureDefinitions.hpp>
+#include <libserver/util/Scheduler.hpp>
 
 #include <array>
 #include <chrono>
@@ -80,8 +81,9 @@ public:
     //! Active skill effects indexed by skillEffectId (0-23).
     static constexpr size_t EffectCount = 24;
     std::array<bool, EffectCount> effects{};
-    //! Per-effect generation counter, incremented on each apply, used to invalidate stale removal timers.
-    std::array<uint32_t, EffectCount> effectGenerations{};
+    //! Per-effect job removing the effect once it expires, cancelled when the effect is extended or removed.
+    //! Zero if there is no job. A job whose ID no longer matches is stale and does not remove the effect.
+    std::array<Scheduler::JobId, EffectCount> effectRemovalJobs{};
 
     //! Rank of the currently active removeMagic attack (0 = none active).
     uint32_t attackRank{};
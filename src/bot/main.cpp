@@ -0,0 +1,1571 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+//! Headless bots generating a load on a server and reporting the latency of its responses.
+//!
+//! Usage: alicia-bot [--address <address>] [--port <port>] [--bots <count>] [--prefix <name>]
+//!                   [--mix ranch=<weight>,race=<weight>,chat=<weight>]
+//!                   [--ramp-up-ms <milliseconds>] [--duration-s <seconds>]
+//!                   [--snapshot-hz <rate>] [--position-hz <rate>] [--chat-per-min <rate>]
+//!                   [--ranch-group <size>] [--race-group <size>] [--json <path>]
+//!
+//! Every bot logs in to the lobby server as the user `<prefix><index>`, creating the character
+//! if the user has none, and plays one of the scenarios:
+//! - ranch: enters the ranch of the first bot of its group and sends the snapshots and the chat,
+//! - race: the first bot of the group makes a room, the others enter it and ready up,
+//!   then the group races, sending the positions and the chat,
+//! - chat: logs in to the messenger, enters the all chat and chats.
+//!
+//! The bots expect the server to authenticate with the `local` authentication backend,
+//! which accepts any user, and connect to the servers advertised by the lobby.
+//! Every bot holds up to three connections, the server limits the connections
+//! from one address with `network.connections` of its configuration.
+//! Latency is measured from a request to its response, per request command.
+
+#include <libserver/network/chatter/ChatterProtocol.hpp>
+#include <libserver/network/chatter/proto/ChatterMessageDefinitions.hpp>
+#include <libserver/network/command/CommandServer.hpp>
+#include <libserver/network/command/proto/LobbyMessageDefinitions.hpp>
+#include <libserver/network/command/proto/RaceMessageDefinitions.hpp>
+#include <libserver/network/command/proto/RanchMessageDefinitions.hpp>
+#include <libserver/util/Xor.hpp>
+
+#include <boost/asio.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <optional>
+#include <ranges>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+namespace asio = boost::asio;
+using Clock = std::chrono::steady_clock;
+
+using namespace server;
+
+//! Game version the lobby expects in the login.
+constexpr uint16_t GameVersionConstant0 = 50;
+constexpr uint16_t GameVersionConstant1 = 281;
+//! The only horse TID the lobby accepts for a created character.
+constexpr uint32_t DefaultHorseTid = 20001;
+//! Interval of the lobby heartbeats.
+constexpr std::chrono::seconds HeartbeatInterval{10};
+//! Interval of the start race attempts of the room master.
+constexpr std::chrono::seconds StartRaceInterval{1};
+//! For how long to wait for the responses to the leave commands.
+constexpr std::chrono::milliseconds DrainTime{1000};
+
+enum class Scenario
+{
+  Ranch,
+  Race,
+  Chat
+};
+
+std::string_view GetScenarioName(Scenario scenario)
+{
+  switch (scenario)
+  {
+    case Scenario::Ranch:
+      return "ranch";
+    case Scenario::Race:
+      return "race";
+    case Scenario::Chat:
+      return "chat";
+  }
+  return "unknown";
+}
+
+//! Options of the bots.
+struct Options
+{
+  asio::ip::address address{asio::ip::address_v4::loopback()};
+  uint16_t port{10030};
+  std::size_t botCount{10};
+  std::string prefix{"bot"};
+  //! Weights of the scenarios, indexed by the scenario.
+  std::array<uint32_t, 3> mix{1, 1, 1};
+  //! Interval between the logins of two bots.
+  std::chrono::milliseconds rampUp{100};
+  std::chrono::seconds duration{60};
+  //! Ranch snapshots sent per second by a bot.
+  double snapshotRate{10.0};
+  //! Race positions sent per second by a bot.
+  double positionRate{20.0};
+  //! Chat messages sent per minute by a bot.
+  double chatRate{6.0};
+  //! Count of the bots sharing a ranch.
+  std::size_t ranchGroupSize{5};
+  //! Count of the bots sharing a race room.
+  std::size_t raceGroupSize{4};
+  //! Path of the JSON report, if any.
+  std::filesystem::path jsonPath;
+};
+
+//! Statistics of the bots.
+struct Statistics
+{
+  std::size_t connectionCount{};
+  std::size_t failedConnectionCount{};
+  std::size_t loggedInBotCount{};
+  std::size_t failedBotCount{};
+  std::size_t bytesSent{};
+  std::size_t bytesReceived{};
+  //! Count of the commands sent, per command.
+  std::map<std::string, std::size_t, std::less<>> sentCommands;
+  //! Count of the cancels and errors received, per command.
+  std::map<std::string, std::size_t, std::less<>> failures;
+  //! Times from a request to its response, per request command.
+  std::map<std::string, std::vector<std::chrono::microseconds>, std::less<>> latencies;
+};
+
+std::string_view GetName(protocol::Command command)
+{
+  return protocol::GetCommandName(command);
+}
+
+std::string_view GetName(protocol::ChatterCommand command)
+{
+  return protocol::GetChatterCommandName(command);
+}
+
+//! A connection of a bot to one of the servers.
+class Connection
+  : public std::enable_shared_from_this<Connection>
+{
+public:
+  enum class Protocol
+  {
+    Command,
+    Chatter
+  };
+
+  //! Called with the ID and the data of a command received from the server.
+  using CommandHandler = std::function<void(uint16_t commandId, std::span<const std::byte> data)>;
+  //! Called when the connection is lost, not when it is closed by `Close`.
+  using CloseHandler = std::function<void()>;
+
+  Connection(asio::io_context& ioContext, Protocol protocol, Statistics& statistics)
+    : _socket(ioContext)
+    , _protocol(protocol)
+    , _statistics(statistics)
+  {
+  }
+
+  void SetCommandHandler(CommandHandler handler)
+  {
+    _commandHandler = std::move(handler);
+  }
+
+  void SetCloseHandler(CloseHandler handler)
+  {
+    _closeHandler = std::move(handler);
+  }
+
+  void Connect(
+    const asio::ip::tcp::endpoint& endpoint,
+    std::function<void(bool)> connectHandler)
+  {
+    _socket.async_connect(
+      endpoint,
+      [self = shared_from_this(), connectHandler = std::move(connectHandler)](
+        const boost::system::error_code& error)
+      {
+        if (error)
+        {
+          ++self->_statistics.failedConnectionCount;
+          connectHandler(false);
+          return;
+        }
+
+        ++self->_statistics.connectionCount;
+        boost::system::error_code optionError;
+        self->_socket.set_option(asio::ip::tcp::no_delay(true), optionError);
+        self->Read();
+        connectHandler(true);
+      });
+  }
+
+  void Close()
+  {
+    _isClosed = true;
+    boost::system::error_code error;
+    _socket.close(error);
+  }
+
+  [[nodiscard]] bool IsClosed() const
+  {
+    return _isClosed;
+  }
+
+  //! Resets the rolling code, the servers reset it on the login and on entering a ranch or a room.
+  void ResetCode()
+  {
+    _client.SetCode({});
+  }
+
+  //! Sends the command.
+  template <typename T>
+  void Send(const T& command)
+  {
+    std::array<std::byte, protocol::BufferSize> buffer{};
+    SinkStream sink(std::span(buffer.data(), buffer.size()));
+    sink.Write(command);
+
+    const auto commandId = static_cast<uint16_t>(T::GetCommand());
+    const std::span commandData(buffer.data(), sink.GetCursor());
+
+    const auto origin = _queuedData.size();
+    if (_protocol == Protocol::Command)
+      _client.WriteClientCommand(commandId, commandData, _queuedData);
+    else
+      protocol::WriteClientChatterCommand(commandId, commandData, _queuedData);
+
+    _statistics.bytesSent += _queuedData.size() - origin;
+    ++_statistics.sentCommands[std::string(GetName(T::GetCommand()))];
+    Write();
+  }
+
+  //! Sends the command and measures the time until any of the response commands is received.
+  template <typename... Responses, typename T>
+  void Request(const T& command)
+  {
+    _pendingRequests.emplace_back(PendingRequest{
+      .name = std::string(GetName(T::GetCommand())),
+      .responseIds = {static_cast<uint16_t>(Responses::GetCommand())...},
+      .sendTime = Clock::now()});
+    Send(command);
+  }
+
+private:
+  struct PendingRequest
+  {
+    std::string name;
+    std::vector<uint16_t> responseIds;
+    Clock::time_point sendTime;
+  };
+
+  void Write()
+  {
+    if (_isWriting || _queuedData.empty() || _isClosed)
+      return;
+
+    _isWriting = true;
+    std::swap(_writtenData, _queuedData);
+    _queuedData.clear();
+
+    asio::async_write(
+      _socket,
+      asio::buffer(_writtenData),
+      [self = shared_from_this()](const boost::system::error_code& error, std::size_t)
+      {
+        self->_isWriting = false;
+        if (error)
+          return;
+
+        self->Write();
+      });
+  }
+
+  void Read()
+  {
+    _socket.async_read_some(
+      asio::buffer(_readBuffer),
+      [self = shared_from_this()](const boost::system::error_code& error, std::size_t size)
+      {
+        if (error)
+        {
+          self->Lose();
+          return;
+        }
+
+        self->_statistics.bytesReceived += size;
+        self->_receivedData.insert(
+          self->_receivedData.end(),
+          self->_readBuffer.begin(),
+          self->_readBuffer.begin() + size);
+
+        try
+        {
+          self->ProcessReceivedData();
+        }
+        catch (const std::exception& x)
+        {
+          ++self->_statistics.failures[std::format("malformed data: {}", x.what())];
+          self->Lose();
+          return;
+        }
+
+        self->Read();
+      });
+  }
+
+  //! Closes the connection lost to the server or to malformed data.
+  void Lose()
+  {
+    if (_isClosed)
+      return;
+
+    Close();
+    if (_closeHandler)
+      _closeHandler();
+  }
+
+  //! Dispatches the commands buffered whole.
+  void ProcessReceivedData()
+  {
+    std::size_t cursor = 0;
+    while (not _isClosed)
+    {
+      const std::span data(_receivedData.data() + cursor, _receivedData.size() - cursor);
+
+      uint16_t commandId{};
+      std::size_t headerSize{};
+      std::size_t commandSize{};
+
+      if (_protocol == Protocol::Command)
+      {
+        // The server does not scramble the command data, only the magic is encoded.
+        uint32_t magicValue{};
+        if (data.size() < sizeof(magicValue))
+          break;
+        std::memcpy(&magicValue, data.data(), sizeof(magicValue));
+
+        const auto magic = protocol::decode_message_magic(magicValue);
+        if (magic.length < sizeof(magicValue))
+          throw std::runtime_error("bad command length");
+
+        commandId = magic.id;
+        headerSize = sizeof(magicValue);
+        commandSize = magic.length;
+      }
+      else
+      {
+        // The server scrambles the whole command, including the header.
+        std::array<std::byte, sizeof(protocol::ChatterCommandHeader)> header{};
+        if (data.size() < header.size())
+          break;
+        util::XorWithKey(protocol::ChatterXorCode, data.first(header.size()), header);
+
+        protocol::ChatterCommandHeader decodedHeader{};
+        std::memcpy(&decodedHeader.length, header.data(), sizeof(decodedHeader.length));
+        std::memcpy(
+          &decodedHeader.commandId,
+          header.data() + sizeof(decodedHeader.length),
+          sizeof(decodedHeader.commandId));
+        if (decodedHeader.length < header.size())
+          throw std::runtime_error("bad chatter command length");
+
+        commandId = decodedHeader.commandId;
+        headerSize = header.size();
+        commandSize = decodedHeader.length;
+      }
+
+      if (data.size() < commandSize)
+        break;
+
+      const auto commandData = data.subspan(headerSize, commandSize - headerSize);
+      if (_protocol == Protocol::Chatter)
+        util::XorWithKey(protocol::ChatterXorCode, commandData, headerSize);
+
+      cursor += commandSize;
+      HandleCommand(commandId, commandData);
+    }
+
+    _receivedData.erase(_receivedData.begin(), _receivedData.begin() + cursor);
+  }
+
+  void HandleCommand(uint16_t commandId, std::span<const std::byte> commandData)
+  {
+    const auto requestIter = std::ranges::find_if(
+      _pendingRequests,
+      [commandId](const PendingRequest& request)
+      {
+        return std::ranges::find(request.responseIds, commandId) != request.responseIds.cend();
+      });
+
+    if (requestIter != _pendingRequests.cend())
+    {
+      _statistics.latencies[requestIter->name].emplace_back(
+        std::chrono::duration_cast<std::chrono::microseconds>(
+          Clock::now() - requestIter->sendTime));
+      _pendingRequests.erase(requestIter);
+    }
+
+    if (_commandHandler)
+      _commandHandler(commandId, commandData);
+  }
+
+  asio::ip::tcp::socket _socket;
+  Protocol _protocol;
+  Statistics& _statistics;
+  CommandHandler _commandHandler;
+  CloseHandler _closeHandler;
+
+  //! Rolling XOR code of the command protocol.
+  CommandClient _client;
+  std::deque<PendingRequest> _pendingRequests;
+
+  //! Data queued for writing after the current write.
+  std::vector<std::byte> _queuedData;
+  //! Data being written.
+  std::vector<std::byte> _writtenData;
+  bool _isWriting{false};
+  bool _isClosed{false};
+
+  std::vector<std::byte> _receivedData;
+  std::array<std::byte, 16 * 1024> _readBuffer{};
+};
+
+//! Returns whether the command data are of the response command.
+template <typename T>
+bool Is(uint16_t commandId)
+{
+  return commandId == static_cast<uint16_t>(T::GetCommand());
+}
+
+//! Reads the response command from the command data.
+template <typename T>
+T ReadCommand(std::span<const std::byte> commandData)
+{
+  T command{};
+  SourceStream source(commandData);
+  source.Read(command);
+  return command;
+}
+
+class Bot;
+
+//! Bots sharing a ranch or a room.
+struct Group
+{
+  //! Bot hosting the ranch or the room, the first bot of the group.
+  Bot* host{};
+  //! Bots waiting for the host to be ready.
+  std::vector<Bot*> waitingBots;
+  //! UID of the character of the host.
+  std::optional<uint32_t> hostCharacterUid;
+  //! UID of the room hosted.
+  std::optional<uint32_t> roomUid;
+  //! Count of the guests that readied up in the room.
+  std::size_t readyGuestCount{};
+  //! Count of the guests that failed to enter the room.
+  std::size_t failedGuestCount{};
+  //! Count of the guests of the group.
+  std::size_t guestCount{};
+};
+
+//! A bot playing a scenario.
+class Bot
+  : public std::enable_shared_from_this<Bot>
+{
+public:
+  Bot(
+    asio::io_context& ioContext,
+    const Options& options,
+    Statistics& statistics,
+    std::size_t index,
+    Scenario scenario,
+    std::shared_ptr<Group> group)
+    : _ioContext(ioContext)
+    , _options(options)
+    , _statistics(statistics)
+    , _scenario(scenario)
+    , _group(std::move(group))
+    , _name(std::format("{}{}", options.prefix, index))
+    , _heartbeatTimer(ioContext)
+    , _activityTimer(ioContext)
+    , _chatTimer(ioContext)
+  {
+  }
+
+  void Start()
+  {
+    _lobby = CreateConnection(
+      Connection::Protocol::Command, "lobby", &Bot::HandleLobbyCommand);
+
+    _lobby->Connect(
+      {_options.address, _options.port},
+      [self = shared_from_this()](bool isConnected)
+      {
+        if (not isConnected)
+        {
+          self->Fail("lobby connect");
+          return;
+        }
+
+        self->_lobby->Request<
+          protocol::LobbyCommandLoginOK,
+          protocol::AcCmdCLLoginCancel,
+          protocol::LobbyCommandCreateNicknameNotify>(
+          protocol::AcCmdCLLogin{
+            .constant0 = GameVersionConstant0,
+            .constant1 = GameVersionConstant1,
+            .loginId = self->_name,
+            .authKey = self->_name});
+      });
+  }
+
+  //! Leaves the ranch or the room, the connections are closed by `Close`.
+  void Stop()
+  {
+    _isStopped = true;
+    _activityTimer.cancel();
+    _chatTimer.cancel();
+
+    if (_ranch && not _ranch->IsClosed())
+    {
+      _ranch->Request<protocol::AcCmdCRLeaveRanchOK>(protocol::AcCmdCRLeaveRanch{});
+    }
+    if (_race && not _race->IsClosed())
+    {
+      _race->Request<protocol::AcCmdCRLeaveRoomOK>(protocol::AcCmdCRLeaveRoom{});
+    }
+  }
+
+  void Close()
+  {
+    _heartbeatTimer.cancel();
+    for (const auto& connection : {_lobby, _ranch, _race, _messenger, _allChat})
+    {
+      if (connection)
+        connection->Close();
+    }
+  }
+
+  //! Called by the host of the group once the ranch or the room is ready for the guests.
+  void OnHostReady()
+  {
+    if (_isStopped)
+      return;
+
+    if (_scenario == Scenario::Ranch)
+      EnterRanch(*_group->hostCharacterUid);
+    else if (_scenario == Scenario::Race)
+      EnterRoom(*_group->roomUid);
+  }
+
+  //! Called by a guest of the group once it readied up or failed to enter the room.
+  void OnGuestUpdated()
+  {
+    if (_isRaceStarted || not _race)
+      return;
+
+    // Start the race once all the guests which did not fail are ready.
+    if (_group->readyGuestCount + _group->failedGuestCount >= _group->guestCount)
+      StartRace();
+  }
+
+private:
+  //! Creates the connection to the server, a connection lost before the bot stopped fails the bot.
+  std::shared_ptr<Connection> CreateConnection(
+    Connection::Protocol protocol,
+    std::string_view serverName,
+    void (Bot::*commandHandler)(uint16_t, std::span<const std::byte>))
+  {
+    const auto connection = std::make_shared<Connection>(_ioContext, protocol, _statistics);
+    connection->SetCommandHandler(
+      [weak = weak_from_this(), commandHandler](uint16_t commandId, std::span<const std::byte> data)
+      {
+        if (const auto self = weak.lock())
+          (self.get()->*commandHandler)(commandId, data);
+      });
+    connection->SetCloseHandler(
+      [weak = weak_from_this(), serverName = std::string(serverName)]()
+      {
+        if (const auto self = weak.lock(); self && not self->_isStopped)
+          self->Fail(std::format("{} connection lost", serverName));
+      });
+    return connection;
+  }
+
+  [[nodiscard]] bool IsHost() const
+  {
+    return _group && _group->host == this;
+  }
+
+  void Fail(std::string_view reason)
+  {
+    ++_statistics.failures[std::string(reason)];
+    if (not _hasFailed)
+    {
+      _hasFailed = true;
+      ++_statistics.failedBotCount;
+    }
+
+    // The guests would never hear from a failed host.
+    if (IsHost())
+    {
+      _group->waitingBots.clear();
+    }
+    else if (_scenario == Scenario::Race && _group && not _isReady)
+    {
+      ++_group->failedGuestCount;
+      _group->host->OnGuestUpdated();
+    }
+
+    Close();
+  }
+
+  void HandleLobbyCommand(uint16_t commandId, std::span<const std::byte> data)
+  {
+    if (Is<protocol::LobbyCommandCreateNicknameNotify>(commandId))
+    {
+      _lobby->Request<protocol::LobbyCommandLoginOK, protocol::AcCmdCLCreateNicknameCancel>(
+        protocol::AcCmdCLCreateNickname{
+          .nickname = _name,
+          .requestedHorseTid = DefaultHorseTid});
+    }
+    else if (Is<protocol::LobbyCommandLoginOK>(commandId))
+    {
+      // The full response is not readable, the character UID follows the lobby time
+      // and the first member.
+      SourceStream source(data);
+      protocol::LobbyCommandLoginOK response{};
+      source.Read(response.lobbyTime.dwLowDateTime)
+        .Read(response.lobbyTime.dwHighDateTime)
+        .Read(response.member0)
+        .Read(response.uid);
+
+      _characterUid = response.uid;
+      _lobby->ResetCode();
+      ++_statistics.loggedInBotCount;
+
+      ScheduleHeartbeat();
+      Play();
+    }
+    else if (Is<protocol::AcCmdCLLoginCancel>(commandId))
+    {
+      Fail("AcCmdCLLoginCancel");
+    }
+    else if (Is<protocol::AcCmdCLCreateNicknameCancel>(commandId))
+    {
+      Fail("AcCmdCLCreateNicknameCancel");
+    }
+    else if (Is<protocol::AcCmdCLEnterRanchOK>(commandId))
+    {
+      const auto response = ReadCommand<protocol::AcCmdCLEnterRanchOK>(data);
+      ConnectRanch(response);
+    }
+    else if (Is<protocol::AcCmdCLEnterRanchCancel>(commandId))
+    {
+      // The ranch of the host may be locked, fall back to the own ranch.
+      if (_characterUid != _ranchRancherUid)
+      {
+        ++_statistics.failures["AcCmdCLEnterRanchCancel"];
+        EnterRanch(_characterUid);
+        return;
+      }
+      Fail("AcCmdCLEnterRanchCancel");
+    }
+    else if (Is<protocol::AcCmdCLMakeRoomOK>(commandId))
+    {
+      const auto response = ReadCommand<protocol::AcCmdCLMakeRoomOK>(data);
+      ConnectRace(
+        response.roomUid,
+        response.oneTimePassword,
+        {asio::ip::address_v4(response.raceServerAddress), response.raceServerPort});
+    }
+    else if (Is<protocol::AcCmdCLMakeRoomCancel>(commandId))
+    {
+      Fail("AcCmdCLMakeRoomCancel");
+    }
+    else if (Is<protocol::AcCmdCLEnterRoomOK>(commandId))
+    {
+      const auto response = ReadCommand<protocol::AcCmdCLEnterRoomOK>(data);
+      ConnectRace(
+        response.roomUid,
+        response.oneTimePassword,
+        {asio::ip::address_v4(response.raceServerAddress), response.raceServerPort});
+    }
+    else if (Is<protocol::AcCmdCLEnterRoomCancel>(commandId))
+    {
+      Fail("AcCmdCLEnterRoomCancel");
+    }
+    else if (Is<protocol::AcCmdCLGetMessengerInfoOK>(commandId))
+    {
+      const auto response = ReadCommand<protocol::AcCmdCLGetMessengerInfoOK>(data);
+      // The address is sent in the network byte order.
+      ConnectMessenger(
+        response.code,
+        {asio::ip::address_v4(ntohl(response.ip)), response.port});
+    }
+    else if (Is<protocol::AcCmdCLGetMessengerInfoCancel>(commandId))
+    {
+      Fail("AcCmdCLGetMessengerInfoCancel");
+    }
+  }
+
+  void ScheduleHeartbeat()
+  {
+    _heartbeatTimer.expires_after(HeartbeatInterval);
+    _heartbeatTimer.async_wait(
+      [weak = weak_from_this()](const boost::system::error_code& error)
+      {
+        const auto self = weak.lock();
+        if (error || not self || self->_lobby->IsClosed())
+          return;
+
+        self->_lobby->Send(protocol::AcCmdCLHeartbeat{});
+        self->ScheduleHeartbeat();
+      });
+  }
+
+  void Play()
+  {
+    if (_isStopped)
+      return;
+
+    switch (_scenario)
+    {
+      case Scenario::Ranch:
+      {
+        if (IsHost())
+        {
+          EnterRanch(_characterUid);
+          break;
+        }
+
+        if (_group->hostCharacterUid)
+          EnterRanch(*_group->hostCharacterUid);
+        else
+          _group->waitingBots.emplace_back(this);
+        break;
+      }
+      case Scenario::Race:
+      {
+        if (IsHost())
+        {
+          protocol::AcCmdCLMakeRoom makeRoom{};
+          makeRoom.name = std::format("{} room", _name);
+          makeRoom.playerCount = static_cast<uint8_t>(_group->guestCount + 1);
+          makeRoom.gameMode = protocol::GameMode::Speed;
+          makeRoom.teamMode = protocol::TeamMode::FFA;
+          makeRoom.missionId = 0;
+          makeRoom.unk3 = 0;
+          makeRoom.bitset = {};
+          makeRoom.unk4 = 0;
+
+          _lobby->Request<protocol::AcCmdCLMakeRoomOK, protocol::AcCmdCLMakeRoomCancel>(
+            makeRoom);
+          break;
+        }
+
+        if (_group->roomUid)
+          EnterRoom(*_group->roomUid);
+        else
+          _group->waitingBots.emplace_back(this);
+        break;
+      }
+      case Scenario::Chat:
+      {
+        _lobby->Request<
+          protocol::AcCmdCLGetMessengerInfoOK,
+          protocol::AcCmdCLGetMessengerInfoCancel>(
+          protocol::AcCmdCLGetMessengerInfo{});
+        break;
+      }
+    }
+  }
+
+  //! Notifies the guests waiting for the host.
+  void NotifyWaitingBots()
+  {
+    const auto waitingBots = std::move(_group->waitingBots);
+    _group->waitingBots.clear();
+    for (const auto& bot : waitingBots)
+      bot->OnHostReady();
+  }
+
+  void ScheduleChat(std::function<void()> sendChat)
+  {
+    if (_options.chatRate <= 0.0)
+      return;
+
+    _chatTimer.expires_after(std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<double>(60.0 / _options.chatRate)));
+    _chatTimer.async_wait(
+      [weak = weak_from_this(), sendChat = std::move(sendChat)](
+        const boost::system::error_code& error)
+      {
+        const auto self = weak.lock();
+        if (error || not self || self->_isStopped)
+          return;
+
+        sendChat();
+        self->ScheduleChat(sendChat);
+      });
+  }
+
+  //! Schedules the activity at the rate, the activity returns `false` to stop.
+  void ScheduleActivity(double rate, std::function<bool()> activity)
+  {
+    if (rate <= 0.0)
+      return;
+
+    _activityTimer.expires_after(std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<double>(1.0 / rate)));
+    _activityTimer.async_wait(
+      [weak = weak_from_this(), rate, activity = std::move(activity)](
+        const boost::system::error_code& error)
+      {
+        const auto self = weak.lock();
+        if (error || not self || self->_isStopped)
+          return;
+
+        if (activity())
+          self->ScheduleActivity(rate, activity);
+      });
+  }
+
+  [[nodiscard]] std::string MakeChatMessage()
+  {
+    return std::format("{} message {}", _name, _chatSequence++);
+  }
+
+  // Ranch
+
+  void EnterRanch(uint32_t rancherUid)
+  {
+    _ranchRancherUid = rancherUid;
+    _lobby->Request<protocol::AcCmdCLEnterRanchOK, protocol::AcCmdCLEnterRanchCancel>(
+      protocol::AcCmdCLEnterRanch{
+        .rancherUid = rancherUid,
+        .unk1 = {},
+        .unk2 = 0});
+  }
+
+  void ConnectRanch(const protocol::AcCmdCLEnterRanchOK& response)
+  {
+    _ranch = CreateConnection(
+      Connection::Protocol::Command, "ranch", &Bot::HandleRanchCommand);
+
+    _ranch->Connect(
+      {asio::ip::address_v4(response.ranchAddress), response.ranchPort},
+      [self = shared_from_this(), response](bool isConnected)
+      {
+        if (not isConnected)
+        {
+          self->Fail("ranch connect");
+          return;
+        }
+
+        self->_ranch->Request<
+          protocol::AcCmdCREnterRanchOK,
+          protocol::RanchCommandEnterRanchCancel>(
+          protocol::AcCmdCREnterRanch{
+            .characterUid = self->_characterUid,
+            .otp = response.otp,
+            .rancherUid = response.rancherUid});
+      });
+  }
+
+  void HandleRanchCommand(uint16_t commandId, std::span<const std::byte> data)
+  {
+    if (Is<protocol::AcCmdCREnterRanchOK>(commandId))
+    {
+      const auto response = ReadCommand<protocol::AcCmdCREnterRanchOK>(data);
+      _ranch->ResetCode();
+
+      const auto characterIter = std::ranges::find_if(
+        response.characters,
+        [this](const protocol::RanchCharacter& character)
+        {
+          return character.uid == _characterUid;
+        });
+      if (characterIter == response.characters.cend())
+      {
+        Fail("ranch character missing");
+        return;
+      }
+
+      _ranchIndex = characterIter->oid;
+
+      if (IsHost())
+      {
+        _group->hostCharacterUid = _characterUid;
+        NotifyWaitingBots();
+      }
+
+      ScheduleActivity(
+        _options.snapshotRate,
+        [this]()
+        {
+          SendRanchSnapshot();
+          return true;
+        });
+      ScheduleChat(
+        [this]()
+        {
+          protocol::AcCmdCRRanchChat chat{};
+          chat.message = MakeChatMessage();
+          _ranch->Send(chat);
+        });
+    }
+    else if (Is<protocol::RanchCommandEnterRanchCancel>(commandId))
+    {
+      Fail("RanchCommandEnterRanchCancel");
+    }
+  }
+
+  void SendRanchSnapshot()
+  {
+    const auto time = static_cast<uint32_t>(_snapshotSequence++);
+    protocol::AcCmdCRRanchSnapshot snapshot{};
+
+    // Mostly partial snapshots, as the client sends while moving.
+    if (time % 10 == 0)
+    {
+      snapshot.type = protocol::AcCmdCRRanchSnapshot::Full;
+      snapshot.full = {
+        .ranchIndex = _ranchIndex,
+        .time = time,
+        .velocityX = 1.0f};
+    }
+    else
+    {
+      snapshot.type = protocol::AcCmdCRRanchSnapshot::Partial;
+      snapshot.partial = {
+        .ranchIndex = _ranchIndex,
+        .time = time};
+    }
+
+    _ranch->Send(snapshot);
+  }
+
+  // Race
+
+  void EnterRoom(uint32_t roomUid)
+  {
+    _lobby->Request<protocol::AcCmdCLEnterRoomOK, protocol::AcCmdCLEnterRoomCancel>(
+      protocol::AcCmdCLEnterRoom{
+        .roomUid = roomUid,
+        .password = {},
+        .member3 = 0});
+  }
+
+  void ConnectRace(
+    uint32_t roomUid,
+    uint32_t oneTimePassword,
+    const asio::ip::tcp::endpoint& endpoint)
+  {
+    _race = CreateConnection(
+      Connection::Protocol::Command, "race", &Bot::HandleRaceCommand);
+
+    _roomUid = roomUid;
+    _race->Connect(
+      endpoint,
+      [self = shared_from_this(), oneTimePassword](bool isConnected)
+      {
+        if (not isConnected)
+        {
+          self->Fail("race connect");
+          return;
+        }
+
+        self->_race->Request<
+          protocol::AcCmdCREnterRoomOK,
+          protocol::AcCmdCREnterRoomCancel>(
+          protocol::AcCmdCREnterRoom{
+            .characterUid = self->_characterUid,
+            .oneTimePassword = oneTimePassword,
+            .roomUid = self->_roomUid});
+      });
+  }
+
+  void StartRace()
+  {
+    if (_isStopped || _isRaceStarted)
+      return;
+
+    _race->Request<protocol::AcCmdCRStartRaceNotify, protocol::AcCmdCRStartRaceCancel>(
+      protocol::AcCmdCRStartRace{});
+  }
+
+  void HandleRaceCommand(uint16_t commandId, std::span<const std::byte> data)
+  {
+    if (Is<protocol::AcCmdCREnterRoomOK>(commandId))
+    {
+      _race->ResetCode();
+
+      if (IsHost())
+      {
+        // The guests enter the room once the master is in it.
+        _group->roomUid = _roomUid;
+        NotifyWaitingBots();
+        OnGuestUpdated();
+        return;
+      }
+
+      _race->Send(protocol::AcCmdCRReadyRace{});
+      _isReady = true;
+      ++_group->readyGuestCount;
+      _group->host->OnGuestUpdated();
+    }
+    else if (Is<protocol::AcCmdCREnterRoomCancel>(commandId))
+    {
+      Fail("AcCmdCREnterRoomCancel");
+    }
+    else if (Is<protocol::AcCmdCRStartRaceCancel>(commandId))
+    {
+      // Some guests are not ready yet, try again later.
+      ++_statistics.failures["AcCmdCRStartRaceCancel"];
+      _activityTimer.expires_after(StartRaceInterval);
+      _activityTimer.async_wait(
+        [weak = weak_from_this()](const boost::system::error_code& error)
+        {
+          if (const auto self = weak.lock(); self && not error)
+            self->StartRace();
+        });
+    }
+    else if (Is<protocol::AcCmdCRStartRaceNotify>(commandId))
+    {
+      _isRaceStarted = true;
+
+      // The full notify is not readable, the racers follow the race settings.
+      SourceStream source(data);
+      protocol::AcCmdCRStartRaceNotify notify{};
+      source.Read(notify.raceGameMode)
+        .Read(notify.raceTeamMode)
+        .Read(notify.hostOid)
+        .Read(notify.member4)
+        .Read(notify.raceMapBlockId);
+
+      uint8_t racerCount{};
+      source.Read(racerCount);
+      for (uint8_t racerIdx = 0; racerIdx < racerCount; ++racerIdx)
+      {
+        protocol::AcCmdCRStartRaceNotify::Player racer{};
+        source.Read(racer.oid)
+          .Read(racer.name)
+          .Read(racer.unk2)
+          .Read(racer.unk3)
+          .Read(racer.p2dId)
+          .Read(racer.teamColor)
+          .Read(racer.unk6)
+          .Read(racer.unk7);
+
+        if (racer.name == _name)
+          _raceOid = racer.oid;
+      }
+
+      if (not _raceOid)
+      {
+        Fail("racer missing");
+        return;
+      }
+
+      _race->Send(protocol::AcCmdCRLoadingComplete{});
+
+      ScheduleActivity(
+        _options.positionRate,
+        [this]()
+        {
+          SendRacePosition();
+          return true;
+        });
+      ScheduleChat(
+        [this]()
+        {
+          protocol::AcCmdCRChat chat{};
+          chat.message = MakeChatMessage();
+          _race->Send(chat);
+        });
+    }
+  }
+
+  void SendRacePosition()
+  {
+    const auto step = static_cast<float>(_positionSequence++);
+    _race->Send(protocol::AcCmdUserRaceUpdatePos{
+      .oid = *_raceOid,
+      .member2 = {step, 0.0f, std::sin(step / 10.0f)},
+      .member3 = {1.0f, 0.0f, 0.0f},
+      .member4 = 10.0f});
+  }
+
+  // Chat
+
+  void ConnectMessenger(uint32_t code, const asio::ip::tcp::endpoint& endpoint)
+  {
+    _messenger = CreateConnection(
+      Connection::Protocol::Chatter, "messenger", &Bot::HandleMessengerCommand);
+
+    _messenger->Connect(
+      endpoint,
+      [self = shared_from_this(), code](bool isConnected)
+      {
+        if (not isConnected)
+        {
+          self->Fail("messenger connect");
+          return;
+        }
+
+        self->_messenger->Request<
+          protocol::ChatCmdLoginAckOK,
+          protocol::ChatCmdLoginAckCancel>(
+          protocol::ChatCmdLogin{
+            .characterUid = self->_characterUid,
+            .name = self->_name,
+            .code = code});
+      });
+  }
+
+  void HandleMessengerCommand(uint16_t commandId, std::span<const std::byte> data)
+  {
+    if (Is<protocol::ChatCmdLoginAckOK>(commandId))
+    {
+      _messenger->Request<protocol::ChatCmdChannelInfoAckOk>(
+        protocol::ChatCmdChannelInfo{});
+    }
+    else if (Is<protocol::ChatCmdLoginAckCancel>(commandId))
+    {
+      Fail("ChatCmdLoginAckCancel");
+    }
+    else if (Is<protocol::ChatCmdChannelInfoAckOk>(commandId))
+    {
+      const auto response = ReadCommand<protocol::ChatCmdChannelInfoAckOk>(data);
+
+      boost::system::error_code error;
+      const auto address = asio::ip::make_address(response.hostname, error);
+      if (error)
+      {
+        Fail("all chat address");
+        return;
+      }
+
+      ConnectAllChat(response.code, {address, response.port});
+    }
+  }
+
+  void ConnectAllChat(uint32_t code, const asio::ip::tcp::endpoint& endpoint)
+  {
+    _allChat = CreateConnection(
+      Connection::Protocol::Chatter, "all chat", &Bot::HandleAllChatCommand);
+
+    _allChat->Connect(
+      endpoint,
+      [self = shared_from_this(), code](bool isConnected)
+      {
+        if (not isConnected)
+        {
+          self->Fail("all chat connect");
+          return;
+        }
+
+        self->_allChat->Request<
+          protocol::ChatCmdEnterRoomAckOk,
+          protocol::ChatCmdEnterRoomAckCancel>(
+          protocol::ChatCmdEnterRoom{
+            .code = code,
+            .characterUid = self->_characterUid,
+            .characterName = self->_name});
+      });
+  }
+
+  void HandleAllChatCommand(uint16_t commandId, std::span<const std::byte> data)
+  {
+    if (Is<protocol::ChatCmdEnterRoomAckOk>(commandId))
+    {
+      ScheduleChat(
+        [this]()
+        {
+          const auto message = MakeChatMessage();
+          _pendingChats.emplace_back(message, Clock::now());
+          protocol::ChatCmdChat chat{};
+          chat.message = message;
+          _allChat->Send(chat);
+        });
+    }
+    else if (Is<protocol::ChatCmdEnterRoomAckCancel>(commandId))
+    {
+      Fail("ChatCmdEnterRoomAckCancel");
+    }
+    else if (Is<protocol::ChatCmdChannelChatTrs>(commandId))
+    {
+      // The chat is broadcast to everyone, including the author.
+      const auto notify = ReadCommand<protocol::ChatCmdChannelChatTrs>(data);
+      const auto chatIter = std::ranges::find_if(
+        _pendingChats,
+        [&notify](const auto& pendingChat)
+        {
+          return pendingChat.first == notify.message;
+        });
+      if (chatIter == _pendingChats.cend())
+        return;
+
+      _statistics.latencies[std::string(GetName(protocol::ChatterCommand::ChatCmdChat))].emplace_back(
+        std::chrono::duration_cast<std::chrono::microseconds>(
+          Clock::now() - chatIter->second));
+      _pendingChats.erase(_pendingChats.begin(), chatIter + 1);
+    }
+  }
+
+  asio::io_context& _ioContext;
+  const Options& _options;
+  Statistics& _statistics;
+  Scenario _scenario;
+  std::shared_ptr<Group> _group;
+  std::string _name;
+
+  asio::steady_timer _heartbeatTimer;
+  //! Timer of the snapshots, the positions or the start race attempts.
+  asio::steady_timer _activityTimer;
+  asio::steady_timer _chatTimer;
+
+  std::shared_ptr<Connection> _lobby;
+  std::shared_ptr<Connection> _ranch;
+  std::shared_ptr<Connection> _race;
+  std::shared_ptr<Connection> _messenger;
+  std::shared_ptr<Connection> _allChat;
+
+  bool _hasFailed{false};
+  bool _isStopped{false};
+  uint32_t _characterUid{};
+  std::size_t _chatSequence{};
+
+  uint32_t _ranchRancherUid{};
+  uint16_t _ranchIndex{};
+  std::size_t _snapshotSequence{};
+
+  uint32_t _roomUid{};
+  bool _isReady{false};
+  bool _isRaceStarted{false};
+  std::optional<uint16_t> _raceOid;
+  std::size_t _positionSequence{};
+
+  //! Chat messages not broadcast back yet.
+  std::deque<std::pair<std::string, Clock::time_point>> _pendingChats;
+};
+
+//! Assigns the scenarios to the bots in proportion to the weights,
+//! interleaving the scenarios.
+std::vector<Scenario> AssignScenarios(const Options& options)
+{
+  std::vector<Scenario> scenarios;
+  std::array<std::size_t, 3> assignedCounts{};
+
+  for (std::size_t botIdx = 0; botIdx < options.botCount; ++botIdx)
+  {
+    // Pick the scenario furthest behind its share.
+    std::optional<std::size_t> picked;
+    for (std::size_t scenarioIdx = 0; scenarioIdx < options.mix.size(); ++scenarioIdx)
+    {
+      if (options.mix[scenarioIdx] == 0)
+        continue;
+
+      const auto share = static_cast<double>(assignedCounts[scenarioIdx]) / options.mix[scenarioIdx];
+      if (not picked
+        || share < static_cast<double>(assignedCounts[*picked]) / options.mix[*picked])
+      {
+        picked = scenarioIdx;
+      }
+    }
+
+    ++assignedCounts[*picked];
+    scenarios.emplace_back(static_cast<Scenario>(*picked));
+  }
+
+  return scenarios;
+}
+
+//! Returns the percentile of the sorted latencies.
+std::chrono::microseconds GetPercentile(
+  const std::vector<std::chrono::microseconds>& sortedLatencies,
+  double percentile)
+{
+  if (sortedLatencies.empty())
+    return {};
+
+  const auto idx = static_cast<std::size_t>(
+    percentile / 100.0 * static_cast<double>(sortedLatencies.size() - 1));
+  return sortedLatencies[idx];
+}
+
+bool ParseMix(std::string_view value, Options& options)
+{
+  options.mix = {};
+  for (const auto entry : std::views::split(value, ','))
+  {
+    const std::string_view pair(entry.begin(), entry.end());
+    const auto separator = pair.find('=');
+    if (separator == std::string_view::npos)
+      return false;
+
+    const auto name = pair.substr(0, separator);
+    const auto weight = static_cast<uint32_t>(std::stoul(std::string(pair.substr(separator + 1))));
+
+    bool isKnown = false;
+    for (const auto scenario : {Scenario::Ranch, Scenario::Race, Scenario::Chat})
+    {
+      if (GetScenarioName(scenario) != name)
+        continue;
+      options.mix[static_cast<std::size_t>(scenario)] = weight;
+      isKnown = true;
+    }
+
+    if (not isKnown)
+      return false;
+  }
+
+  return std::ranges::any_of(options.mix, [](uint32_t weight) { return weight > 0; });
+}
+
+bool ParseOptions(int argc, char** argv, Options& options)
+{
+  for (int argIdx = 1; argIdx < argc; ++argIdx)
+  {
+    const std::string_view arg = argv[argIdx];
+    if (argIdx + 1 >= argc)
+      return false;
+    const std::string value = argv[++argIdx];
+
+    if (arg == "--address")
+      options.address = asio::ip::make_address(value);
+    else if (arg == "--port")
+      options.port = static_cast<uint16_t>(std::stoul(value));
+    else if (arg == "--bots")
+      options.botCount = std::stoul(value);
+    else if (arg == "--prefix")
+      options.prefix = value;
+    else if (arg == "--mix")
+    {
+      if (not ParseMix(value, options))
+        return false;
+    }
+    else if (arg == "--ramp-up-ms")
+      options.rampUp = std::chrono::milliseconds(std::stoul(value));
+    else if (arg == "--duration-s")
+      options.duration = std::chrono::seconds(std::stoul(value));
+    else if (arg == "--snapshot-hz")
+      options.snapshotRate = std::stod(value);
+    else if (arg == "--position-hz")
+      options.positionRate = std::stod(value);
+    else if (arg == "--chat-per-min")
+      options.chatRate = std::stod(value);
+    else if (arg == "--ranch-group")
+      options.ranchGroupSize = std::max(std::stoul(value), 1ul);
+    else if (arg == "--race-group")
+      options.raceGroupSize = std::clamp(std::stoul(value), 1ul, 8ul);
+    else if (arg == "--json")
+      options.jsonPath = value;
+    else
+      return false;
+  }
+
+  return true;
+}
+
+} // anon namespace
+
+int main(int argc, char** argv)
+{
+  Options options;
+
+  try
+  {
+    if (not ParseOptions(argc, argv, options))
+    {
+      std::cerr << "Usage: alicia-bot [--address <address>] [--port <port>] [--bots <count>] [--prefix <name>]\n"
+                   "                  [--mix ranch=<weight>,race=<weight>,chat=<weight>]\n"
+                   "                  [--ramp-up-ms <milliseconds>] [--duration-s <seconds>]\n"
+                   "                  [--snapshot-hz <rate>] [--position-hz <rate>] [--chat-per-min <rate>]\n"
+                   "                  [--ranch-group <size>] [--race-group <size>] [--json <path>]\n";
+      return 2;
+    }
+  }
+  catch (const std::exception& x)
+  {
+    std::cerr << std::format("Invalid argument: {}\n", x.what());
+    return 2;
+  }
+
+  asio::io_context ioContext;
+  Statistics statistics;
+
+  // Create the bots and split them to the groups of their scenario.
+  const auto scenarios = AssignScenarios(options);
+  std::vector<std::shared_ptr<Bot>> bots;
+  std::array<std::size_t, 3> scenarioCounts{};
+  std::array<std::shared_ptr<Group>, 3> currentGroups;
+
+  for (std::size_t botIdx = 0; botIdx < scenarios.size(); ++botIdx)
+  {
+    const auto scenario = scenarios[botIdx];
+    const auto scenarioIdx = static_cast<std::size_t>(scenario);
+    const auto groupSize = scenario == Scenario::Ranch
+      ? options.ranchGroupSize
+      : scenario == Scenario::Race ? options.raceGroupSize : 1;
+
+    auto& group = currentGroups[scenarioIdx];
+    const bool isHost = scenarioCounts[scenarioIdx]++ % groupSize == 0;
+    if (isHost)
+      group = std::make_shared<Group>();
+    else
+      ++group->guestCount;
+
+    auto bot = std::make_shared<Bot>(ioContext, options, statistics, botIdx, scenario, group);
+    if (isHost)
+      group->host = bot.get();
+    bots.emplace_back(std::move(bot));
+  }
+
+  std::cout << std::format(
+    "Running {} bots ({} ranch, {} race, {} chat) against {}:{} for {}s\n",
+    bots.size(),
+    scenarioCounts[static_cast<std::size_t>(Scenario::Ranch)],
+    scenarioCounts[static_cast<std::size_t>(Scenario::Race)],
+    scenarioCounts[static_cast<std::size_t>(Scenario::Chat)],
+    options.address.to_string(),
+    options.port,
+    options.duration.count());
+
+  // Log the bots in one by one.
+  asio::steady_timer rampUpTimer(ioContext);
+  std::size_t startedBotCount = 0;
+  std::function<void()> startNextBot = [&]()
+  {
+    if (startedBotCount == bots.size())
+      return;
+
+    bots[startedBotCount++]->Start();
+    rampUpTimer.expires_after(options.rampUp);
+    rampUpTimer.async_wait([&](const boost::system::error_code& error)
+    {
+      if (not error)
+        startNextBot();
+    });
+  };
+  startNextBot();
+
+  // Stop the bots after the duration and close them after the drain time.
+  const auto beginTime = Clock::now();
+  asio::steady_timer durationTimer(ioContext);
+  durationTimer.expires_after(options.duration);
+  durationTimer.async_wait([&](const boost::system::error_code&)
+  {
+    rampUpTimer.cancel();
+    for (const auto& bot : bots)
+      bot->Stop();
+
+    durationTimer.expires_after(DrainTime);
+    durationTimer.async_wait([&](const boost::system::error_code&)
+    {
+      for (const auto& bot : bots)
+        bot->Close();
+    });
+  });
+
+  ioContext.run();
+  const auto duration = std::chrono::duration<double>(Clock::now() - beginTime - DrainTime).count();
+
+  std::size_t sentCommandCount = 0;
+  for (const auto count : statistics.sentCommands | std::views::values)
+    sentCommandCount += count;
+
+  std::cout << std::format(
+    "Bots: {} logged in, {} failed\n"
+    "Connections: {} ({} failed)\n"
+    "Commands: {} in {:.3f}s ({:.1f} commands/s)\n"
+    "Sent: {} bytes, received: {} bytes\n",
+    statistics.loggedInBotCount,
+    statistics.failedBotCount,
+    statistics.connectionCount,
+    statistics.failedConnectionCount,
+    sentCommandCount,
+    duration,
+    duration > 0.0 ? static_cast<double>(sentCommandCount) / duration : 0.0,
+    statistics.bytesSent,
+    statistics.bytesReceived);
+
+  std::cout << std::format(
+    "{:<32} {:>8} {:>10} {:>10} {:>10} {:>10}\n",
+    "Latency (us)", "samples", "p50", "p90", "p99", "max");
+
+  std::string jsonLatencies;
+  for (auto& [name, latencies] : statistics.latencies)
+  {
+    std::ranges::sort(latencies);
+    const auto p50 = GetPercentile(latencies, 50.0);
+    const auto p90 = GetPercentile(latencies, 90.0);
+    const auto p99 = GetPercentile(latencies, 99.0);
+    const auto max = latencies.empty() ? std::chrono::microseconds{} : latencies.back();
+
+    std::cout << std::format(
+      "{:<32} {:>8} {:>10} {:>10} {:>10} {:>10}\n",
+      name, latencies.size(), p50.count(), p90.count(), p99.count(), max.count());
+
+    jsonLatencies += std::format(
+      "{}\"{}\": {{\"p50\": {}, \"p90\": {}, \"p99\": {}, \"max\": {}, \"samples\": {}}}",
+      jsonLatencies.empty() ? "" : ", ",
+      name, p50.count(), p90.count(), p99.count(), max.count(), latencies.size());
+  }
+
+  std::string jsonFailures;
+  for (const auto& [reason, count] : statistics.failures)
+  {
+    std::cout << std::format("Failure: {} ({}x)\n", reason, count);
+    jsonFailures += std::format(
+      "{}\"{}\": {}", jsonFailures.empty() ? "" : ", ", reason, count);
+  }
+
+  if (not options.jsonPath.empty())
+  {
+    std::ofstream json(options.jsonPath);
+    if (not json)
+    {
+      std::cerr << std::format("Couldn't open '{}' for writing\n", options.jsonPath.string());
+      return 1;
+    }
+
+    json << std::format(
+      "{{\"bots\": {}, \"logged_in_bots\": {}, \"failed_bots\": {}, "
+      "\"connections\": {}, \"failed_connections\": {}, \"commands\": {}, "
+      "\"duration_s\": {:.6f}, \"bytes_sent\": {}, \"bytes_received\": {}, "
+      "\"latency_us\": {{{}}}, \"failures\": {{{}}}}}\n",
+      bots.size(),
+      statistics.loggedInBotCount,
+      statistics.failedBotCount,
+      statistics.connectionCount,
+      statistics.failedConnectionCount,
+      sentCommandCount,
+      duration,
+      statistics.bytesSent,
+      statistics.bytesReceived,
+      jsonLatencies,
+      jsonFailures);
+  }
+
+  return statistics.failedBotCount == 0 ? 0 : 1;
+}
@@ -28,7 +28,8 @@ namespace server
 {
 
 DataDirector::DataDirector(const std::filesystem::path& basePath)
-  : _userStorage(
+  : _scheduler(_wakeup)
+  , _userStorage(
       [&](const auto& key, auto& user)
       {
         try
@@ -602,6 +603,21 @@ DataDirector::DataDirector(const std::filesystem::path& basePath)
         return false;
       })
 {
+  // The storages wake the director up when an operation is queued.
+  _userStorage.SetWakeup(_wakeup);
+  _infractionStorage.SetWakeup(_wakeup);
+  _characterStorage.SetWakeup(_wakeup);
+  _horseStorage.SetWakeup(_wakeup);
+  _itemStorage.SetWakeup(_wakeup);
+  _storageItemStorage.SetWakeup(_wakeup);
+  _eggStorage.SetWakeup(_wakeup);
+  _petStorage.SetWakeup(_wakeup);
+  _guildStorage.SetWakeup(_wakeup);
+  _housingStorage.SetWakeup(_wakeup);
+  _settingsStorage.SetWakeup(_wakeup);
+  _dailyQuestStorage.SetWakeup(_wakeup);
+  _mailStorage.SetWakeup(_wakeup);
+
   _primaryDataSource = std::make_unique<FileDataSource>();
   if (auto* fileDataSource = dynamic_cast<FileDataSource*>(_primaryDataSource.get()))
   {
@@ -679,18 +695,40 @@ void DataDirector::Tick()
   }
 }
 
+Wakeup& DataDirector::GetWakeup()
+{
+  return _wakeup;
+}
+
+std::optional<Scheduler::Clock::time_point> DataDirector::GetNextTickTime()
+{
+  if (HasQueuedStorageOperations())
+    return Scheduler::Clock::now();
+  return _scheduler.GetNextJobTime();
+}
+
 void DataDirector::RequestLoadUserData(
-  const std::string& userName)
+  const std::string& userName,
+  Wakeup* loadWakeup)
 {
   auto& userDataContext = _userDataContext[userName];
 
   // If the user data are being loaded or are already loaded, prevent the user load.
-  if (userDataContext.isBeingLoaded.load(std::memory_order::relaxed) ||
-    userDataContext.isUserDataLoaded.load(std::memory_order::relaxed))
+  if (userDataContext.isBeingLoaded.load(std::memory_order::relaxed))
   {
+    userDataContext.loadWakeup.store(loadWakeup, std::memory_order::release);
     return;
   }
 
+  if (userDataContext.isUserDataLoaded.load(std::memory_order::relaxed))
+  {
+    if (loadWakeup != nullptr)
+      loadWakeup->Signal();
+    return;
+  }
+
+  userDataContext.loadWakeup.store(loadWakeup, std::memory_order::release);
+
   // Indicate that the user data are being loaded and set the timeout.
   userDataContext.isBeingLoaded.store(true, std::memory_order::relaxed);
   userDataContext.timeout = Scheduler::Clock::now() + std::chrono::seconds(10);
@@ -703,17 +741,27 @@ void DataDirector::RequestLoadUserData(
 
 void DataDirector::RequestLoadCharacterData(
   const std::string& userName,
-  data::Uid characterUid)
+  data::Uid characterUid,
+  Wakeup* loadWakeup)
 {
   auto& userDataContext = _userDataContext[userName];
 
   // If the user data are being loaded or are already loaded, prevent the character load.
-  if (userDataContext.isBeingLoaded.load(std::memory_order::relaxed) ||
-    userDataContext.isCharacterDataLoaded.load(std::memory_order::relaxed))
+  if (userDataContext.isBeingLoaded.load(std::memory_order::relaxed))
   {
+    userDataContext.loadWakeup.store(loadWakeup, std::memory_order::release);
     return;
   }
 
+  if (userDataContext.isCharacterDataLoaded.load(std::memory_order::relaxed))
+  {
+    if (loadWakeup != nullptr)
+      loadWakeup->Signal();
+    return;
+  }
+
+  userDataContext.loadWakeup.store(loadWakeup, std::memory_order::release);
+
   // Indicate that the user data are being loaded and set the timeout.
   userDataContext.isBeingLoaded.store(true, std::memory_order::relaxed);
   userDataContext.timeout = Scheduler::Clock::now() + std::chrono::seconds(10);
@@ -1113,6 +1161,34 @@ DataSource& DataDirector::GetDataSource() noexcept
   return *_primaryDataSource;
 }
 
+void DataDirector::FinishLoad(UserDataContext& userDataContext)
+{
+  userDataContext.isBeingLoaded.store(false, std::memory_order::relaxed);
+
+  const auto loadWakeup = userDataContext.loadWakeup.exchange(
+    nullptr,
+    std::memory_order::acq_rel);
+  if (loadWakeup != nullptr)
+    loadWakeup->Signal();
+}
+
+bool DataDirector::HasQueuedStorageOperations() const noexcept
+{
+  return _userStorage.HasQueuedOperations()
+    || _infractionStorage.HasQueuedOperations()
+    || _characterStorage.HasQueuedOperations()
+    || _horseStorage.HasQueuedOperations()
+    || _itemStorage.HasQueuedOperations()
+    || _storageItemStorage.HasQueuedOperations()
+    || _eggStorage.HasQueuedOperations()
+    || _petStorage.HasQueuedOperations()
+    || _guildStorage.HasQueuedOperations()
+    || _housingStorage.HasQueuedOperations()
+    || _settingsStorage.HasQueuedOperations()
+    || _dailyQuestStorage.HasQueuedOperations()
+    || _mailStorage.HasQueuedOperations();
+}
+
 void DataDirector::ScheduleUserLoad(
   UserDataContext& userDataContext,
   const std::string& userName)
@@ -1124,7 +1200,7 @@ void DataDirector::ScheduleUserLoad(
       // If the user is completely loaded we can return.
       if (userDataContext.isUserDataLoaded.load(std::memory_order::relaxed))
       {
-        userDataContext.isBeingLoaded.store(false, std::memory_order::relaxed);
+        FinishLoad(userDataContext);
         return;
       }
 
@@ -1132,7 +1208,7 @@ void DataDirector::ScheduleUserLoad(
       if (Scheduler::Clock::now() > userDataContext.timeout)
       {
         spdlog::warn("Timeout reached loading data for user '{}': {}", userName, userDataContext.debugMessage);
-        userDataContext.isBeingLoaded.store(false, std::memory_order::relaxed);
+        FinishLoad(userDataContext);
         return;
       }
 
@@ -1209,7 +1285,7 @@ void DataDirector::ScheduleCharacterLoad(
       // If the character is completely loaded we can return.
       if (userDataContext.isCharacterDataLoaded.load(std::memory_order::relaxed))
       {
-        userDataContext.isBeingLoaded.store(false, std::memory_order::relaxed);
+        FinishLoad(userDataContext);
         return;
       }
 
@@ -1217,7 +1293,7 @@ void DataDirector::ScheduleCharacterLoad(
       if (Scheduler::Clock::now() > userDataContext.timeout)
       {
         spdlog::warn("Timeout reached loading data for character '{}'", characterUid);
-        userDataContext.isBeingLoaded.store(false, std::memory_order::relaxed);
+        FinishLoad(userDataContext);
         return;
       }
 
@@ -0,0 +1,92 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include "libserver/network/BufferPool.hpp"
+
+namespace server::network
+{
+
+BufferPool::BufferPool(
+  std::size_t maxBufferCount,
+  std::size_t maxBufferCapacity)
+  : _storage(std::make_shared<Storage>())
+{
+  _storage->maxBufferCount = maxBufferCount;
+  _storage->maxBufferCapacity = maxBufferCapacity;
+}
+
+BufferHandle BufferPool::Acquire()
+{
+  std::unique_ptr<Buffer> buffer;
+
+  {
+    std::scoped_lock lock(_storage->mutex);
+    if (not _storage->buffers.empty())
+    {
+      buffer = std::move(_storage->buffers.back());
+      _storage->buffers.pop_back();
+    }
+  }
+
+  if (not buffer)
+    buffer = std::make_unique<Buffer>();
+
+  return BufferHandle(
+    buffer.release(),
+    [storage = _storage](Buffer* buffer)
+    {
+      storage->Release(buffer);
+    });
+}
+
+std::size_t BufferPool::GetIdleBufferCount() const
+{
+  std::scoped_lock lock(_storage->mutex);
+  return _storage->buffers.size();
+}
+
+BufferPool& BufferPool::Global()
+{
+  static BufferPool pool;
+  return pool;
+}
+
+void BufferPool::Storage::Release(Buffer* buffer) noexcept
+{
+  std::unique_ptr<Buffer> ownedBuffer(buffer);
+
+  // Do not retain the buffers which grew too large.
+  if (ownedBuffer->capacity() > maxBufferCapacity)
+    return;
+
+  ownedBuffer->clear();
+
+  try
+  {
+    std::scoped_lock lock(mutex);
+    if (buffers.size() < maxBufferCount)
+      buffers.emplace_back(std::move(ownedBuffer));
+  }
+  catch (const std::exception&)
+  {
+    // The buffer is freed.
+  }
+}
+
+} // namespace server::network
@@ -0,0 +1,224 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include "libserver/network/Capture.hpp"
+
+#include "libserver/util/Stream.hpp"
+
+#include <format>
+#include <stdexcept>
+
+namespace server::network
+{
+
+namespace
+{
+
+//! Size of the capture file header.
+//! Magic, version, protocol, reserved byte, port and the begin time.
+constexpr std::size_t HeaderSize = 4 + 2 + 1 + 1 + 2 + 8;
+
+//! Size of the record header.
+//! Time, client ID, type, reserved byte, command ID and the data size.
+constexpr std::size_t RecordHeaderSize = 8 + 8 + 1 + 1 + 2 + 2;
+
+} // namespace
+
+CaptureWriter::CaptureWriter(
+  const std::filesystem::path& path,
+  CaptureProtocol protocol,
+  uint16_t port)
+  : _file(path, std::ios::binary | std::ios::trunc)
+  , _beginTime(std::chrono::steady_clock::now())
+{
+  if (not _file)
+  {
+    throw std::runtime_error(
+      std::format("Couldn't create the capture file '{}'", path.string()));
+  }
+
+  const auto beginTime = std::chrono::duration_cast<std::chrono::milliseconds>(
+    std::chrono::system_clock::now().time_since_epoch());
+
+  std::array<std::byte, HeaderSize> header{};
+  SinkStream sink(std::span(header.data(), header.size()));
+  sink.Write(std::span(CaptureHeader::Magic))
+    .Write(CaptureHeader::Version)
+    .Write(protocol)
+    .Write(uint8_t{0})
+    .Write(port)
+    .Write(static_cast<int64_t>(beginTime.count()));
+
+  _file.write(reinterpret_cast<const char*>(header.data()), header.size());
+}
+
+void CaptureWriter::WriteConnected(ClientId clientId)
+{
+  Write(CaptureRecord::Type::Connected, clientId, 0, {});
+}
+
+void CaptureWriter::WriteDisconnected(ClientId clientId)
+{
+  Write(CaptureRecord::Type::Disconnected, clientId, 0, {});
+}
+
+void CaptureWriter::WriteCommand(
+  ClientId clientId,
+  uint16_t commandId,
+  std::span<const std::byte> data)
+{
+  Write(CaptureRecord::Type::Command, clientId, commandId, data);
+}
+
+void CaptureWriter::WriteCodeChanged(
+  ClientId clientId,
+  std::span<const std::byte> code)
+{
+  Write(CaptureRecord::Type::CodeChanged, clientId, 0, code);
+}
+
+void CaptureWriter::Flush()
+{
+  std::scoped_lock lock(_mutex);
+  _file.flush();
+}
+
+std::filesystem::path CaptureWriter::MakePath(
+  const std::filesystem::path& directory,
+  uint16_t port)
+{
+  const auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
+    std::chrono::system_clock::now().time_since_epoch());
+  return directory / std::format("{}-{}.capture", port, now.count());
+}
+
+void CaptureWriter::Write(
+  CaptureRecord::Type type,
+  ClientId clientId,
+  uint16_t commandId,
+  std::span<const std::byte> data)
+{
+  std::array<std::byte, RecordHeaderSize> recordHeader{};
+  SinkStream sink(std::span(recordHeader.data(), recordHeader.size()));
+
+  std::scoped_lock lock(_mutex);
+
+  // The time is taken under the lock, so that the records are ordered by their time.
+  const auto time = std::chrono::duration_cast<std::chrono::microseconds>(
+    std::chrono::steady_clock::now() - _beginTime);
+
+  sink.Write(static_cast<uint64_t>(time.count()))
+    .Write(static_cast<uint64_t>(clientId))
+    .Write(type)
+    .Write(uint8_t{0})
+    .Write(commandId)
+    .Write(static_cast<uint16_t>(data.size()));
+
+  _file.write(reinterpret_cast<const char*>(recordHeader.data()), recordHeader.size());
+  _file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+}
+
+CaptureReader::CaptureReader(const std::filesystem::path& path)
+  : _file(path, std::ios::binary)
+{
+  if (not _file)
+  {
+    throw std::runtime_error(
+      std::format("Couldn't open the capture file '{}'", path.string()));
+  }
+
+  std::array<std::byte, HeaderSize> header{};
+  _file.read(reinterpret_cast<char*>(header.data()), header.size());
+  if (_file.gcount() != static_cast<std::streamsize>(header.size()))
+  {
+    throw std::runtime_error(
+      std::format("'{}' is not a capture file: Truncated header", path.string()));
+  }
+
+  std::array<char, 4> magic{};
+  uint16_t version{};
+  uint8_t reserved{};
+  int64_t beginTime{};
+
+  SourceStream source(std::span(header.data(), header.size()));
+  source.Read(std::span(magic))
+    .Read(version)
+    .Read(_header.protocol)
+    .Read(reserved)
+    .Read(_header.port)
+    .Read(beginTime);
+
+  if (magic != CaptureHeader::Magic)
+  {
+    throw std::runtime_error(
+      std::format("'{}' is not a capture file: Bad magic", path.string()));
+  }
+
+  if (version != CaptureHeader::Version)
+  {
+    throw std::runtime_error(
+      std::format("Unsupported version '{}' of the capture file '{}'", version, path.string()));
+  }
+
+  _header.beginTime = std::chrono::system_clock::time_point(
+    std::chrono::milliseconds(beginTime));
+}
+
+const CaptureHeader& CaptureReader::GetHeader() const noexcept
+{
+  return _header;
+}
+
+bool CaptureReader::Read(CaptureRecord& record)
+{
+  std::array<std::byte, RecordHeaderSize> recordHeader{};
+  _file.read(reinterpret_cast<char*>(recordHeader.data()), recordHeader.size());
+
+  // End of the capture.
+  if (_file.gcount() == 0)
+    return false;
+
+  if (_file.gcount() != static_cast<std::streamsize>(recordHeader.size()))
+    throw std::runtime_error("Truncated capture record header");
+
+  uint64_t time{};
+  uint64_t clientId{};
+  uint8_t reserved{};
+  uint16_t dataSize{};
+
+  SourceStream source(std::span(recordHeader.data(), recordHeader.size()));
+  source.Read(time)
+    .Read(clientId)
+    .Read(record.type)
+    .Read(reserved)
+    .Read(record.commandId)
+    .Read(dataSize);
+
+  record.time = std::chrono::microseconds(time);
+  record.clientId = static_cast<ClientId>(clientId);
+
+  record.data.resize(dataSize);
+  _file.read(reinterpret_cast<char*>(record.data.data()), dataSize);
+  if (_file.gcount() != static_cast<std::streamsize>(dataSize))
+    throw std::runtime_error("Truncated capture record data");
+
+  return true;
+}
+
+} // namespace server::network
@@ -0,0 +1,126 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+
+#include "libserver/network/CommandDispatch.hpp"
+
+#include <cstring>
+
+namespace server::network
+{
+
+CommandDispatch::~CommandDispatch()
+{
+  Reset();
+}
+
+std::span<std::byte> CommandDispatch::PrepareData(std::size_t size)
+{
+  if (_dataCapacity < size)
+  {
+    _data = std::make_unique_for_overwrite<std::byte[]>(size);
+    _dataCapacity = size;
+  }
+
+  _dataSize = size;
+  return {_data.get(), size};
+}
+
+void CommandDispatch::CommitData(std::size_t size) noexcept
+{
+  assert(size <= _dataSize);
+  _dataSize = size;
+}
+
+std::span<const std::byte> CommandDispatch::GetData() const noexcept
+{
+  return {_data.get(), _dataSize};
+}
+
+void CommandDispatch::Reset() noexcept
+{
+  if (_command != nullptr)
+  {
+    _destroyCommand(_command);
+    _command = nullptr;
+    _destroyCommand = nullptr;
+  }
+
+  _arena.Release();
+  _dataSize = 0;
+  clientId = 0;
+  commandId = 0;
+}
+
+CommandDispatchPool::CommandDispatchPool(std::size_t maxIdleCount)
+  : _maxIdleCount(maxIdleCount)
+{
+  _idleDispatches.reserve(_maxIdleCount);
+}
+
+CommandDispatch& CommandDispatchPool::Acquire()
+{
+  std::scoped_lock lock(_mutex);
+  if (not _idleDispatches.empty())
+  {
+    auto* const dispatch = _idleDispatches.back();
+    _idleDispatches.pop_back();
+    return *dispatch;
+  }
+
+  auto& dispatch = _dispatches.emplace_back(std::make_unique<CommandDispatch>());
+  dispatch->_poolIdx = _dispatches.size() - 1;
+  return *dispatch;
+}
+
+void CommandDispatchPool::Release(CommandDispatch& dispatch) noexcept
+{
+  dispatch.Reset();
+
+  std::unique_ptr<CommandDispatch> releasedDispatch;
+
+  {
+    std::scoped_lock lock(_mutex);
+    if (_idleDispatches.size() < _maxIdleCount)
+    {
+      // The capacity of the idle dispatches is reserved up front,
+      // so that the release does not allocate.
+      _idleDispatches.push_back(&dispatch);
+      return;
+    }
+
+    // Remove the dispatch from the pool, moving the last dispatch in its place.
+    const auto poolIdx = dispatch._poolIdx;
+    releasedDispatch = std::move(_dispatches[poolIdx]);
+    if (poolIdx != _dispatches.size() - 1)
+    {
+      _dispatches[poolIdx] = std::move(_dispatches.back());
+      _dispatches[poolIdx]->_poolIdx = poolIdx;
+    }
+    _dispatches.pop_back();
+  }
+}
+
+std::size_t CommandDispatchPool::GetIdleCount() const
+{
+  std::scoped_lock lock(_mutex);
+  return _idleDispatches.size();
+}
+
+} // namespace server::network
@@ -0,0 +1,136 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include "libserver/network/ReadBuffer.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+
+namespace server::network
+{
+
+ReadBuffer::ReadBuffer(
+  std::size_t minReadSize,
+  std::size_t maxReadSize)
+  : _minReadSize(std::max(minReadSize, std::size_t{1}))
+  , _maxReadSize(std::max(maxReadSize, _minReadSize))
+  , _readSize(_minReadSize)
+{
+}
+
+std::span<std::byte> ReadBuffer::Prepare()
+{
+  const std::size_t pendingSize = _end - _begin;
+  if (pendingSize > _maxReadSize)
+    throw std::length_error("Too much unconsumed data in the read buffer");
+
+  const std::size_t tailSize = _capacity - _end;
+  if (tailSize < _readSize)
+  {
+    if (_capacity < pendingSize + _readSize)
+    {
+      // Leave room for more than one read, so that a partial command
+      // does not have to be moved after every read.
+      const std::size_t capacity = std::max(pendingSize + _readSize, _readSize * 2);
+      auto storage = std::make_unique_for_overwrite<std::byte[]>(capacity);
+      if (pendingSize > 0)
+        std::memcpy(storage.get(), _storage.get() + _begin, pendingSize);
+
+      _storage = std::move(storage);
+      _capacity = capacity;
+      _begin = 0;
+      _end = pendingSize;
+    }
+    else if (tailSize < _minReadSize)
+    {
+      // Move the unconsumed partial data to the front.
+      std::memmove(_storage.get(), _storage.get() + _begin, pendingSize);
+      _begin = 0;
+      _end = pendingSize;
+    }
+
+    // Otherwise read to the space left after the unconsumed data,
+    // it fits at least the smallest read.
+  }
+
+  _preparedSize = std::min(_readSize, _capacity - _end);
+  return {_storage.get() + _end, _preparedSize};
+}
+
+void ReadBuffer::Commit(std::size_t size)
+{
+  assert(size <= _preparedSize);
+  _end += size;
+
+  // The prepared space might be smaller than the read size
+  // when there is a partial command in front of it.
+  if (size == _preparedSize)
+  {
+    // The read filled the whole space, more data are likely waiting.
+    _readSize = std::min(_readSize * 2, _maxReadSize);
+  }
+  else if (size < _preparedSize / 4)
+  {
+    _readSize = std::max(_readSize / 2, _minReadSize);
+  }
+}
+
+std::span<const std::byte> ReadBuffer::GetData() const noexcept
+{
+  return {_storage.get() + _begin, _end - _begin};
+}
+
+void ReadBuffer::Consume(std::size_t size)
+{
+  assert(size <= _end - _begin);
+  _begin += size;
+
+  // Rewind the buffer once all the data are consumed.
+  if (_begin == _end)
+  {
+    _begin = 0;
+    _end = 0;
+  }
+}
+
+void ReadBuffer::Trim() noexcept
+{
+  if (_begin != _end)
+    return;
+
+  _storage.reset();
+  _capacity = 0;
+  _begin = 0;
+  _end = 0;
+  _readSize = _minReadSize;
+}
+
+std::size_t ReadBuffer::GetReadSize() const noexcept
+{
+  return _readSize;
+}
+
+std::size_t ReadBuffer::GetCapacity() const noexcept
+{
+  return _capacity;
+}
+
+} // namespace server::network
@@ -21,6 +21,7 @@
 
 #include "libserver/util/Deferred.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <ranges>
 #include <spdlog/spdlog.h>
@@ -32,22 +33,50 @@ namespace server::network
 namespace
 {
 
-constexpr std::size_t MaxConnectionsPerAddress = 3;
-constexpr std::size_t MaxTotalConnections = 1024;
-constexpr std::size_t MaxConnectRatePerAddress = 10;
-constexpr auto RateWindow = std::chrono::seconds(30);
+//! Capacity of the client registry per allowed connection. Larger than one,
+//! as the disconnected clients leave the registry only after the connection slot is released.
+constexpr std::size_t ClientRegistryCapacityFactor = 2;
+//! Interval of the server tick, which also advances the idle timing wheel.
+constexpr auto TickInterval = std::chrono::seconds(1);
+
+//! Converts the duration to a count of ticks, rounded up.
+uint64_t ToTickCount(std::chrono::steady_clock::duration duration) noexcept
+{
+  if (duration <= std::chrono::steady_clock::duration::zero())
+    return 1;
+
+  const auto tickInterval = std::chrono::duration_cast<
+    std::chrono::steady_clock::duration>(TickInterval);
+  return static_cast<uint64_t>((duration + tickInterval - std::chrono::steady_clock::duration{1}) / tickInterval);
+}
+
+#if defined(SO_REUSEPORT)
+//! Socket option allowing multiple acceptors to bind to the same port.
+using ReusePort = boost::asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>;
+#endif
 
 } // namespace
 
 Client::Client(
   ClientId clientId,
   asio::ip::tcp::socket&& socket,
-  EventHandlerInterface& networkEventHandler) noexcept
-  : _clientId(clientId)
+  EventHandlerInterface& networkEventHandler,
+  const WriteQueueLimits& writeQueueLimits,
+  const ReadBufferLimits& readBufferLimits) noexcept
+  : _writeQueueLimits(writeQueueLimits)
+  , _readBufferLimits(readBufferLimits)
+  , _readBuffer(readBufferLimits.minReadSize, readBufferLimits.maxReadSize)
+  , _lastActivity(std::chrono::steady_clock::now().time_since_epoch().count())
+  , _clientId(clientId)
   , _socket(std::move(socket))
   , _networkEventHandler(networkEventHandler)
 {
   _remoteAddress = _socket.remote_endpoint().address().to_v4();
+
+  // The data are read only after the socket reports them available,
+  // the read should never block the I/O thread.
+  boost::system::error_code error;
+  _socket.non_blocking(true, error);
 }
 
 void Client::Begin()
@@ -55,9 +84,14 @@ void Client::Begin()
   if (_shouldRun.exchange(true, std::memory_order::acq_rel))
     return;
 
-  _networkEventHandler.OnClientConnected(_clientId);
-
-  ReadLoop();
+  // Begin the client on its strand.
+  asio::dispatch(
+    _socket.get_executor(),
+    [clientPtr = this->shared_from_this()]()
+    {
+      clientPtr->_networkEventHandler.OnClientConnected(clientPtr->_clientId);
+      clientPtr->ReadLoop();
+    });
 }
 
 void Client::End()
@@ -65,33 +99,176 @@ void Client::End()
   if (not _shouldRun.exchange(false, std::memory_order::seq_cst))
     return;
 
-  try
+  // The client might be ended from any thread,
+  // close the socket on the client's strand.
+  asio::dispatch(
+    _socket.get_executor(),
+    [clientPtr = this->shared_from_this()]()
+    {
+      try
+      {
+        if (clientPtr->_socket.is_open())
+        {
+          clientPtr->_socket.shutdown(asio::socket_base::shutdown_both);
+          clientPtr->_socket.close();
+        }
+      }
+      catch (const std::exception&)
+      {
+        // Ignore
+      }
+
+      clientPtr->_networkEventHandler.OnClientDisconnected(clientPtr->_clientId);
+    });
+}
+
+void Client::QueueWrite(WriteBuffer buffer, CoalescingKey coalescingKey)
+{
+  if (not _shouldRun.load(std::memory_order::acquire))
+    return;
+
+  bool isWriteLoopPending = false;
+  bool isOverLimitTooLong = false;
+
   {
-    if (_socket.is_open())
+    std::scoped_lock lock(_writeMutex);
+
+    const bool isOverLimits = IsOverWriteQueueLimits(
+      _writeQueueMetrics.writeCount + 1,
+      _writeQueueMetrics.byteCount + buffer->size());
+
+    // Droppable writes over the limits supersede the queued write
+    // with the same key or are dropped. The writes being sent have already
+    // left the queue and are not replaced. The write loop is already pending.
+    if (isOverLimits && coalescingKey != 0)
     {
-      _socket.shutdown(asio::socket_base::shutdown_both);
-      _socket.close();
+      const auto queuedWriteIter = std::ranges::find(
+        _writeQueue | std::views::reverse,
+        coalescingKey,
+        &QueuedWrite::coalescingKey);
+
+      if (queuedWriteIter != (_writeQueue | std::views::reverse).end())
+      {
+        _writeQueueMetrics.byteCount -= queuedWriteIter->buffer->size();
+        _writeQueueMetrics.byteCount += buffer->size();
+        queuedWriteIter->buffer = std::move(buffer);
+        ++_writeQueueMetrics.coalescedWriteCount;
+      }
+      else
+      {
+        ++_writeQueueMetrics.droppedWriteCount;
+      }
+
+      return;
     }
+
+    // The write loop is already scheduled if there are writes pending.
+    isWriteLoopPending = not _writeQueue.empty();
+
+    _writeQueueMetrics.writeCount += 1;
+    _writeQueueMetrics.byteCount += buffer->size();
+    _writeQueueMetrics.peakByteCount = std::max(
+      _writeQueueMetrics.peakByteCount,
+      _writeQueueMetrics.byteCount);
+
+    _writeQueue.emplace_back(QueuedWrite{
+      .buffer = std::move(buffer),
+      .coalescingKey = coalescingKey});
+
+    isOverLimitTooLong = UpdateWriteQueueLimitState();
   }
-  catch (const std::exception&)
+
+  if (isOverLimitTooLong)
   {
-    // Ignore
+    EnforceWriteQueueLimits();
+    return;
   }
 
-  _networkEventHandler.OnClientDisconnected(_clientId);
+  if (isWriteLoopPending)
+    return;
+
+  // Writes are queued from the director threads,
+  // perform the write on the client's strand.
+  asio::post(
+    _socket.get_executor(),
+    [clientPtr = this->shared_from_this()]()
+    {
+      clientPtr->WriteLoop();
+    });
 }
 
-void Client::QueueWrite(WriteSupplier writeSupplier)
+void Client::EnforceWriteQueueLimits()
 {
+  WriteQueueMetrics metrics;
+
+  {
+    std::scoped_lock lock(_writeMutex);
+    if (not UpdateWriteQueueLimitState())
+      return;
+
+    metrics = _writeQueueMetrics;
+  }
+
   if (not _shouldRun.load(std::memory_order::acquire))
     return;
 
+  spdlog::warn(
+    "Client {} is disconnecting because its write queue stayed over the limits"
+    " ({} writes, {} bytes, peak {} bytes, {} coalesced and {} dropped writes)",
+    _clientId,
+    metrics.writeCount,
+    metrics.byteCount,
+    metrics.peakByteCount,
+    metrics.coalescedWriteCount,
+    metrics.droppedWriteCount);
+
+  End();
+}
+
+WriteQueueMetrics Client::GetWriteQueueMetrics() const
+{
+  std::scoped_lock lock(_writeMutex);
+  return _writeQueueMetrics;
+}
+
+std::chrono::steady_clock::time_point Client::GetLastActivity() const noexcept
+{
+  return std::chrono::steady_clock::time_point(
+    std::chrono::steady_clock::duration(_lastActivity.load(std::memory_order::relaxed)));
+}
+
+void Client::TrimReadBuffer()
+{
+  if (_readBufferLimits.trimTimeout <= std::chrono::seconds::zero()
+    || _isReadBufferTrimmed.load(std::memory_order::relaxed))
   {
-    std::scoped_lock lock(_writeMutex);
-    _writeQueue.emplace(writeSupplier);
+    return;
   }
 
-  WriteLoop();
+  // Release the buffer only after the client stays idle for the whole timeout,
+  // so that the buffer of a client sending data only occasionally is kept.
+  if (std::chrono::steady_clock::now() - GetLastActivity() < _readBufferLimits.trimTimeout)
+    return;
+
+  asio::post(
+    _socket.get_executor(),
+    [clientPtr = this->shared_from_this()]()
+    {
+      // The client might have sent data in the meantime.
+      const auto idleDuration = std::chrono::steady_clock::now() - clientPtr->GetLastActivity();
+      if (idleDuration < clientPtr->_readBufferLimits.trimTimeout)
+        return;
+
+      clientPtr->_readBuffer.Trim();
+      clientPtr->_isReadBufferTrimmed.store(
+        clientPtr->_readBuffer.GetCapacity() == 0,
+        std::memory_order::relaxed);
+    });
+}
+
+ClientId Client::GetId() const noexcept
+{
+  return _clientId;
 }
 
 asio::ip::address_v4 Client::GetAddress() const noexcept
@@ -99,48 +276,63 @@ asio::ip::address_v4 Client::GetAddress() const noexcept
   return _remoteAddress;
 }
 
-void Client::WriteLoop() noexcept
+bool Client::IsOverWriteQueueLimits(
+  std::size_t writeCount,
+  std::size_t byteCount) const noexcept
 {
-  // todo: forgive me for this, its not clean, its not pretty and i'm pretty sure there some side effects
-  //       i'll nuke it in the future
+  const bool isOverWriteCount = _writeQueueLimits.maxWriteCount != 0
+    && writeCount > _writeQueueLimits.maxWriteCount;
+  const bool isOverByteCount = _writeQueueLimits.maxByteCount != 0
+    && byteCount > _writeQueueLimits.maxByteCount;
+
+  return isOverWriteCount || isOverByteCount;
+}
 
+bool Client::UpdateWriteQueueLimitState()
+{
+  if (not IsOverWriteQueueLimits(_writeQueueMetrics.writeCount, _writeQueueMetrics.byteCount))
+  {
+    _writeQueueOverLimitSince.reset();
+    return false;
+  }
+
+  const auto now = std::chrono::steady_clock::now();
+  if (not _writeQueueOverLimitSince)
+    _writeQueueOverLimitSince = now;
+
+  return now - *_writeQueueOverLimitSince >= _writeQueueLimits.overLimitTimeout;
+}
+
+void Client::WriteLoop() noexcept
+{
   if (not _shouldRun.load(std::memory_order::acquire))
     return;
 
   if (_isSending.load(std::memory_order::acquire))
     return;
 
-  std::scoped_lock lock(_writeMutex);
-  if (_writeQueue.empty())
+  // Take all the pending buffers, the lock is held only for the swap.
   {
-    return;
+    std::scoped_lock lock(_writeMutex);
+    if (_writeQueue.empty())
+      return;
+
+    _sendingWrites.swap(_writeQueue);
   }
 
-  // Write the suppliers to the write buffer.
-  while (not _writeQueue.empty())
+  _sendingBufferSequence.clear();
+  for (const auto& write : _sendingWrites)
   {
-    try
-    {
-      const auto& supplier = _writeQueue.front();
-      supplier(_writeBuffer);
-      _writeQueue.pop();
-    }
-    catch (const std::exception& e)
-    {
-      spdlog::error("Unhandled exception in supplier of write data for client {}: {}",
-        _clientId,
-        e.what());
-      End();
-      return;
-    }
+    _sendingBufferSequence.emplace_back(write.buffer->data(), write.buffer->size());
   }
 
   _isSending.store(true, std::memory_order::release);
 
-  // Asynchronously write the data to the socket.
-  _socket.async_write_some(
-    _writeBuffer.data(),
-    [clientPtr = this->shared_from_this()](const boost::system::error_code& error, const std::size_t size)
+  // Asynchronously write all the buffers to the socket with a gathering write.
+  asio::async_write(
+    _socket,
+    _sendingBufferSequence,
+    [clientPtr = this->shared_from_this()](const boost::system::error_code& error, std::size_t)
     {
       try
       {
@@ -157,23 +349,31 @@ void Client::WriteLoop() noexcept
                 std::format("Generic network error {}", error.message()));
           }
         }
-
-        // Consume the sent bytes.
-        {
-          std::scoped_lock lock(clientPtr->_writeMutex);
-          clientPtr->_writeBuffer.consume(size);
-        }
       }
       catch (const std::exception& x)
       {
         spdlog::debug(
-          "Client {} is disconnecting because of read loop exception: {}",
+          "Client {} is disconnecting because of write loop exception: {}",
           clientPtr->_clientId,
           x.what());
 
         clientPtr->End();
       }
 
+      {
+        std::scoped_lock lock(clientPtr->_writeMutex);
+        for (const auto& write : clientPtr->_sendingWrites)
+        {
+          clientPtr->_writeQueueMetrics.writeCount -= 1;
+          clientPtr->_writeQueueMetrics.byteCount -= write.buffer->size();
+        }
+
+        clientPtr->UpdateWriteQueueLimitState();
+      }
+
+      // Release the written buffers back to their pool.
+      clientPtr->_sendingWrites.clear();
+
       clientPtr->_isSending.store(false, std::memory_order::release);
       clientPtr->WriteLoop();
     });
@@ -184,16 +384,32 @@ void Client::ReadLoop() noexcept
   if (not _shouldRun.load(std::memory_order::acquire))
     return;
 
-  _socket.async_read_some(
-    _readBuffer.prepare(1024),
-    [clientPtr = this->shared_from_this()](boost::system::error_code error, std::size_t size)
+  // Wait for the data without holding the read buffer,
+  // so that the buffer of an idle client may be released.
+  _socket.async_wait(
+    asio::ip::tcp::socket::wait_read,
+    [clientPtr = this->shared_from_this()](boost::system::error_code error)
     {
       try
       {
+        std::size_t size = 0;
+        if (not error)
+        {
+          // Read as much of the available data as the read buffer allows.
+          const auto readSpace = clientPtr->_readBuffer.Prepare();
+          size = clientPtr->_socket.read_some(
+            asio::buffer(readSpace.data(), readSpace.size()),
+            error);
+        }
+
         if (error)
         {
           switch (error.value())
           {
+            case asio::error::would_block:
+              // Spurious wake-up, wait for the data again.
+              clientPtr->ReadLoop();
+              return;
             case asio::error::operation_aborted:
               throw std::runtime_error("Connection aborted by the server");
             case asio::error::misc_errors::eof:
@@ -205,17 +421,17 @@ void Client::ReadLoop() noexcept
           }
         }
 
-        clientPtr->_readBuffer.commit(size);
-
-        const std::span receivedData{
-          static_cast<const std::byte*>(clientPtr->_readBuffer.data().data()),
-          clientPtr->_readBuffer.data().size()};
+        clientPtr->_readBuffer.Commit(size);
+        clientPtr->_isReadBufferTrimmed.store(false, std::memory_order::relaxed);
+        clientPtr->_lastActivity.store(
+          std::chrono::steady_clock::now().time_since_epoch().count(),
+          std::memory_order::relaxed);
 
         const auto consumedBytes = clientPtr->_networkEventHandler.OnClientData(
           clientPtr->_clientId,
-          receivedData);
+          clientPtr->_readBuffer.GetData());
 
-        clientPtr->_readBuffer.consume(consumedBytes);
+        clientPtr->_readBuffer.Consume(consumedBytes);
 
         // Continue the read loop.
         clientPtr->ReadLoop();
@@ -233,21 +449,106 @@ void Client::ReadLoop() noexcept
 }
 
 Server::Server(EventHandlerInterface& networkEventHandler) noexcept
-  : _acceptor(_io_ctx)
-  , _timer(_io_ctx)
+  : _timer(_io_ctx)
   , _networkEventHandler(networkEventHandler)
 {
 }
 
-void Server::Begin(const asio::ip::address& address, uint16_t port)
+void Server::Begin(
+  const asio::ip::address& address,
+  uint16_t port,
+  const ServerSettings& settings)
 {
   const asio::ip::tcp::endpoint server_endpoint(address, port);
+  _settings = settings;
+
+  if (not _clients)
+  {
+    _clients = std::make_unique<SlotMap<Client>>(
+      std::max(settings.connectionLimits.maxConnections, std::size_t{1})
+        * ClientRegistryCapacityFactor);
+  }
+
+  std::size_t acceptorCount = std::max(settings.acceptorCount, std::size_t{1});
+#if !defined(SO_REUSEPORT)
+  if (acceptorCount > 1)
+  {
+    spdlog::warn(
+      "Sharded acceptors are not supported on this platform, using a single acceptor for {}:{}",
+      address.to_string(),
+      port);
+    acceptorCount = 1;
+  }
+#endif
+
+  // Every acceptor is driven by its own I/O context,
+  // so the I/O thread pool is at least as large as the count of acceptors.
+  const std::size_t ioContextCount = std::max(settings.ioThreadCount, acceptorCount);
+
+  // Close the acceptors, stop and join the I/O thread pool
+  // once the primary I/O context stops.
+  const Deferred deferredJoinWorkers([this]()
+  {
+    for (auto& ioContext : _workerIoContexts)
+      ioContext->stop();
+
+    for (auto& thread : _workerThreads)
+    {
+      if (thread.joinable())
+        thread.join();
+    }
+
+    for (auto& acceptor : _acceptors)
+    {
+      boost::system::error_code error;
+      acceptor->close(error);
+    }
+
+    // The I/O contexts are kept alive, as the sockets of clients might still be bound to them.
+    _workerThreads.clear();
+  });
+
+  // Spin up the I/O thread pool.
+  // The primary I/O context runs on this thread,
+  // the rest of the I/O contexts run on their own threads.
+  for (std::size_t idx = 1; idx < ioContextCount; ++idx)
+  {
+    auto& ioContext = *_workerIoContexts.emplace_back(
+      std::make_unique<asio::io_context>(1));
+
+    _workerThreads.emplace_back([&ioContext]()
+    {
+      // Keep the I/O context running even without any clients bound to it.
+      const auto workGuard = asio::make_work_guard(ioContext);
+
+      try
+      {
+        ioContext.run();
+      }
+      catch (const std::exception& x)
+      {
+        spdlog::error("Exception in asio IO context of the I/O thread pool: {}", x.what());
+      }
+    });
+  }
 
   try
   {
-    _acceptor.open(server_endpoint.protocol());
-    _acceptor.bind(server_endpoint);
-    _acceptor.listen();
+    for (std::size_t idx = 0; idx < acceptorCount; ++idx)
+    {
+      auto& ioContext = idx == 0 ? _io_ctx : *_workerIoContexts[idx - 1];
+      auto& acceptor = *_acceptors.emplace_back(
+        std::make_unique<asio::ip::tcp::acceptor>(ioContext));
+
+      acceptor.open(server_endpoint.protocol());
+#if defined(SO_REUSEPORT)
+      // Let the kernel balance the incoming connections between the acceptors.
+      if (acceptorCount > 1)
+        acceptor.set_option(ReusePort(true));
+#endif
+      acceptor.bind(server_endpoint);
+      acceptor.listen();
+    }
   }
   catch (const std::exception& x)
   {
@@ -259,8 +560,16 @@ void Server::Begin(const asio::ip::address& address, uint16_t port)
         x.what()));
   }
 
-  // Run the accept loop.
-  AcceptLoop();
+  // Run the accept loops, each on the I/O context of its acceptor.
+  for (auto& acceptor : _acceptors)
+  {
+    asio::post(
+      acceptor->get_executor(),
+      [this, &acceptor = *acceptor]()
+      {
+        AcceptLoop(acceptor);
+      });
+  }
 
   try
   {
@@ -290,19 +599,20 @@ void Server::Begin(const asio::ip::address& address, uint16_t port)
 
 void Server::End()
 {
-  _acceptor.close();
+  // The acceptor is closed on the thread which began the server,
+  // once the primary I/O context stops.
   _io_ctx.stop();
 }
 
 std::shared_ptr<Client> Server::GetClient(ClientId clientId)
 {
-  const auto clientItr = _clients.find(clientId);
-  if (clientItr == _clients.end())
+  auto client = _clients ? _clients->Get(clientId) : nullptr;
+  if (not client)
   {
     throw std::runtime_error("Invalid client");
   }
 
-  return clientItr->second->shared_from_this();
+  return client;
 }
 
 void Server::HandleNetworkTick()
@@ -318,15 +628,14 @@ void Server::OnClientConnected(
 void Server::OnClientDisconnected(
   ClientId clientId)
 {
-  const auto clientIt = _clients.find(clientId);
-  assert(clientIt != _clients.end());
+  const auto client = _clients->Get(clientId);
+  assert(client);
 
-  const auto address = clientIt->second->GetAddress();
-  OnThrottleDisconnect(address);
+  OnThrottleDisconnect(client->GetAddress());
 
   _networkEventHandler.OnClientDisconnected(clientId);
 
-  _clients.erase(clientIt);
+  _clients->Erase(clientId);
 }
 
 size_t Server::OnClientData(
@@ -338,10 +647,20 @@ size_t Server::OnClientData(
 
 bool Server::IsConnectionThrottled(const asio::ip::address_v4& address) noexcept
 {
+  // The address states are shared by all the acceptors,
+  // so that the limits hold globally for the server.
+  std::scoped_lock lock(_addressStatesMutex);
+
+  const auto& limits = _settings.connectionLimits;
+  // If there are more active connections than allowed by `maxConnections`
+  // throttle the connection.
+  if (_activeConnections >= limits.maxConnections)
+    return true;
+
   auto& state = _addressStates[address];
-  // If there are more active connections than allowed by `MaxConnectionsPerAddress`
+  // If there are more active connections than allowed by `maxConnectionsPerAddress`
   // throttle the connection from the address.
-  if (state.activeConnections >= MaxConnectionsPerAddress)
+  if (state.activeConnections >= limits.maxConnectionsPerAddress)
     return true;
 
   const auto now = std::chrono::steady_clock::now();
@@ -350,25 +669,28 @@ bool Server::IsConnectionThrottled(const asio::ip::address_v4& address) noexcept
   while (not state.connectionTimestamps.empty())
   {
     const auto timeSinceConnection = now - state.connectionTimestamps.front();
-    if (timeSinceConnection < RateWindow)
+    if (timeSinceConnection < limits.rateWindow)
       break;
 
     state.connectionTimestamps.pop_front();
   }
 
-  // If there are more connection attempts than allowed by `MaxConnectRatePerAddress`
+  // If there are more connection attempts than allowed by `maxConnectRatePerAddress`
   // throttle the connection from the address.
-  if (state.connectionTimestamps.size() >= MaxConnectRatePerAddress)
+  if (state.connectionTimestamps.size() >= limits.maxConnectRatePerAddress)
     return true;
 
   state.activeConnections++;
   state.connectionTimestamps.push_back(now);
+  _activeConnections++;
 
   return false;
 }
 
 void Server::OnThrottleDisconnect(const asio::ip::address_v4& address) noexcept
 {
+  std::scoped_lock lock(_addressStatesMutex);
+
   const auto it = _addressStates.find(address);
   if (it == _addressStates.end())
   {
@@ -378,6 +700,9 @@ void Server::OnThrottleDisconnect(const asio::ip::address_v4& address) noexcept
   if (it->second.activeConnections > 0)
   {
     --it->second.activeConnections;
+
+    assert(_activeConnections > 0);
+    --_activeConnections;
   }
 
   if (it->second.activeConnections == 0 &&
@@ -387,10 +712,26 @@ void Server::OnThrottleDisconnect(const asio::ip::address_v4& address) noexcept
   }
 }
 
-void Server::AcceptLoop() noexcept
+asio::io_context& Server::NextIoContext() noexcept
+{
+  // The primary I/O context is a part of the pool.
+  const std::size_t poolSize = _workerIoContexts.size() + 1;
+  const std::size_t idx = _nextIoContextIdx.fetch_add(1, std::memory_order::relaxed) % poolSize;
+
+  if (idx == 0)
+    return _io_ctx;
+  return *_workerIoContexts[idx - 1];
+}
+
+void Server::AcceptLoop(asio::ip::tcp::acceptor& acceptor) noexcept
 {
-  _acceptor.async_accept(
-    [&](const boost::system::error_code& error, asio::ip::tcp::socket client_socket)
+  // Accept the client socket onto a strand of the next I/O context in the pool,
+  // so that the I/O of the client is serialized.
+  // The clients of every acceptor are distributed over the whole pool,
+  // which may be larger than the count of the acceptors.
+  acceptor.async_accept(
+    asio::make_strand(NextIoContext()),
+    [this, &acceptor](const boost::system::error_code& error, asio::ip::tcp::socket client_socket)
     {
       try
       {
@@ -408,27 +749,43 @@ void Server::AcceptLoop() noexcept
             "Connection rejected from {} (throttled)",
             remoteAddr.to_string());
           client_socket.close();
-          AcceptLoop();
+          AcceptLoop(acceptor);
           return;
         }
 
-        // Sequential Id.
-        const ClientId clientId = _client_id++;
-
-        // Create the client.
-        const auto [itr, emplaced] = _clients.try_emplace(
-          clientId,
-          std::make_shared<Client>(clientId,
-            std::move(client_socket),
-            *this));
+        // Create the client in a free slot of the registry.
+        const auto client = _clients->Emplace(
+          [this, &client_socket](const ClientId clientId)
+          {
+            return std::make_shared<Client>(
+              clientId,
+              std::move(client_socket),
+              *this,
+              _settings.writeQueueLimits,
+              _settings.readBufferLimits);
+          });
+
+        if (not client)
+        {
+          spdlog::warn(
+            "Connection rejected from {} (client registry is full)",
+            remoteAddr.to_string());
+          client_socket.close();
+          OnThrottleDisconnect(remoteAddr);
+          AcceptLoop(acceptor);
+          return;
+        }
 
-        // Id is sequential so emplacement should never fail.
-        assert(emplaced);
+        if (_settings.idleTimeout > std::chrono::seconds::zero())
+        {
+          std::scoped_lock lock(_idleWheelMutex);
+          _idleWheel.Schedule(client->GetId(), ToTickCount(_settings.idleTimeout));
+        }
 
-        itr->second->Begin();
+        client->Begin();
 
         // Continue the accept loop.
-        AcceptLoop();
+        AcceptLoop(acceptor);
       }
       catch (const std::exception& x)
       {
@@ -443,7 +800,17 @@ void Server::TickLoop() noexcept
 {
   _networkEventHandler.HandleNetworkTick();
 
-  _timer.expires_after(std::chrono::seconds(1));
+  // Disconnect the clients which are not keeping up with their writes
+  // and release the read buffers of the clients idle for longer than the trim timeout.
+  _clients->ForEach([](const std::shared_ptr<Client>& client)
+  {
+    client->EnforceWriteQueueLimits();
+    client->TrimReadBuffer();
+  });
+
+  ReapIdleClients();
+
+  _timer.expires_after(TickInterval);
   _timer.async_wait([this](const boost::system::error_code& error)
     {
       if (error)
@@ -453,4 +820,40 @@ void Server::TickLoop() noexcept
     });
 }
 
+void Server::ReapIdleClients() noexcept
+{
+  if (_settings.idleTimeout <= std::chrono::seconds::zero())
+    return;
+
+  const auto now = std::chrono::steady_clock::now();
+
+  std::scoped_lock lock(_idleWheelMutex);
+  _expiredIdleClients.clear();
+  _idleWheel.Advance(_expiredIdleClients);
+
+  for (const ClientId clientId : _expiredIdleClients)
+  {
+    // The client might have disconnected in the meantime.
+    const auto client = _clients->Get(clientId);
+    if (not client)
+      continue;
+
+    // Reschedule the client if it was active since it was scheduled.
+    const auto idleDuration = now - client->GetLastActivity();
+    if (idleDuration < _settings.idleTimeout)
+    {
+      _idleWheel.Schedule(clientId, ToTickCount(_settings.idleTimeout - idleDuration));
+      continue;
+    }
+
+    spdlog::info(
+      "Client {} ({}) is disconnecting after being idle for {}s",
+      clientId,
+      client->GetAddress().to_string(),
+      std::chrono::duration_cast<std::chrono::seconds>(idleDuration).count());
+
+    client->End();
+  }
+}
+
 } // namespace server::network
@@ -0,0 +1,81 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include "libserver/network/TimingWheel.hpp"
+
+#include <algorithm>
+
+namespace server::network
+{
+
+TimingWheel::TimingWheel(std::size_t slotCount)
+  : _slots(std::max(slotCount, std::size_t{1}))
+{
+}
+
+void TimingWheel::Schedule(ClientId clientId, uint64_t delay)
+{
+  delay = std::max(delay, uint64_t{1});
+
+  // The slot of the current tick was already processed,
+  // a delay of exactly one round of the wheel takes no extra rounds.
+  const auto slotCount = static_cast<uint64_t>(_slots.size());
+  const auto slotIdx = (_tick + delay) % slotCount;
+  _slots[slotIdx].emplace_back(Entry{
+    .clientId = clientId,
+    .rounds = (delay - 1) / slotCount});
+
+  ++_size;
+}
+
+void TimingWheel::Advance(std::vector<ClientId>& expired)
+{
+  ++_tick;
+
+  auto& slot = _slots[_tick % _slots.size()];
+
+  // Expire the entries in their last round and keep the rest in place.
+  std::size_t keptCount = 0;
+  for (auto& entry : slot)
+  {
+    if (entry.rounds == 0)
+    {
+      expired.emplace_back(entry.clientId);
+      continue;
+    }
+
+    --entry.rounds;
+    slot[keptCount++] = entry;
+  }
+
+  _size -= slot.size() - keptCount;
+  slot.resize(keptCount);
+}
+
+uint64_t TimingWheel::GetTick() const noexcept
+{
+  return _tick;
+}
+
+std::size_t TimingWheel::GetSize() const noexcept
+{
+  return _size;
+}
+
+} // namespace server::network
@@ -18,8 +18,11 @@
  **/
 
 #include "libserver/network/chatter/ChatterProtocol.hpp"
+#include "libserver/util/Xor.hpp"
 
-#include <unordered_map>
+#include <array>
+#include <cstring>
+#include <utility>
 
 namespace server::protocol
 {
@@ -27,7 +30,8 @@ namespace server::protocol
 namespace
 {
 
-const std::unordered_map<ChatterCommand, std::string_view> commands = {
+//! Chatter command IDs mapped to the command names.
+constexpr std::pair<ChatterCommand, std::string_view> CommandNameList[] = {
   {ChatterCommand::ChatCmdLogin, "ChatCmdLogin"},
   {ChatterCommand::ChatCmdLoginAckOK, "ChatCmdLoginAckOK"},
   {ChatterCommand::ChatCmdLoginAckCancel, "ChatCmdLoginAckCancel"},
@@ -100,12 +104,45 @@ const std::unordered_map<ChatterCommand, std::string_view> commands = {
   {ChatterCommand::ChatCmdChangeLetterOptionAckOk, "ChatCmdChangeLetterOptionAckOk"}
 };
 
+//! Names of the commands indexed by the command IDs.
+//! Commands without a name are "n/a".
+constexpr auto CommandNames = []()
+{
+  std::array<std::string_view, static_cast<std::size_t>(ChatterCommand::Count)> names{};
+  names.fill("n/a");
+  for (const auto& [command, name] : CommandNameList)
+  {
+    names[static_cast<std::size_t>(command)] = name;
+  }
+  return names;
+}();
+
 } // namespace
 
 std::string_view GetChatterCommandName(server::protocol::ChatterCommand command)
 {
-  const auto commandIter = commands.find(command);
-  return commandIter == commands.cend() ? "n/a" : commandIter->second;
+  const auto index = static_cast<std::size_t>(command);
+  return index < CommandNames.size() ? CommandNames[index] : "n/a";
+}
+
+void WriteClientChatterCommand(
+  uint16_t commandId,
+  std::span<const std::byte> commandData,
+  std::vector<std::byte>& output)
+{
+  const ChatterCommandHeader header{
+    .length = static_cast<uint16_t>(sizeof(ChatterCommandHeader) + commandData.size()),
+    .commandId = commandId};
+
+  const auto origin = output.size();
+  output.resize(origin + header.length);
+
+  const std::span command(output.data() + origin, header.length);
+  std::memcpy(command.data(), &header.length, sizeof(header.length));
+  std::memcpy(command.data() + sizeof(header.length), &header.commandId, sizeof(header.commandId));
+  std::memcpy(command.data() + sizeof(ChatterCommandHeader), commandData.data(), commandData.size());
+
+  util::XorWithKey(ChatterXorCode, command);
 }
 
 } // namespace server::protocol
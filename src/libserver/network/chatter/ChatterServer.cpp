@@ -20,7 +20,11 @@
 #include "libserver/network/chatter/ChatterServer.hpp"
 #include "libserver/util/Stream.hpp"
 #include "libserver/util/Util.hpp"
+#include "libserver/util/Xor.hpp"
 
+#include <array>
+#include <filesystem>
+#include <format>
 #include <stacktrace>
 
 #include <spdlog/spdlog.h>
@@ -31,20 +35,20 @@ namespace server
 namespace
 {
 
-// The base XOR scrambling constant, which seems to not roll.
-constexpr std::array XorCode{
-  static_cast<std::byte>(0x2B),
-  static_cast<std::byte>(0xFE),
-  static_cast<std::byte>(0xB8),
-  static_cast<std::byte>(0x02)};
+//! Max size of the whole command, including the header.
+constexpr std::size_t MaxCommandSize = 4092;
 
 // todo: de/serializer map, handler map
 
 } // anon namespace
 
 ChatterServer::ChatterServer(
-  IChatterServerEventsHandler& chatterServerEventsHandler)
+  IChatterServerEventsHandler& chatterServerEventsHandler,
+  Executor::Strand& handlerStrand)
   : _chatterServerEventsHandler(chatterServerEventsHandler)
+  , _handlers(static_cast<std::size_t>(protocol::ChatterCommand::Count))
+  , _handlerSections(static_cast<std::size_t>(protocol::ChatterCommand::Count))
+  , _handlerStrand(handlerStrand)
   , _server(*this)
 {
 }
@@ -56,13 +60,28 @@ ChatterServer::~ChatterServer()
     _serverThread.join();
 }
 
-void ChatterServer::BeginHost(network::asio::ip::address_v4 address, uint16_t port)
+void ChatterServer::BeginHost(
+  network::asio::ip::address_v4 address,
+  uint16_t port,
+  const network::ServerSettings& settings)
 {
-  _serverThread = std::thread([this, address, port]()
+  if (not settings.captureDirectory.empty())
+  {
+    std::filesystem::create_directories(settings.captureDirectory);
+    const auto capturePath = network::CaptureWriter::MakePath(settings.captureDirectory, port);
+
+    _capture = std::make_unique<network::CaptureWriter>(
+      capturePath,
+      network::CaptureProtocol::Chatter,
+      port);
+    spdlog::info("Capturing the chatter commands received on port {} to '{}'", port, capturePath.string());
+  }
+
+  _serverThread = std::thread([this, address, port, settings]()
   {
     try
     {
-      _server.Begin(address, port);
+      _server.Begin(address, port, settings);
     }
     catch (const std::exception& x)
     {
@@ -85,6 +104,12 @@ void ChatterServer::EndHost()
 
   _server.End();
   _serverThread.join();
+
+  if (_capture)
+  {
+    _capture->Flush();
+    _capture.reset();
+  }
 }
 
 void ChatterServer::HandleNetworkTick()
@@ -93,12 +118,24 @@ void ChatterServer::HandleNetworkTick()
 
 void ChatterServer::OnClientConnected(network::ClientId clientId)
 {
-  _chatterServerEventsHandler.HandleClientConnected(clientId);
+  if (_capture)
+    _capture->WriteConnected(clientId);
+
+  _handlerStrand.Post([this, clientId]()
+  {
+    _chatterServerEventsHandler.HandleClientConnected(clientId);
+  });
 }
 
 void ChatterServer::OnClientDisconnected(network::ClientId clientId)
 {
-  _chatterServerEventsHandler.HandleClientDisconnected(clientId);
+  if (_capture)
+    _capture->WriteDisconnected(clientId);
+
+  _handlerStrand.Post([this, clientId]()
+  {
+    _chatterServerEventsHandler.HandleClientDisconnected(clientId);
+  });
 }
 
 size_t ChatterServer::OnClientData(
@@ -124,12 +161,12 @@ size_t ChatterServer::OnClientData(
       .Read(header.commandId);
 
     // Decrypt the header.
-    header.length ^= *reinterpret_cast<const uint16_t*>(XorCode.data());
-    header.commandId ^= *reinterpret_cast<const uint16_t*>(XorCode.data() + 2);
+    header.length ^= *reinterpret_cast<const uint16_t*>(protocol::ChatterXorCode.data());
+    header.commandId ^= *reinterpret_cast<const uint16_t*>(protocol::ChatterXorCode.data() + 2);
 
     // If the the length of the command is notat least the size of the header
     // or is more than 4KB discard the command.
-    if (header.length < sizeof(protocol::ChatterCommandHeader) ||  header.length > 4092)
+    if (header.length < sizeof(protocol::ChatterCommandHeader) ||  header.length > MaxCommandSize)
     {
       break;
     }
@@ -145,19 +182,27 @@ size_t ChatterServer::OnClientData(
     }
 
     const size_t commandDataLength = header.length - sizeof(protocol::ChatterCommandHeader);
-    std::vector<std::byte> commandData(commandDataLength);
 
-    SinkStream commandDataSink({commandData.begin(), commandData.end()});
+    // The command is unscrambled and decoded to a pooled dispatch,
+    // which carries it to the handler strand.
+    auto& dispatch = _dispatchPool.Acquire();
+    dispatch.clientId = clientId;
+    dispatch.commandId = header.commandId;
 
-    // Read the command data from the command stream.
-    for (size_t idx = 0; idx < commandDataLength; ++idx)
-    {
-      std::byte& val = commandData[idx];
-      commandStream.Read(val);
-      val ^= XorCode[(commandStream.GetCursor() - 1) % 4];
-    }
+    // Unscramble the command data to the dispatch.
+    // The key is applied by the position of the data in the read buffer.
+    const auto commandDataOffset = commandStream.GetCursor();
+    util::XorWithKey(
+      protocol::ChatterXorCode,
+      data.subspan(commandDataOffset, commandDataLength),
+      dispatch.PrepareData(commandDataLength),
+      commandDataOffset);
+    commandStream.Seek(commandDataOffset + commandDataLength);
+
+    const auto commandData = dispatch.GetData();
 
-    SourceStream commandDataSource({commandData.begin(), commandData.end()});
+    if (_capture)
+      _capture->WriteCommand(clientId, header.commandId, commandData);
 
     if (debugIncomingCommandData)
     {
@@ -171,43 +216,79 @@ size_t ChatterServer::OnClientData(
     }
 
     // Find the handler of the command.
-    const auto handlerIter = _handlers.find(header.commandId);
-    if (handlerIter == _handlers.cend())
+    const auto handlerIndex = static_cast<std::size_t>(header.commandId);
+    if (handlerIndex >= _handlers.size()
+      || not _handlers[handlerIndex].decode)
     {
+      _dispatchPool.Release(dispatch);
+
       if (debugCommands)
       {
         spdlog::warn("Unhandled chatter command: {} ({:#x})", 
           GetChatterCommandName(static_cast<protocol::ChatterCommand>(header.commandId)),
           header.commandId);
       }
+
+      continue;
     }
-    else
+
+    // Decode the command on this thread, so that the decoding of the clients
+    // runs in parallel, and handle it on the handler strand.
+    try
     {
-      const auto& handler = handlerIter->second;
-      try
-      {
-        handler(clientId, commandDataSource);
-        
-        if (debugCommands)
-        {
-          spdlog::debug("Handled chatter command: {} ({:#x})", 
-            GetChatterCommandName(static_cast<protocol::ChatterCommand>(header.commandId)),
-            header.commandId);
-        }
-      }
-      catch (const std::exception& ex)
-      {
-        spdlog::error("Unhandled exception handling chatter command {} ({:#x}): {}",
-          GetChatterCommandName(static_cast<protocol::ChatterCommand>(header.commandId)),
-          header.commandId,
-          ex.what());
-      }
+      _handlers[handlerIndex].decode(dispatch);
+    }
+    catch (const std::exception& ex)
+    {
+      _dispatchPool.Release(dispatch);
+
+      spdlog::error("Unhandled exception decoding chatter command {} ({:#x}): {}",
+        GetChatterCommandName(static_cast<protocol::ChatterCommand>(header.commandId)),
+        header.commandId,
+        ex.what());
+      continue;
     }
+
+    // The task captures only pointers, so it is stored without an allocation.
+    _handlerStrand.Post([this, &dispatch]()
+    {
+      HandleDispatch(dispatch);
+    });
   }
 
   return commandStream.GetCursor();
 }
 
+void ChatterServer::HandleDispatch(network::CommandDispatch& dispatch)
+{
+  const auto commandId = dispatch.commandId;
+  const auto handlerIndex = static_cast<std::size_t>(commandId);
+
+  try
+  {
+    Profiler::Scope profilerScope(Profiler::Global(), _handlerSections[handlerIndex]);
+    _handlers[handlerIndex].handle(dispatch.clientId, dispatch);
+  }
+  catch (const std::exception& ex)
+  {
+    spdlog::error("Unhandled exception handling chatter command {} ({:#x}): {}",
+      GetChatterCommandName(static_cast<protocol::ChatterCommand>(commandId)),
+      commandId,
+      ex.what());
+    _dispatchPool.Release(dispatch);
+    return;
+  }
+
+  if (debugCommands)
+  {
+    spdlog::debug("Handled chatter command: {} ({:#x})",
+      GetChatterCommandName(static_cast<protocol::ChatterCommand>(commandId)),
+      commandId);
+  }
+
+  _dispatchPool.Release(dispatch);
+}
+
 network::asio::ip::address_v4 ChatterServer::GetClientAddress(const network::ClientId clientId)
 {
   return _server.GetClient(clientId)->GetAddress();
@@ -218,4 +299,90 @@ void ChatterServer::DisconnectClient(network::ClientId clientId)
   _server.GetClient(clientId)->End();
 }
 
+void ChatterServer::RegisterHandlerSection(protocol::ChatterCommand commandId)
+{
+  _handlerSections[static_cast<std::size_t>(commandId)] = Profiler::Global().RegisterSection(
+    std::format("chatter/{}", GetChatterCommandName(commandId)));
+}
+
+network::WriteBuffer ChatterServer::SerializeCommand(
+  protocol::ChatterCommand commandId,
+  const std::function<void(SinkStream&)>& writer)
+{
+  // Scratch buffer for the serialization, sized to the largest command.
+  thread_local std::array<std::byte, MaxCommandSize> commandBuffer;
+
+  SinkStream commandSink(commandBuffer);
+
+  // Reserve the space for the header.
+  commandSink.Seek(sizeof(protocol::ChatterCommandHeader));
+
+  // Write the command data.
+  writer(commandSink);
+
+  const protocol::ChatterCommandHeader header {
+    .length = static_cast<uint16_t>(commandSink.GetCursor()),
+    .commandId = static_cast<uint16_t>(commandId),};
+
+  if (debugOutgoingCommandData)
+  {
+    spdlog::debug("Write data for command '{}' (0x{:X}),\n\n"
+      "Command data size: {} \n"
+      "Data dump: \n\n{}\n",
+      GetChatterCommandName(commandId),
+      header.commandId,
+      header.length,
+      util::GenerateByteDump(
+        std::span(
+          commandBuffer.data() + sizeof(protocol::ChatterCommandHeader),
+          header.length - sizeof(protocol::ChatterCommandHeader))));
+  }
+
+  commandSink.Seek(0);
+  commandSink.Write(header.length)
+    .Write(header.commandId);
+
+  // Scramble the whole command to the pooled buffer.
+  auto payload = network::BufferPool::Global().Acquire();
+  payload->resize(header.length);
+  util::XorWithKey(
+    protocol::ChatterXorCode,
+    std::span(commandBuffer.data(), header.length),
+    *payload);
+
+  return payload;
+}
+
+void ChatterServer::SendCommand(
+  network::ClientId clientId,
+  protocol::ChatterCommand commandId,
+  const std::function<void(SinkStream&)>& writer)
+{
+  network::WriteBuffer payload;
+
+  try
+  {
+    payload = SerializeCommand(commandId, writer);
+  }
+  catch (const std::exception& x)
+  {
+    spdlog::error(
+      "Unhandled exception serializing chatter command '{}' (0x{:X}) for client {}: {}",
+      GetChatterCommandName(commandId),
+      static_cast<uint16_t>(commandId),
+      clientId,
+      x.what());
+    return;
+  }
+
+  _server.GetClient(clientId)->QueueWrite(std::move(payload));
+
+  if (debugCommands)
+  {
+    spdlog::debug("Sent chatter command message '{}' (0x{:X})",
+      GetChatterCommandName(commandId),
+      static_cast<uint16_t>(commandId));
+  }
+}
+
 } // namespace server
\ No newline at end of file
@@ -22,10 +22,13 @@
 #include <stdexcept>
 
 void server::protocol::ChatCmdLogin::Write(
-  const ChatCmdLogin&,
-  SinkStream&)
+  const ChatCmdLogin& command,
+  SinkStream& stream)
 {
-  throw std::runtime_error("Not implemented");
+  stream.Write(command.characterUid)
+    .Write(command.name)
+    .Write(command.code)
+    .Write(command.guildUid);
 }
 
 void server::protocol::Presence::Read(
@@ -719,10 +722,13 @@ void server::protocol::ChatCmdChatInvitationTrs::Read(
 }
 
 void server::protocol::ChatCmdEnterRoom::Write(
-  const ChatCmdEnterRoom&,
-  SinkStream&)
+  const ChatCmdEnterRoom& command,
+  SinkStream& stream)
 {
-  throw std::runtime_error("Not implemented");
+  stream.Write(command.code)
+    .Write(command.characterUid)
+    .Write(command.characterName)
+    .Write(command.guildUid);
 }
 
 void server::protocol::ChatCmdEnterRoom::Read(
@@ -798,10 +804,11 @@ void server::protocol::ChatCmdLeaveBuddyTrs::Read(
 }
 
 void server::protocol::ChatCmdChat::Write(
-  const ChatCmdChat&,
-  SinkStream&)
+  const ChatCmdChat& command,
+  SinkStream& stream)
 {
-  throw std::runtime_error("Not implemented");
+  stream.Write(command.message)
+    .Write(command.role);
 }
 
 void server::protocol::ChatCmdChat::Read(
@@ -923,17 +930,19 @@ void server::protocol::ChatCmdChannelChatTrs::Write(
 }
 
 void server::protocol::ChatCmdChannelChatTrs::Read(
-  ChatCmdChannelChatTrs&,
-  SourceStream&)
+  ChatCmdChannelChatTrs& command,
+  SourceStream& stream)
 {
-  throw std::runtime_error("Not implemented");
+  stream.Read(command.messageAuthor)
+    .Read(command.message)
+    .Read(command.role);
 }
 
 void server::protocol::ChatCmdChannelInfo::Write(
   const ChatCmdChannelInfo&,
   SinkStream&)
 {
-  throw std::runtime_error("Not implemented");
+  // Empty
 }
 
 void server::protocol::ChatCmdChannelInfo::Read(
@@ -953,10 +962,12 @@ void server::protocol::ChatCmdChannelInfoAckOk::Write(
 }
 
 void server::protocol::ChatCmdChannelInfoAckOk::Read(
-  ChatCmdChannelInfoAckOk&,
-  SourceStream&)
+  ChatCmdChannelInfoAckOk& command,
+  SourceStream& stream)
 {
-  throw std::runtime_error("Not implemented");
+  stream.Read(command.hostname)
+    .Read(command.port)
+    .Read(command.code);
 }
 
 void server::protocol::ChatCmdGuildChannelChatTrs::Write(
@@ -18,8 +18,10 @@
  **/
 
 #include "libserver/network/command/CommandProtocol.hpp"
+#include "libserver/util/Xor.hpp"
 
-#include <unordered_map>
+#include <array>
+#include <utility>
 
 namespace server::protocol
 {
@@ -28,7 +30,7 @@ namespace
 {
 
 //! Commands IDs mapped to the command names.
-const std::unordered_map<Command, std::string_view> commands = {
+constexpr std::pair<Command, std::string_view> CommandNameList[] = {
   {Command::AcCmdCLLogin, "AcCmdCLLogin"},
   {Command::AcCmdCLLoginOK, "AcCmdCLLoginOK"},
   {Command::AcCmdCLLoginCancel, "AcCmdCLLoginCancel"},
@@ -675,6 +677,19 @@ const std::unordered_map<Command, std::string_view> commands = {
   {Command::AcCmdUserRaceItemGet, "AcCmdUserRaceItemGet"},
 };
 
+//! Names of the commands indexed by the command IDs.
+//! Commands without a name are "n/a".
+constexpr auto CommandNames = []()
+{
+  std::array<std::string_view, static_cast<std::size_t>(Command::Count)> names{};
+  names.fill("n/a");
+  for (const auto& [command, name] : CommandNameList)
+  {
+    names[static_cast<std::size_t>(command)] = name;
+  }
+  return names;
+}();
+
 } // namespace
 
 MessageMagic decode_message_magic(uint32_t value)
@@ -708,10 +723,25 @@ uint32_t encode_message_magic(MessageMagic magic)
   return encoded;
 }
 
+void ApplyXorCode(
+  const XorCode& code,
+  std::span<const std::byte> source,
+  std::span<std::byte> sink)
+{
+  util::XorWithKey(code, source, sink);
+}
+
+void ApplyXorCode(
+  const XorCode& code,
+  std::span<std::byte> data)
+{
+  util::XorWithKey(code, data);
+}
+
 std::string_view GetCommandName(Command command)
 {
-  const auto commandIter = commands.find(command);
-  return commandIter == commands.cend() ? "n/a" : commandIter->second;
+  const auto index = static_cast<std::size_t>(command);
+  return index < CommandNames.size() ? CommandNames[index] : "n/a";
 }
 
 } // namespace server
@@ -19,9 +19,11 @@
 
 #include "libserver/network/command/CommandServer.hpp"
 
-#include "libserver/util/Deferred.hpp"
 #include "libserver/util/Util.hpp"
 
+#include <cstring>
+#include <filesystem>
+#include <format>
 #include <ranges>
 #include <stacktrace>
 
@@ -40,31 +42,6 @@ constexpr std::size_t MaxCommandDataSize = 8192;
 //! That is command data size + size of the message magic.
 constexpr std::size_t MaxCommandSize = MaxCommandDataSize + sizeof(protocol::MessageMagic);
 
-//! Reads every specified byte of the source stream,
-//! performs XOR operation on that byte with the specified sliding key
-//! and writes the result to the sink stream.
-//!
-//! @param key Xor Key
-//! @param source Source stream.
-//! @param sink Sink stream.
-void XorAlgorithm(
-  const protocol::XorCode& key,
-  SourceStream& source,
-  SinkStream& sink)
-{
-  for (std::size_t idx = 0; idx < source.Size(); idx++)
-  {
-    const auto shift = idx % 4;
-
-    // Read a byte.
-    std::byte v;
-    source.Read(v);
-
-    // Xor it with the key.
-    sink.Write(v ^ key[shift]);
-  }
-}
-
 bool IsMuted(protocol::Command id)
 {
   return id == protocol::Command::AcCmdCLHeartbeat
@@ -109,9 +86,41 @@ int32_t CommandClient::GetRollingCodeInt() const
   return *reinterpret_cast<const int32_t*>(_rollingCode.data());
 }
 
+void CommandClient::WriteClientCommand(
+  uint16_t commandId,
+  std::span<const std::byte> commandData,
+  std::vector<std::byte>& output)
+{
+  // The padding is derived from the rolled code, which rolls only for commands with data.
+  std::size_t padding = 0;
+  if (not commandData.empty())
+  {
+    RollCode();
+    padding = static_cast<uint32_t>(GetRollingCodeInt()) & 7;
+  }
+
+  const auto scrambledDataSize = commandData.size() + padding;
+  const uint32_t magic = protocol::encode_message_magic({
+    .id = commandId,
+    .length = static_cast<uint16_t>(sizeof(protocol::MessageMagic) + scrambledDataSize)});
+
+  const auto origin = output.size();
+  output.resize(origin + sizeof(magic) + scrambledDataSize);
+  std::memcpy(output.data() + origin, &magic, sizeof(magic));
+
+  const std::span scrambledData(output.data() + origin + sizeof(magic), scrambledDataSize);
+  std::memcpy(scrambledData.data(), commandData.data(), commandData.size());
+  if (not commandData.empty())
+    protocol::ApplyXorCode(_rollingCode, scrambledData);
+}
+
 CommandServer::CommandServer(
-  EventHandlerInterface& networkEventHandler)
-  : _eventHandler(networkEventHandler)
+  EventHandlerInterface& networkEventHandler,
+  Executor::Strand& handlerStrand)
+  : _handlers(static_cast<std::size_t>(protocol::Command::Count))
+  , _handlerSections(static_cast<std::size_t>(protocol::Command::Count))
+  , _eventHandler(networkEventHandler)
+  , _handlerStrand(handlerStrand)
   , _serverNetworkEventHandler(*this)
   , _server(_serverNetworkEventHandler)
 {
@@ -121,14 +130,29 @@ CommandServer::~CommandServer()
 {
 }
 
-void CommandServer::BeginHost(const asio::ip::address& address, uint16_t port)
+void CommandServer::BeginHost(
+  const asio::ip::address& address,
+  uint16_t port,
+  const network::ServerSettings& settings)
 {
+  if (not settings.captureDirectory.empty())
+  {
+    std::filesystem::create_directories(settings.captureDirectory);
+    const auto capturePath = network::CaptureWriter::MakePath(settings.captureDirectory, port);
+
+    _capture = std::make_unique<network::CaptureWriter>(
+      capturePath,
+      network::CaptureProtocol::Command,
+      port);
+    spdlog::info("Capturing the commands received on port {} to '{}'", port, capturePath.string());
+  }
+
   _serverThread = std::thread(
-    [this, address, port]()
+    [this, address, port, settings]()
     {
       try
       {
-        _server.Begin(address, port);
+        _server.Begin(address, port, settings);
       }
       catch (const std::exception& x)
       {
@@ -151,6 +175,12 @@ void CommandServer::EndHost()
 
   _server.End();
   _serverThread.join();
+
+  if (_capture)
+  {
+    _capture->Flush();
+    _capture.reset();
+  }
 }
 
 asio::ip::address_v4 CommandServer::GetClientAddress(ClientId clientId)
@@ -165,7 +195,29 @@ void CommandServer::DisconnectClient(ClientId clientId)
 
 void CommandServer::SetCode(ClientId client, protocol::XorCode code)
 {
-  _clients[client].SetCode(code);
+  {
+    const auto clientState = GetClientState(client);
+    std::scoped_lock lock(clientState->mutex);
+    clientState->client.SetCode(code);
+  }
+
+  if (_capture)
+    _capture->WriteCodeChanged(client, code);
+}
+
+network::WriteQueueMetrics CommandServer::GetClientWriteQueueMetrics(ClientId clientId)
+{
+  return _server.GetClient(clientId)->GetWriteQueueMetrics();
+}
+
+std::shared_ptr<CommandServer::ClientState> CommandServer::GetClientState(ClientId clientId)
+{
+  auto client = _server.GetClient(clientId);
+  auto* const clientState = client->GetUserData<ClientState>();
+  if (clientState == nullptr)
+    throw std::runtime_error("Client did not connect yet");
+
+  return {std::move(client), clientState};
 }
 
 CommandServer::NetworkEventHandler::NetworkEventHandler(
@@ -176,55 +228,74 @@ CommandServer::NetworkEventHandler::NetworkEventHandler(
 
 void CommandServer::NetworkEventHandler::HandleNetworkTick()
 {
-  _commandServer._eventHandler.HandleNetworkTick();
+  _commandServer._handlerStrand.Post([this]()
+  {
+    _commandServer._eventHandler.HandleNetworkTick();
+  });
 }
 
 void CommandServer::NetworkEventHandler::OnClientConnected(
   network::ClientId clientId)
 {
-  _commandServer._eventHandler.HandleClientConnected(clientId);
+  // The protocol state lives with the connection.
+  _commandServer._server.GetClient(clientId)->EmplaceUserData<ClientState>();
+
+  if (_commandServer._capture)
+    _commandServer._capture->WriteConnected(clientId);
+
+  _commandServer._handlerStrand.Post([this, clientId]()
+  {
+    _commandServer._eventHandler.HandleClientConnected(clientId);
+  });
 }
 
 void CommandServer::NetworkEventHandler::OnClientDisconnected(
   network::ClientId clientId)
 {
-  _commandServer._eventHandler.HandleClientDisconnected(clientId);
+  if (_commandServer._capture)
+    _commandServer._capture->WriteDisconnected(clientId);
+
+  // The clients which received droppable commands faster than they could be written.
+  const auto writeQueueMetrics = _commandServer.GetClientWriteQueueMetrics(clientId);
+  if (writeQueueMetrics.coalescedWriteCount > 0 || writeQueueMetrics.droppedWriteCount > 0)
+  {
+    spdlog::debug(
+      "Client {} disconnected with {} coalesced and {} dropped writes, peak write queue size {} bytes",
+      clientId,
+      writeQueueMetrics.coalescedWriteCount,
+      writeQueueMetrics.droppedWriteCount,
+      writeQueueMetrics.peakByteCount);
+  }
+
+  _commandServer._handlerStrand.Post([this, clientId]()
+  {
+    _commandServer._eventHandler.HandleClientDisconnected(clientId);
+  });
 }
 
 size_t CommandServer::NetworkEventHandler::OnClientData(
   network::ClientId clientId,
   const std::span<const std::byte>& data)
 {
-  SourceStream commandStream(data);
+  // The protocol state of the client, looked up once for all the commands in the data.
+  const auto clientState = _commandServer.GetClientState(clientId);
 
-  while (commandStream.GetCursor() != commandStream.Size())
+  // Cursor of the first byte of data that was not consumed yet.
+  std::size_t cursor = 0;
+
+  while (cursor != data.size())
   {
     // The size of the buffer that was not read yet.
-    const size_t bufferedDataSize = commandStream.Size() - commandStream.GetCursor();
+    const size_t bufferedDataSize = data.size() - cursor;
 
     // Do not continue if the available data does not contain the data
     // for the message magic.
     if (bufferedDataSize < sizeof(protocol::MessageMagic))
       break;
 
-    // Store the origin cursor position before reading the command.
-    // This is so we can return to it if the command is not completely buffered.
-    const auto streamOrigin = commandStream.GetCursor();
-    bool isCommandBufferedWhole = true;
-
-    const Deferred deferredResetCommandStreamCursor(
-      [streamOrigin, &commandStream, &isCommandBufferedWhole]()
-      {
-        // If the command was not buffered whole,
-        // reset the stream to the cursor before the command was read,
-        // so that it may be read when more data arrive.
-        if (not isCommandBufferedWhole)
-          commandStream.Seek(streamOrigin);
-      });
-
     // Read the message magic.
     uint32_t magicValue{};
-    commandStream.Read(magicValue);
+    std::memcpy(&magicValue, data.data() + cursor, sizeof(magicValue));
 
     const auto magic = protocol::decode_message_magic(magicValue);
 
@@ -255,33 +326,38 @@ size_t CommandServer::NetworkEventHandler::OnClientData(
     const size_t availableDataSize = bufferedDataSize - sizeof(protocol::MessageMagic);
 
     // If all the required command data are not buffered,
-    // wait for them to arrive.
+    // wait for them to arrive. The cursor stays before the magic,
+    // so that the command is read again when more data arrive.
     if (commandDataSize > availableDataSize)
-    {
-      isCommandBufferedWhole = false;
       break;
-    }
-
-    // Buffer for the command data.
-    std::array<std::byte, MaxCommandDataSize> commandDataBuffer{};
 
-    // Read the command data.
-    commandStream.Read(
-      commandDataBuffer.data(),
+    // The scrambled command data, still in the read buffer.
+    const auto commandData = data.subspan(
+      cursor + sizeof(protocol::MessageMagic),
       commandDataSize);
 
-    SourceStream commandDataStream(nullptr);
-
-    auto& client = _commandServer._clients[clientId];
+    // The command is buffered whole, consume it.
+    cursor += magic.length;
 
     const auto commandId = static_cast<protocol::Command>(magic.id);
 
+    // The command is unscrambled and decoded to a pooled dispatch,
+    // which carries it to the handler strand.
+    auto& dispatch = _commandServer._dispatchPool.Acquire();
+    dispatch.clientId = clientId;
+    dispatch.commandId = magic.id;
+
     // Validate and process the command data.
     if (commandDataSize > 0)
     {
-      client.RollCode();
+      protocol::XorCode rollingCode{};
+      {
+        std::scoped_lock lock(clientState->mutex);
+        clientState->client.RollCode();
+        rollingCode = clientState->client.GetRollingCode();
+      }
 
-      const uint32_t code = client.GetRollingCodeInt();
+      const uint32_t code = *reinterpret_cast<const uint32_t*>(rollingCode.data());
 
       // Extract the padding from the code.
       const auto padding = code & 7;
@@ -290,6 +366,7 @@ size_t CommandServer::NetworkEventHandler::OnClientData(
       // size is smaller or equal to the generated padding.
       if (padding >= commandDataSize)
       {
+        _commandServer._dispatchPool.Release(dispatch);
         throw std::runtime_error(
           std::format(
             "Malformed command {}: Bad command data size '{}', padding is {}.",
@@ -301,22 +378,14 @@ size_t CommandServer::NetworkEventHandler::OnClientData(
 
       const auto actualCommandDataSize = commandDataSize - padding;
 
-      // Source stream of the command data.
-      SourceStream dataSourceStream(
-        {commandDataBuffer.begin(), commandDataSize});
-      // Sink stream of the command data.
-      // Correctly points to the same buffer.
-      SinkStream dataSinkStream(
-        {commandDataBuffer.begin(), commandDataBuffer.end()});
-
-      // Apply XOR algorithm to the data.
-      XorAlgorithm(
-        client.GetRollingCode(),
-        dataSourceStream,
-        dataSinkStream);
-
-      commandDataStream = std::move(SourceStream(
-        {commandDataBuffer.begin(), actualCommandDataSize}));
+      // Unscramble the command data straight from the read buffer
+      // to the dispatch in a single pass.
+      const auto commandDataSpace = dispatch.PrepareData(commandDataSize);
+      protocol::ApplyXorCode(
+        rollingCode,
+        commandData,
+        commandDataSpace);
+      dispatch.CommitData(actualCommandDataSize);
 
       if (_commandServer.debugIncomingCommandData
         && not IsMuted(commandId))
@@ -332,14 +401,25 @@ size_t CommandServer::NetworkEventHandler::OnClientData(
           commandDataSize,
           padding,
           actualCommandDataSize,
-          util::GenerateByteDump({commandDataBuffer.data(), commandDataSize}));
+          util::GenerateByteDump(commandDataSpace));
       }
     }
 
+    if (_commandServer._capture)
+    {
+      _commandServer._capture->WriteCommand(
+        clientId,
+        magic.id,
+        dispatch.GetData());
+    }
+
     // Find the handler of the command.
-    const auto handlerIter = _commandServer._handlers.find(commandId);
-    if (handlerIter == _commandServer._handlers.cend())
+    const auto handlerIndex = static_cast<std::size_t>(magic.id);
+    if (handlerIndex >= _commandServer._handlers.size()
+      || not _commandServer._handlers[handlerIndex].decode)
     {
+      _commandServer._dispatchPool.Release(dispatch);
+
       if (_commandServer.debugCommands
         && not IsMuted(commandId))
       {
@@ -348,107 +428,209 @@ size_t CommandServer::NetworkEventHandler::OnClientData(
           GetCommandName(commandId),
           magic.id);
       }
+
+      continue;
     }
-    else
+
+    // Decode the command on this thread, so that the decoding of the clients
+    // runs in parallel, and handle it on the handler strand.
+    try
+    {
+      _commandServer._handlers[handlerIndex].decode(dispatch);
+    }
+    catch (const std::exception& x)
     {
-      const auto& handler = handlerIter->second;
-      // Handler validity is checked when registering.
-      assert(handler);
+      _commandServer._dispatchPool.Release(dispatch);
+
+      spdlog::error(
+        "Unhandled exception decoding command '{}' (0x{:x}): {}",
+        protocol::GetCommandName(commandId),
+        magic.id,
+        x.what());
+      continue;
+    }
 
-      try
-      {
-        // Call the handler.
-        handler(clientId, commandDataStream);
-      }
-      catch (const std::exception& x)
-      {
-        spdlog::error(
-          "Unhandled exception handling command '{}' (0x{:x}): {}",
-          protocol::GetCommandName(commandId),
-          magic.id,
-          x.what());
-      }
+    // The task captures only pointers, so it is stored without an allocation.
+    _commandServer._handlerStrand.Post([this, &dispatch]()
+    {
+      HandleDispatch(dispatch);
+    });
+  }
 
-      // There shouldn't be any left-over data in the stream.
-      assert(commandDataStream.GetCursor() == commandDataStream.Size());
+  return cursor;
+}
 
-      if (_commandServer.debugCommands
-        && not IsMuted(commandId))
-      {
-        spdlog::debug(
-          "Handled command '{}' (0x{:x})",
-          GetCommandName(commandId),
-          magic.id);
-      }
-    }
+void CommandServer::NetworkEventHandler::HandleDispatch(
+  network::CommandDispatch& dispatch)
+{
+  const auto commandId = static_cast<protocol::Command>(dispatch.commandId);
+  const auto handlerIndex = static_cast<std::size_t>(dispatch.commandId);
+
+  try
+  {
+    Profiler::Scope profilerScope(
+      Profiler::Global(),
+      _commandServer._handlerSections[handlerIndex]);
+
+    // Call the handler.
+    _commandServer._handlers[handlerIndex].handle(dispatch.clientId, dispatch);
+  }
+  catch (const std::exception& x)
+  {
+    spdlog::error(
+      "Unhandled exception handling command '{}' (0x{:x}): {}",
+      protocol::GetCommandName(commandId),
+      dispatch.commandId,
+      x.what());
+    _commandServer._dispatchPool.Release(dispatch);
+    return;
   }
 
-  return commandStream.GetCursor();
+  if (_commandServer.debugCommands
+    && not IsMuted(commandId))
+  {
+    spdlog::debug(
+      "Handled command '{}' (0x{:x})",
+      GetCommandName(commandId),
+      dispatch.commandId);
+  }
+
+  _commandServer._dispatchPool.Release(dispatch);
 }
 
-void CommandServer::SendCommand(
-  ClientId clientId,
+void CommandServer::RegisterHandlerSection(protocol::Command commandId)
+{
+  _handlerSections[static_cast<std::size_t>(commandId)] = Profiler::Global().RegisterSection(
+    std::format("command/{}", GetCommandName(commandId)));
+}
+
+std::size_t CommandServer::WriteCommand(
+  std::span<std::byte> buffer,
   protocol::Command commandId,
-  CommandSupplier supplier)
+  const CommandSupplier& supplier)
 {
-  try
+  SinkStream commandSink(buffer);
+
+  const auto streamOrigin = commandSink.GetCursor();
+  commandSink.Seek(streamOrigin + sizeof(protocol::MessageMagic));
+
+  // Write the message data.
+  supplier(commandSink);
+
+  // Command size is the size of the whole command.
+  const size_t commandSize = commandSink.GetCursor();
+
+  if (debugOutgoingCommandData
+    && not IsMuted(commandId))
   {
-    _server.GetClient(clientId)->QueueWrite(
-      [this, commandId, supplier = std::move(supplier)](asio::streambuf& writeBuffer)
-      {
-        const auto mutableBuffer = writeBuffer.prepare(MaxCommandSize);
-        const auto writeBufferView = std::span(
-          static_cast<std::byte*>(mutableBuffer.data()),
-          mutableBuffer.size());
+    spdlog::debug("Write data for command '{}' (0x{:X}),\n\n"
+      "Command data size: {} \n"
+      "Data dump: \n\n{}\n",
+      GetCommandName(commandId),
+      static_cast<uint32_t>(commandId),
+      commandSize,
+      util::GenerateByteDump(
+        buffer.subspan(
+          sizeof(protocol::MessageMagic),
+          commandSize - sizeof(protocol::MessageMagic))));
+  }
 
-        SinkStream commandSink(writeBufferView);
+  // Traverse back the stream before the message data,
+  // and write the message magic.
+  commandSink.Seek(streamOrigin);
 
-        const auto streamOrigin = commandSink.GetCursor();
-        commandSink.Seek(streamOrigin + sizeof(protocol::MessageMagic));
+  // Write the message magic.
+  const protocol::MessageMagic magic{
+    .id = static_cast<uint16_t>(commandId),
+    .length = static_cast<uint16_t>(commandSize)};
 
-        // Write the message data.
-        supplier(commandSink);
+  commandSink.Write(encode_message_magic(magic));
 
-        // Command size is the size of the whole command.
-        const size_t commandSize = commandSink.GetCursor();
+  return commandSize;
+}
 
-        if (debugOutgoingCommandData
-          && not IsMuted(commandId))
-        {
-          spdlog::debug("Write data for command '{}' (0x{:X}),\n\n"
-            "Command data size: {} \n"
-            "Data dump: \n\n{}\n",
-            GetCommandName(commandId),
-            static_cast<uint32_t>(commandId),
-            commandSize,
-            util::GenerateByteDump(
-              std::span(
-                static_cast<std::byte*>(mutableBuffer.data()) + sizeof(protocol::MessageMagic),
-                commandSize - sizeof(protocol::MessageMagic))));
-        }
+CommandServer::CommandPayload CommandServer::SerializeCommand(
+  protocol::Command commandId,
+  const CommandSupplier& supplier,
+  std::optional<std::size_t> commandDataSize)
+{
+  if (commandDataSize
+    && *commandDataSize <= MaxCommandDataSize)
+  {
+    // Serialize the command directly to the pooled buffer sized for it.
+    auto payload = network::BufferPool::Global().Acquire();
+    payload->resize(sizeof(protocol::MessageMagic) + *commandDataSize);
 
-        // Traverse back the stream before the message data,
-        // and write the message magic.
-        commandSink.Seek(streamOrigin);
+    const auto commandSize = WriteCommand(
+      *payload,
+      commandId,
+      supplier);
+    payload->resize(commandSize);
 
-        // Write the message magic.
-        const protocol::MessageMagic magic{
-          .id = static_cast<uint16_t>(commandId),
-          .length = static_cast<uint16_t>(commandSize)};
+    return payload;
+  }
 
-        commandSink.Write(encode_message_magic(magic));
-        writeBuffer.commit(magic.length);
+  // Scratch buffer for the serialization, sized to the largest command.
+  thread_local std::array<std::byte, MaxCommandSize> commandBuffer;
 
-        if (debugCommands
-          && not IsMuted(commandId))
-        {
-          spdlog::debug("Sent command message '{}' (0x{:X})",
-          GetCommandName(commandId),
-          static_cast<uint32_t>(commandId));
-        }
+  const auto commandSize = WriteCommand(
+    commandBuffer,
+    commandId,
+    supplier);
+
+  // Copy only the serialized command to the pooled buffer,
+  // which retains its capacity between uses.
+  auto payload = network::BufferPool::Global().Acquire();
+  payload->assign(
+    commandBuffer.begin(),
+    commandBuffer.begin() + commandSize);
+
+  return payload;
+}
+
+void CommandServer::SendCommand(
+  ClientId clientId,
+  protocol::Command commandId,
+  const CommandSupplier& supplier,
+  std::optional<std::size_t> commandDataSize)
+{
+  CommandPayload payload;
 
-        return commandSize;
-      });
+  try
+  {
+    payload = SerializeCommand(commandId, supplier, commandDataSize);
+  }
+  catch (const std::exception& x)
+  {
+    spdlog::error(
+      "Unhandled exception serializing command '{}' (0x{:X}) for client {}: {}",
+      GetCommandName(commandId),
+      static_cast<uint32_t>(commandId),
+      clientId,
+      x.what());
+    return;
+  }
+
+  SendCommandPayload(clientId, commandId, std::move(payload));
+}
+
+void CommandServer::SendCommandPayload(
+  ClientId clientId,
+  protocol::Command commandId,
+  CommandPayload payload,
+  network::CoalescingKey coalescingKey)
+{
+  try
+  {
+    _server.GetClient(clientId)->QueueWrite(std::move(payload), coalescingKey);
+
+    if (debugCommands
+      && not IsMuted(commandId))
+    {
+      spdlog::debug("Sent command message '{}' (0x{:X})",
+      GetCommandName(commandId),
+      static_cast<uint32_t>(commandId));
+    }
   }
   catch (std::exception&)
   {
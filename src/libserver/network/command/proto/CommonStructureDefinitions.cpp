@@ -24,50 +24,6 @@
 namespace server::protocol
 {
 
-void Item::Write(const Item& item, SinkStream& stream)
-{
-  stream.Write(item.uid)
-    .Write(item.tid)
-    .Write(item.expiresAt)
-    .Write(item.count);
-}
-
-void Item::Read(Item& item, SourceStream& stream)
-{
-  stream.Read(item.uid)
-    .Read(item.tid)
-    .Read(item.expiresAt)
-    .Read(item.count);
-}
-
-void StoredItem::Write(const StoredItem& item, SinkStream& stream)
-{
-  stream.Write(item.uid)
-    .Write(item.goodsSq)
-    .Write(item.status)
-    .Write(item.val3)
-    .Write(item.val4)
-    .Write(item.carrots)
-    .Write(item.priceId)
-    .Write(item.sender)
-    .Write(item.message)
-    .Write(item.dateAndTime);
-}
-
-void StoredItem::Read(StoredItem& item, SourceStream& stream)
-{
-  stream.Read(item.uid)
-    .Read(item.goodsSq)
-    .Read(item.status)
-    .Read(item.val3)
-    .Read(item.val4)
-    .Read(item.carrots)
-    .Read(item.priceId)
-    .Read(item.sender)
-    .Read(item.message)
-    .Read(item.dateAndTime);
-}
-
 void KeyboardOptions::Option::Write(const Option& option, SinkStream& stream)
 {
   stream.Write(option.secondaryKey)
@@ -22,25 +22,6 @@
 namespace server::protocol
 {
 
-void AcCmdCLLogin::Write(
-  const AcCmdCLLogin&,
-  SinkStream&)
-{
-  throw std::runtime_error("Not implemented.");
-}
-
-void AcCmdCLLogin::Read(
-  AcCmdCLLogin& command,
-  SourceStream& stream)
-{
-  stream.Read(command.constant0)
-    .Read(command.constant1)
-    .Read(command.loginId)
-    .Read(command.memberNo)
-    .Read(command.authKey)
-    .Read(command.val0);
-}
-
 void LobbyCommandLoginOK::SystemContent::Write(const SystemContent& command, SinkStream& stream)
 {
   stream.Write(static_cast<uint8_t>(command.values.size()));
@@ -272,10 +253,12 @@ void LobbyCommandCreateNicknameNotify::Read(
 }
 
 void AcCmdCLCreateNickname::Write(
-  const AcCmdCLCreateNickname&,
-  SinkStream&)
+  const AcCmdCLCreateNickname& command,
+  SinkStream& stream)
 {
-  throw std::runtime_error("Not implemented.");
+  stream.Write(command.nickname)
+    .Write(command.character)
+    .Write(command.requestedHorseTid);
 }
 
 void AcCmdCLCreateNickname::Read(
@@ -536,10 +519,18 @@ void LobbyCommandRoomListOK::Read(
 }
 
 void AcCmdCLMakeRoom::Write(
-  const AcCmdCLMakeRoom&,
-  SinkStream&)
+  const AcCmdCLMakeRoom& command,
+  SinkStream& stream)
 {
-  throw std::runtime_error("Not implemented.");
+  stream.Write(command.name)
+    .Write(command.password)
+    .Write(command.playerCount)
+    .Write(command.gameMode)
+    .Write(command.teamMode)
+    .Write(command.missionId)
+    .Write(command.unk3)
+    .Write(command.bitset)
+    .Write(command.unk4);
 }
 
 void AcCmdCLMakeRoom::Read(
@@ -569,10 +560,15 @@ void AcCmdCLMakeRoomOK::Write(
 }
 
 void AcCmdCLMakeRoomOK::Read(
-  AcCmdCLMakeRoomOK&,
-  SourceStream&)
+  AcCmdCLMakeRoomOK& command,
+  SourceStream& stream)
 {
-  throw std::runtime_error("Not implemented.");
+  stream.Read(command.roomUid)
+    .Read(command.oneTimePassword)
+    .Read(command.raceServerAddress)
+    .Read(command.raceServerPort)
+    .Read(command.unk2);
+  command.raceServerAddress = ntohl(command.raceServerAddress);
 }
 
 void AcCmdCLMakeRoomCancel::Write(
@@ -590,10 +586,12 @@ void AcCmdCLMakeRoomCancel::Read(
 }
 
 void AcCmdCLEnterRoom::Write(
-  const AcCmdCLEnterRoom&,
-  SinkStream&)
+  const AcCmdCLEnterRoom& command,
+  SinkStream& stream)
 {
-  throw std::runtime_error("Not implemented.");
+  stream.Write(command.roomUid)
+    .Write(command.password)
+    .Write(command.member3);
 }
 
 void AcCmdCLEnterRoom::Read(
@@ -617,10 +615,15 @@ void AcCmdCLEnterRoomOK::Write(
 }
 
 void AcCmdCLEnterRoomOK::Read(
-  AcCmdCLEnterRoomOK&,
-  SourceStream&)
+  AcCmdCLEnterRoomOK& command,
+  SourceStream& stream)
 {
-  throw std::runtime_error("Not implemented.");
+  stream.Read(command.roomUid)
+    .Read(command.oneTimePassword)
+    .Read(command.raceServerAddress)
+    .Read(command.raceServerPort)
+    .Read(command.member6);
+  command.raceServerAddress = ntohl(command.raceServerAddress);
 }
 
 void AcCmdCLEnterRoomCancel::Write(
@@ -740,10 +743,12 @@ void AcCmdCLRequestDailyQuestListOK::Read(
 }
 
 void AcCmdCLEnterRanch::Write(
-  const AcCmdCLEnterRanch&,
-  SinkStream&)
+  const AcCmdCLEnterRanch& command,
+  SinkStream& stream)
 {
-  throw std::runtime_error("Not implemented.");
+  stream.Write(command.rancherUid)
+    .Write(command.unk1)
+    .Write(command.unk2);
 }
 
 void AcCmdCLEnterRanch::Read(
@@ -766,10 +771,14 @@ void AcCmdCLEnterRanchOK::Write(
 }
 
 void AcCmdCLEnterRanchOK::Read(
-  AcCmdCLEnterRanchOK&,
-  SourceStream&)
+  AcCmdCLEnterRanchOK& command,
+  SourceStream& stream)
 {
-  throw std::runtime_error("Not implemented.");
+  stream.Read(command.rancherUid)
+    .Read(command.otp)
+    .Read(command.ranchAddress)
+    .Read(command.ranchPort);
+  command.ranchAddress = ntohl(command.ranchAddress);
 }
 
 void AcCmdCLEnterRanchCancel::Write(
@@ -790,7 +799,7 @@ void AcCmdCLGetMessengerInfo::Write(
   const AcCmdCLGetMessengerInfo&,
   SinkStream&)
 {
-  throw std::runtime_error("Not implemented.");
+  // Empty.
 }
 
 void AcCmdCLGetMessengerInfo::Read(
@@ -810,10 +819,12 @@ void AcCmdCLGetMessengerInfoOK::Write(
 }
 
 void AcCmdCLGetMessengerInfoOK::Read(
-  AcCmdCLGetMessengerInfoOK&,
-  SourceStream&)
+  AcCmdCLGetMessengerInfoOK& command,
+  SourceStream& stream)
 {
-  throw std::runtime_error("Not implemented.");
+  stream.Read(command.code)
+    .Read(command.ip)
+    .Read(command.port);
 }
 
 void AcCmdCLGetMessengerInfoCancel::Write(
@@ -904,7 +915,7 @@ void AcCmdCLHeartbeat::Write(
   const AcCmdCLHeartbeat&,
   SinkStream&)
 {
-  throw std::runtime_error("Not implemented.");
+  // Empty.
 }
 
 void AcCmdCLHeartbeat::Read(
@@ -1190,12 +1201,8 @@ void AcCmdLCPersonalInfo::CourseInformation::Write(const CourseInformation& comm
   {
     stream.Write(entry.courseId)
       .Write(entry.timesRaced)
-      .Write(entry.recordTime);
-
-    for (const auto& byte : entry.member4)
-    {
-      stream.Write(byte);
-    }
+      .Write(entry.recordTime)
+      .Write(std::span(entry.member4));
   }
 }
 
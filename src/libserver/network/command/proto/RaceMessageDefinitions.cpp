@@ -97,10 +97,12 @@ void WriteRoomDescription(SinkStream& stream, const RoomDescription& roomDescrip
 }
 
 void AcCmdCREnterRoom::Write(
-  const AcCmdCREnterRoom&,
-  SinkStream&)
+  const AcCmdCREnterRoom& command,
+  SinkStream& stream)
 {
-  throw std::logic_error("Not implemented.");
+  stream.Write(command.characterUid)
+    .Write(command.oneTimePassword)
+    .Write(command.roomUid);
 }
 
 void AcCmdCREnterRoom::Read(
@@ -314,7 +316,7 @@ void AcCmdCRLeaveRoom::Write(
   const AcCmdCRLeaveRoom&,
   SinkStream&)
 {
-  throw std::logic_error("Not implemented.");
+  // Empty.
 }
 
 void AcCmdCRLeaveRoom::Read(
@@ -353,10 +355,14 @@ void AcCmdCRLeaveRoomNotify::Read(
 }
 
 void AcCmdCRStartRace::Write(
-  const AcCmdCRStartRace&,
-  SinkStream&)
+  const AcCmdCRStartRace& command,
+  SinkStream& stream)
 {
-  throw std::logic_error("Not implemented.");
+  stream.Write(static_cast<uint8_t>(command.unk0.size()));
+  for (const auto& element : command.unk0)
+  {
+    stream.Write(element);
+  }
 }
 
 void AcCmdCRStartRace::Read(
@@ -553,7 +559,7 @@ void AcCmdCRLoadingComplete::Write(
   const AcCmdCRLoadingComplete&,
   SinkStream&)
 {
-  throw std::logic_error("Not implemented.");
+  // Empty.
 }
 
 void AcCmdCRLoadingComplete::Read(
@@ -578,10 +584,11 @@ void AcCmdCRLoadingCompleteNotify::Read(
 }
 
 void AcCmdCRChat::Write(
-  const AcCmdCRChat&,
-  SinkStream&)
+  const AcCmdCRChat& command,
+  SinkStream& stream)
 {
-  throw std::runtime_error("Not implemented");
+  stream.Write(command.message)
+    .Write(command.unknown);
 }
 
 void AcCmdCRChat::Read(
@@ -612,7 +619,7 @@ void AcCmdCRReadyRace::Write(
   const AcCmdCRReadyRace&,
   SinkStream&)
 {
-  throw std::runtime_error("Not implemented");
+  // Empty.
 }
 
 void AcCmdCRReadyRace::Read(
@@ -1067,35 +1074,6 @@ void AcCmdCRRequestMagicItemNotify::Read(
   throw std::runtime_error("Not implemented");
 }
 
-void AcCmdUserRaceUpdatePos::Write(
-  const AcCmdUserRaceUpdatePos&,
-  SinkStream&)
-{
-  throw std::runtime_error("Not implemented");
-}
-
-void AcCmdUserRaceUpdatePos::Read(
-  AcCmdUserRaceUpdatePos& command,
-  SourceStream& stream)
-{
-  stream.Read(command.oid);
-
-  for (auto& element : command.member2)
-  {
-    stream.Read(element);
-  }
-
-  for (auto& element : command.member3)
-  {
-    stream.Read(element);
-  }
-
-  stream.Read(command.member4)
-    .Read(command.member5)
-    .Read(command.member6)
-    .Read(command.member7);
-}
-
 void AcCmdRCRoomCountdown::Write(
   const AcCmdRCRoomCountdown& command,
   SinkStream& stream)
@@ -1188,11 +1166,7 @@ void AcCmdCRRelay::Read(
   uint16_t bufferSize;
   stream.Read(bufferSize);
   command.data.resize(bufferSize);
-
-  for (uint8_t& datum : command.data)
-  {
-    stream.Read(datum);
-  }
+  stream.Read(std::span(command.data));
 
   // Parse command parameters
   const std::span<const std::byte> payloadData = std::as_bytes(
@@ -1311,28 +1285,6 @@ void AcCmdCRRelay::Read(
   }
 }
 
-void AcCmdCRRelayNotify::Write(
-  const AcCmdCRRelayNotify& command,
-  SinkStream& stream)
-{
-  stream.Write(command.fromOid)
-    .Write(command.toOid)
-    .Write(command.payloadType);
-
-  stream.Write(static_cast<uint16_t>(command.data.size()));
-  for (const uint8_t datum : command.data)
-  {
-    stream.Write(datum);
-  }
-}
-
-void AcCmdCRRelayNotify::Read(
-  AcCmdCRRelayNotify&,
-  SourceStream&)
-{
-  throw std::runtime_error("Not implemented");
-}
-
 void AcCmdRCTeamSpurGauge::Write(
   const AcCmdRCTeamSpurGauge& command,
   SinkStream& stream)
@@ -136,10 +136,12 @@ void RanchCommandMountFamilyTreeCancel::Read(
 }
 
 void AcCmdCREnterRanch::Write(
-  const AcCmdCREnterRanch&,
-  SinkStream&)
+  const AcCmdCREnterRanch& command,
+  SinkStream& stream)
 {
-  throw std::runtime_error("Not implemented.");
+  stream.Write(command.characterUid)
+    .Write(command.otp)
+    .Write(command.rancherUid);
 }
 
 void AcCmdCREnterRanch::Read(
@@ -213,10 +215,57 @@ void AcCmdCREnterRanchOK::Write(
 }
 
 void AcCmdCREnterRanchOK::Read(
-  AcCmdCREnterRanchOK&,
-  SourceStream&)
+  AcCmdCREnterRanchOK& command,
+  SourceStream& stream)
 {
-  throw std::runtime_error("Not implemented.");
+  stream.Read(command.rancherUid)
+    .Read(command.rancherName)
+    .Read(command.ranchName);
+
+  // Read the ranch horses
+  uint8_t ranchHorseCount;
+  stream.Read(ranchHorseCount);
+  command.horses.resize(ranchHorseCount);
+  for (auto& horse : command.horses)
+  {
+    stream.Read(horse);
+  }
+
+  // Read the ranch characters
+  uint8_t ranchCharacterCount;
+  stream.Read(ranchCharacterCount);
+  command.characters.resize(ranchCharacterCount);
+  for (auto& character : command.characters)
+  {
+    stream.Read(character);
+  }
+
+  stream.Read(command.member6)
+    .Read(command.scramblingConstant)
+    .Read(command.ranchProgress);
+
+  // Read the ranch housing
+  uint8_t housingCount;
+  stream.Read(housingCount);
+  command.housing.resize(housingCount);
+  for (auto& housing : command.housing)
+  {
+    stream.Read(housing);
+  }
+
+  stream.Read(command.horseSlots)
+    .Read(command.member11)
+    .Read(command.bitset)
+    .Read(command.incubatorSlots)
+    .Read(command.incubatorUseCount);
+
+  for (auto& egg : command.incubator)
+  {
+    stream.Read(egg);
+  }
+
+  stream.Read(command.league)
+    .Read(command.member17);
 }
 
 void RanchCommandEnterRanchCancel::Write(
@@ -247,117 +296,87 @@ void RanchCommandEnterRanchNotify::Read(
   throw std::runtime_error("Not implemented.");
 }
 
-void AcCmdCRRanchSnapshot::FullSpatial::Write(
-  const FullSpatial& structure,
+void AcCmdCRRanchSnapshot::Write(
+  const AcCmdCRRanchSnapshot& command,
   SinkStream& stream)
 {
-  stream.Write(structure.ranchIndex)
-    .Write(structure.time)
-    .Write(structure.action)
-    .Write(structure.timer);
+  stream.Write(command.type);
 
-  for (const auto& byte : structure.member4)
-  {
-    stream.Write(byte);
-  }
-
-  for (const auto& byte : structure.matrix)
+  switch (command.type)
   {
-    stream.Write(byte);
+    case Full:
+      {
+        stream.Write(command.full);
+        break;
+      }
+    case Partial:
+      {
+        stream.Write(command.partial);
+        break;
+      }
+    default:
+      {
+        throw std::runtime_error(
+          std::format(
+            "Update type {} not implemented",
+            static_cast<uint32_t>(command.type)));
+      }
   }
-
-  stream.Write(structure.velocityX)
-    .Write(structure.velocityY)
-    .Write(structure.velocityZ);
 }
 
-void AcCmdCRRanchSnapshot::FullSpatial::Read(
-  FullSpatial& structure,
+void AcCmdCRRanchSnapshot::Read(
+  AcCmdCRRanchSnapshot& command,
   SourceStream& stream)
 {
-  stream.Read(structure.ranchIndex)
-    .Read(structure.time)
-    .Read(structure.action)
-    .Read(structure.timer);
-
-  for (auto& byte : structure.member4)
-  {
-    stream.Read(byte);
-  }
+  stream.Read(command.type);
 
-  for (auto& byte : structure.matrix)
+  switch (command.type)
   {
-    stream.Read(byte);
+    case Full:
+      {
+        stream.Read(command.full);
+        break;
+      }
+    case Partial:
+      {
+        stream.Read(command.partial);
+        break;
+      }
+    default:
+      {
+        throw std::runtime_error(
+          std::format(
+            "Update type {} not implemented",
+            static_cast<uint32_t>(command.type)));
+      }
   }
-
-  stream.Read(structure.velocityX)
-    .Read(structure.velocityY)
-    .Read(structure.velocityZ);
 }
 
-void AcCmdCRRanchSnapshot::PartialSpatial::Write(
-  const PartialSpatial& structure,
+void AcCmdCRRanchSnapshotView::Write(
+  const AcCmdCRRanchSnapshotView& command,
   SinkStream& stream)
 {
-  stream.Write(structure.ranchIndex)
-    .Write(structure.time)
-    .Write(structure.action)
-    .Write(structure.timer);
-
-  for (const auto& byte : structure.member4)
-  {
-    stream.Write(byte);
-  }
-
-  for (const auto& byte : structure.matrix)
-  {
-    stream.Write(byte);
-  }
-}
-
-void AcCmdCRRanchSnapshot::PartialSpatial::Read(
-  PartialSpatial& structure,
-  SourceStream& stream)
-{
-  stream.Read(structure.ranchIndex)
-    .Read(structure.time)
-    .Read(structure.action)
-    .Read(structure.timer);
-
-  for (auto& byte : structure.member4)
-  {
-    stream.Read(byte);
-  }
-
-  for (auto& byte : structure.matrix)
-  {
-    stream.Read(byte);
-  }
-}
-
-void AcCmdCRRanchSnapshot::Write(
-  const AcCmdCRRanchSnapshot&,
-  SinkStream&)
-{
-  throw std::runtime_error("Not implemented.");
+  stream.Write(command.type)
+    .Write(command.spatial);
 }
 
-void AcCmdCRRanchSnapshot::Read(
-  AcCmdCRRanchSnapshot& command,
+void AcCmdCRRanchSnapshotView::Read(
+  AcCmdCRRanchSnapshotView& command,
   SourceStream& stream)
 {
   stream.Read(command.type);
 
+  std::size_t spatialSize = 0;
   switch (command.type)
   {
-    case Full:
+    case AcCmdCRRanchSnapshot::Full:
       {
-        stream.Read(command.full);
+        spatialSize = *AcCmdCRRanchSnapshot::FullSpatial::Schema::FixedSize;
         break;
       }
-    case Partial:
+    case AcCmdCRRanchSnapshot::Partial:
       {
-        stream.Read(command.partial);
+        spatialSize = *AcCmdCRRanchSnapshot::PartialSpatial::Schema::FixedSize;
         break;
       }
     default:
@@ -368,6 +387,12 @@ void AcCmdCRRanchSnapshot::Read(
             static_cast<uint32_t>(command.type)));
       }
   }
+
+  command.spatial = stream.ReadView(spatialSize);
+
+  // Both of the spatials begin with the ranch index.
+  SourceStream spatialStream(command.spatial);
+  spatialStream.Read(command.ranchIndex);
 }
 
 void RanchCommandRanchSnapshotNotify::Write(
@@ -471,7 +496,7 @@ void AcCmdCRLeaveRanch::Write(
   const AcCmdCRLeaveRanch&,
   SinkStream&)
 {
-  throw std::runtime_error("Not implemented.");
+  // Empty.
 }
 
 void AcCmdCRLeaveRanch::Read(
@@ -513,7 +538,7 @@ void AcCmdCRHeartbeat::Write(
   const AcCmdCRHeartbeat&,
   SinkStream&)
 {
-  throw std::runtime_error("Not implemented.");
+  // Empty.
 }
 
 void AcCmdCRHeartbeat::Read(
@@ -1128,41 +1153,6 @@ void AcCmdCRGetItemFromStorage::Read(
   stream.Read(command.storageItemUid);
 }
 
-void AcCmdCRGetItemFromStorageOK::Write(
-  const AcCmdCRGetItemFromStorageOK& command,
-  SinkStream& stream)
-{
-  stream.Write(command.storageItemUid);
-  stream.Write(static_cast<uint8_t>(command.items.size()));
-  for (const auto& item : command.items)
-  {
-    stream.Write(item);
-  }
-  stream.Write(command.updatedCarrots);
-}
-
-void AcCmdCRGetItemFromStorageOK::Read(
-  AcCmdCRGetItemFromStorageOK&,
-  SourceStream&)
-{
-  throw std::runtime_error("Not implemented.");
-}
-
-void AcCmdCRGetItemFromStorageCancel::Write(
-  const AcCmdCRGetItemFromStorageCancel& command,
-  SinkStream& stream)
-{
-  stream.Write(command.storageItemUid)
-    .Write(command.status);
-}
-
-void AcCmdCRGetItemFromStorageCancel::Read(
-  AcCmdCRGetItemFromStorageCancel&,
-  SourceStream&)
-{
-  throw std::runtime_error("Not implemented.");
-}
-
 void RanchCommandCheckStorageItem::Write(
   const AcCmdCRGetItemFromStorage&,
   SinkStream&)
@@ -1191,25 +1181,6 @@ void RanchCommandRequestNpcDressList::Read(
   stream.Read(command.unk0);
 }
 
-void RanchCommandRequestNpcDressListOK::Write(
-  const RanchCommandRequestNpcDressListOK& command,
-  SinkStream& stream)
-{
-  stream.Write(command.unk0);
-  stream.Write(static_cast<uint8_t>(command.dressList.size()));
-  for (const auto& item : command.dressList)
-  {
-    stream.Write(item);
-  }
-}
-
-void RanchCommandRequestNpcDressListOK::Read(
-  RanchCommandRequestNpcDressListOK&,
-  SourceStream&)
-{
-  throw std::runtime_error("Not implemented.");
-}
-
 void RanchCommandRequestNpcDressListCancel::Write(
   const RanchCommandRequestNpcDressListCancel&,
   SinkStream&)
@@ -1225,10 +1196,12 @@ void RanchCommandRequestNpcDressListCancel::Read(
 }
 
 void AcCmdCRRanchChat::Write(
-  const AcCmdCRRanchChat&,
-  SinkStream&)
+  const AcCmdCRRanchChat& command,
+  SinkStream& stream)
 {
-  throw std::runtime_error("Not implemented");
+  stream.Write(command.message)
+    .Write(command.unknown)
+    .Write(command.unknown2);
 }
 
 void AcCmdCRRanchChat::Read(
@@ -0,0 +1,40 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include "libserver/util/Arena.hpp"
+
+namespace server
+{
+
+Arena::Arena()
+  : _resource(_buffer.data(), _buffer.size(), std::pmr::new_delete_resource())
+{
+}
+
+std::pmr::memory_resource& Arena::GetResource() noexcept
+{
+  return _resource;
+}
+
+void Arena::Release() noexcept
+{
+  _resource.release();
+}
+
+} // namespace server
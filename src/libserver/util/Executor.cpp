@@ -0,0 +1,323 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include "libserver/util/Executor.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <spdlog/spdlog.h>
+
+namespace server
+{
+
+namespace
+{
+
+//! Executor of the worker running on the current thread.
+thread_local const Executor* CurrentExecutor = nullptr;
+//! Index of the worker running on the current thread.
+thread_local std::size_t CurrentWorkerIdx = 0;
+
+} // anon namespace
+
+Executor::Strand::Strand(Executor& executor)
+  : _executor(executor)
+{
+}
+
+void Executor::Strand::Post(Task task)
+{
+  {
+    std::scoped_lock lock(_tasksMutex);
+    _tasks.emplace_back(std::move(task));
+
+    // The strand is already posted, it runs the task once it gets to it.
+    if (_isScheduled)
+      return;
+    _isScheduled = true;
+  }
+
+  _executor.Post([this]()
+  {
+    Run();
+  });
+}
+
+void Executor::Strand::PostAt(Clock::time_point when, Task task)
+{
+  _executor.PostAt(when, [this, task = std::move(task)]() mutable
+  {
+    Post(std::move(task));
+  });
+}
+
+void Executor::Strand::Run()
+{
+  Task task;
+  {
+    std::scoped_lock lock(_tasksMutex);
+    task = std::move(_tasks.front());
+    _tasks.pop_front();
+  }
+
+  try
+  {
+    task();
+  }
+  catch (const std::exception& x)
+  {
+    spdlog::error("Unhandled exception in a strand task: {}", x.what());
+  }
+
+  {
+    std::scoped_lock lock(_tasksMutex);
+    if (_tasks.empty())
+    {
+      _isScheduled = false;
+      return;
+    }
+  }
+
+  // Repost the strand instead of running all its tasks at once,
+  // so that a busy strand does not starve the other tasks of the worker.
+  _executor.Post([this]()
+  {
+    Run();
+  });
+}
+
+Executor::~Executor()
+{
+  End();
+}
+
+void Executor::Begin(std::size_t workerCount)
+{
+  if (workerCount == 0)
+    workerCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+  {
+    std::scoped_lock lock(_idleMutex);
+    // The executor can be begun only once.
+    if (_shouldRun || not _workers.empty())
+      return;
+    _shouldRun = true;
+  }
+
+  for (std::size_t workerIdx = 0; workerIdx < workerCount; ++workerIdx)
+    _workers.emplace_back(std::make_unique<Worker>());
+
+  // The workers are started only after all of them exist, as they steal from each other.
+  for (std::size_t workerIdx = 0; workerIdx < workerCount; ++workerIdx)
+  {
+    _workers[workerIdx]->thread = std::thread([this, workerIdx]()
+    {
+      WorkerLoop(workerIdx);
+    });
+  }
+}
+
+void Executor::End()
+{
+  {
+    std::scoped_lock lock(_idleMutex);
+    if (not _shouldRun)
+      return;
+    _shouldRun = false;
+  }
+
+  _idleCondition.notify_all();
+
+  // The workers are kept, so that tasks posted after the end are only discarded.
+  for (const auto& worker : _workers)
+  {
+    if (worker->thread.joinable())
+      worker->thread.join();
+  }
+}
+
+void Executor::Post(Task task)
+{
+  if (_workers.empty())
+    throw std::runtime_error("Executor was not begun");
+
+  // Tasks posted by a worker stay on the worker, the idle workers steal them if it is busy.
+  const std::size_t workerIdx = CurrentExecutor == this
+    ? CurrentWorkerIdx
+    : _nextWorkerIdx.fetch_add(1, std::memory_order::relaxed) % _workers.size();
+
+  QueueTask(workerIdx, std::move(task));
+
+  // Acquiring the mutex makes sure a worker checking for the tasks
+  // before going idle either sees the task or is woken up.
+  {
+    std::scoped_lock lock(_idleMutex);
+  }
+  _idleCondition.notify_one();
+}
+
+void Executor::PostAt(Clock::time_point when, Task task)
+{
+  {
+    std::scoped_lock lock(_idleMutex);
+    _timedTasks.emplace_back(TimedTask{
+      .when = when,
+      .sequence = ++_timedTaskSequence,
+      .task = std::move(task)});
+    std::ranges::push_heap(_timedTasks, std::greater<>{});
+    UpdateEarliestTimedTaskTime();
+  }
+
+  // Wake a worker to wait for the new time point, in case it is earlier.
+  _idleCondition.notify_one();
+}
+
+std::size_t Executor::GetWorkerCount() const noexcept
+{
+  return _workers.size();
+}
+
+void Executor::WorkerLoop(std::size_t workerIdx)
+{
+  CurrentExecutor = this;
+  CurrentWorkerIdx = workerIdx;
+
+  while (true)
+  {
+    // The due timed tasks are posted before taking the next task,
+    // as the workers of a saturated executor never run out of tasks.
+    if (Clock::now().time_since_epoch().count()
+      >= _earliestTimedTaskTime.load(std::memory_order::relaxed))
+    {
+      std::scoped_lock lock(_idleMutex);
+      PostDueTimedTasks();
+    }
+
+    if (auto task = TakeTask(workerIdx))
+    {
+      try
+      {
+        (*task)();
+      }
+      catch (const std::exception& x)
+      {
+        spdlog::error("Unhandled exception in an executor task: {}", x.what());
+      }
+
+      continue;
+    }
+
+    std::unique_lock lock(_idleMutex);
+    if (not _shouldRun)
+      break;
+
+    if (PostDueTimedTasks())
+      continue;
+
+    if (_queuedTaskCount.load(std::memory_order::acquire) > 0)
+      continue;
+
+    // Wait for a task to be posted or for the earliest timed task to be due.
+    if (_timedTasks.empty())
+      _idleCondition.wait(lock);
+    else
+      _idleCondition.wait_until(lock, _timedTasks.front().when);
+  }
+
+  CurrentExecutor = nullptr;
+}
+
+std::optional<Executor::Task> Executor::TakeTask(std::size_t workerIdx)
+{
+  // Take the oldest task of the worker first.
+  {
+    auto& worker = *_workers[workerIdx];
+    std::scoped_lock lock(worker.tasksMutex);
+    if (not worker.tasks.empty())
+    {
+      auto task = std::move(worker.tasks.front());
+      worker.tasks.pop_front();
+      _queuedTaskCount.fetch_sub(1, std::memory_order::acq_rel);
+      return task;
+    }
+  }
+
+  // Steal the newest task of another worker.
+  for (std::size_t offset = 1; offset < _workers.size(); ++offset)
+  {
+    auto& victim = *_workers[(workerIdx + offset) % _workers.size()];
+    std::scoped_lock lock(victim.tasksMutex);
+    if (not victim.tasks.empty())
+    {
+      auto task = std::move(victim.tasks.back());
+      victim.tasks.pop_back();
+      _queuedTaskCount.fetch_sub(1, std::memory_order::acq_rel);
+      return task;
+    }
+  }
+
+  return std::nullopt;
+}
+
+bool Executor::PostDueTimedTasks()
+{
+  const auto now = Clock::now();
+  bool isAnyDue = false;
+
+  while (not _timedTasks.empty() && _timedTasks.front().when <= now)
+  {
+    std::ranges::pop_heap(_timedTasks, std::greater<>{});
+    // Spread the due tasks between the workers, the idle ones are woken below.
+    QueueTask(
+      _nextWorkerIdx.fetch_add(1, std::memory_order::relaxed) % _workers.size(),
+      std::move(_timedTasks.back().task));
+    _timedTasks.pop_back();
+    isAnyDue = true;
+  }
+
+  if (isAnyDue)
+  {
+    UpdateEarliestTimedTaskTime();
+    _idleCondition.notify_all();
+  }
+
+  return isAnyDue;
+}
+
+void Executor::UpdateEarliestTimedTaskTime() noexcept
+{
+  _earliestTimedTaskTime.store(
+    _timedTasks.empty()
+      ? std::numeric_limits<Clock::rep>::max()
+      : _timedTasks.front().when.time_since_epoch().count(),
+    std::memory_order::relaxed);
+}
+
+void Executor::QueueTask(std::size_t workerIdx, Task task)
+{
+  // Counted before it is queued, so that the count never drops below the tasks taken.
+  _queuedTaskCount.fetch_add(1, std::memory_order::acq_rel);
+
+  auto& worker = *_workers[workerIdx];
+  std::scoped_lock lock(worker.tasksMutex);
+  worker.tasks.emplace_back(std::move(task));
+}
+
+} // namespace server
@@ -13,8 +13,18 @@
 #include <unicode/uregex.h>
 #endif
 
+#include <array>
+#include <cstdint>
+#include <cstring>
 #include <format>
+#include <memory>
 #include <stdexcept>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define LOCALE_ASCII_SSE2
+#endif
 
 #include <spdlog/spdlog.h>
 
@@ -37,114 +47,418 @@ constexpr std::u16string_view KoreanLettersPattern = u"[가-힣]";
 constexpr std::u16string_view LatinLettersPattern = u"[A-Za-z0-9()\\[\\]{}]";
 constexpr std::u16string_view ValidLettersPattern = u"[^가-힣A-Za-z0-9()\\[\\]{}]";
 
-} // anon namespace
+//! First byte of the two-byte EUC-KR characters and of their second byte.
+constexpr uint8_t EucKrWideByteFirst = 0xA1;
+//! Last byte of the two-byte EUC-KR characters and of their second byte.
+constexpr uint8_t EucKrWideByteLast = 0xFE;
+//! Count of the values of a byte of the two-byte EUC-KR characters.
+constexpr std::size_t EucKrWideByteRange = EucKrWideByteLast - EucKrWideByteFirst + 1;
+
+//! Marks a missing mapping in the conversion tables.
+constexpr char16_t UnmappedCodeUnit = 0;
+constexpr uint16_t UnmappedEucKrCode = 0;
+
+//! Tables of the mappings between the two-byte EUC-KR characters
+//! and the basic multilingual plane of Unicode.
+//! The tables are built once from the ICU converter, so the mappings are exactly the same.
+//! Anything without a mapping is converted by ICU, including its error handling.
+struct EucKrTables
+{
+  //! Unicode code units of the two-byte EUC-KR characters,
+  //! indexed by the offsets of both bytes from `EucKrWideByteFirst`.
+  std::array<char16_t, EucKrWideByteRange * EucKrWideByteRange> toUnicode{};
+  //! Two-byte EUC-KR characters of the Unicode code units, the first byte in the high byte.
+  std::array<uint16_t, 0x10000> fromUnicode{};
+};
+
+//! Throws if the ICU operation failed.
+void CheckIcuError(UErrorCode error, std::string_view operation)
+{
+  if (error <= U_ZERO_ERROR)
+    return;
+
+  if (error == U_FILE_ACCESS_ERROR)
+  {
+    spdlog::error("Unicode ICU data for conversion {} not available", operation);
+  }
 
-std::string ToUtf8(const std::string& input)
+  throw std::runtime_error(
+    std::format(
+      "Failed to perform locale conversion {}: 0x{:x}",
+      operation,
+      static_cast<uint32_t>(error)));
+}
+
+//! Builds the conversion tables from the ICU EUC-KR converter.
+std::unique_ptr<EucKrTables> BuildEucKrTables()
 {
-  std::string output;
+  auto tables = std::make_unique<EucKrTables>();
+
+  UErrorCode error = U_ZERO_ERROR;
+  UConverter* converter = ucnv_open("EUC-KR", &error);
+  CheckIcuError(error, "between EUC-KR and Unicode");
+
+  const Deferred closeConverter([converter]()
+  {
+    ucnv_close(converter);
+  });
+
+  // Only the exact mappings are collected, anything else fails the conversion.
+  ucnv_setToUCallBack(converter, UCNV_TO_U_CALLBACK_STOP, nullptr, nullptr, nullptr, &error);
+  ucnv_setFromUCallBack(converter, UCNV_FROM_U_CALLBACK_STOP, nullptr, nullptr, nullptr, &error);
+  CheckIcuError(error, "between EUC-KR and Unicode");
+
+  for (std::size_t firstIdx = 0; firstIdx < EucKrWideByteRange; ++firstIdx)
+  {
+    for (std::size_t secondIdx = 0; secondIdx < EucKrWideByteRange; ++secondIdx)
+    {
+      const std::array character{
+        static_cast<char>(EucKrWideByteFirst + firstIdx),
+        static_cast<char>(EucKrWideByteFirst + secondIdx)};
+
+      std::array<UChar, 4> unicode{};
+      error = U_ZERO_ERROR;
+      const auto unicodeLength = ucnv_toUChars(
+        converter,
+        unicode.data(),
+        static_cast<int32_t>(unicode.size()),
+        character.data(),
+        static_cast<int32_t>(character.size()),
+        &error);
+      ucnv_resetToUnicode(converter);
+
+      if (U_FAILURE(error) || unicodeLength != 1 || unicode[0] == UnmappedCodeUnit)
+        continue;
+
+      tables->toUnicode[firstIdx * EucKrWideByteRange + secondIdx] = unicode[0];
+    }
+  }
+
+  // Collect the reverse mappings. Several characters might map to the same code unit,
+  // the one ICU picks is looked up rather than assumed.
+  for (const char16_t codeUnit : tables->toUnicode)
+  {
+    if (codeUnit == UnmappedCodeUnit || tables->fromUnicode[codeUnit] != UnmappedEucKrCode)
+      continue;
+
+    std::array<char, 8> character{};
+    error = U_ZERO_ERROR;
+    const auto characterLength = ucnv_fromUChars(
+      converter,
+      character.data(),
+      static_cast<int32_t>(character.size()),
+      reinterpret_cast<const UChar*>(&codeUnit),
+      1,
+      &error);
+    ucnv_resetFromUnicode(converter);
+
+    if (U_FAILURE(error) || characterLength != 2)
+      continue;
+
+    tables->fromUnicode[codeUnit] = static_cast<uint16_t>(
+      static_cast<uint8_t>(character[0]) << 8 | static_cast<uint8_t>(character[1]));
+  }
+
+  return tables;
+}
+
+//! Returns the conversion tables, built on the first use.
+const EucKrTables& GetEucKrTables()
+{
+  static const auto tables = BuildEucKrTables();
+  return *tables;
+}
+
+//! Returns the input up to the first null character,
+//! as the conversions stop there.
+std::string_view TruncateAtNull(std::string_view input) noexcept
+{
+  const auto nullPos = input.find('\0');
+  return nullPos == std::string_view::npos
+    ? input
+    : input.substr(0, nullPos);
+}
 
-  std::u16string unicodeOutput;
+//! Converts EUC-KR to UTF-8 with ICU, through UTF-16.
+void IcuToUtf8(std::string_view input, std::string& output)
+{
+  thread_local std::u16string unicodeOutput;
   unicodeOutput.resize(input.length() * 2);
 
-  thread_local UErrorCode error;
+  UErrorCode error = U_ZERO_ERROR;
 
   thread_local UConverter* koreanConv = ucnv_open("EUC-KR", &error);
-  ucnv_toUChars(
+  CheckIcuError(error, "from EUC-KR to Unicode");
+  const auto unicodeLength = ucnv_toUChars(
     koreanConv,
     unicodeOutput.data(),
     static_cast<int32_t>(unicodeOutput.size()),
     input.data(),
     static_cast<int32_t>(input.length()),
     &error);
-  if (error > U_ZERO_ERROR)
-  {
-    if (error == U_FILE_ACCESS_ERROR)
-    {
-      spdlog::error("Unicode ICU data for conversion from EUC-KR not available");
-    }
-
-    throw std::runtime_error(
-      std::format(
-        "Failed to perform locale conversion from EUC-KR to Unicode: 0x{:x}",
-        static_cast<uint32_t>(error)));
-  }
+  CheckIcuError(error, "from EUC-KR to Unicode");
 
   thread_local UConverter* utfConv = ucnv_open("UTF-8", &error);
+  CheckIcuError(error, "from Unicode to UTF-8");
   output.resize(UCNV_GET_MAX_BYTES_FOR_STRING(
-    unicodeOutput.length(),
+    unicodeLength,
     ucnv_getMaxCharSize(utfConv)));
 
-  ucnv_fromUChars(
+  const auto outputLength = ucnv_fromUChars(
     utfConv,
     output.data(),
     static_cast<int32_t>(output.size()),
     unicodeOutput.data(),
-    static_cast<int32_t>(unicodeOutput.length()),
+    unicodeLength,
     &error);
-  if (error > U_ZERO_ERROR)
-  {
-    throw std::runtime_error(
-      std::format(
-        "Failed to perform locale conversion from Unicode to UTF-8: 0x{:x}",
-        static_cast<uint32_t>(error)));
-  }
+  CheckIcuError(error, "from Unicode to UTF-8");
 
-  return {output.data()};
+  output.resize(static_cast<std::size_t>(outputLength));
 }
 
-std::string FromUtf8(const std::string& input)
+//! Converts UTF-8 to EUC-KR with ICU, through UTF-16.
+void IcuFromUtf8(std::string_view input, std::string& output)
 {
-  std::string output;
-
-  std::u16string unicodeOutput;
+  thread_local std::u16string unicodeOutput;
   unicodeOutput.resize(input.length() * 2);
 
-  thread_local UErrorCode error;
+  UErrorCode error = U_ZERO_ERROR;
 
   thread_local UConverter* utfConv = ucnv_open("UTF-8", &error);
-  ucnv_toUChars(
+  CheckIcuError(error, "from UTF-8 to Unicode");
+  const auto unicodeLength = ucnv_toUChars(
     utfConv,
     unicodeOutput.data(),
     static_cast<int32_t>(unicodeOutput.size()),
     input.data(),
     static_cast<int32_t>(input.length()),
     &error);
-  if (error > U_ZERO_ERROR)
-  {
-    throw std::runtime_error(
-      std::format(
-        "Failed to perform locale conversion from UTF-8 to Unicode: 0x{:x}",
-        static_cast<uint32_t>(error)));
-  }
+  CheckIcuError(error, "from UTF-8 to Unicode");
 
   thread_local UConverter* koreanConv = ucnv_open("EUC-KR", &error);
+  CheckIcuError(error, "from Unicode to EUC-KR");
   output.resize(UCNV_GET_MAX_BYTES_FOR_STRING(
-    unicodeOutput.length(),
+    unicodeLength,
     ucnv_getMaxCharSize(koreanConv)));
 
-  ucnv_fromUChars(
+  const auto outputLength = ucnv_fromUChars(
     koreanConv,
     output.data(),
     static_cast<int32_t>(output.size()),
     unicodeOutput.data(),
-    static_cast<int32_t>(unicodeOutput.length()),
+    unicodeLength,
     &error);
-  if (error > U_ZERO_ERROR)
+  CheckIcuError(error, "from Unicode to EUC-KR");
+
+  output.resize(static_cast<std::size_t>(outputLength));
+}
+
+//! Converts EUC-KR to UTF-8 with the tables.
+//! @returns `true` if all the characters have a mapping, `false` otherwise.
+bool TableToUtf8(std::string_view input, std::string& output)
+{
+  const auto& tables = GetEucKrTables();
+
+  // A two-byte EUC-KR character takes at most three bytes in UTF-8.
+  output.resize(input.size() * 3 / 2 + 1);
+  auto* out = reinterpret_cast<uint8_t*>(output.data());
+  const auto* const outBegin = out;
+
+  for (std::size_t idx = 0; idx < input.size();)
+  {
+    const auto first = static_cast<uint8_t>(input[idx]);
+    if (first < 0x80)
+    {
+      *out++ = first;
+      ++idx;
+      continue;
+    }
+
+    if (idx + 1 >= input.size())
+      return false;
+
+    const auto second = static_cast<uint8_t>(input[idx + 1]);
+    if (first < EucKrWideByteFirst || first > EucKrWideByteLast
+      || second < EucKrWideByteFirst || second > EucKrWideByteLast)
+    {
+      return false;
+    }
+
+    const char16_t codeUnit = tables.toUnicode[
+      (first - EucKrWideByteFirst) * EucKrWideByteRange + (second - EucKrWideByteFirst)];
+    if (codeUnit == UnmappedCodeUnit)
+      return false;
+
+    if (codeUnit < 0x800)
+    {
+      *out++ = static_cast<uint8_t>(0xC0 | codeUnit >> 6);
+      *out++ = static_cast<uint8_t>(0x80 | (codeUnit & 0x3F));
+    }
+    else
+    {
+      *out++ = static_cast<uint8_t>(0xE0 | codeUnit >> 12);
+      *out++ = static_cast<uint8_t>(0x80 | (codeUnit >> 6 & 0x3F));
+      *out++ = static_cast<uint8_t>(0x80 | (codeUnit & 0x3F));
+    }
+
+    idx += 2;
+  }
+
+  output.resize(static_cast<std::size_t>(out - outBegin));
+  return true;
+}
+
+//! Converts UTF-8 to EUC-KR with the tables.
+//! @returns `true` if the input is well-formed and all the characters have a mapping,
+//!          `false` otherwise.
+bool TableFromUtf8(std::string_view input, std::string& output)
+{
+  const auto& tables = GetEucKrTables();
+
+  // A character takes at most as many bytes in EUC-KR as in UTF-8.
+  output.resize(input.size());
+  auto* out = reinterpret_cast<uint8_t*>(output.data());
+  const auto* const outBegin = out;
+
+  const auto* in = reinterpret_cast<const uint8_t*>(input.data());
+  const auto* const inEnd = in + input.size();
+
+  const auto isContinuation = [](uint8_t byte)
+  {
+    return (byte & 0xC0) == 0x80;
+  };
+
+  while (in < inEnd)
   {
-    if (error == U_FILE_ACCESS_ERROR)
+    const uint8_t first = *in;
+    if (first < 0x80)
+    {
+      *out++ = first;
+      ++in;
+      continue;
+    }
+
+    // Decode the code unit, rejecting anything but the well-formed sequences
+    // of the basic multilingual plane. Overlong forms and surrogates are left to ICU.
+    char16_t codeUnit{};
+    if (first >= 0xC2 && first <= 0xDF)
     {
-      spdlog::error("Unicode ICU data for conversion to EUC-KR not available");
+      if (inEnd - in < 2 || not isContinuation(in[1]))
+        return false;
+
+      codeUnit = static_cast<char16_t>((first & 0x1F) << 6 | (in[1] & 0x3F));
+      in += 2;
+    }
+    else if (first >= 0xE0 && first <= 0xEF)
+    {
+      if (inEnd - in < 3 || not isContinuation(in[1]) || not isContinuation(in[2]))
+        return false;
+      if (first == 0xE0 && in[1] < 0xA0)
+        return false;
+      if (first == 0xED && in[1] >= 0xA0)
+        return false;
+
+      codeUnit = static_cast<char16_t>(
+        (first & 0x0F) << 12 | (in[1] & 0x3F) << 6 | (in[2] & 0x3F));
+      in += 3;
+    }
+    else
+    {
+      return false;
     }
 
-    throw std::runtime_error(
-      std::format(
-        "Failed to perform locale conversion from Unicode to EUC-KR: 0x{:x}",
-        static_cast<uint32_t>(error)));
+    const uint16_t character = tables.fromUnicode[codeUnit];
+    if (character == UnmappedEucKrCode)
+      return false;
+
+    *out++ = static_cast<uint8_t>(character >> 8);
+    *out++ = static_cast<uint8_t>(character);
   }
 
-  return {output.data()};
+  output.resize(static_cast<std::size_t>(out - outBegin));
+  return true;
 }
 
+} // anon namespace
+
+bool IsAscii(std::string_view input) noexcept
+{
+  const auto* data = reinterpret_cast<const uint8_t*>(input.data());
+  std::size_t size = input.size();
+
+#if defined(LOCALE_ASCII_SSE2)
+  for (; size >= 16; data += 16, size -= 16)
+  {
+    const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+    if (_mm_movemask_epi8(chunk) != 0)
+      return false;
+  }
+#endif
+
+  for (; size >= 8; data += 8, size -= 8)
+  {
+    uint64_t word;
+    std::memcpy(&word, data, sizeof(word));
+    if ((word & 0x8080'8080'8080'8080) != 0)
+      return false;
+  }
+
+  for (; size > 0; ++data, --size)
+  {
+    if (*data >= 0x80)
+      return false;
+  }
+
+  return true;
+}
+
+void ToUtf8(std::string_view input, std::string& output)
+{
+  input = TruncateAtNull(input);
+
+  // ASCII is the same in both of the encodings.
+  if (IsAscii(input))
+  {
+    output.assign(input);
+    return;
+  }
+
+  if (TableToUtf8(input, output))
+    return;
+
+  IcuToUtf8(input, output);
+}
+
+std::string ToUtf8(std::string_view input)
+{
+  std::string output;
+  ToUtf8(input, output);
+  return output;
+}
+
+void FromUtf8(std::string_view input, std::string& output)
+{
+  input = TruncateAtNull(input);
+
+  // ASCII is the same in both of the encodings.
+  if (IsAscii(input))
+  {
+    output.assign(input);
+    return;
+  }
+
+  if (TableFromUtf8(input, output))
+    return;
+
+  IcuFromUtf8(input, output);
+}
+
+std::string FromUtf8(std::string_view input)
+{
+  std::string output;
+  FromUtf8(input, output);
+  return output;
+}
 
 bool IsNameValid(
   const std::string& input,
@@ -0,0 +1,289 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include "libserver/util/Profiler.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <format>
+#include <new>
+#include <ranges>
+#include <stdexcept>
+
+namespace server
+{
+
+namespace
+{
+
+//! Serial number of the next profiler.
+std::atomic_uint64_t nextProfilerSerial{1};
+
+//! Adds to the counter. Only the owning thread writes to the counter,
+//! so the increment does not need to be atomic, only the loads and stores do.
+void Increment(std::atomic_uint64_t& counter, uint64_t value) noexcept
+{
+  counter.store(
+    counter.load(std::memory_order::relaxed) + value,
+    std::memory_order::relaxed);
+}
+
+std::size_t GetBucketIndex(Profiler::Clock::duration duration) noexcept
+{
+  const auto microseconds = std::chrono::duration_cast<std::chrono::microseconds>(
+    duration).count();
+  if (microseconds <= 0)
+    return 0;
+
+  return std::min<std::size_t>(
+    std::bit_width(static_cast<uint64_t>(microseconds)),
+    Profiler::BucketCount - 1);
+}
+
+} // anon namespace
+
+std::chrono::nanoseconds Profiler::Histogram::GetMeanDuration() const noexcept
+{
+  if (count == 0)
+    return {};
+  return totalDuration / count;
+}
+
+std::chrono::microseconds Profiler::Histogram::GetPercentileDuration(
+  double percentile) const noexcept
+{
+  if (count == 0)
+    return {};
+
+  const auto targetCount = std::max<uint64_t>(
+    1,
+    static_cast<uint64_t>(std::ceil(static_cast<double>(count) * percentile / 100.0)));
+
+  uint64_t cumulativeCount = 0;
+  for (std::size_t bucketIdx = 0; bucketIdx < buckets.size(); ++bucketIdx)
+  {
+    cumulativeCount += buckets[bucketIdx];
+    if (cumulativeCount >= targetCount)
+      return std::chrono::microseconds(uint64_t{1} << bucketIdx);
+  }
+
+  return std::chrono::microseconds(uint64_t{1} << (BucketCount - 1));
+}
+
+Profiler::Histogram& Profiler::Histogram::operator-=(const Histogram& other) noexcept
+{
+  count -= other.count;
+  totalDuration -= other.totalDuration;
+  for (std::size_t bucketIdx = 0; bucketIdx < buckets.size(); ++bucketIdx)
+    buckets[bucketIdx] -= other.buckets[bucketIdx];
+  return *this;
+}
+
+Profiler::Scope::Scope(Profiler& profiler, SectionId sectionId) noexcept
+  : _profiler(profiler)
+  , _sectionId(sectionId)
+  , _begin(Clock::now())
+{
+}
+
+Profiler::Scope::~Scope()
+{
+  _profiler.Record(_sectionId, Clock::now() - _begin);
+}
+
+Profiler::ThreadCounters::~ThreadCounters()
+{
+  for (auto& chunk : chunks)
+    delete chunk.load(std::memory_order::relaxed);
+}
+
+Profiler::Profiler()
+  : _serial(nextProfilerSerial.fetch_add(1, std::memory_order::relaxed))
+{
+}
+
+Profiler::~Profiler() = default;
+
+Profiler& Profiler::Global()
+{
+  static Profiler profiler;
+  return profiler;
+}
+
+Profiler::SectionId Profiler::RegisterSection(std::string_view name)
+{
+  std::scoped_lock lock(_sectionsMutex);
+
+  const auto [sectionIdIter, inserted] = _sectionIds.try_emplace(
+    std::string(name),
+    static_cast<SectionId>(_sectionNames.size()));
+  if (not inserted)
+    return sectionIdIter->second;
+
+  if (_sectionNames.size() >= MaxSectionCount)
+  {
+    _sectionIds.erase(sectionIdIter);
+    throw std::length_error(std::format("Couldn't register profiler section '{}', too many sections", name));
+  }
+
+  _sectionNames.emplace_back(name);
+  return sectionIdIter->second;
+}
+
+void Profiler::Record(SectionId sectionId, Clock::duration duration) noexcept
+{
+  if (sectionId >= MaxSectionCount)
+    return;
+
+  const auto threadCounters = GetThreadCounters();
+  if (threadCounters == nullptr)
+    return;
+
+  auto& chunkSlot = threadCounters->chunks[sectionId / SectionsPerChunk];
+  auto chunk = chunkSlot.load(std::memory_order::relaxed);
+  if (chunk == nullptr)
+  {
+    chunk = new (std::nothrow) Chunk();
+    if (chunk == nullptr)
+      return;
+    // Published to the collecting thread.
+    chunkSlot.store(chunk, std::memory_order::release);
+  }
+
+  auto& counters = (*chunk)[sectionId % SectionsPerChunk];
+  Increment(counters.count, 1);
+  Increment(
+    counters.totalDuration,
+    static_cast<uint64_t>(std::max<int64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count(),
+      0)));
+  Increment(counters.buckets[GetBucketIndex(duration)], 1);
+}
+
+std::vector<Profiler::Section> Profiler::Collect() const
+{
+  std::vector<Section> profile;
+  {
+    std::scoped_lock lock(_sectionsMutex);
+    profile.reserve(_sectionNames.size());
+    for (const auto& name : _sectionNames)
+      profile.emplace_back(Section{.name = name, .histogram = {}});
+  }
+
+  std::scoped_lock lock(_threadsMutex);
+  for (const auto& threadCounters : _threadCounters | std::views::values)
+  {
+    for (std::size_t chunkIdx = 0; chunkIdx < threadCounters->chunks.size(); ++chunkIdx)
+    {
+      const auto chunk = threadCounters->chunks[chunkIdx].load(std::memory_order::acquire);
+      if (chunk == nullptr)
+        continue;
+
+      for (std::size_t counterIdx = 0; counterIdx < chunk->size(); ++counterIdx)
+      {
+        const auto sectionId = chunkIdx * SectionsPerChunk + counterIdx;
+        if (sectionId >= profile.size())
+          break;
+
+        const auto& counters = (*chunk)[counterIdx];
+        auto& histogram = profile[sectionId].histogram;
+        histogram.count += counters.count.load(std::memory_order::relaxed);
+        histogram.totalDuration += std::chrono::nanoseconds(
+          counters.totalDuration.load(std::memory_order::relaxed));
+        for (std::size_t bucketIdx = 0; bucketIdx < BucketCount; ++bucketIdx)
+          histogram.buckets[bucketIdx] += counters.buckets[bucketIdx].load(std::memory_order::relaxed);
+      }
+    }
+  }
+
+  return profile;
+}
+
+void Profiler::Subtract(std::vector<Section>& profile, const std::vector<Section>& earlierProfile)
+{
+  const auto sectionCount = std::min(profile.size(), earlierProfile.size());
+  for (std::size_t sectionId = 0; sectionId < sectionCount; ++sectionId)
+    profile[sectionId].histogram -= earlierProfile[sectionId].histogram;
+}
+
+std::vector<std::string> Profiler::Format(
+  const std::vector<Section>& profile,
+  std::size_t limit)
+{
+  std::vector<const Section*> calledSections;
+  for (const auto& section : profile)
+  {
+    if (section.histogram.count > 0)
+      calledSections.emplace_back(&section);
+  }
+
+  std::ranges::sort(
+    calledSections,
+    [](const Section* lhs, const Section* rhs)
+    {
+      return lhs->histogram.totalDuration > rhs->histogram.totalDuration;
+    });
+
+  std::vector<std::string> lines;
+  for (const auto section : calledSections | std::views::take(limit))
+  {
+    const auto& histogram = section->histogram;
+    lines.emplace_back(std::format(
+      "{}: {} calls, total {}us, mean {}us, p50 <{}us, p99 <{}us",
+      section->name,
+      histogram.count,
+      std::chrono::duration_cast<std::chrono::microseconds>(histogram.totalDuration).count(),
+      std::chrono::duration_cast<std::chrono::microseconds>(histogram.GetMeanDuration()).count(),
+      histogram.GetPercentileDuration(50).count(),
+      histogram.GetPercentileDuration(99).count()));
+  }
+
+  return lines;
+}
+
+Profiler::ThreadCounters* Profiler::GetThreadCounters() noexcept
+{
+  // Counters of the thread for the last profiler it recorded to.
+  thread_local struct
+  {
+    uint64_t profilerSerial{0};
+    ThreadCounters* counters{nullptr};
+  } threadCache;
+
+  if (threadCache.profilerSerial == _serial)
+    return threadCache.counters;
+
+  try
+  {
+    std::scoped_lock lock(_threadsMutex);
+    auto& counters = _threadCounters[std::this_thread::get_id()];
+    if (not counters)
+      counters = std::make_unique<ThreadCounters>();
+
+    threadCache = {.profilerSerial = _serial, .counters = counters.get()};
+    return counters.get();
+  }
+  catch (const std::exception&)
+  {
+    return nullptr;
+  }
+}
+
+} // namespace server
@@ -22,61 +22,150 @@
 namespace server
 {
 
-Scheduler::Scheduler()
+Scheduler::Scheduler(Wakeup& wakeup)
+  : _wakeup(&wakeup)
 {
-  _jobIterator = _jobs.cend();
 }
 
 void Scheduler::Tick()
 {
-  // Make sure there is jobs to execute.
-  if (_jobs.empty())
-    return;
-
-  // If the job iterator is at the end cycle it back to the front,
-  // since the job list is not empty.
-  if (_jobIterator == _jobs.cend())
+  // Only the jobs queued before the tick and due at its beginning are executed,
+  // so that a task re-queueing itself does not keep the tick going.
+  const auto now = Clock::now();
+  JobId lastJobId{};
   {
-    _jobIterator = _jobs.begin();
+    std::scoped_lock lock(_jobsMutex);
+    lastJobId = _lastJobId;
   }
 
-  // Iterate over the jobs until you find one that can be executed,
-  // execute it and remove it from the job list.
-  while (true)
+  // Entries of the jobs queued during the tick for a time point already due,
+  // returned to the heap once the tick ends.
+  std::vector<ScheduledJob> deferredJobs;
+  const auto returnDeferredJobs = [this, &deferredJobs]()
+  {
+    std::scoped_lock lock(_jobsMutex);
+    for (const auto& job : deferredJobs)
+      _jobHeap.emplace(job);
+  };
+
+  try
   {
-    const auto& job = *_jobIterator;
-    if (Clock::now() >= job.when)
+    while (true)
     {
-      try
-      {
-        job.task();
-        _jobIterator = _jobs.erase(_jobIterator);
-      }
-      catch (const std::exception& x)
+      JobId jobId{};
+      QueuedTask task;
+
       {
-        // Executing task for job threw an error, erase the job
-        // and move onto the next one
-        _jobIterator = _jobs.erase(_jobIterator);
-        throw x;
+        // The lock is not held while the task executes,
+        // so that the task can queue and cancel jobs.
+        std::scoped_lock lock(_jobsMutex);
+
+        if (_jobHeap.empty())
+          break;
+
+        const auto job = _jobHeap.top();
+        if (job.when > now)
+          break;
+
+        _jobHeap.pop();
+
+        if (job.jobId > lastJobId)
+        {
+          deferredJobs.emplace_back(job);
+          continue;
+        }
+
+        const auto taskIter = _tasks.find(job.jobId);
+        // The job was cancelled.
+        if (taskIter == _tasks.cend())
+          continue;
+
+        jobId = job.jobId;
+        task = std::move(taskIter->second);
+        _tasks.erase(taskIter);
       }
 
-      break;
+      if (task.jobTask)
+        task.jobTask(jobId);
+      else
+        task.task();
     }
-
-    if (++_jobIterator == _jobs.cend())
-      break;
   }
+  catch (...)
+  {
+    // The remaining jobs are left for the next tick.
+    returnDeferredJobs();
+    throw;
+  }
+
+  returnDeferredJobs();
 }
 
-void Scheduler::Queue(
-  const Task& task,
+Scheduler::JobId Scheduler::Queue(
+  Task task,
   const Clock::time_point when)
+{
+  return QueueTask(QueuedTask{.task = std::move(task), .jobTask = {}}, when);
+}
+
+Scheduler::JobId Scheduler::Queue(
+  JobTask task,
+  const Clock::time_point when)
+{
+  return QueueTask(QueuedTask{.task = {}, .jobTask = std::move(task)}, when);
+}
+
+Scheduler::JobId Scheduler::QueueTask(
+  QueuedTask task,
+  const Clock::time_point when)
+{
+  JobId jobId{};
+  bool isEarliestJob = false;
+
+  {
+    std::scoped_lock lock(_jobsMutex);
+
+    jobId = ++_lastJobId;
+    _tasks.emplace(jobId, std::move(task));
+    _jobHeap.emplace(ScheduledJob{
+      .when = when,
+      .jobId = jobId});
+
+    isEarliestJob = _jobHeap.top().jobId == jobId;
+  }
+
+  // The owner needs to be woken up only if the job is due sooner
+  // than the jobs it already knows about.
+  if (isEarliestJob && _wakeup != nullptr)
+    _wakeup->Signal();
+
+  return jobId;
+}
+
+bool Scheduler::Cancel(const JobId jobId)
+{
+  std::scoped_lock lock(_jobsMutex);
+  // The heap entry is discarded once it reaches the top.
+  return _tasks.erase(jobId) > 0;
+}
+
+std::optional<Scheduler::Clock::time_point> Scheduler::GetNextJobTime()
 {
   std::scoped_lock lock(_jobsMutex);
-  _jobs.emplace_back(Job{
-    .when = when,
-    .task = task});
+
+  // Discard the entries of the cancelled jobs.
+  while (not _jobHeap.empty() && not _tasks.contains(_jobHeap.top().jobId))
+    _jobHeap.pop();
+
+  if (_jobHeap.empty())
+    return std::nullopt;
+  return _jobHeap.top().when;
 }
 
+std::size_t Scheduler::GetJobCount()
+{
+  std::scoped_lock lock(_jobsMutex);
+  return _tasks.size();
+}
 
 } // namespace server
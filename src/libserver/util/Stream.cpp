@@ -6,6 +6,9 @@
 
 #include "libserver/util/Locale.hpp"
 
+#include <algorithm>
+#include <cstring>
+
 namespace server
 {
 
@@ -57,68 +60,107 @@ SinkStream& SinkStream::operator=(SinkStream&& rhs) noexcept
 
 void SinkStream::Write(const void* data, std::size_t size)
 {
-  if (_cursor + size > _storage.size())
+  if (size > _storage.size() - _cursor)
   {
     throw std::overflow_error(std::format("Couldn't write {} bytes to the buffer (cursor: {}, available: {}). Not enough space.", size, _cursor, _storage.size()));
   }
 
+  if (size == 0)
+    return;
+
   // Write the bytes.
-  for (std::size_t byteIdx = 0; byteIdx < size; ++byteIdx)
-  {
-    _storage[_cursor++] = static_cast<const std::byte*>(data)[byteIdx];
-  }
+  std::memcpy(_storage.data() + _cursor, data, size);
+  _cursor += size;
 }
 
 SinkStream& SinkStream::Write(const std::string& value)
 {
-  const std::string buffer = locale::FromUtf8(value);
-
-  for (char b : buffer)
-  {
-    Write(b);
-  }
+  WriteString(value);
+  return *this;
+}
 
-  Write(static_cast<char>(0x00));
+SinkStream& SinkStream::Write(const std::pmr::string& value)
+{
+  WriteString(value);
   return *this;
 }
 
+void SinkStream::WriteString(std::string_view value)
+{
+  thread_local std::string buffer;
+  locale::FromUtf8(value, buffer);
+
+  // Write the string with its null-terminator.
+  Write(buffer.c_str(), buffer.size() + 1);
+}
+
 void SourceStream::Read(void* data, std::size_t size)
 {
-  if (_cursor + size > _storage.size())
+  if (size > _storage.size() - _cursor)
   {
     throw std::overflow_error(std::format("Couldn't read {} bytes from the buffer (cursor: {}, available: {}). Not enough space.", size, _cursor, _storage.size()));
   }
 
+  if (size == 0)
+    return;
+
   // Read the bytes.
-  for (std::size_t byteIdx = 0; byteIdx < size; ++byteIdx)
+  std::memcpy(data, _storage.data() + _cursor, size);
+  _cursor += size;
+}
+
+std::span<const std::byte> SourceStream::ReadView(std::size_t size)
+{
+  if (size > _storage.size() - _cursor)
   {
-    static_cast<std::byte*>(data)[byteIdx] = _storage[_cursor++];
+    throw std::overflow_error(std::format("Couldn't read {} bytes from the buffer (cursor: {}, available: {}). Not enough space.", size, _cursor, _storage.size()));
   }
+
+  const auto view = _storage.subspan(_cursor, size);
+  _cursor += size;
+  return view;
 }
 
 SourceStream& SourceStream::Read(std::string& value)
 {
-  std::string buffer;
-  buffer.reserve(512);
+  locale::ToUtf8(ReadString(), value);
+  return *this;
+}
 
-  bool readNext = true;
-  do
+SourceStream& SourceStream::Read(std::pmr::string& value)
+{
+  const auto buffer = ReadString();
+  if (locale::IsAscii(buffer))
   {
-    char read = '\0';
-    Read(read);
-
-    if (read == '\0')
-    {
-      readNext = false;
-    }
-    else
-    {
-      buffer += read;
-    }
-  } while (readNext);
-
-  value = locale::ToUtf8(buffer);
+    value.assign(buffer);
+    return *this;
+  }
+
+  thread_local std::string converted;
+  locale::ToUtf8(buffer, converted);
+  value.assign(converted);
   return *this;
 }
 
+std::string_view SourceStream::ReadString()
+{
+  // Find the null-terminator within the rest of the stream.
+  const auto remaining = _storage.subspan(_cursor);
+  const auto terminator = std::ranges::find(remaining, std::byte{0});
+  if (terminator == remaining.end())
+  {
+    throw std::overflow_error(std::format("Couldn't read a string from the buffer (cursor: {}, available: {}). Missing null-terminator.", _cursor, _storage.size()));
+  }
+
+  const auto length = static_cast<std::size_t>(
+    std::distance(remaining.begin(), terminator));
+  const std::string_view buffer(
+    reinterpret_cast<const char*>(remaining.data()),
+    length);
+
+  // Skip the string with its null-terminator.
+  _cursor += length + 1;
+  return buffer;
+}
+
 } // namespace server
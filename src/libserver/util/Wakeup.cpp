@@ -0,0 +1,54 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include "libserver/util/Wakeup.hpp"
+
+namespace server
+{
+
+void Wakeup::SetHandler(Handler handler)
+{
+  std::scoped_lock lock(_handlerMutex);
+  _handler = std::move(handler);
+}
+
+void Wakeup::Signal()
+{
+  // Only the first signal after the reset invokes the handler.
+  if (_isSignalled.exchange(true, std::memory_order::acq_rel))
+    return;
+
+  // The handler is invoked under the lock
+  // so that it is never invoked after it was replaced.
+  std::scoped_lock lock(_handlerMutex);
+  if (_handler)
+    _handler();
+}
+
+bool Wakeup::Reset() noexcept
+{
+  return _isSignalled.exchange(false, std::memory_order::acq_rel);
+}
+
+bool Wakeup::IsSignalled() const noexcept
+{
+  return _isSignalled.load(std::memory_order::acquire);
+}
+
+} // namespace server
@@ -0,0 +1,235 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include "libserver/util/Xor.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(_M_X64)
+  #define SERVER_XOR_X86_64
+  #include <immintrin.h>
+  #if defined(_MSC_VER)
+    #include <intrin.h>
+  #endif
+#endif
+
+#if defined(SERVER_XOR_X86_64) && (defined(__GNUC__) || defined(__clang__))
+  #define SERVER_XOR_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+  #define SERVER_XOR_TARGET_AVX2
+#endif
+
+namespace server::util
+{
+
+namespace
+{
+
+//! Processes the data in 64-bit words, the unaligned tail byte by byte.
+//! The key must be already rotated so that its first byte applies to the first byte of the data.
+void XorScalar(
+  const XorKey& key,
+  const std::byte* source,
+  std::byte* sink,
+  std::size_t size)
+{
+  uint32_t pattern{};
+  std::memcpy(&pattern, key.data(), sizeof(pattern));
+  const uint64_t widePattern = static_cast<uint64_t>(pattern) << 32 | pattern;
+
+  std::size_t idx = 0;
+  for (; idx + sizeof(uint64_t) <= size; idx += sizeof(uint64_t))
+  {
+    uint64_t word{};
+    std::memcpy(&word, source + idx, sizeof(word));
+    word ^= widePattern;
+    std::memcpy(sink + idx, &word, sizeof(word));
+  }
+
+  // The processed size is a multiple of the key size,
+  // the key needs no rotation for the tail.
+  for (; idx < size; ++idx)
+  {
+    sink[idx] = source[idx] ^ key[idx % key.size()];
+  }
+}
+
+#ifdef SERVER_XOR_X86_64
+
+//! Processes the data in 128-bit vectors, the tail with the scalar kernel.
+void XorSse2(
+  const XorKey& key,
+  const std::byte* source,
+  std::byte* sink,
+  std::size_t size)
+{
+  int32_t pattern{};
+  std::memcpy(&pattern, key.data(), sizeof(pattern));
+  const __m128i vectorPattern = _mm_set1_epi32(pattern);
+
+  std::size_t idx = 0;
+  for (; idx + sizeof(__m128i) <= size; idx += sizeof(__m128i))
+  {
+    const __m128i vector = _mm_loadu_si128(
+      reinterpret_cast<const __m128i*>(source + idx));
+    _mm_storeu_si128(
+      reinterpret_cast<__m128i*>(sink + idx),
+      _mm_xor_si128(vector, vectorPattern));
+  }
+
+  XorScalar(key, source + idx, sink + idx, size - idx);
+}
+
+//! Processes the data in 256-bit vectors, the tail with the scalar kernel.
+SERVER_XOR_TARGET_AVX2 void XorAvx2(
+  const XorKey& key,
+  const std::byte* source,
+  std::byte* sink,
+  std::size_t size)
+{
+  int32_t pattern{};
+  std::memcpy(&pattern, key.data(), sizeof(pattern));
+  const __m256i vectorPattern = _mm256_set1_epi32(pattern);
+
+  std::size_t idx = 0;
+  for (; idx + sizeof(__m256i) <= size; idx += sizeof(__m256i))
+  {
+    const __m256i vector = _mm256_loadu_si256(
+      reinterpret_cast<const __m256i*>(source + idx));
+    _mm256_storeu_si256(
+      reinterpret_cast<__m256i*>(sink + idx),
+      _mm256_xor_si256(vector, vectorPattern));
+  }
+
+  XorScalar(key, source + idx, sink + idx, size - idx);
+}
+
+//! Checks whether the processor and the operating system support AVX2.
+bool IsAvx2Supported()
+{
+#if defined(_MSC_VER)
+  int registers[4]{};
+  __cpuid(registers, 1);
+  // OSXSAVE and AVX.
+  const bool isAvxSupported = (registers[2] & (1 << 27)) && (registers[2] & (1 << 28));
+  // The operating system must preserve the YMM registers.
+  if (not isAvxSupported || (_xgetbv(0) & 0x6) != 0x6)
+    return false;
+
+  __cpuidex(registers, 7, 0);
+  return registers[1] & (1 << 5);
+#else
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif // SERVER_XOR_X86_64
+
+} // anon namespace
+
+bool IsXorKernelSupported(XorKernel kernel)
+{
+  switch (kernel)
+  {
+    case XorKernel::Scalar:
+      return true;
+#ifdef SERVER_XOR_X86_64
+    case XorKernel::Sse2:
+      // SSE2 is a part of the x86-64 baseline.
+      return true;
+    case XorKernel::Avx2:
+    {
+      static const bool isSupported = IsAvx2Supported();
+      return isSupported;
+    }
+#endif
+    default:
+      return false;
+  }
+}
+
+XorKernel GetXorKernel()
+{
+  static const XorKernel kernel = []()
+  {
+    for (const auto kernel : {XorKernel::Avx2, XorKernel::Sse2})
+    {
+      if (IsXorKernelSupported(kernel))
+        return kernel;
+    }
+    return XorKernel::Scalar;
+  }();
+
+  return kernel;
+}
+
+void XorWithKey(
+  XorKernel kernel,
+  const XorKey& key,
+  std::span<const std::byte> source,
+  std::span<std::byte> sink,
+  std::size_t keyOffset)
+{
+  if (sink.size() < source.size())
+    throw std::invalid_argument("Sink is smaller than the source");
+
+  // Rotate the key so that its first byte applies to the first byte of the source.
+  XorKey rotatedKey{};
+  for (std::size_t idx = 0; idx < key.size(); ++idx)
+  {
+    rotatedKey[idx] = key[(keyOffset + idx) % key.size()];
+  }
+
+  switch (kernel)
+  {
+#ifdef SERVER_XOR_X86_64
+    case XorKernel::Avx2:
+      XorAvx2(rotatedKey, source.data(), sink.data(), source.size());
+      break;
+    case XorKernel::Sse2:
+      XorSse2(rotatedKey, source.data(), sink.data(), source.size());
+      break;
+#endif
+    default:
+      XorScalar(rotatedKey, source.data(), sink.data(), source.size());
+      break;
+  }
+}
+
+void XorWithKey(
+  const XorKey& key,
+  std::span<const std::byte> source,
+  std::span<std::byte> sink,
+  std::size_t keyOffset)
+{
+  XorWithKey(GetXorKernel(), key, source, sink, keyOffset);
+}
+
+void XorWithKey(
+  const XorKey& key,
+  std::span<std::byte> data,
+  std::size_t keyOffset)
+{
+  XorWithKey(GetXorKernel(), key, data, data, keyOffset);
+}
+
+} // namespace server::util
@@ -0,0 +1,495 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+//! Replays the commands captured by a server (see `network.capture` in the server config)
+//! to a local server instance and reports the latency and the throughput.
+//!
+//! Usage: alicia-replay <capture file> [--address <address>] [--port <port>]
+//!                      [--speed <factor>] [--drain-ms <milliseconds>] [--json <path>]
+//!
+//! Every captured client is replayed over its own connection. The commands of a client
+//! are sent in the captured order at the captured times, divided by the speed factor.
+//! A speed of 0 sends the commands as fast as possible. The order of the commands of a client
+//! is preserved at any speed, but the commands of the clients which waited for a response
+//! of the server may then arrive before the server is ready for them.
+
+#include <libserver/network/Capture.hpp>
+#include <libserver/network/chatter/ChatterProtocol.hpp>
+#include <libserver/network/command/CommandServer.hpp>
+
+#include <boost/asio.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <deque>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+
+namespace asio = boost::asio;
+using Clock = std::chrono::steady_clock;
+
+using namespace server;
+
+//! Options of the replay.
+struct Options
+{
+  std::filesystem::path capturePath;
+  asio::ip::address address{asio::ip::address_v4::loopback()};
+  //! Port of the server, the captured port if not specified.
+  std::optional<uint16_t> port;
+  //! Factor the captured times are divided by. Zero sends as fast as possible.
+  double speed{1.0};
+  //! For how long to wait for the responses after the last command.
+  std::chrono::milliseconds drainTime{1000};
+  //! Path of the JSON report, if any.
+  std::filesystem::path jsonPath;
+};
+
+//! Statistics of the replay.
+struct Statistics
+{
+  std::size_t connectionCount{};
+  std::size_t failedConnectionCount{};
+  std::size_t commandCount{};
+  std::size_t bytesSent{};
+  std::size_t bytesReceived{};
+  //! Times from a command to the next data received from the server on the connection.
+  std::vector<std::chrono::microseconds> latencies;
+};
+
+//! A connection replaying a captured client.
+struct Connection
+{
+  explicit Connection(asio::io_context& ioContext)
+    : socket(ioContext)
+  {
+  }
+
+  asio::ip::tcp::socket socket;
+  //! Rolling XOR code of the client.
+  CommandClient client;
+
+  //! Send times of the commands not followed by any data from the server yet.
+  std::deque<Clock::time_point> pendingCommands;
+
+  //! Data queued for writing after the current write.
+  std::vector<std::byte> queuedData;
+  //! Data being written.
+  std::vector<std::byte> writtenData;
+  bool isWriting{false};
+  //! Whether the connection should be closed once the writes are done.
+  bool isClosing{false};
+
+  std::array<std::byte, 16 * 1024> readBuffer{};
+};
+
+class Replay
+{
+public:
+  Replay(const Options& options, std::vector<network::CaptureRecord> records, network::CaptureProtocol protocol)
+    : _options(options)
+    , _records(std::move(records))
+    , _protocol(protocol)
+    , _timer(_ioContext)
+  {
+  }
+
+  void Run(const asio::ip::tcp::endpoint& endpoint)
+  {
+    _endpoint = endpoint;
+    _beginTime = Clock::now();
+    ScheduleNextRecord();
+    _ioContext.run();
+    _endTime = Clock::now();
+  }
+
+  [[nodiscard]] const Statistics& GetStatistics() const
+  {
+    return _statistics;
+  }
+
+  [[nodiscard]] Clock::duration GetDuration() const
+  {
+    return _endTime - _beginTime;
+  }
+
+private:
+  void ScheduleNextRecord()
+  {
+    if (_nextRecordIdx == _records.size())
+    {
+      // Wait for the last responses and close the remaining connections.
+      _timer.expires_after(_options.drainTime);
+      _timer.async_wait([this](const boost::system::error_code&)
+      {
+        for (auto& [clientId, connection] : _connections)
+        {
+          boost::system::error_code error;
+          connection->socket.close(error);
+        }
+        _connections.clear();
+      });
+      return;
+    }
+
+    const auto& record = _records[_nextRecordIdx];
+
+    auto dueTime = Clock::now();
+    if (_options.speed > 0.0)
+    {
+      dueTime = _beginTime + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double, std::micro>(
+          static_cast<double>(record.time.count()) / _options.speed));
+    }
+
+    _timer.expires_at(dueTime);
+    _timer.async_wait([this](const boost::system::error_code& error)
+    {
+      if (error)
+        return;
+
+      ReplayRecord(_records[_nextRecordIdx++]);
+      ScheduleNextRecord();
+    });
+  }
+
+  void ReplayRecord(const network::CaptureRecord& record)
+  {
+    switch (record.type)
+    {
+      case network::CaptureRecord::Type::Connected:
+      {
+        auto connection = std::make_shared<Connection>(_ioContext);
+
+        // The connect is synchronous so that the following records
+        // of the client are replayed over an established connection.
+        boost::system::error_code error;
+        connection->socket.connect(_endpoint, error);
+        if (error)
+        {
+          ++_statistics.failedConnectionCount;
+          std::cerr << std::format(
+            "Client {} couldn't connect: {}\n", record.clientId, error.message());
+          return;
+        }
+
+        connection->socket.set_option(asio::ip::tcp::no_delay(true));
+        ++_statistics.connectionCount;
+        _connections[record.clientId] = connection;
+        Read(connection);
+        break;
+      }
+      case network::CaptureRecord::Type::Disconnected:
+      {
+        const auto connectionIter = _connections.find(record.clientId);
+        if (connectionIter == _connections.cend())
+          return;
+
+        const auto connection = connectionIter->second;
+        _connections.erase(connectionIter);
+
+        connection->isClosing = true;
+        if (not connection->isWriting)
+        {
+          boost::system::error_code error;
+          connection->socket.close(error);
+        }
+        break;
+      }
+      case network::CaptureRecord::Type::Command:
+      {
+        const auto connectionIter = _connections.find(record.clientId);
+        if (connectionIter == _connections.cend())
+          return;
+
+        const auto& connection = connectionIter->second;
+        const auto origin = connection->queuedData.size();
+        if (_protocol == network::CaptureProtocol::Command)
+        {
+          connection->client.WriteClientCommand(
+            record.commandId, record.data, connection->queuedData);
+        }
+        else
+        {
+          protocol::WriteClientChatterCommand(
+            record.commandId, record.data, connection->queuedData);
+        }
+
+        ++_statistics.commandCount;
+        _statistics.bytesSent += connection->queuedData.size() - origin;
+        connection->pendingCommands.emplace_back(Clock::now());
+        Write(connection);
+        break;
+      }
+      case network::CaptureRecord::Type::CodeChanged:
+      {
+        const auto connectionIter = _connections.find(record.clientId);
+        if (connectionIter == _connections.cend() || record.data.size() != sizeof(protocol::XorCode))
+          return;
+
+        protocol::XorCode code{};
+        std::ranges::copy(record.data, code.begin());
+        connectionIter->second->client.SetCode(code);
+        break;
+      }
+    }
+  }
+
+  void Write(const std::shared_ptr<Connection>& connection)
+  {
+    if (connection->isWriting || connection->queuedData.empty())
+      return;
+
+    connection->isWriting = true;
+    std::swap(connection->writtenData, connection->queuedData);
+    connection->queuedData.clear();
+
+    asio::async_write(
+      connection->socket,
+      asio::buffer(connection->writtenData),
+      [this, connection](const boost::system::error_code& error, std::size_t)
+      {
+        connection->isWriting = false;
+        if (error)
+          return;
+
+        if (not connection->queuedData.empty())
+        {
+          Write(connection);
+        }
+        else if (connection->isClosing)
+        {
+          boost::system::error_code closeError;
+          connection->socket.close(closeError);
+        }
+      });
+  }
+
+  void Read(const std::shared_ptr<Connection>& connection)
+  {
+    connection->socket.async_read_some(
+      asio::buffer(connection->readBuffer),
+      [this, connection](const boost::system::error_code& error, std::size_t size)
+      {
+        if (error)
+          return;
+
+        _statistics.bytesReceived += size;
+
+        // The data answer all the commands sent since the previous data.
+        const auto now = Clock::now();
+        for (const auto sendTime : connection->pendingCommands)
+        {
+          _statistics.latencies.emplace_back(
+            std::chrono::duration_cast<std::chrono::microseconds>(now - sendTime));
+        }
+        connection->pendingCommands.clear();
+
+        Read(connection);
+      });
+  }
+
+  const Options& _options;
+  std::vector<network::CaptureRecord> _records;
+  network::CaptureProtocol _protocol;
+
+  asio::io_context _ioContext;
+  asio::steady_timer _timer;
+  asio::ip::tcp::endpoint _endpoint;
+
+  std::size_t _nextRecordIdx{0};
+  std::unordered_map<network::ClientId, std::shared_ptr<Connection>> _connections;
+
+  Clock::time_point _beginTime;
+  Clock::time_point _endTime;
+  Statistics _statistics;
+};
+
+//! Returns the percentile of the sorted latencies.
+std::chrono::microseconds GetPercentile(
+  const std::vector<std::chrono::microseconds>& sortedLatencies,
+  double percentile)
+{
+  if (sortedLatencies.empty())
+    return {};
+
+  const auto idx = static_cast<std::size_t>(
+    percentile / 100.0 * static_cast<double>(sortedLatencies.size() - 1));
+  return sortedLatencies[idx];
+}
+
+bool ParseOptions(int argc, char** argv, Options& options)
+{
+  for (int argIdx = 1; argIdx < argc; ++argIdx)
+  {
+    const std::string_view arg = argv[argIdx];
+    const bool hasValue = argIdx + 1 < argc;
+
+    if (arg == "--address" && hasValue)
+      options.address = asio::ip::make_address(argv[++argIdx]);
+    else if (arg == "--port" && hasValue)
+      options.port = static_cast<uint16_t>(std::stoul(argv[++argIdx]));
+    else if (arg == "--speed" && hasValue)
+      options.speed = std::max(std::stod(argv[++argIdx]), 0.0);
+    else if (arg == "--drain-ms" && hasValue)
+      options.drainTime = std::chrono::milliseconds(std::stoul(argv[++argIdx]));
+    else if (arg == "--json" && hasValue)
+      options.jsonPath = argv[++argIdx];
+    else if (not arg.starts_with("--") && options.capturePath.empty())
+      options.capturePath = arg;
+    else
+      return false;
+  }
+
+  return not options.capturePath.empty();
+}
+
+} // anon namespace
+
+int main(int argc, char** argv)
+{
+  Options options;
+
+  try
+  {
+    if (not ParseOptions(argc, argv, options))
+    {
+      std::cerr << "Usage: alicia-replay <capture file> [--address <address>] [--port <port>]\n"
+                   "                     [--speed <factor>] [--drain-ms <milliseconds>] [--json <path>]\n";
+      return 2;
+    }
+  }
+  catch (const std::exception& x)
+  {
+    std::cerr << std::format("Invalid argument: {}\n", x.what());
+    return 2;
+  }
+
+  std::vector<network::CaptureRecord> records;
+  network::CaptureHeader header;
+
+  try
+  {
+    network::CaptureReader reader(options.capturePath);
+    header = reader.GetHeader();
+
+    network::CaptureRecord record;
+    while (reader.Read(record))
+      records.emplace_back(std::move(record));
+  }
+  catch (const std::exception& x)
+  {
+    std::cerr << std::format("Couldn't read the capture: {}\n", x.what());
+    return 1;
+  }
+
+  const auto capturedDuration = records.empty()
+    ? std::chrono::microseconds{}
+    : records.back().time;
+  const asio::ip::tcp::endpoint endpoint(
+    options.address,
+    options.port.value_or(header.port));
+
+  std::cout << std::format(
+    "Replaying {} records ({:.3f}s captured) to {}:{} at speed {}\n",
+    records.size(),
+    std::chrono::duration<double>(capturedDuration).count(),
+    endpoint.address().to_string(),
+    endpoint.port(),
+    options.speed);
+
+  Replay replay(options, std::move(records), header.protocol);
+  replay.Run(endpoint);
+
+  auto statistics = replay.GetStatistics();
+  std::ranges::sort(statistics.latencies);
+
+  // The drain time is not a part of the replay.
+  const auto duration = std::chrono::duration<double>(
+    replay.GetDuration() - options.drainTime).count();
+  const auto commandsPerSecond = duration > 0.0
+    ? static_cast<double>(statistics.commandCount) / duration
+    : 0.0;
+
+  const auto p50 = GetPercentile(statistics.latencies, 50.0);
+  const auto p90 = GetPercentile(statistics.latencies, 90.0);
+  const auto p99 = GetPercentile(statistics.latencies, 99.0);
+  const auto max = statistics.latencies.empty()
+    ? std::chrono::microseconds{}
+    : statistics.latencies.back();
+
+  std::cout << std::format(
+    "Connections: {} ({} failed)\n"
+    "Commands: {} in {:.3f}s ({:.1f} commands/s)\n"
+    "Sent: {} bytes, received: {} bytes\n"
+    "Latency: p50 {}us, p90 {}us, p99 {}us, max {}us ({} samples)\n",
+    statistics.connectionCount,
+    statistics.failedConnectionCount,
+    statistics.commandCount,
+    duration,
+    commandsPerSecond,
+    statistics.bytesSent,
+    statistics.bytesReceived,
+    p50.count(),
+    p90.count(),
+    p99.count(),
+    max.count(),
+    statistics.latencies.size());
+
+  if (not options.jsonPath.empty())
+  {
+    std::ofstream json(options.jsonPath);
+    if (not json)
+    {
+      std::cerr << std::format("Couldn't open '{}' for writing\n", options.jsonPath.string());
+      return 1;
+    }
+
+    json << std::format(
+      "{{\"connections\": {}, \"failed_connections\": {}, \"commands\": {}, "
+      "\"duration_s\": {:.6f}, \"commands_per_s\": {:.3f}, "
+      "\"bytes_sent\": {}, \"bytes_received\": {}, "
+      "\"latency_us\": {{\"p50\": {}, \"p90\": {}, \"p99\": {}, \"max\": {}, \"samples\": {}}}}}\n",
+      statistics.connectionCount,
+      statistics.failedConnectionCount,
+      statistics.commandCount,
+      duration,
+      commandsPerSecond,
+      statistics.bytesSent,
+      statistics.bytesReceived,
+      p50.count(),
+      p90.count(),
+      p99.count(),
+      max.count(),
+      statistics.latencies.size());
+  }
+
+  return statistics.failedConnectionCount == 0 ? 0 : 1;
+}
@@ -21,6 +21,7 @@
 
 #include <libserver/util/Util.hpp>
 
+#include <algorithm>
 #include <charconv>
 #include <format>
 #include <fstream>
@@ -175,6 +176,13 @@ void Config::LoadFromFile(const std::filesystem::path& filePath)
     return Listen{};
   };
 
+  const auto parseIdleTimeout = [](const YAML::Node& node, std::chrono::seconds fallback)
+  {
+    return std::chrono::seconds(std::max(
+      node["idle_timeout_s"].as<int64_t>(fallback.count()),
+      int64_t{0}));
+  };
+
   try
   {
     const YAML::Node yamlConfig = YAML::Load(file);
@@ -186,6 +194,7 @@ void Config::LoadFromFile(const std::filesystem::path& filePath)
       const auto generalYaml = serverYaml["general"];
       general.brand = generalYaml["brand"].as<std::string>("<not set>");
       general.notice = generalYaml["notice"].as<std::string>("");
+      general.workerThreads = generalYaml["worker_threads"].as<std::size_t>(0);
     }
     catch (const std::exception& e)
     {
@@ -217,12 +226,136 @@ void Config::LoadFromFile(const std::filesystem::path& filePath)
       spdlog::error("Unhandled exception parsing the authentication config: {}", e.what());
     }
 
+    // Directors config
+    try
+    {
+      const auto parseDirectorTicks = [](const YAML::Node& node, const DirectorTicks& fallback)
+      {
+        DirectorTicks ticks = fallback;
+        if (not node)
+          return ticks;
+
+        ticks.tickRate = std::max(
+          node["tick_rate"].as<uint32_t>(ticks.tickRate),
+          uint32_t{1});
+        ticks.adaptive = node["adaptive"].as<bool>(ticks.adaptive);
+        ticks.minTickRate = std::clamp(
+          node["min_tick_rate"].as<uint32_t>(ticks.minTickRate),
+          uint32_t{1},
+          ticks.tickRate);
+        ticks.catchUp = node["catch_up"].as<bool>(ticks.catchUp);
+        return ticks;
+      };
+
+      const auto directorsYaml = serverYaml["directors"];
+      const auto defaultTicks = parseDirectorTicks(directorsYaml["default"], DirectorTicks{});
+
+      directors.authentication = parseDirectorTicks(directorsYaml["authentication"], defaultTicks);
+      directors.data = parseDirectorTicks(directorsYaml["data"], defaultTicks);
+      directors.lobby = parseDirectorTicks(directorsYaml["lobby"], defaultTicks);
+      directors.race = parseDirectorTicks(directorsYaml["race"], defaultTicks);
+      directors.telemetry = parseDirectorTicks(directorsYaml["telemetry"], directors.telemetry);
+
+      // These directors are neither woken up nor have time-driven work.
+      for (const auto* const untickedDirector : {"messenger", "all_chat", "private_chat", "ranch"})
+      {
+        if (directorsYaml[untickedDirector])
+        {
+          spdlog::error(
+            "The director '{}' is not ticked, its tick settings are rejected",
+            untickedDirector);
+        }
+      }
+    }
+    catch (const std::exception& e)
+    {
+      spdlog::error("Unhandled exception parsing the directors config: {}", e.what());
+    }
+
+    // Profiler config
+    try
+    {
+      const auto profilerYaml = serverYaml["profiler"];
+      profiler.reportInterval = std::chrono::seconds(std::max(
+        profilerYaml["report_interval"].as<int64_t>(profiler.reportInterval.count()),
+        int64_t{0}));
+      profiler.reportLimit = profilerYaml["report_limit"].as<std::size_t>(
+        profiler.reportLimit);
+    }
+    catch (const std::exception& e)
+    {
+      spdlog::error("Unhandled exception parsing the profiler config: {}", e.what());
+    }
+
+    // Network config
+    try
+    {
+      const auto networkYaml = serverYaml["network"];
+      network.ioThreadCount = std::max(
+        networkYaml["io_threads"].as<std::size_t>(1),
+        std::size_t{1});
+      network.acceptorCount = std::max(
+        networkYaml["acceptors"].as<std::size_t>(1),
+        std::size_t{1});
+
+      if (const auto writeQueueYaml = networkYaml["write_queue"])
+      {
+        auto& writeQueueLimits = network.writeQueueLimits;
+        writeQueueLimits.maxWriteCount = writeQueueYaml["max_writes"].as<std::size_t>(
+          writeQueueLimits.maxWriteCount);
+        writeQueueLimits.maxByteCount = writeQueueYaml["max_bytes"].as<std::size_t>(
+          writeQueueLimits.maxByteCount);
+        writeQueueLimits.overLimitTimeout = std::chrono::milliseconds(
+          writeQueueYaml["timeout_ms"].as<int64_t>(writeQueueLimits.overLimitTimeout.count()));
+      }
+
+      if (const auto readBufferYaml = networkYaml["read_buffer"])
+      {
+        auto& readBufferLimits = network.readBufferLimits;
+        readBufferLimits.minReadSize = std::max(
+          readBufferYaml["min_read_size"].as<std::size_t>(readBufferLimits.minReadSize),
+          std::size_t{1});
+        readBufferLimits.maxReadSize = std::max(
+          readBufferYaml["max_read_size"].as<std::size_t>(readBufferLimits.maxReadSize),
+          readBufferLimits.minReadSize);
+        readBufferLimits.trimTimeout = std::chrono::seconds(
+          readBufferYaml["trim_timeout_s"].as<int64_t>(readBufferLimits.trimTimeout.count()));
+      }
+
+      if (const auto connectionsYaml = networkYaml["connections"])
+      {
+        auto& connectionLimits = network.connectionLimits;
+        connectionLimits.maxConnections = std::max(
+          connectionsYaml["max_connections"].as<std::size_t>(connectionLimits.maxConnections),
+          std::size_t{1});
+        connectionLimits.maxConnectionsPerAddress = std::max(
+          connectionsYaml["max_per_address"].as<std::size_t>(connectionLimits.maxConnectionsPerAddress),
+          std::size_t{1});
+        connectionLimits.maxConnectRatePerAddress = std::max(
+          connectionsYaml["max_rate_per_address"].as<std::size_t>(connectionLimits.maxConnectRatePerAddress),
+          std::size_t{1});
+        connectionLimits.rateWindow = std::chrono::seconds(
+          connectionsYaml["rate_window_s"].as<int64_t>(connectionLimits.rateWindow.count()));
+      }
+
+      if (const auto captureYaml = networkYaml["capture"];
+        captureYaml && captureYaml["enabled"].as<bool>(false))
+      {
+        network.captureDirectory = captureYaml["directory"].as<std::string>("./captures");
+      }
+    }
+    catch (const std::exception& e)
+    {
+      spdlog::error("Unhandled exception parsing the network config: {}", e.what());
+    }
+
     // Lobby config
     try
     {
       const auto lobbyYaml = serverYaml["lobby"];
       lobby.enabled = lobbyYaml["enabled"].as<bool>();
       lobby.listen = parseListenSection(lobbyYaml["listen"]);
+      lobby.idleTimeout = parseIdleTimeout(lobbyYaml, lobby.idleTimeout);
 
       const auto lobbyAdvertisementYaml = lobbyYaml["advertisement"];
       lobby.advertisement.ranch = parseListenSection(lobbyAdvertisementYaml["ranch"]);
@@ -243,6 +376,7 @@ void Config::LoadFromFile(const std::filesystem::path& filePath)
       const auto ranchYaml = serverYaml["ranch"];
       ranch.enabled = ranchYaml["enabled"].as<bool>();
       ranch.listen = parseListenSection(ranchYaml["listen"]);
+      ranch.idleTimeout = parseIdleTimeout(ranchYaml, ranch.idleTimeout);
     }
     catch (const std::exception& e)
     {
@@ -255,6 +389,7 @@ void Config::LoadFromFile(const std::filesystem::path& filePath)
       const auto raceYaml = serverYaml["race"];
       race.enabled = raceYaml["enabled"].as<bool>();
       race.listen = parseListenSection(raceYaml["listen"]);
+      race.idleTimeout = parseIdleTimeout(raceYaml, race.idleTimeout);
     }
     catch (const std::exception& e)
     {
@@ -267,6 +402,7 @@ void Config::LoadFromFile(const std::filesystem::path& filePath)
       const auto messengerYaml = serverYaml["messenger"];
       messenger.enabled = messengerYaml["enabled"].as<bool>();
       messenger.listen = parseListenSection(messengerYaml["listen"]);
+      messenger.idleTimeout = parseIdleTimeout(messengerYaml, messenger.idleTimeout);
     }
     catch (const std::exception& e)
     {
@@ -279,6 +415,7 @@ void Config::LoadFromFile(const std::filesystem::path& filePath)
       const auto allChatYaml = serverYaml["all_chat"];
       allChat.enabled = allChatYaml["enabled"].as<bool>();
       allChat.listen = parseListenSection(allChatYaml["listen"]);
+      allChat.idleTimeout = parseIdleTimeout(allChatYaml, allChat.idleTimeout);
     }
     catch (const std::exception& e)
     {
@@ -291,6 +428,7 @@ void Config::LoadFromFile(const std::filesystem::path& filePath)
       const auto privateChatYaml = serverYaml["private_chat"];
       privateChat.enabled = privateChatYaml["enabled"].as<bool>();
       privateChat.listen = parseListenSection(privateChatYaml["listen"]);
+      privateChat.idleTimeout = parseIdleTimeout(privateChatYaml, privateChat.idleTimeout);
     }
     catch (const std::exception& e)
     {
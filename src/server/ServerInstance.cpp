@@ -19,6 +19,7 @@
 
 #include "server/ServerInstance.hpp"
 
+#include <format>
 #include <stacktrace>
 
 namespace server
@@ -34,47 +35,73 @@ void DumpStackTrace()
   }
 }
 
+//! Count of the ticks a director woken up repeatedly takes right away,
+//! before its next tick is deferred to the tick interval.
+constexpr std::size_t MaxImmediateDirectorTicks = 4;
+//! Count of the late time-driven ticks a director catches up with,
+//! a director which is further behind skips the late ticks.
+constexpr uint64_t MaxCatchUpDirectorTicks = 10;
+//! Count of the consecutive ticks fitting in half of their budget
+//! after which the adaptive tick rate doubles back.
+constexpr std::size_t AdaptiveRecoveryDirectorTicks = 50;
+//! Interval between the warnings about a director skipping ticks.
+constexpr auto DirectorSkipWarningInterval = std::chrono::seconds(10);
+
+//! Returns the interval between the ticks at the tick rate.
+//! @param tickRate Tick rate, in ticks per second.
+//! @returns Interval between the ticks.
+Executor::Clock::duration GetTickInterval(uint32_t tickRate)
+{
+  return std::chrono::duration_cast<Executor::Clock::duration>(std::chrono::seconds(1))
+    / std::max(tickRate, uint32_t{1});
+}
+
 } // anon namespace
 
 ServerInstance::ServerInstance(
   const std::filesystem::path& resourceDirectory)
   : _resourceDirectory(resourceDirectory)
+  , _authenticationStrand(_executor)
   , _authenticationService(*this)
+  , _dataDirectorStrand(_executor)
   , _dataDirector(resourceDirectory / "data")
+  , _lobbyDirectorStrand(_executor)
   , _lobbyDirector(*this)
+  , _messengerStrand(_executor)
   , _messengerDirector(*this)
+  , _allChatDirectorStrand(_executor)
   , _allChatDirector(*this)
+  , _privateChatDirectorStrand(_executor)
   , _privateChatDirector(*this)
+  , _ranchDirectorStrand(_executor)
   , _ranchDirector(*this)
+  , _raceDirectorStrand(_executor)
   , _raceDirector(*this)
   , _chatSystem(*this)
   , _infractionSystem(*this)
   , _itemSystem(*this)
   , _matchmakingSystem(*this)
+  , _telemetryStrand(_executor)
   , _telemetry(*this)
 {
 }
 
 ServerInstance::~ServerInstance()
 {
-  const auto waitForThread = [](const std::string& threadName, std::thread& thread)
   {
-    if (thread.joinable())
+    std::unique_lock lock(_runningDirectorsMutex);
+    if (_runningDirectorCount > 0)
+      spdlog::debug("Waiting for {} directors to finish...", _runningDirectorCount);
+
+    _runningDirectorsCondition.wait(lock, [this]()
     {
-      spdlog::debug("Waiting for the '{}' thread to finish...", threadName);
-      thread.join();
-      spdlog::debug("Thread for '{}' finished", threadName);
-    }
-  };
+      return _runningDirectorCount == 0;
+    });
+  }
 
-  waitForThread("race director", _raceDirectorThread);
-  waitForThread("ranch director", _ranchDirectorThread);
-  waitForThread("private chat director", _privateChatDirectorThread);
-  waitForThread("all chat director", _allChatDirectorThread);
-  waitForThread("messenger director", _messengerThread);
-  waitForThread("lobby director", _lobbyDirectorThread);
-  waitForThread("data director", _dataDirectorThread);
-  waitForThread("authentication", _authenticationThread);
+  // The executor ends before the strands and the directors are destroyed.
+  _executor.End();
+  spdlog::debug("Executor finished");
 }
 
 void ServerInstance::Initialize()
@@ -95,191 +122,386 @@ void ServerInstance::Initialize()
   _moderationSystem.ReadConfig(_resourceDirectory / "config/server/automod.yaml");
   _systemContentRegistry.ReadConfig(_resourceDirectory / "config/server/system_content.yaml");
 
-  // Initialize the directors and tick them on their own threads.
-  // Directors will terminate their tick loop once `_shouldRun` flag is set to false.
+  // Initialize the directors and tick them on their strands of the executor,
+  // each director runs on a single thread at a time. The directors tick when
+  // work is queued to them or when their time-driven ticks are due.
+  // Directors will terminate once `_shouldRun` flag is set to false.
+  _executor.Begin(_config.general.workerThreads);
+  spdlog::info("Executor is running {} worker threads", _executor.GetWorkerCount());
+
+  RunDirector(
+    "the authentication",
+    _authenticationService,
+    _authenticationStrand,
+    _config.directors.authentication);
+  RunDirector(
+    "the data director",
+    _dataDirector,
+    _dataDirectorStrand,
+    _config.directors.data);
+  RunDirector(
+    "the lobby director",
+    _lobbyDirector,
+    _lobbyDirectorStrand,
+    _config.directors.lobby);
 
-  // Authentication service
-  _authenticationThread = std::thread([this]()
+  if (_config.messenger.enabled)
   {
-    try
+    RunDirector(
+      "the messenger director",
+      _messengerDirector,
+      _messengerStrand);
+
+    // All chat depends on messenger
+    if (_config.allChat.enabled)
     {
-      _authenticationService.Initialize();
-      RunDirectorTaskLoop(_authenticationService);
-      _authenticationService.Terminate();
+      RunDirector(
+        "the messenger (all chat) director",
+        _allChatDirector,
+        _allChatDirectorStrand);
     }
-    catch (const std::exception& x)
-    {
-      spdlog::error("Unhandled exception in the authentication: {}", x.what());
-      DumpStackTrace();
 
-      _shouldRun = false;
+    // Private chat depends on messenger
+    if (_config.privateChat.enabled)
+    {
+      RunDirector(
+        "the messenger (private chat) director",
+        _privateChatDirector,
+        _privateChatDirectorStrand);
     }
-  });
+  }
+
+  RunDirector(
+    "the ranch director",
+    _ranchDirector,
+    _ranchDirectorStrand);
+  RunDirector(
+    "the race director",
+    _raceDirector,
+    _raceDirectorStrand,
+    _config.directors.race);
 
-  // Data director
-  _dataDirectorThread = std::thread([this]()
+  if (GetSettings().telemetry.enabled)
+  {
+    RunDirector(
+      "telemetry",
+      _telemetry,
+      _telemetryStrand,
+      _config.directors.telemetry);
+  }
+  else
+  {
+    spdlog::info("Metric collection is disabled");
+  }
+
+  if (_config.profiler.reportInterval.count() > 0)
+  {
+    ScheduleProfileReport(Profiler::Global().Collect());
+  }
+}
+
+void ServerInstance::RunDirector(std::shared_ptr<DirectorRun> directorRun)
+{
+  directorRun->isTicked = directorRun->wakeup != nullptr
+    || static_cast<bool>(directorRun->nextTickTime);
+
+  // The directors which are not ticked have no tick rate nor statistics.
+  if (directorRun->isTicked)
+  {
+    directorRun->tickInterval = GetTickInterval(directorRun->ticks.tickRate);
+    directorRun->profilerSection = Profiler::Global().RegisterSection(
+      std::format("tick/{}", directorRun->name));
+
+    std::scoped_lock lock(directorRun->statisticsMutex);
+    directorRun->statistics.name = directorRun->name;
+    directorRun->statistics.tickRate = directorRun->ticks.tickRate;
+  }
+
+  {
+    std::scoped_lock lock(_runningDirectorsMutex);
+    ++_runningDirectorCount;
+    _directorRuns.emplace_back(directorRun);
+  }
+
+  directorRun->strand.Post([this, directorRun]()
   {
     try
     {
-      _dataDirector.Initialize();
-      RunDirectorTaskLoop(_dataDirector);
-      _dataDirector.Terminate();
+      directorRun->initialize();
     }
     catch (const std::exception& x)
     {
-      spdlog::error("Unhandled exception in the data director: {}", x.what());
+      spdlog::error("Unhandled exception in {}: {}", directorRun->name, x.what());
       DumpStackTrace();
 
-      _shouldRun = false;
+      directorRun->isTerminated = true;
+      OnDirectorFinished();
+      Terminate();
+      return;
     }
+
+    // Tick the director whenever work is queued to it.
+    if (directorRun->wakeup != nullptr)
+    {
+      directorRun->wakeup->SetHandler([this, directorRun]()
+      {
+        directorRun->strand.Post([this, directorRun]()
+        {
+          TickDirector(directorRun);
+        });
+      });
+    }
+
+    if (directorRun->isTicked)
+      TickDirector(directorRun);
   });
+}
 
-  // Lobby director
-  _lobbyDirectorThread = std::thread([this]()
+void ServerInstance::TickDirector(
+  const std::shared_ptr<DirectorRun>& directorRun,
+  std::optional<Executor::Clock::time_point> dueTickTime)
+{
+  if (directorRun->isTerminated)
+    return;
+
+  if (not _shouldRun.load(std::memory_order::relaxed))
   {
+    directorRun->isTerminated = true;
+    if (directorRun->wakeup != nullptr)
+      directorRun->wakeup->SetHandler({});
+
     try
     {
-      _lobbyDirector.Initialize();
-      RunDirectorTaskLoop(_lobbyDirector);
-      _lobbyDirector.Terminate();
+      directorRun->terminate();
     }
     catch (const std::exception& x)
     {
-      spdlog::error("Unhandled exception in the lobby director: {}", x.what());
+      spdlog::error("Unhandled exception in {}: {}", directorRun->name, x.what());
       DumpStackTrace();
-
-      _shouldRun = false;
     }
-  });
 
-  // Messenger director
-  if (_config.messenger.enabled)
+    OnDirectorFinished();
+    return;
+  }
+
+  if (not directorRun->isTicked)
+    return;
+
+  const auto now = Executor::Clock::now();
+  const auto intervalTickTime = directorRun->lastTickTime + directorRun->tickInterval;
+  if (now >= intervalTickTime)
+    directorRun->immediateTickCount = 0;
+
+  if (dueTickTime)
   {
-    _messengerThread = std::thread([this]()
+    // The time-driven tick might be late, in which case the late ticks
+    // are either caught up with by ticking back to back or skipped.
+    directorRun->lastDueTickTime = *dueTickTime;
+
+    const auto lateTickCount = static_cast<uint64_t>(
+      (now - *dueTickTime) / directorRun->tickInterval);
+    if (lateTickCount > 0
+      && (not directorRun->ticks.catchUp || lateTickCount > MaxCatchUpDirectorTicks))
     {
-      try
+      directorRun->lastDueTickTime = now;
+
       {
-        _messengerDirector.Initialize();
-        RunDirectorTaskLoop(_messengerDirector);
-        _messengerDirector.Terminate();
+        std::scoped_lock lock(directorRun->statisticsMutex);
+        directorRun->statistics.skippedTickCount += lateTickCount;
       }
-      catch (const std::exception& x)
-      {
-        spdlog::error("Unhandled exception in the messenger director: {}", x.what());
-        DumpStackTrace();
 
-        _shouldRun = false;
+      if (now - directorRun->lastSkipWarningTime >= DirectorSkipWarningInterval)
+      {
+        directorRun->lastSkipWarningTime = now;
+        spdlog::warn("{} is behind and skipped {} ticks", directorRun->name, lateTickCount);
       }
-    });
-
-    // All chat director
-    if (_config.allChat.enabled) // All chat depends on messenger
+    }
+  }
+  else
+  {
+    // A director woken up repeatedly, for example by work it queues to itself,
+    // ticks right away only a limited count of times within the tick interval,
+    // so that a director polling for work does not spin.
+    if (now < intervalTickTime)
     {
-      _allChatDirectorThread = std::thread([this]()
+      if (directorRun->immediateTickCount >= MaxImmediateDirectorTicks)
       {
-        try
-        {
-          _allChatDirector.Initialize();
-          RunDirectorTaskLoop(_allChatDirector);
-          _allChatDirector.Terminate();
-        }
-        catch (const std::exception& x)
-        {
-          spdlog::error("Unhandled exception in the messenger (all chat) director: {}", x.what());
-          DumpStackTrace();
+        ArmDirectorTimer(directorRun, intervalTickTime);
+        return;
+      }
 
-          _shouldRun = false;
-        }
-      });
+      ++directorRun->immediateTickCount;
     }
 
-    // Private chat director
-    if (_config.privateChat.enabled) // Private chat depends on messenger
-    {
-      _privateChatDirectorThread = std::thread([this]()
-      {
-        try
-        {
-          _privateChatDirector.Initialize();
-          RunDirectorTaskLoop(_privateChatDirector);
-          _privateChatDirector.Terminate();
-        }
-        catch (const std::exception& x)
-        {
-          spdlog::error("Unhandled exception in the messenger (private chat) director: {}", x.what());
-          DumpStackTrace();
+    directorRun->lastDueTickTime = now;
+  }
 
-          _shouldRun = false;
-        }
-      });
-    }
+  directorRun->lastTickTime = now;
+
+  // The work queued from now on wakes the director up again.
+  if (directorRun->wakeup != nullptr)
+    directorRun->wakeup->Reset();
+
+  try
+  {
+    directorRun->tick();
+  }
+  catch (const std::exception& x)
+  {
+    spdlog::error("Exception in tick loop: {}", x.what());
   }
 
-  // Ranch director
-  _ranchDirectorThread = std::thread([this]()
+  OnDirectorTicked(*directorRun, Executor::Clock::now() - now);
+
+  if (not directorRun->nextTickTime)
+    return;
+
+  std::optional<Executor::Clock::time_point> nextTickTime;
+  try
   {
-    try
-    {
-      _ranchDirector.Initialize();
-      RunDirectorTaskLoop(_ranchDirector);
-      _ranchDirector.Terminate();
-    }
-    catch (const std::exception& x)
-    {
-      spdlog::error("Unhandled exception in the ranch director: {}", x.what());
-      DumpStackTrace();
+    nextTickTime = directorRun->nextTickTime();
+  }
+  catch (const std::exception& x)
+  {
+    spdlog::error("Exception determining the next tick of {}: {}", directorRun->name, x.what());
+    // Keep ticking at the tick rate.
+    nextTickTime = now;
+  }
 
-      _shouldRun = false;
-    }
-  });
+  // The time-driven ticks follow the last due tick at most at the tick rate.
+  if (nextTickTime)
+  {
+    ArmDirectorTimer(
+      directorRun,
+      std::max(*nextTickTime, directorRun->lastDueTickTime + directorRun->tickInterval));
+  }
+}
+
+void ServerInstance::OnDirectorTicked(
+  DirectorRun& directorRun,
+  Executor::Clock::duration tickDuration)
+{
+  Profiler::Global().Record(directorRun.profilerSection, tickDuration);
 
-  // Race director
-  _raceDirectorThread = std::thread([this]()
+  const bool isOverrun = tickDuration > directorRun.tickInterval;
+
+  if (directorRun.ticks.adaptive)
   {
-    try
+    const auto minTickInterval = GetTickInterval(directorRun.ticks.tickRate);
+    const auto maxTickInterval = GetTickInterval(directorRun.ticks.minTickRate);
+
+    if (isOverrun)
     {
-      _raceDirector.Initialize();
-      RunDirectorTaskLoop(_raceDirector);
-      _raceDirector.Terminate();
+      // Halve the tick rate while the ticks overrun their budget.
+      directorRun.fittingTickCount = 0;
+      directorRun.tickInterval = std::min(directorRun.tickInterval * 2, maxTickInterval);
     }
-    catch (const std::exception& x)
+    else if (tickDuration <= directorRun.tickInterval / 2)
     {
-      spdlog::error("Unhandled exception in the race director: {}", x.what());
-      DumpStackTrace();
-
-      _shouldRun = false;
+      // Double the tick rate back once the ticks fit in their budget for a while.
+      if (++directorRun.fittingTickCount >= AdaptiveRecoveryDirectorTicks)
+      {
+        directorRun.fittingTickCount = 0;
+        directorRun.tickInterval = std::max(directorRun.tickInterval / 2, minTickInterval);
+      }
     }
+    else
+    {
+      directorRun.fittingTickCount = 0;
+    }
+  }
+
+  const auto tickDurationUs = std::chrono::duration_cast<std::chrono::microseconds>(
+    tickDuration);
+
+  std::scoped_lock lock(directorRun.statisticsMutex);
+  auto& statistics = directorRun.statistics;
+  statistics.tickRate = static_cast<uint32_t>(std::chrono::seconds(1) / directorRun.tickInterval);
+  ++statistics.tickCount;
+  if (isOverrun)
+    ++statistics.overrunCount;
+  statistics.totalTickDuration += tickDurationUs;
+  statistics.maxTickDuration = std::max(statistics.maxTickDuration, tickDurationUs);
+}
+
+void ServerInstance::ArmDirectorTimer(
+  const std::shared_ptr<DirectorRun>& directorRun,
+  Executor::Clock::time_point tickTime)
+{
+  // The timer armed sooner ticks the director first,
+  // after which the next tick time is determined again.
+  if (directorRun->timerTime && *directorRun->timerTime <= tickTime)
+    return;
+
+  directorRun->timerTime = tickTime;
+  const auto timerGeneration = ++directorRun->timerGeneration;
+
+  directorRun->strand.PostAt(tickTime, [this, directorRun, timerGeneration, tickTime]()
+  {
+    // The timer was re-armed sooner.
+    if (timerGeneration != directorRun->timerGeneration)
+      return;
+
+    directorRun->timerTime.reset();
+    TickDirector(directorRun, tickTime);
   });
+}
 
-  // Telemetry.
-  if (GetSettings().telemetry.enabled)
+void ServerInstance::OnDirectorFinished()
+{
   {
-    _telemetryThread = std::thread([this]()
+    std::scoped_lock lock(_runningDirectorsMutex);
+    --_runningDirectorCount;
+  }
+  _runningDirectorsCondition.notify_all();
+}
+
+void ServerInstance::ScheduleProfileReport(std::vector<Profiler::Section> earlierProfile)
+{
+  _executor.PostAt(
+    Executor::Clock::now() + _config.profiler.reportInterval,
+    [this, earlierProfile = std::move(earlierProfile)]()
     {
-      try
+      if (not _shouldRun.load(std::memory_order::relaxed))
+        return;
+
+      auto profile = Profiler::Global().Collect();
+      auto intervalProfile = profile;
+      Profiler::Subtract(intervalProfile, earlierProfile);
+
+      std::string report;
+      for (const auto& section : Profiler::Format(intervalProfile, _config.profiler.reportLimit))
       {
-        _telemetry.Initialize();
-        RunDirectorTaskLoop(_telemetry);
-        _telemetry.Terminate();
+        if (not report.empty())
+          report += "; ";
+        report += section;
       }
-      catch (const std::exception& x)
-      {
-        spdlog::error("Unhandled exception in telemetry: {}", x.what());
-        DumpStackTrace();
 
-        _shouldRun = false;
+      if (not report.empty())
+      {
+        spdlog::info(
+          "Profile of the last {}s: {}",
+          _config.profiler.reportInterval.count(),
+          report);
       }
+
+      ScheduleProfileReport(std::move(profile));
     });
-  }
-  else
-  {
-    spdlog::info("Metric collection is disabled");
-  }
 }
 
 void ServerInstance::Terminate()
 {
   _shouldRun.store(false, std::memory_order::relaxed);
+
+  // Wake the directors up so that they terminate.
+  std::scoped_lock lock(_runningDirectorsMutex);
+  for (const auto& directorRun : _directorRuns)
+  {
+    directorRun->strand.Post([this, directorRun]()
+    {
+      TickDirector(directorRun);
+    });
+  }
 }
 
 AuthenticationService& ServerInstance::GetAuthenticationService()
@@ -397,6 +619,64 @@ OtpSystem& ServerInstance::GetOtpSystem()
   return _otpSystem;
 }
 
+std::vector<ServerInstance::DirectorStatistics> ServerInstance::CollectDirectorStatistics()
+{
+  std::vector<DirectorStatistics> statistics;
+
+  std::scoped_lock lock(_runningDirectorsMutex);
+  for (const auto& directorRun : _directorRuns)
+  {
+    if (not directorRun->isTicked)
+      continue;
+
+    std::scoped_lock statisticsLock(directorRun->statisticsMutex);
+    auto& directorStatistics = directorRun->statistics;
+    statistics.emplace_back(directorStatistics);
+
+    // The counters start over, the name and the rate are kept.
+    directorStatistics = DirectorStatistics{
+      .name = statistics.back().name,
+      .tickRate = statistics.back().tickRate};
+  }
+
+  return statistics;
+}
+
+Executor& ServerInstance::GetExecutor()
+{
+  return _executor;
+}
+
+Executor::Strand& ServerInstance::GetLobbyDirectorStrand()
+{
+  return _lobbyDirectorStrand;
+}
+
+Executor::Strand& ServerInstance::GetMessengerDirectorStrand()
+{
+  return _messengerStrand;
+}
+
+Executor::Strand& ServerInstance::GetAllChatDirectorStrand()
+{
+  return _allChatDirectorStrand;
+}
+
+Executor::Strand& ServerInstance::GetPrivateChatDirectorStrand()
+{
+  return _privateChatDirectorStrand;
+}
+
+Executor::Strand& ServerInstance::GetRanchDirectorStrand()
+{
+  return _ranchDirectorStrand;
+}
+
+Executor::Strand& ServerInstance::GetRaceDirectorStrand()
+{
+  return _raceDirectorStrand;
+}
+
 Config& ServerInstance::GetSettings()
 {
   return _config;
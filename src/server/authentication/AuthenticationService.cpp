@@ -101,18 +101,42 @@ void AuthenticationService::Tick() noexcept
   }
 
   _hasVerdicts.store(true, std::memory_order::release);
+  _serverInstance.GetLobbyDirector().GetWakeup().Signal();
 
   _queue.pop();
+
+  // Authenticate the next user right away.
+  if (not _queue.empty())
+    _wakeup.Signal();
+}
+
+Wakeup& AuthenticationService::GetWakeup() noexcept
+{
+  return _wakeup;
+}
+
+std::optional<std::chrono::steady_clock::time_point> AuthenticationService::GetNextTickTime() noexcept
+{
+  // The backend might not have the result of the authentication yet,
+  // in which case it is polled.
+  std::scoped_lock lock(_queueMutex);
+  if (_queue.empty())
+    return std::nullopt;
+  return std::chrono::steady_clock::now();
 }
 
 void AuthenticationService::QueueAuthentication(
   const std::string& userName,
   const std::string& userToken) noexcept
 {
-  std::scoped_lock lock(_queueMutex);
-  _queue.emplace(Authentication{
-    .userName = userName,
-    .userToken = userToken});
+  {
+    std::scoped_lock lock(_queueMutex);
+    _queue.emplace(Authentication{
+      .userName = userName,
+      .userToken = userToken});
+  }
+
+  _wakeup.Signal();
 }
 
 bool AuthenticationService::HasAuthenticationVerdicts() noexcept
@@ -27,7 +27,7 @@ namespace server
 {
 
 AllChatDirector::AllChatDirector(ServerInstance& serverInstance)
-  : _chatterServer(*this)
+  : _chatterServer(*this, serverInstance.GetAllChatDirectorStrand())
   , _serverInstance(serverInstance)
 {
   // Register chatter command handlers
@@ -57,7 +57,13 @@ void AllChatDirector::Initialize()
     GetConfig().listen.address.to_string(),
     GetConfig().listen.port);
 
-  _chatterServer.BeginHost(GetConfig().listen.address, GetConfig().listen.port);
+  auto networkSettings = _serverInstance.GetSettings().network;
+  networkSettings.idleTimeout = GetConfig().idleTimeout;
+
+  _chatterServer.BeginHost(
+    GetConfig().listen.address,
+    GetConfig().listen.port,
+    networkSettings);
 }
 
 void AllChatDirector::Terminate()
@@ -223,7 +229,7 @@ void AllChatDirector::HandleChatterChat(
     .messageAuthor = isGameMaster
       ? std::format("[GM] {}", characterName)
       : characterName,
-    .message = command.message,
+    .message = std::string(command.message),
     .role = protocol::ChatCmdChat::Role::User};
   
   for (const auto& [onlineClientId, onlineClientContext] : _clients)
@@ -27,7 +27,7 @@ namespace server
 {
 
 PrivateChatDirector::PrivateChatDirector(ServerInstance& serverInstance)
-  : _chatterServer(*this)
+  : _chatterServer(*this, serverInstance.GetPrivateChatDirectorStrand())
   , _serverInstance(serverInstance)
 {
   // Register chatter command handlers
@@ -57,7 +57,13 @@ void PrivateChatDirector::Initialize()
     GetConfig().listen.address.to_string(),
     GetConfig().listen.port);
 
-  _chatterServer.BeginHost(GetConfig().listen.address, GetConfig().listen.port);
+  auto networkSettings = _serverInstance.GetSettings().network;
+  networkSettings.idleTimeout = GetConfig().idleTimeout;
+
+  _chatterServer.BeginHost(
+    GetConfig().listen.address,
+    GetConfig().listen.port,
+    networkSettings);
 }
 
 void PrivateChatDirector::Terminate()
@@ -218,7 +224,7 @@ void PrivateChatDirector::HandleChatterChat(
 
   protocol::ChatCmdChatTrs notify{
     .characterUid = conversationContext.characterUid,
-    .message = command.message};
+    .message = std::string(command.message)};
 
   // Send message to invoker
   _chatterServer.QueueCommand<decltype(notify)>(clientId, [notify](){ return notify; });
@@ -27,6 +27,7 @@ namespace server
 
 LobbyDirector::LobbyDirector(ServerInstance& serverInstance)
   : _serverInstance(serverInstance)
+  , _scheduler(_wakeup)
   , _networkHandler(new LobbyNetworkHandler(_serverInstance))
 {
 }
@@ -49,18 +50,8 @@ void LobbyDirector::Terminate()
 
 void LobbyDirector::Tick()
 {
-  // Process the client login response queue.
-  if (not _loginResponseQueue.empty())
-  {
-    ProcesLoginResponse();
-  }
-
-  // Process the client login request queue.
-  if (not _loginRequestQueue.empty())
-  {
-    ProcessLoginRequest();
-  }
-
+  // The verdicts are applied before the queues are processed
+  // so that the logins proceed on the tick the verdicts woke the director up for.
   if (_serverInstance.GetAuthenticationService().HasAuthenticationVerdicts())
   {
     const auto authentications = _serverInstance.GetAuthenticationService().PollAuthenticationVerdicts();
@@ -77,9 +68,44 @@ void LobbyDirector::Tick()
     }
   }
 
+  bool isLoginProgressing = false;
+
+  // Process the client login response queue.
+  if (not _loginResponseQueue.empty())
+  {
+    isLoginProgressing |= ProcesLoginResponse();
+  }
+
+  // Process the client login request queue.
+  if (not _loginRequestQueue.empty())
+  {
+    isLoginProgressing |= ProcessLoginRequest();
+  }
+
+  // Tick again right away if the logins can progress further,
+  // otherwise the authentication or the data director wake the director up.
+  if (isLoginProgressing
+    && (not _loginResponseQueue.empty() || not _loginRequestQueue.empty()))
+  {
+    _wakeup.Signal();
+  }
+
   _scheduler.Tick();
 }
 
+Wakeup& LobbyDirector::GetWakeup()
+{
+  return _wakeup;
+}
+
+std::optional<Scheduler::Clock::time_point> LobbyDirector::GetNextTickTime()
+{
+  // The queued logins are polled as well, in case a wakeup does not arrive.
+  if (not _loginResponseQueue.empty() || not _loginRequestQueue.empty())
+    return Scheduler::Clock::now();
+  return _scheduler.GetNextJobTime();
+}
+
 bool LobbyDirector::QueueClientConnect(network::ClientId clientId)
 {
   const auto [iter, inserted] = _clientLogins.try_emplace(clientId);
@@ -101,6 +127,7 @@ size_t LobbyDirector::QueueClientLogin(
   clientLoginIter->second.userToken = userToken;
 
   _loginRequestQueue.emplace_back(clientId);
+  _wakeup.Signal();
 
   return _loginRequestQueue.size() + _loginResponseQueue.size();
 }
@@ -299,7 +326,7 @@ LobbyNetworkHandler& LobbyDirector::GetNetworkHandler()
   return *_networkHandler;
 }
 
-void LobbyDirector::ProcessLoginRequest()
+bool LobbyDirector::ProcessLoginRequest()
 {
   const network::ClientId clientId = _loginRequestQueue.front();
   auto& loginContext = _clientLogins[clientId];
@@ -312,12 +339,12 @@ void LobbyDirector::ProcessLoginRequest()
       loginContext.userToken);
 
     loginContext.userAuthenticationRequested = true;
-    return;
+    return false;
   }
 
   // If the authentication result is not available skip to the next user.
   if (not loginContext.isAuthenticated.has_value())
-    return;
+    return false;
 
   if (not loginContext.isAuthenticated.value())
   {
@@ -326,22 +353,24 @@ void LobbyDirector::ProcessLoginRequest()
       clientId,
       protocol::AcCmdCLLoginCancel::Reason::InvalidUser);
     _loginRequestQueue.pop_front();
-    return;
+    return true;
   }
 
   // Request the load of the user data if not requested yet.
   if (not loginContext.userLoadRequested)
   {
-    _serverInstance.GetDataDirector().RequestLoadUserData(loginContext.userName);
+    _serverInstance.GetDataDirector().RequestLoadUserData(
+      loginContext.userName,
+      &_wakeup);
 
     loginContext.userLoadRequested = true;
-    return;
+    return false;
   }
 
   // If the data are still being loaded do not proceed with login.
   if (_serverInstance.GetDataDirector().AreDataBeingLoaded(loginContext.userName))
   {
-    return;
+    return false;
   }
 
   _loginRequestQueue.pop_front();
@@ -353,7 +382,7 @@ void LobbyDirector::ProcessLoginRequest()
       clientId,
       protocol::AcCmdCLLoginCancel::Reason::Generic);
     spdlog::warn("Rejected login of user '{}' because of a server error", loginContext.userName);
-    return;
+    return true;
   }
 
   const auto userRecord = _serverInstance.GetDataDirector().GetUser(
@@ -377,9 +406,11 @@ void LobbyDirector::ProcessLoginRequest()
     // Queue the user response.
     _loginResponseQueue.emplace_back(clientId);
   }
+
+  return true;
 }
 
-void LobbyDirector::ProcesLoginResponse()
+bool LobbyDirector::ProcesLoginResponse()
 {
   const network::ClientId clientId = _loginResponseQueue.front();
   auto& loginContext = _clientLogins[clientId];
@@ -389,7 +420,7 @@ void LobbyDirector::ProcesLoginResponse()
   {
     if (_serverInstance.GetDataDirector().AreDataBeingLoaded(loginContext.userName))
     {
-      return;
+      return false;
     }
   }
 
@@ -413,10 +444,11 @@ void LobbyDirector::ProcesLoginResponse()
     {
       _serverInstance.GetDataDirector().RequestLoadCharacterData(
         loginContext.userName,
-        characterUid);
+        characterUid,
+        &_wakeup);
 
       loginContext.userCharacterLoadRequested = true;
-      return;
+      return false;
     }
   }
 
@@ -431,7 +463,7 @@ void LobbyDirector::ProcesLoginResponse()
       clientId,
       protocol::AcCmdCLLoginCancel::Reason::Generic);
     spdlog::warn("Rejected login of user '{}' because of a server error", loginContext.userName);
-    return;
+    return true;
   }
 
   const auto& [iter, inserted] = _userInstances.try_emplace(
@@ -444,7 +476,7 @@ void LobbyDirector::ProcesLoginResponse()
     spdlog::warn(
       "Rejected login of user '{}' because the user is already logged in from different location",
       loginContext.userName);
-    return;
+    return true;
   }
 
   const bool requiresCharacterCreator = _charactersForcedIntoCreator.erase(characterUid) > 0
@@ -465,6 +497,7 @@ void LobbyDirector::ProcesLoginResponse()
   });
 
   _clientLogins.erase(clientId);
+  return true;
 }
 
 } // namespace server
\ No newline at end of file
@@ -28,7 +28,7 @@ std::random_device rd;
 LobbyNetworkHandler::LobbyNetworkHandler(
   ServerInstance& serverInstance)
   : _serverInstance(serverInstance)
-  , _commandServer(*this)
+  , _commandServer(*this, serverInstance.GetLobbyDirectorStrand())
 {
   _commandServer.RegisterCommandHandler<protocol::AcCmdCLLogin>(
     [this](const ClientId clientId, const auto& command)
@@ -292,7 +292,13 @@ void LobbyNetworkHandler::Initialize()
     lobbyConfig.listen.address.to_string(),
     lobbyConfig.listen.port);
 
-  _commandServer.BeginHost(lobbyConfig.listen.address, lobbyConfig.listen.port);
+  auto networkSettings = _serverInstance.GetSettings().network;
+  networkSettings.idleTimeout = lobbyConfig.idleTimeout;
+
+  _commandServer.BeginHost(
+    lobbyConfig.listen.address,
+    lobbyConfig.listen.port,
+    networkSettings);
 }
 
 void LobbyNetworkHandler::Terminate()
@@ -629,7 +635,7 @@ void LobbyNetworkHandler::HandleClientConnected(ClientId clientId)
     clientId,
     _commandServer.GetClientAddress(clientId).to_string());
 
-  _serverInstance.GetLobbyDirector().GetScheduler().Queue(
+  _serverInstance.GetLobbyDirectorStrand().Post(
     [this, clientId]()
     {
       _serverInstance.GetLobbyDirector().QueueClientConnect(clientId);
@@ -640,7 +646,7 @@ void LobbyNetworkHandler::HandleClientDisconnected(ClientId clientId)
 {
     const auto& clientContext = GetClientContext(clientId, false);
 
-    _serverInstance.GetLobbyDirector().GetScheduler().Queue(
+    _serverInstance.GetLobbyDirectorStrand().Post(
       [this, isAuthenticated = clientContext.isAuthenticated, clientId, userName = clientContext.userName]()
       {
         if (isAuthenticated)
@@ -685,7 +691,7 @@ void LobbyNetworkHandler::HandleLogin(
   auto& clientContext = GetClientContext(clientId, false);
   clientContext.userName = command.loginId;
 
-  _serverInstance.GetLobbyDirector().GetScheduler().Queue(
+  _serverInstance.GetLobbyDirectorStrand().Post(
     [this, clientId, userName = command.loginId, userToken = command.authKey]()
     {
       [[maybe_unused]] const auto queuePosition = _serverInstance.GetLobbyDirector().QueueClientLogin(
@@ -1253,7 +1259,7 @@ void LobbyNetworkHandler::HandleMakeRoom(
       return response;
     });
 
-  _serverInstance.GetLobbyDirector().GetScheduler().Queue(
+  _serverInstance.GetLobbyDirectorStrand().Post(
     [this, userName = clientContext.userName, createdRoomUid]()
     {
       _serverInstance.GetLobbyDirector().SetUserRoom(userName, createdRoomUid);
@@ -1392,7 +1398,7 @@ void LobbyNetworkHandler::HandleLeaveRoom(
   const ClientId clientId)
 {
   const auto& clientContext = GetClientContext(clientId);
-  _serverInstance.GetLobbyDirector().GetScheduler().Queue(
+  _serverInstance.GetLobbyDirectorStrand().Post(
     [this, userName = clientContext.userName]()
     {
       _serverInstance.GetLobbyDirector().SetUserRoom(userName, 0);
@@ -1578,7 +1584,7 @@ void LobbyNetworkHandler::HandleCreateNickname(
         user.characterUid() = userCharacterUid;
       });
 
-    _serverInstance.GetLobbyDirector().GetScheduler().Queue(
+    _serverInstance.GetLobbyDirectorStrand().Post(
       [this, userCharacterUid, userName = clientContext.userName]()
       {
         _serverInstance.GetLobbyDirector().GetUser(userName).characterUid = userCharacterUid;
@@ -2162,7 +2168,7 @@ void LobbyNetworkHandler::HandleCheckWaitingSeqno(
   const ClientId clientId,
   [[maybe_unused]] const protocol::AcCmdCLCheckWaitingSeqno& command)
 {
-  _serverInstance.GetLobbyDirector().GetScheduler().Queue([this, clientId]()
+  _serverInstance.GetLobbyDirectorStrand().Post([this, clientId]()
   {
     SendWaitingSeqno(
       clientId,
@@ -2209,15 +2215,7 @@ void LobbyNetworkHandler::HandleUpdateSystemContent(
   protocol::AcCmdLCUpdateSystemContent notify{};
   notify.systemContent.values = {{command.key, command.value}};
 
-  for (const auto& connectedClientId : _clients | std::views::keys)
-  {
-    _commandServer.QueueCommand<decltype(notify)>(
-      connectedClientId,
-      [notify]()
-      {
-        return notify;
-      });
-  }
+  _commandServer.BroadcastCommand(_clients | std::views::keys, notify);
 }
 
 void LobbyNetworkHandler::HandleEnterRoomQuickStop(
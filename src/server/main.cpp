@@ -19,6 +19,7 @@
 
 #include "Version.hpp"
 #include "server/ServerInstance.hpp"
+#include <libserver/util/Profiler.hpp>
 #include <libserver/util/Util.hpp>
 
 #include <spdlog/sinks/daily_file_sink.h>
@@ -93,10 +94,24 @@ void InteractiveLoop()
     const auto command = server::util::TokenizeString(
       commandLine, ' ');
 
+    if (command.empty())
+      continue;
+
     if (command[0] == "exit")
     {
       shouldProgramRun.exchange(false, std::memory_order::relaxed);
     }
+    else if (command[0] == "profile")
+    {
+      // Dump the profile recorded since the start of the server.
+      const auto sections = server::Profiler::Format(
+        server::Profiler::Global().Collect());
+      if (sections.empty())
+        spdlog::info("Profile is empty");
+
+      for (const auto& section : sections)
+        spdlog::info("[Profile] {}", section);
+    }
   }
 }
 
@@ -32,7 +32,7 @@ constexpr auto OnlinePlayersCategoryUid = std::numeric_limits<uint32_t>::max() -
 constexpr std::string_view DateTimeFormat = "{:%H:%M:%S %d/%m/%Y} UTC";
 
 MessengerDirector::MessengerDirector(ServerInstance& serverInstance)
-  : _chatterServer(*this)
+  : _chatterServer(*this, serverInstance.GetMessengerDirectorStrand())
   , _serverInstance(serverInstance)
 {
   // Register chatter command handlers
@@ -146,7 +146,13 @@ void MessengerDirector::Initialize()
     GetConfig().listen.address.to_string(),
     GetConfig().listen.port);
 
-  _chatterServer.BeginHost(GetConfig().listen.address, GetConfig().listen.port);
+  auto networkSettings = _serverInstance.GetSettings().network;
+  networkSettings.idleTimeout = GetConfig().idleTimeout;
+
+  _chatterServer.BeginHost(
+    GetConfig().listen.address,
+    GetConfig().listen.port,
+    networkSettings);
 }
 
 void MessengerDirector::Terminate()
@@ -28,6 +28,7 @@
 #include <spdlog/spdlog.h>
 
 #include <bitset>
+#include <ranges>
 
 namespace server
 {
@@ -72,8 +73,9 @@ const server::registry::Magic::SlotInfo RandomMagicItem(ServerInstance& serverIn
 } // anon namespace
 
 RaceDirector::RaceDirector(ServerInstance& serverInstance)
-  : _serverInstance(serverInstance)
-  , _commandServer(*this)
+  : _scheduler(_wakeup)
+  , _serverInstance(serverInstance)
+  , _commandServer(*this, serverInstance.GetRaceDirectorStrand())
 {
   _commandServer.RegisterCommandHandler<protocol::AcCmdCREnterRoom>(
     [this](ClientId clientId, const auto& message)
@@ -202,7 +204,7 @@ RaceDirector::RaceDirector(ServerInstance& serverInstance)
       HandleRelayCommand(clientId, message);
     });
 
-  _commandServer.RegisterCommandHandler<protocol::AcCmdCRRelay>(
+  _commandServer.RegisterCommandHandler<protocol::AcCmdCRRelayView>(
     [this](ClientId clientId, const auto& message)
     {
       HandleRelay(clientId, message);
@@ -375,7 +377,13 @@ void RaceDirector::Initialize()
   });
   test.detach();
 
-  _commandServer.BeginHost(GetConfig().listen.address, GetConfig().listen.port);
+  auto networkSettings = GetServerInstance().GetSettings().network;
+  networkSettings.idleTimeout = GetConfig().idleTimeout;
+
+  _commandServer.BeginHost(
+    GetConfig().listen.address,
+    GetConfig().listen.port,
+    networkSettings);
 }
 
 void RaceDirector::Terminate()
@@ -384,6 +392,30 @@ void RaceDirector::Terminate()
   _commandServer.EndHost();
 }
 
+Wakeup& RaceDirector::GetWakeup()
+{
+  return _wakeup;
+}
+
+std::optional<Scheduler::Clock::time_point> RaceDirector::GetNextTickTime()
+{
+  {
+    // The stages of the races progress on the ticks.
+    std::scoped_lock lock(_raceInstancesMutex);
+    const bool isAnyRaceInProgress = std::ranges::any_of(
+      std::views::values(_raceInstances),
+      [](const RaceInstance& raceInstance)
+      {
+        return raceInstance.stage != RaceInstance::Stage::Waiting;
+      });
+
+    if (isAnyRaceInProgress)
+      return Scheduler::Clock::now();
+  }
+
+  return _scheduler.GetNextJobTime();
+}
+
 void RaceDirector::Tick()
 {
   try
@@ -1269,9 +1301,9 @@ void RaceDirector::HandleChangeRoomOptions(
 
   protocol::AcCmdCRChangeRoomOptionsNotify notify{
     .optionsBitfield = command.optionsBitfield,
-    .name = command.name,
+    .name = std::string(command.name),
     .playerCount = command.playerCount,
-    .password = command.password,
+    .password = std::string(command.password),
     .gameMode = command.gameMode,
     .mapBlockId = command.mapBlockId,
     .npcDifficulty = command.npcDifficulty};
@@ -1767,6 +1799,8 @@ void RaceDirector::HandleStartRace(
   // Mark the start time of when race started loading
   raceInstance.loadingStartTimePoint = std::chrono::steady_clock::now();
   raceInstance.stageTimeoutTimePoint = raceInstance.loadingStartTimePoint + std::chrono::seconds(30);
+  // Wake the director up to tick the loading stage.
+  _wakeup.Signal();
 
   _serverInstance.GetRoomSystem().GetRoom(
     roomUid,
@@ -2602,12 +2636,8 @@ void RaceDirector::HandleRaceUserPos(
       });
   }
 
-  for (const auto& raceClientId : raceInstance.clients)
-  {
-    // Prevent broadcast to self.
-    if (clientId == raceClientId)
-      continue;
-  }
+  // The position is not forwarded to the other racers,
+  // they follow the racer through its relayed snapshots.
 }
 
 void RaceDirector::HandleChat(ClientId clientId, const protocol::AcCmdCRChat& command)
@@ -2700,12 +2730,7 @@ void RaceDirector::HandleChat(ClientId clientId, const protocol::AcCmdCRChat& co
 
     for (const auto& notify : response)
     {
-      for (const ClientId raceClientId : raceInstance.clients)
-      {
-        _commandServer.QueueCommand<protocol::AcCmdCRChatNotify>(
-          raceClientId,
-          [notify]{ return notify; });
-      }
+      _commandServer.BroadcastCommand(raceInstance.clients, notify);
     }
   }
 }
@@ -2726,20 +2751,19 @@ void RaceDirector::HandleRelayCommand(
   const auto& raceInstance = GetRaceInstance(clientContext);
 
   // Relay the command to all other clients in the room
-  for (const ClientId raceClientId : raceInstance.clients)
-  {
-    if (raceClientId != clientId) // Don't send back to sender
-    {
-      _commandServer.QueueCommand<decltype(notify)>(
-        raceClientId,
-        [notify]{return notify;});
-    }
-  }
+  _commandServer.BroadcastCommand(
+    raceInstance.clients | std::views::filter(
+      [clientId](const ClientId raceClientId)
+      {
+        // Don't send back to sender
+        return raceClientId != clientId;
+      }),
+    notify);
 }
 
 void RaceDirector::HandleRelay(
   ClientId clientId,
-  const protocol::AcCmdCRRelay& command)
+  const protocol::AcCmdCRRelayView& command)
 {
   const auto& clientContext = GetClientContext(clientId);
 
@@ -2748,59 +2772,59 @@ void RaceDirector::HandleRelay(
     .fromOid = command.fromOid,
     .toOid = command.toOid,
     .payloadType = command.payloadType,
-    .data = std::move(command.data),};
+    .data = command.data};
 
   switch (command.payloadType)
   {
     case protocol::relay::RelayCommandId::Snapshot:
     {
-      // Do anything related to `command.snapshot`, if needed
+      // Decode the `snapshot` from `command.data` and handle it, if needed
       break;
     }
     case protocol::relay::RelayCommandId::SyncProgress:
     {
-      // Do anything related to `command.syncProgress`, if needed
+      // Decode the `syncProgress` from `command.data` and handle it, if needed
       break;
     }
     case protocol::relay::RelayCommandId::SetTargetStateEnabled:
     case protocol::relay::RelayCommandId::SetTargetStateDisabled:
     {
-      // Do anything related to `command.setTargetState`, if needed
+      // Decode the `setTargetState` from `command.data` and handle it, if needed
       break;
     }
     case protocol::relay::RelayCommandId::NetSetState:
     {
-      // Do anything related to `command.netSetState`, if needed
+      // Decode the `netSetState` from `command.data` and handle it, if needed
       break;
     }
     case protocol::relay::RelayCommandId::NetSetLayerAnimation:
     {
-      // Do anything related to `command.netSetLayerAnimation`, if needed
+      // Decode the `netSetLayerAnimation` from `command.data` and handle it, if needed
       break;
     }
     case protocol::relay::RelayCommandId::SyncGoalIn:
     {
-      // Do anything related to `command.syncGoalIn`, if needed
+      // Decode the `syncGoalIn` from `command.data` and handle it, if needed
       break;
     }
     case protocol::relay::RelayCommandId::SpurLevel:
     {
-      // Do anything related to `command.spurLevel`, if needed
+      // Decode the `spurLevel` from `command.data` and handle it, if needed
       break;
     }
     case protocol::relay::RelayCommandId::SlidingMotion:
     {
-      // Do anything related to `command.slidingMotion`, if needed
+      // Decode the `slidingMotion` from `command.data` and handle it, if needed
       break;
     }
     case protocol::relay::RelayCommandId::BroadcastCharacterUid:
     {
-      // Do anything related to `command.broadcastCharacterUid`, if needed
+      // Decode the `broadcastCharacterUid` from `command.data` and handle it, if needed
       break;
     }
     case protocol::relay::RelayCommandId::ResetPosOther:
     {
-      // Do anything related to `command.resetPosOther`, if needed
+      // Decode the `resetPosOther` from `command.data` and handle it, if needed
       break;
     }
     default:
@@ -2820,6 +2844,18 @@ void RaceDirector::HandleRelay(
     }
   }
 
+  // Snapshots and progress of the same racer supersede each other
+  // for the clients which are not keeping up with their writes.
+  // The other payloads are events and must not be dropped.
+  network::CoalescingKey coalescingKey = 0;
+  if (command.payloadType == protocol::relay::RelayCommandId::Snapshot
+    || command.payloadType == protocol::relay::RelayCommandId::SyncProgress)
+  {
+    coalescingKey = network::MakeCoalescingKey(
+      static_cast<uint32_t>(decltype(notify)::GetCommand()),
+      static_cast<uint32_t>(command.payloadType) << 16 | command.fromOid);
+  }
+
   std::scoped_lock lock(_raceInstancesMutex);
   // Get the room instance for this client
   const auto& raceInstance = GetRaceInstance(clientContext);
@@ -2828,15 +2864,15 @@ void RaceDirector::HandleRelay(
 
   // TODO: potential improvement - instead of blindly broadcasting to room,
   // forward packet to recepient if `toOid` is non-zero.
-  for (const ClientId raceClientId : raceInstance.clients)
-  {
-    if (raceClientId != clientId) // Don't send back to sender
-    {
-      _commandServer.QueueCommand<decltype(notify)>(
-        raceClientId,
-        [notify]{return notify;});
-    }
-  }
+  _commandServer.BroadcastCommand(
+    raceInstance.clients | std::views::filter(
+      [clientId](const ClientId raceClientId)
+      {
+        // Don't send back to sender
+        return raceClientId != clientId;
+      }),
+    notify,
+    coalescingKey);
 }
 
 void RaceDirector::HandleUserRaceActivateInteractiveEvent(
@@ -3689,7 +3725,9 @@ void RaceDirector::RemoveEffect(
     return;
   }
   racer.effects[effectId] = false;
-  ++racer.effectGenerations[effectId];
+  // The removal job may already be executing, clearing its ID makes it stale.
+  _scheduler.Cancel(racer.effectRemovalJobs[effectId]);
+  racer.effectRemovalJobs[effectId] = 0;
 
   const protocol::AcCmdRCRemoveSkillEffect removeSkillEffect{
     .characterOid = racer.oid,
@@ -3800,7 +3838,10 @@ RaceDirector::EffectVerdict RaceDirector::ScheduleSkillEffect(
     return EffectVerdict::Duplicated;
 
   targetRacer.effects[effectId] = true;
-  const uint32_t generation = ++targetRacer.effectGenerations[effectId];
+  // The effect is extended, the removal is rescheduled.
+  // The removal job may already be executing, clearing its ID makes it stale.
+  _scheduler.Cancel(targetRacer.effectRemovalJobs[effectId]);
+  targetRacer.effectRemovalJobs[effectId] = 0;
   if (magicSlotInfo.attackRank > 0)
     targetRacer.attackRank = magicSlotInfo.attackRank;
 
@@ -3821,10 +3862,10 @@ RaceDirector::EffectVerdict RaceDirector::ScheduleSkillEffect(
     }
   }
 
-  _scheduler.Queue(
+  targetRacer.effectRemovalJobs[effectId] = _scheduler.Queue(
     [this, roomUid = raceInstance.roomUid, targetOid, targetCharacterUid, effectId,
-      attackRank = magicSlotInfo.attackRank, generation,
-      clearMagicTarget = magicSlotInfo.attackRank > 1]()
+      attackRank = magicSlotInfo.attackRank,
+      clearMagicTarget = magicSlotInfo.attackRank > 1](Scheduler::JobId removalJobId)
     {
       std::scoped_lock raceInstanceLock(_raceInstancesMutex);
       const auto raceInstanceIter = _raceInstances.find(roomUid);
@@ -3837,11 +3878,12 @@ RaceDirector::EffectVerdict RaceDirector::ScheduleSkillEffect(
         return;
 
       auto& racer = raceInstance.tracker.GetRacer(targetCharacterUid);
-
-      // If the generation has changed, this effect was extended — skip the removal
-      if (racer.effectGenerations[effectId] != generation)
+      // The effect was extended or removed after the job was taken for execution,
+      // but before it locked the race instances.
+      if (racer.effectRemovalJobs[effectId] != removalJobId)
         return;
 
+      racer.effectRemovalJobs[effectId] = 0;
       racer.effects[effectId] = false;
       // Only clear attackRank if a higher-rank attack hasn't replaced this one
       if (attackRank > 0 && racer.attackRank == attackRank)
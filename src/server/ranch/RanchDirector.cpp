@@ -51,7 +51,7 @@ constexpr uint16_t MaxPlenitude = 1200;
 
 RanchDirector::RanchDirector(ServerInstance& serverInstance)
   : _serverInstance(serverInstance)
-  , _commandServer(*this)
+  , _commandServer(*this, serverInstance.GetRanchDirectorStrand())
 {
   _commandServer.RegisterCommandHandler<protocol::AcCmdCREnterRanch>(
     [this](ClientId clientId, const auto& message)
@@ -71,7 +71,7 @@ RanchDirector::RanchDirector(ServerInstance& serverInstance)
       HandleChat(clientId, command);
     });
 
-  _commandServer.RegisterCommandHandler<protocol::AcCmdCRRanchSnapshot>(
+  _commandServer.RegisterCommandHandler<protocol::AcCmdCRRanchSnapshotView>(
     [this](ClientId clientId, const auto& message)
     {
       HandleSnapshot(clientId, message);
@@ -282,15 +282,9 @@ RanchDirector::RanchDirector(ServerInstance& serverInstance)
         .characterUid = command.characterUid};
 
       const auto& clientContext = GetClientContext(clientId);
-      for (const ClientId& ranchClientId : _ranches[clientContext.visitingRancherUid].clients)
-      {
-        _commandServer.QueueCommand<decltype(notify)>(
-          ranchClientId,
-          [notify]()
-          {
-            return notify;
-          });
-      }
+      _commandServer.BroadcastCommand(
+        _ranches[clientContext.visitingRancherUid].clients,
+        notify);
     });
 
   _commandServer.RegisterCommandHandler<protocol::AcCmdCROpCmd>(
@@ -471,7 +465,13 @@ void RanchDirector::Initialize()
     GetConfig().listen.address.to_string(),
     GetConfig().listen.port);
 
-  _commandServer.BeginHost(GetConfig().listen.address, GetConfig().listen.port);
+  auto networkSettings = GetServerInstance().GetSettings().network;
+  networkSettings.idleTimeout = GetConfig().idleTimeout;
+
+  _commandServer.BeginHost(
+    GetConfig().listen.address,
+    GetConfig().listen.port,
+    networkSettings);
 }
 
 void RanchDirector::Terminate()
@@ -1223,18 +1223,13 @@ void RanchDirector::HandleRanchLeave(ClientId clientId)
   protocol::AcCmdCRLeaveRanchNotify notify{
     .characterId = clientContext.characterUid};
 
-  for (const ClientId& ranchClientId : ranchInstance.clients)
-  {
-    if (ranchClientId == clientId)
-      continue;
-
-    _commandServer.QueueCommand<decltype(notify)>(
-      ranchClientId,
-      [notify]()
+  _commandServer.BroadcastCommand(
+    ranchInstance.clients | std::views::filter(
+      [clientId](const ClientId ranchClientId)
       {
-        return notify;
-      });
-  }
+        return ranchClientId != clientId;
+      }),
+    notify);
 }
 
 
@@ -1338,48 +1333,36 @@ void RanchDirector::HandleChat(
 
 void RanchDirector::HandleSnapshot(
   ClientId clientId,
-  const protocol::AcCmdCRRanchSnapshot& command)
+  const protocol::AcCmdCRRanchSnapshotView& command)
 {
   const auto& clientContext = GetClientContext(clientId);
   const auto& ranchInstance = _ranches[clientContext.visitingRancherUid];
 
-  protocol::RanchCommandRanchSnapshotNotify notify{
+  // The spatial is forwarded as it was received.
+  const protocol::RanchCommandRanchSnapshotNotifyView notify{
     .ranchIndex = ranchInstance.tracker.GetCharacterOid(
       clientContext.characterUid),
     .type = command.type,
-  };
+    .spatial = command.spatial};
 
-  switch (command.type)
-  {
-    case protocol::AcCmdCRRanchSnapshot::Full:
-    {
-      if (command.full.ranchIndex != notify.ranchIndex)
-        throw std::runtime_error("Client sent a snapshot for an entity it's not controlling");
-      notify.full = command.full;
-      break;
-    }
-    case protocol::AcCmdCRRanchSnapshot::Partial:
-    {
-      if (command.full.ranchIndex != notify.ranchIndex)
-        throw std::runtime_error("Client sent a snapshot for an entity it's not controlling");
-      notify.partial = command.partial;
-      break;
-    }
-  }
+  if (command.ranchIndex != notify.ranchIndex)
+    throw std::runtime_error("Client sent a snapshot for an entity it's not controlling");
 
-  for (const auto& ranchClient : ranchInstance.clients)
-  {
-    // Do not broadcast to the client that sent the snapshot.
-    if (ranchClient == clientId)
-      continue;
+  // Snapshots of the same entity supersede each other
+  // for the clients which are not keeping up with their writes.
+  const auto coalescingKey = network::MakeCoalescingKey(
+    static_cast<uint32_t>(decltype(notify)::GetCommand()),
+    static_cast<uint32_t>(notify.type) << 16 | notify.ranchIndex);
 
-    _commandServer.QueueCommand<decltype(notify)>(
-      ranchClient,
-      [notify]()
+  // Do not broadcast to the client that sent the snapshot.
+  _commandServer.BroadcastCommand(
+    ranchInstance.clients | std::views::filter(
+      [clientId](const ClientId ranchClientId)
       {
-        return notify;
-      });
-  }
+        return ranchClientId != clientId;
+      }),
+    notify,
+    coalescingKey);
 }
 
 void RanchDirector::HandleEnterBreedingMarket(
@@ -1771,19 +1754,14 @@ void RanchDirector::HandleUpdateMountNickname(
       return response;
     });
   
-  for (const ClientId& ranchClientId : _ranches[clientContext.visitingRancherUid].clients)
-  {
-    // Prevent broadcast to self.
-    if (ranchClientId == clientId)
-      continue;
-
-    _commandServer.QueueCommand<decltype(notify)>(
-      ranchClientId,
-      [notify]()
+  // Prevent broadcast to self.
+  _commandServer.BroadcastCommand(
+    _ranches[clientContext.visitingRancherUid].clients | std::views::filter(
+      [clientId](const ClientId ranchClientId)
       {
-        return notify;
-      });
-  }
+        return ranchClientId != clientId;
+      }),
+    notify);
 }
 
 void RanchDirector::SendUpdateMountNicknameCancel(
@@ -2646,13 +2624,7 @@ void RanchDirector::HandleUpdatePet(
   }
 
   const auto& ranchInstance = _ranches[clientContext.visitingRancherUid];
-  for (const ClientId ranchClientId : ranchInstance.clients)
-  {
-    _commandServer.QueueCommand<decltype(response)>(ranchClientId, [response]()
-      {
-        return response;
-      });
-  }
+  _commandServer.BroadcastCommand(ranchInstance.clients, response);
 }
 
 void RanchDirector::SendUpdatePetCancel(
@@ -83,7 +83,7 @@ ChatSystem::~ChatSystem()
 
 ChatSystem::ChatVerdict ChatSystem::ProcessChatMessage(
   data::Uid characterUid,
-  const std::string& message) noexcept
+  std::string_view message) noexcept
 {
   ChatVerdict verdict;
 
@@ -95,7 +95,7 @@ ChatSystem::ChatVerdict ChatSystem::ProcessChatMessage(
   if (message.starts_with("//"))
   {
     verdict.commandVerdict = ProcessCommandMessage(
-      characterUid, message.substr(2));
+      characterUid, std::string(message.substr(2)));
     return verdict;
   }
 
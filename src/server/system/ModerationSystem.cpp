@@ -50,14 +50,14 @@ void ModerationSystem::ReadConfig(
 }
 
 ModerationSystem::Verdict ModerationSystem::Moderate(
-  const std::string& input) const noexcept
+  std::string_view input) const noexcept
 {
   Verdict verdict;
 
   for (const auto& word : _words)
   {
     // Check if any part of the input matches the word.
-    if (!std::regex_match(input, word.regex))
+    if (!std::regex_match(input.begin(), input.end(), word.regex))
       continue;
 
     // Check if the word is prevented or just censored.
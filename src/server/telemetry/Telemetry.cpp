@@ -33,6 +33,11 @@ void PrepareTables(pqxx::connection& connection)
   tx.exec("create schema if not exists metrics");
   tx.exec("create table if not exists metrics.player_count_time_series(time bigint primary key, value int);");
   tx.exec("create table if not exists metrics.room_count_time_series(time bigint primary key, value int);");
+  tx.exec(
+    "create table if not exists metrics.director_tick_time_series("
+    "time bigint, director text, tick_rate int, tick_count bigint, overrun_count bigint,"
+    " skipped_tick_count bigint, mean_tick_duration_us bigint, max_tick_duration_us bigint,"
+    " primary key (time, director));");
 
   tx.commit();
 }
@@ -41,6 +46,7 @@ void PrepareTables(pqxx::connection& connection)
 
 Telemetry::Telemetry(ServerInstance& serverInstance)
   : _serverInstance(serverInstance)
+  , _scheduler(_wakeup)
 {
 }
 
@@ -81,6 +87,16 @@ void Telemetry::Tick()
   _scheduler.Tick();
 }
 
+Wakeup& Telemetry::GetWakeup()
+{
+  return _wakeup;
+}
+
+std::optional<Scheduler::Clock::time_point> Telemetry::GetNextTickTime()
+{
+  return _scheduler.GetNextJobTime();
+}
+
 void Telemetry::ConnectPostgresBackend()
 {
   const auto& settings = _serverInstance.GetSettings();
@@ -111,6 +127,20 @@ void Telemetry::CollectData()
 
   _playerCountMetric.Collect(playerCount);
   _roomCountMetric.Collect(roomCount);
+
+  for (const auto& statistics : _serverInstance.CollectDirectorStatistics())
+  {
+    const auto tickCount = static_cast<int64_t>(statistics.tickCount);
+    _directorTickMetrics[statistics.name].Collect(DirectorTickMetric{
+      .tickRate = statistics.tickRate,
+      .tickCount = statistics.tickCount,
+      .overrunCount = statistics.overrunCount,
+      .skippedTickCount = statistics.skippedTickCount,
+      .meanTickDuration = tickCount > 0
+        ? statistics.totalTickDuration.count() / tickCount
+        : 0,
+      .maxTickDuration = statistics.maxTickDuration.count()});
+  }
 }
 
 void Telemetry::ScheduleCollectData()
@@ -170,6 +200,33 @@ void Telemetry::SynchronizeData()
       });
 
     roomCountStream.complete();
+
+    auto directorTickStream = pqxx::stream_to::raw_table(tx, "metrics.director_tick_time_series");
+    for (auto& [directorName, directorTickMetric] : _directorTickMetrics)
+    {
+      directorTickMetric.GetAndClearData([&directorTickStream, &directorName](auto& data)
+        {
+          for (const auto& [timePoint, value] : data)
+          {
+            // Idle intervals are not synchronized.
+            if (timePoint == decltype(_playerCountMetric)::Clock::time_point::min()
+              || (value.tickCount == 0 && value.skippedTickCount == 0))
+              continue;
+
+            directorTickStream.write_values(
+              std::chrono::duration_cast<std::chrono::seconds>(timePoint.time_since_epoch()).count(),
+              directorName,
+              value.tickRate,
+              value.tickCount,
+              value.overrunCount,
+              value.skippedTickCount,
+              value.meanTickDuration,
+              value.maxTickDuration);
+          }
+        });
+    }
+
+    directorTickStream.complete();
     tx.commit();
   }
   catch (const pqxx::broken_connection&)
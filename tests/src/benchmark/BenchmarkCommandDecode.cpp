@@ -0,0 +1,209 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include "libserver/network/command/CommandProtocol.hpp"
+#include "libserver/network/command/CommandServer.hpp"
+#include "libserver/util/Stream.hpp"
+
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <format>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+//! Max size of the command data.
+constexpr std::size_t MaxCommandDataSize = 8192;
+
+//! Count of the commands in the synthetic stream.
+constexpr std::size_t CommandCount = 200'000;
+
+//! Count of the times the synthetic stream is decoded.
+constexpr std::size_t Iterations = 5;
+
+//! Initial XOR code of the client.
+constexpr server::protocol::XorCode InitialCode{
+  std::byte{0x12}, std::byte{0x34}, std::byte{0x56}, std::byte{0x78}};
+
+//! Generates a stream of small scrambled commands,
+//! the way a client would send them.
+std::vector<std::byte> GenerateCommandStream()
+{
+  std::mt19937 random(0xA11C1A);
+  std::uniform_int_distribution<int> byteDistribution(0, 0xFF);
+  std::uniform_int_distribution<std::size_t> sizeDistribution(4, 64);
+
+  server::CommandClient client;
+  client.SetCode(InitialCode);
+
+  std::vector<std::byte> stream;
+  for (std::size_t commandIdx = 0; commandIdx < CommandCount; ++commandIdx)
+  {
+    client.RollCode();
+    const auto& code = client.GetRollingCode();
+    const auto padding = static_cast<uint32_t>(client.GetRollingCodeInt()) & 7;
+
+    std::vector<std::byte> data(sizeDistribution(random) + padding);
+    for (auto& byte : data)
+      byte = static_cast<std::byte>(byteDistribution(random));
+    server::protocol::ApplyXorCode(code, data);
+
+    const uint32_t magic = server::protocol::encode_message_magic({
+      .id = static_cast<uint16_t>(server::protocol::Command::AcCmdCRHeartbeat),
+      .length = static_cast<uint16_t>(data.size() + sizeof(server::protocol::MessageMagic))});
+
+    const auto magicOffset = stream.size();
+    stream.resize(stream.size() + sizeof(magic));
+    std::memcpy(stream.data() + magicOffset, &magic, sizeof(magic));
+    stream.insert(stream.end(), data.begin(), data.end());
+  }
+
+  return stream;
+}
+
+//! Consumes the decoded command data, so that the decoding is not optimized away.
+uint64_t Consume(uint64_t checksum, std::span<const std::byte> data)
+{
+  for (const auto byte : data)
+    checksum = checksum * 31 + static_cast<uint64_t>(byte);
+  return checksum;
+}
+
+//! Decodes the stream the way the command server did before the decoding
+//! was made allocation-free: zero-initialized buffer per command
+//! and per-byte stream reads and writes.
+uint64_t DecodeLegacy(std::span<const std::byte> data)
+{
+  server::CommandClient client;
+  client.SetCode(InitialCode);
+
+  uint64_t checksum = 0;
+  server::SourceStream commandStream(data);
+  while (commandStream.GetCursor() != commandStream.Size())
+  {
+    uint32_t magicValue{};
+    commandStream.Read(magicValue);
+    const auto magic = server::protocol::decode_message_magic(magicValue);
+    const size_t commandDataSize = magic.length - sizeof(server::protocol::MessageMagic);
+
+    std::array<std::byte, MaxCommandDataSize> commandDataBuffer{};
+    commandStream.Read(commandDataBuffer.data(), commandDataSize);
+
+    client.RollCode();
+    const auto& code = client.GetRollingCode();
+    const auto padding = static_cast<uint32_t>(client.GetRollingCodeInt()) & 7;
+
+    server::SourceStream dataSourceStream({commandDataBuffer.begin(), commandDataSize});
+    server::SinkStream dataSinkStream({commandDataBuffer.begin(), commandDataBuffer.end()});
+    for (std::size_t idx = 0; idx < dataSourceStream.Size(); idx++)
+    {
+      std::byte v;
+      dataSourceStream.Read(v);
+      dataSinkStream.Write(v ^ code[idx % 4]);
+    }
+
+    checksum = Consume(checksum, {commandDataBuffer.data(), commandDataSize - padding});
+  }
+
+  return checksum;
+}
+
+//! Decodes the stream the way the command server does now:
+//! single pass from the read buffer to a pooled command dispatch.
+uint64_t Decode(std::span<const std::byte> data)
+{
+  server::network::CommandDispatchPool dispatchPool;
+
+  server::CommandClient client;
+  client.SetCode(InitialCode);
+
+  uint64_t checksum = 0;
+  std::size_t cursor = 0;
+  while (cursor != data.size())
+  {
+    uint32_t magicValue{};
+    std::memcpy(&magicValue, data.data() + cursor, sizeof(magicValue));
+    const auto magic = server::protocol::decode_message_magic(magicValue);
+    const size_t commandDataSize = magic.length - sizeof(server::protocol::MessageMagic);
+
+    const auto commandData = data.subspan(
+      cursor + sizeof(server::protocol::MessageMagic),
+      commandDataSize);
+    cursor += magic.length;
+
+    client.RollCode();
+    const auto& code = client.GetRollingCode();
+    const auto padding = static_cast<uint32_t>(client.GetRollingCodeInt()) & 7;
+
+    auto& dispatch = dispatchPool.Acquire();
+    server::protocol::ApplyXorCode(code, commandData, dispatch.PrepareData(commandDataSize));
+    dispatch.CommitData(commandDataSize - padding);
+
+    checksum = Consume(checksum, dispatch.GetData());
+    dispatchPool.Release(dispatch);
+  }
+
+  return checksum;
+}
+
+//! Runs the decoder over the stream and reports the per-command cost.
+//! @returns Checksum of the decoded data.
+template <typename Decoder>
+uint64_t Run(std::string_view name, std::span<const std::byte> stream, Decoder decoder)
+{
+  uint64_t checksum = 0;
+
+  const auto begin = std::chrono::steady_clock::now();
+  for (std::size_t iteration = 0; iteration < Iterations; ++iteration)
+    checksum = decoder(stream);
+  const auto end = std::chrono::steady_clock::now();
+
+  const auto elapsed = std::chrono::duration<double, std::nano>(end - begin).count();
+  std::cout << std::format(
+    "{:<8} {:>10.1f} ns/command\n",
+    name,
+    elapsed / static_cast<double>(CommandCount * Iterations));
+
+  return checksum;
+}
+
+} // namespace
+
+int main()
+{
+  const auto stream = GenerateCommandStream();
+
+  std::cout << std::format(
+    "Decoding {} commands ({} bytes), {} iterations\n",
+    CommandCount,
+    stream.size(),
+    Iterations);
+
+  const auto legacyChecksum = Run("legacy", stream, DecodeLegacy);
+  const auto checksum = Run("current", stream, Decode);
+
+  // Both of the decoders must produce the same data.
+  assert(legacyChecksum == checksum);
+  return legacyChecksum == checksum ? 0 : 1;
+}
@@ -0,0 +1,589 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include "libserver/network/chatter/ChatterProtocol.hpp"
+#include "libserver/network/chatter/proto/ChatterMessageDefinitions.hpp"
+#include "libserver/network/command/CommandProtocol.hpp"
+#include "libserver/network/command/proto/LobbyMessageDefinitions.hpp"
+#include "libserver/network/command/proto/RaceMessageDefinitions.hpp"
+#include "libserver/network/command/proto/RanchMessageDefinitions.hpp"
+#include "libserver/util/Locale.hpp"
+#include "libserver/util/Stream.hpp"
+#include "libserver/util/Xor.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER)
+  #include <malloc.h>
+#endif
+
+namespace
+{
+
+//! Count of the allocations made through the global allocation functions.
+//! The benchmark is single-threaded.
+std::size_t allocationCount = 0;
+
+//! Frees the memory allocated by the unaligned allocation function,
+//! for both of the unaligned deallocation functions.
+void FreeAllocation(void* pointer) noexcept
+{
+#if defined(__GNUC__) && !defined(__clang__)
+  // The replacement allocation functions allocate with `std::malloc`, which GCC
+  // does not know about once it inlines them into the new and delete expressions.
+  #pragma GCC diagnostic push
+  #pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+  std::free(pointer);
+#if defined(__GNUC__) && !defined(__clang__)
+  #pragma GCC diagnostic pop
+#endif
+}
+
+} // namespace
+
+void* operator new(std::size_t size)
+{
+  ++allocationCount;
+  if (void* pointer = std::malloc(size == 0 ? 1 : size))
+    return pointer;
+  throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+  ++allocationCount;
+  const auto align = static_cast<std::size_t>(alignment);
+#if defined(_MSC_VER)
+  // MSVC does not provide std::aligned_alloc.
+  if (void* pointer = _aligned_malloc(size == 0 ? 1 : size, align))
+    return pointer;
+#else
+  if (void* pointer = std::aligned_alloc(align, (size + align - 1) / align * align))
+    return pointer;
+#endif
+  throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept
+{
+  FreeAllocation(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+  FreeAllocation(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept
+{
+#if defined(_MSC_VER)
+  _aligned_free(pointer);
+#else
+  std::free(pointer);
+#endif
+}
+
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept
+{
+#if defined(_MSC_VER)
+  _aligned_free(pointer);
+#else
+  std::free(pointer);
+#endif
+}
+
+namespace
+{
+
+using namespace server;
+using namespace server::protocol;
+
+//! Default count of the times each case runs.
+constexpr std::size_t DefaultIterations = 200'000;
+
+//! Max size of the command data.
+constexpr std::size_t MaxCommandDataSize = 4092;
+
+//! A message of a typical length, in Korean, as the players write them.
+constexpr std::string_view KoreanMessage =
+  "\xEC\x95\x88\xEB\x85\x95\xED\x95\x98\xEC\x84\xB8\xEC\x9A\x94 "
+  "\xEB\xAA\xA8\xEB\x91\x90 \xEB\xA0\x88\xEC\x9D\xB4\xEC\x8A\xA4 "
+  "\xED\x95\x98\xEC\x8B\xA4 \xEB\xB6\x84?";
+
+//! A message of a typical length, in ASCII.
+constexpr std::string_view AsciiMessage =
+  "Anyone up for a race in the forest? Meet at the ranch gate.";
+
+//! Result of a benchmark case.
+struct Result
+{
+  std::string name;
+  std::size_t iterations{};
+  //! Bytes of the wire data encoded or decoded per operation.
+  std::size_t bytes{};
+  double nsPerOperation{};
+  double allocationsPerOperation{};
+
+  [[nodiscard]] double MegabytesPerSecond() const
+  {
+    if (nsPerOperation <= 0.0)
+      return 0.0;
+    return static_cast<double>(bytes) * 1e3 / nsPerOperation;
+  }
+};
+
+//! Value the results of the operations are folded into, so that they are not optimized out.
+volatile std::size_t sideEffect = 0;
+
+//! Runs the operation and measures its cost.
+//! @param name Name of the case.
+//! @param iterations Count of the times the operation runs.
+//! @param bytes Bytes of the wire data processed by one operation.
+//! @param operation Operation returning a value depending on its output.
+template <typename Operation>
+Result Run(
+  std::string_view name,
+  std::size_t iterations,
+  std::size_t bytes,
+  Operation operation)
+{
+  // Warm up the caches and the lazily initialized state, e.g. the locale tables.
+  for (std::size_t iteration = 0; iteration < iterations / 10 + 1; ++iteration)
+    sideEffect = sideEffect + operation();
+
+  const auto allocationsBefore = allocationCount;
+  const auto begin = std::chrono::steady_clock::now();
+  for (std::size_t iteration = 0; iteration < iterations; ++iteration)
+    sideEffect = sideEffect + operation();
+  const auto end = std::chrono::steady_clock::now();
+  const auto allocations = allocationCount - allocationsBefore;
+
+  const auto elapsed = std::chrono::duration<double, std::nano>(end - begin).count();
+  return Result{
+    .name = std::string(name),
+    .iterations = iterations,
+    .bytes = bytes,
+    .nsPerOperation = elapsed / static_cast<double>(iterations),
+    .allocationsPerOperation = static_cast<double>(allocations) / static_cast<double>(iterations)};
+}
+
+//! Serializes the command.
+//! @returns Command data.
+template <typename T>
+std::vector<std::byte> Encode(const T& command)
+{
+  std::vector<std::byte> data(MaxCommandDataSize);
+  SinkStream sink(std::span(data.data(), data.size()));
+  sink.Write(command);
+  data.resize(sink.GetCursor());
+  return data;
+}
+
+//! Builds the benchmark of encoding the command into a reused buffer.
+template <typename T>
+auto EncodeOperation(const T& command, std::vector<std::byte>& buffer)
+{
+  return [&command, &buffer]()
+  {
+    SinkStream sink(std::span(buffer.data(), buffer.size()));
+    sink.Write(command);
+    return sink.GetCursor();
+  };
+}
+
+//! Builds the benchmark of decoding a fresh command from the data,
+//! the way the command servers do for every received command.
+template <typename T>
+auto DecodeOperation(const std::vector<std::byte>& data)
+{
+  return [&data]()
+  {
+    SourceStream source(std::span(data.data(), data.size()));
+    T command{};
+    source.Read(command);
+    return source.GetCursor();
+  };
+}
+
+//! Checks the condition of a round-trip and reports the failed case.
+bool Check(bool condition, std::string_view name)
+{
+  if (not condition)
+    std::cerr << std::format("{}: round-trip mismatch\n", name);
+  return condition;
+}
+
+LobbyCommandLoginOK MakeLoginOK()
+{
+  LobbyCommandLoginOK command{
+    .uid = 1024,
+    .name = "rider",
+    .notice = "Welcome to the server!",
+    .introduction = std::string(AsciiMessage),
+    .level = 60,
+    .carrots = 100'000};
+  for (uint32_t idx = 0; idx < 16; ++idx)
+    command.equipmentItems.emplace_back(Item{.uid = idx, .tid = 30'000 + idx, .count = 1});
+  return command;
+}
+
+LobbyCommandRoomListOK MakeRoomListOK()
+{
+  LobbyCommandRoomListOK command{};
+  for (uint32_t idx = 0; idx < 8; ++idx)
+    command.rooms.emplace_back(LobbyCommandRoomListOK::Room{
+      .uid = idx,
+      .name = std::format("Room number {}", idx),
+      .playerCount = 4,
+      .maxPlayerCount = 8});
+  return command;
+}
+
+AcCmdCRRanchSnapshot::FullSpatial MakeFullSpatial()
+{
+  std::mt19937 random(0xA11C1A);
+  AcCmdCRRanchSnapshot::FullSpatial spatial{
+    .ranchIndex = 3,
+    .time = 0x1000,
+    .velocityX = 1.0f};
+  for (auto& byte : spatial.member4)
+    byte = static_cast<std::byte>(random());
+  for (auto& byte : spatial.matrix)
+    byte = static_cast<std::byte>(random());
+  return spatial;
+}
+
+//! Prints the results as a table.
+void PrintTable(const std::vector<Result>& results)
+{
+  std::cout << std::format(
+    "{:<32} {:>8} {:>12} {:>10} {:>12}\n",
+    "case", "bytes", "ns/op", "MB/s", "allocs/op");
+  for (const auto& result : results)
+  {
+    std::cout << std::format(
+      "{:<32} {:>8} {:>12.1f} {:>10.1f} {:>12.2f}\n",
+      result.name,
+      result.bytes,
+      result.nsPerOperation,
+      result.MegabytesPerSecond(),
+      result.allocationsPerOperation);
+  }
+}
+
+//! Writes the results as JSON, one object per case.
+void WriteJson(const std::vector<Result>& results, std::ostream& output)
+{
+  output << "{\n  \"results\": [\n";
+  for (std::size_t idx = 0; idx < results.size(); ++idx)
+  {
+    const auto& result = results[idx];
+    output << std::format(
+      "    {{\"name\": \"{}\", \"iterations\": {}, \"bytes\": {}, "
+      "\"ns_per_op\": {:.3f}, \"mb_per_s\": {:.3f}, \"allocs_per_op\": {:.3f}}}{}\n",
+      result.name,
+      result.iterations,
+      result.bytes,
+      result.nsPerOperation,
+      result.MegabytesPerSecond(),
+      result.allocationsPerOperation,
+      idx + 1 < results.size() ? "," : "");
+  }
+  output << "  ]\n}\n";
+}
+
+} // namespace
+
+//! Usage: benchmark_protocol [--iterations <count>] [--json <path>]
+int main(int argc, char** argv)
+{
+  std::size_t iterations = DefaultIterations;
+  std::string jsonPath;
+
+  for (int argIdx = 1; argIdx < argc; ++argIdx)
+  {
+    const std::string_view arg = argv[argIdx];
+    if (arg == "--iterations" && argIdx + 1 < argc)
+    {
+      iterations = std::strtoull(argv[++argIdx], nullptr, 10);
+    }
+    else if (arg == "--json" && argIdx + 1 < argc)
+    {
+      jsonPath = argv[++argIdx];
+    }
+    else
+    {
+      std::cerr << "Usage: benchmark_protocol [--iterations <count>] [--json <path>]\n";
+      return 2;
+    }
+  }
+
+  if (iterations == 0)
+  {
+    std::cerr << "The count of iterations must be positive\n";
+    return 2;
+  }
+
+  bool valid = true;
+  std::vector<Result> results;
+  std::vector<std::byte> buffer(MaxCommandDataSize);
+
+  // Lobby.
+  const AcCmdCLLogin login{
+    .constant0 = 0x10,
+    .constant1 = 0x20,
+    .loginId = "rider",
+    .memberNo = 1024,
+    .authKey = "0123456789abcdef0123456789abcdef"};
+  const auto loginData = Encode(login);
+  {
+    AcCmdCLLogin decoded{};
+    SourceStream source(std::span(loginData.data(), loginData.size()));
+    source.Read(decoded);
+    valid &= Check(decoded.authKey == login.authKey && decoded.memberNo == login.memberNo, "lobby/login");
+  }
+  results.emplace_back(Run(
+    "lobby/login/decode", iterations, loginData.size(),
+    DecodeOperation<AcCmdCLLogin>(loginData)));
+
+  const auto loginOK = MakeLoginOK();
+  results.emplace_back(Run(
+    "lobby/login-ok/encode", iterations, Encode(loginOK).size(),
+    EncodeOperation(loginOK, buffer)));
+
+  const auto roomListOK = MakeRoomListOK();
+  results.emplace_back(Run(
+    "lobby/room-list-ok/encode", iterations, Encode(roomListOK).size(),
+    EncodeOperation(roomListOK, buffer)));
+
+  // Ranch.
+  const auto spatial = MakeFullSpatial();
+  std::vector<std::byte> snapshotData(MaxCommandDataSize);
+  {
+    SinkStream sink(std::span(snapshotData.data(), snapshotData.size()));
+    sink.Write(AcCmdCRRanchSnapshot::Full)
+      .Write(spatial);
+    snapshotData.resize(sink.GetCursor());
+  }
+  {
+    AcCmdCRRanchSnapshotView decoded{};
+    SourceStream source(std::span(snapshotData.data(), snapshotData.size()));
+    source.Read(decoded);
+    valid &= Check(decoded.ranchIndex == spatial.ranchIndex, "ranch/snapshot");
+  }
+  results.emplace_back(Run(
+    "ranch/snapshot/decode", iterations, snapshotData.size(),
+    DecodeOperation<AcCmdCRRanchSnapshot>(snapshotData)));
+  results.emplace_back(Run(
+    "ranch/snapshot-view/decode", iterations, snapshotData.size(),
+    DecodeOperation<AcCmdCRRanchSnapshotView>(snapshotData)));
+
+  const RanchCommandRanchSnapshotNotify snapshotNotify{
+    .ranchIndex = spatial.ranchIndex,
+    .type = AcCmdCRRanchSnapshot::Full,
+    .full = spatial};
+  results.emplace_back(Run(
+    "ranch/snapshot-notify/encode", iterations, Encode(snapshotNotify).size(),
+    EncodeOperation(snapshotNotify, buffer)));
+
+  AcCmdCRGetItemFromStorageOK storageOK{
+    .storageItemUid = 0xCAFE,
+    .updatedCarrots = 1000};
+  for (uint32_t idx = 0; idx < 16; ++idx)
+    storageOK.items.emplace_back(Item{.uid = idx, .tid = 30'000 + idx, .count = 1});
+  const auto storageOKData = Encode(storageOK);
+  {
+    AcCmdCRGetItemFromStorageOK decoded{};
+    SourceStream source(std::span(storageOKData.data(), storageOKData.size()));
+    source.Read(decoded);
+    valid &= Check(
+      decoded.items.size() == storageOK.items.size() && decoded.items.back().tid == storageOK.items.back().tid,
+      "ranch/storage-ok");
+  }
+  results.emplace_back(Run(
+    "ranch/storage-ok/encode", iterations, storageOKData.size(),
+    EncodeOperation(storageOK, buffer)));
+  results.emplace_back(Run(
+    "ranch/storage-ok/decode", iterations, storageOKData.size(),
+    DecodeOperation<AcCmdCRGetItemFromStorageOK>(storageOKData)));
+
+  // Race.
+  const AcCmdUserRaceUpdatePos updatePos{
+    .oid = 2,
+    .member2 = {1.0f, 2.0f, 3.0f},
+    .member3 = {0.5f, 0.25f, 0.125f},
+    .member4 = 12.0f,
+    .member6 = 0.75f,
+    .member7 = 4096};
+  const auto updatePosData = Encode(updatePos);
+  {
+    AcCmdUserRaceUpdatePos decoded{};
+    SourceStream source(std::span(updatePosData.data(), updatePosData.size()));
+    source.Read(decoded);
+    valid &= Check(
+      decoded.member2 == updatePos.member2 && decoded.member7 == updatePos.member7,
+      "race/update-pos");
+  }
+  results.emplace_back(Run(
+    "race/update-pos/encode", iterations, updatePosData.size(),
+    EncodeOperation(updatePos, buffer)));
+  results.emplace_back(Run(
+    "race/update-pos/decode", iterations, updatePosData.size(),
+    DecodeOperation<AcCmdUserRaceUpdatePos>(updatePosData)));
+
+  std::vector<uint8_t> relayPayload(56);
+  for (std::size_t idx = 0; idx < relayPayload.size(); ++idx)
+    relayPayload[idx] = static_cast<uint8_t>(idx);
+  const AcCmdCRRelayNotify relayNotify{
+    .fromOid = 1,
+    .toOid = 2,
+    .payloadType = relay::RelayCommandId::Snapshot,
+    .data = relayPayload};
+  // The relay request has the same layout as the notify.
+  const auto relayData = Encode(relayNotify);
+  {
+    AcCmdCRRelayView decoded{};
+    SourceStream source(std::span(relayData.data(), relayData.size()));
+    source.Read(decoded);
+    valid &= Check(std::ranges::equal(decoded.data, relayPayload), "race/relay");
+  }
+  results.emplace_back(Run(
+    "race/relay-view/decode", iterations, relayData.size(),
+    DecodeOperation<AcCmdCRRelayView>(relayData)));
+  results.emplace_back(Run(
+    "race/relay-notify/encode", iterations, relayData.size(),
+    EncodeOperation(relayNotify, buffer)));
+
+  // Chatter.
+  const ChatCmdChannelChatTrs channelChat{
+    .messageAuthor = "rider",
+    .message = std::string(KoreanMessage)};
+  const auto channelChatData = Encode(channelChat);
+  results.emplace_back(Run(
+    "chatter/channel-chat-trs/encode", iterations, channelChatData.size(),
+    EncodeOperation(channelChat, buffer)));
+
+  // The chat request carries the message and the role, as the tail of the transmission.
+  const std::vector<std::byte> chatData(
+    channelChatData.begin() + static_cast<std::ptrdiff_t>(channelChat.messageAuthor.size() + 1),
+    channelChatData.end());
+  {
+    ChatCmdChat decoded{};
+    SourceStream source(std::span(chatData.data(), chatData.size()));
+    source.Read(decoded);
+    valid &= Check(decoded.message == std::string_view(channelChat.message), "chatter/chat");
+  }
+  results.emplace_back(Run(
+    "chatter/chat/decode", iterations, chatData.size(),
+    DecodeOperation<ChatCmdChat>(chatData)));
+
+  // Locale.
+  const auto koreanEncoded = locale::FromUtf8(KoreanMessage);
+  valid &= Check(locale::ToUtf8(koreanEncoded) == KoreanMessage, "locale/korean");
+  std::string localeOutput;
+  results.emplace_back(Run(
+    "locale/korean/from-utf8", iterations, KoreanMessage.size(),
+    [&localeOutput]()
+    {
+      locale::FromUtf8(KoreanMessage, localeOutput);
+      return localeOutput.size();
+    }));
+  results.emplace_back(Run(
+    "locale/korean/to-utf8", iterations, koreanEncoded.size(),
+    [&localeOutput, &koreanEncoded]()
+    {
+      locale::ToUtf8(koreanEncoded, localeOutput);
+      return localeOutput.size();
+    }));
+  results.emplace_back(Run(
+    "locale/ascii/to-utf8", iterations, AsciiMessage.size(),
+    [&localeOutput]()
+    {
+      locale::ToUtf8(AsciiMessage, localeOutput);
+      return localeOutput.size();
+    }));
+
+  // XOR of the largest command data.
+  std::vector<std::byte> scrambled(MaxCommandDataSize);
+  for (std::size_t idx = 0; idx < scrambled.size(); ++idx)
+    scrambled[idx] = static_cast<std::byte>(idx);
+  {
+    const auto original = scrambled;
+    constexpr XorCode Code{std::byte{0x12}, std::byte{0x34}, std::byte{0x56}, std::byte{0x78}};
+    ApplyXorCode(Code, scrambled);
+    ApplyXorCode(Code, scrambled);
+    valid &= Check(scrambled == original, "xor/command");
+
+    results.emplace_back(Run(
+      "xor/command", iterations, scrambled.size(),
+      [&scrambled, &Code]()
+      {
+        ApplyXorCode(Code, scrambled);
+        return static_cast<std::size_t>(scrambled.front());
+      }));
+  }
+  results.emplace_back(Run(
+    "xor/chatter", iterations, scrambled.size(),
+    [&scrambled]()
+    {
+      util::XorWithKey(ChatterXorCode, scrambled);
+      return static_cast<std::size_t>(scrambled.front());
+    }));
+
+  // Message magic.
+  valid &= Check(
+    decode_message_magic(encode_message_magic({.id = 0x7, .length = 1024})).length == 1024,
+    "magic");
+  uint16_t magicLength = 0;
+  results.emplace_back(Run(
+    "magic/round-trip", iterations, sizeof(uint32_t),
+    [&magicLength]()
+    {
+      magicLength = static_cast<uint16_t>((magicLength + 1) % 4092);
+      const auto magic = decode_message_magic(
+        encode_message_magic({.id = 0x7, .length = magicLength}));
+      return static_cast<std::size_t>(magic.length);
+    }));
+
+  PrintTable(results);
+
+  if (not jsonPath.empty())
+  {
+    std::ofstream json(jsonPath);
+    if (not json)
+    {
+      std::cerr << std::format("Couldn't open '{}' for writing\n", jsonPath);
+      return 1;
+    }
+    WriteJson(results, json);
+  }
+
+  return valid ? 0 : 1;
+}
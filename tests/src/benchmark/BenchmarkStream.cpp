@@ -0,0 +1,280 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include "libserver/network/command/proto/RanchMessageDefinitions.hpp"
+#include "libserver/util/Locale.hpp"
+#include "libserver/util/Stream.hpp"
+
+#include <algorithm>
+
+#include <chrono>
+#include <format>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+//! Count of the spatial structures in a payload, as in a busy ranch snapshot.
+constexpr std::size_t SpatialCount = 64;
+
+//! Size of the relayed blob in a payload.
+constexpr std::size_t BlobSize = 1024;
+
+//! Count of the item names in a payload, as in an inventory list.
+constexpr std::size_t NameCount = 64;
+
+//! Count of the times the payload is serialized and deserialized.
+constexpr std::size_t Iterations = 50'000;
+
+//! Synthetic payload mixing the typical bulk contents of the messages.
+struct Payload
+{
+  std::vector<server::protocol::AcCmdCRRanchSnapshot::FullSpatial> spatials;
+  std::vector<std::byte> blob;
+  std::vector<std::string> names;
+};
+
+Payload GeneratePayload()
+{
+  std::mt19937 random(0xA11C1A);
+  std::uniform_int_distribution<int> byteDistribution(0, 0xFF);
+
+  Payload payload;
+  payload.spatials.resize(SpatialCount);
+  for (auto& spatial : payload.spatials)
+  {
+    spatial.ranchIndex = static_cast<uint16_t>(random());
+    spatial.time = random();
+    for (auto& byte : spatial.member4)
+      byte = static_cast<std::byte>(byteDistribution(random));
+    for (auto& byte : spatial.matrix)
+      byte = static_cast<std::byte>(byteDistribution(random));
+  }
+
+  payload.blob.resize(BlobSize);
+  for (auto& byte : payload.blob)
+    byte = static_cast<std::byte>(byteDistribution(random));
+
+  for (std::size_t nameIdx = 0; nameIdx < NameCount; ++nameIdx)
+    payload.names.emplace_back(std::format("Item name number {}", nameIdx));
+
+  return payload;
+}
+
+//! Writes the spatials and the blob the way the streams were used
+//! before the bulk copies, one byte at a time.
+void WriteDataLegacy(const Payload& payload, server::SinkStream& sink)
+{
+  for (const auto& spatial : payload.spatials)
+  {
+    sink.Write(spatial.ranchIndex)
+      .Write(spatial.time)
+      .Write(spatial.action)
+      .Write(spatial.timer);
+    for (const auto byte : spatial.member4)
+      sink.Write(byte);
+    for (const auto byte : spatial.matrix)
+      sink.Write(byte);
+    sink.Write(spatial.velocityX)
+      .Write(spatial.velocityY)
+      .Write(spatial.velocityZ);
+  }
+
+  for (const auto byte : payload.blob)
+    sink.Write(byte);
+}
+
+//! Writes the spatials and the blob with the bulk copies.
+void WriteData(const Payload& payload, server::SinkStream& sink)
+{
+  for (const auto& spatial : payload.spatials)
+    sink.Write(spatial);
+
+  sink.Write(std::span(payload.blob));
+}
+
+//! Reads the spatials and the blob the way the streams were used
+//! before the bulk copies, one byte at a time.
+void ReadDataLegacy(Payload& payload, server::SourceStream& source)
+{
+  for (auto& spatial : payload.spatials)
+  {
+    source.Read(spatial.ranchIndex)
+      .Read(spatial.time)
+      .Read(spatial.action)
+      .Read(spatial.timer);
+    for (auto& byte : spatial.member4)
+      source.Read(byte);
+    for (auto& byte : spatial.matrix)
+      source.Read(byte);
+    source.Read(spatial.velocityX)
+      .Read(spatial.velocityY)
+      .Read(spatial.velocityZ);
+  }
+
+  for (auto& byte : payload.blob)
+    source.Read(byte);
+}
+
+//! Reads the spatials and the blob with the bulk copies.
+void ReadData(Payload& payload, server::SourceStream& source)
+{
+  for (auto& spatial : payload.spatials)
+    source.Read(spatial);
+
+  source.Read(std::span(payload.blob));
+}
+
+//! Writes the names the way the streams did before the bulk copies, one char at a time.
+void WriteNamesLegacy(const Payload& payload, server::SinkStream& sink)
+{
+  for (const auto& name : payload.names)
+  {
+    for (const char character : server::locale::FromUtf8(name))
+      sink.Write(character);
+    sink.Write('\0');
+  }
+}
+
+//! Writes the names with the bulk copies.
+void WriteNames(const Payload& payload, server::SinkStream& sink)
+{
+  for (const auto& name : payload.names)
+    sink.Write(name);
+}
+
+//! Reads the names the way the streams did before the bulk copies, one char at a time.
+void ReadNamesLegacy(Payload& payload, server::SourceStream& source)
+{
+  for (auto& name : payload.names)
+  {
+    std::string buffer;
+    buffer.reserve(512);
+
+    char character = '\0';
+    while (source.Read(character), character != '\0')
+      buffer += character;
+
+    name = server::locale::ToUtf8(buffer);
+  }
+}
+
+//! Reads the names with the bulk copies.
+void ReadNames(Payload& payload, server::SourceStream& source)
+{
+  for (auto& name : payload.names)
+    source.Read(name);
+}
+
+//! Runs the function and reports the per-payload cost.
+template <typename Function>
+void Run(std::string_view name, Function function)
+{
+  const auto begin = std::chrono::steady_clock::now();
+  for (std::size_t iteration = 0; iteration < Iterations; ++iteration)
+    function();
+  const auto end = std::chrono::steady_clock::now();
+
+  const auto elapsed = std::chrono::duration<double, std::nano>(end - begin).count();
+  std::cout << std::format(
+    "{:<20} {:>10.1f} ns/payload\n",
+    name,
+    elapsed / static_cast<double>(Iterations));
+}
+
+//! Benchmarks the legacy and the bulk serialization of a part of the payload
+//! and verifies that both produce the same wire output and read it back.
+//! @returns `true` if the outputs match, `false` otherwise.
+template <typename LegacyWriter, typename Writer, typename LegacyReader, typename Reader>
+bool Benchmark(
+  std::string_view name,
+  const Payload& payload,
+  LegacyWriter legacyWriter,
+  Writer writer,
+  LegacyReader legacyReader,
+  Reader reader)
+{
+  std::vector<std::byte> legacyBuffer(64 * 1024);
+  std::vector<std::byte> buffer(64 * 1024);
+  std::size_t legacySize = 0;
+  std::size_t size = 0;
+
+  Run(std::format("{}/write-legacy", name), [&]()
+  {
+    server::SinkStream sink(legacyBuffer);
+    legacyWriter(payload, sink);
+    legacySize = sink.GetCursor();
+  });
+
+  Run(std::format("{}/write", name), [&]()
+  {
+    server::SinkStream sink(buffer);
+    writer(payload, sink);
+    size = sink.GetCursor();
+  });
+
+  // The wire output must not change.
+  if (size != legacySize
+    || not std::equal(buffer.begin(), buffer.begin() + size, legacyBuffer.begin()))
+  {
+    std::cerr << std::format("{}: serialized payloads differ\n", name);
+    return false;
+  }
+
+  Payload legacyReadPayload = payload;
+  Run(std::format("{}/read-legacy", name), [&]()
+  {
+    server::SourceStream source({legacyBuffer.data(), legacySize});
+    legacyReader(legacyReadPayload, source);
+  });
+
+  Payload readPayload = payload;
+  Run(std::format("{}/read", name), [&]()
+  {
+    server::SourceStream source({buffer.data(), size});
+    reader(readPayload, source);
+  });
+
+  if (readPayload.blob != payload.blob || readPayload.names != payload.names)
+  {
+    std::cerr << std::format("{}: deserialized payloads differ\n", name);
+    return false;
+  }
+
+  std::cout << std::format("{}: {} bytes\n", name, size);
+  return true;
+}
+
+} // namespace
+
+int main()
+{
+  const auto payload = GeneratePayload();
+
+  std::cout << std::format("{} iterations\n", Iterations);
+
+  const bool dataMatch = Benchmark(
+    "data", payload, WriteDataLegacy, WriteData, ReadDataLegacy, ReadData);
+  const bool namesMatch = Benchmark(
+    "names", payload, WriteNamesLegacy, WriteNames, ReadNamesLegacy, ReadNames);
+
+  return dataMatch && namesMatch ? 0 : 1;
+}
@@ -0,0 +1,258 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include "libserver/network/CommandDispatch.hpp"
+#include "libserver/network/command/proto/RaceMessageDefinitions.hpp"
+#include "libserver/network/command/proto/RanchMessageDefinitions.hpp"
+#include "libserver/util/Executor.hpp"
+#include "libserver/util/Stream.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <format>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+using namespace server;
+using namespace server::protocol;
+
+//! Count of the messages decoded and forwarded.
+constexpr std::size_t Iterations = 1'000'000;
+
+//! Size of the relayed racer snapshot.
+constexpr std::size_t RelaySnapshotSize = 56;
+
+//! Ranch index of the entity in the ranch snapshot.
+constexpr uint16_t RanchIndex = 3;
+
+std::vector<std::byte> GenerateBytes(std::size_t size)
+{
+  std::mt19937 random(0xA11C1A);
+  std::uniform_int_distribution<int> byteDistribution(0, 0xFF);
+
+  std::vector<std::byte> bytes(size);
+  for (auto& byte : bytes)
+    byte = static_cast<std::byte>(byteDistribution(random));
+  return bytes;
+}
+
+//! Generates the command data of a relayed racer snapshot, as a client would send it.
+std::vector<std::byte> GenerateRelay()
+{
+  const auto payload = GenerateBytes(RelaySnapshotSize);
+
+  std::vector<std::byte> data(128);
+  SinkStream sink(data);
+  sink.Write(uint16_t{1})
+    .Write(uint16_t{0})
+    .Write(relay::RelayCommandId::Snapshot)
+    .Write(static_cast<uint16_t>(payload.size()))
+    .Write(std::span(payload));
+  data.resize(sink.GetCursor());
+  return data;
+}
+
+//! Generates the command data of a full ranch snapshot, as a client would send it.
+std::vector<std::byte> GenerateRanchSnapshot()
+{
+  auto spatial = GenerateBytes(*AcCmdCRRanchSnapshot::FullSpatial::Schema::FixedSize);
+  std::memcpy(spatial.data(), &RanchIndex, sizeof(RanchIndex));
+
+  std::vector<std::byte> data(128);
+  SinkStream sink(data);
+  sink.Write(AcCmdCRRanchSnapshot::Full)
+    .Write(std::span(spatial));
+  data.resize(sink.GetCursor());
+  return data;
+}
+
+//! Pool of the command dispatches, as in the command server.
+network::CommandDispatchPool dispatchPool;
+
+//! Dispatches the command data the way the command server does:
+//! copies them to a pooled dispatch, as the unscrambling does,
+//! decodes the command there and forwards it from a task posted to the handler strand,
+//! which is run in place.
+//! @returns Size of the forwarded message.
+template <typename Command, typename Forwarder>
+std::size_t Dispatch(
+  std::span<const std::byte> data,
+  std::span<std::byte> output,
+  Forwarder forwarder)
+{
+  auto& dispatch = dispatchPool.Acquire();
+  std::ranges::copy(data, dispatch.PrepareData(data.size()).begin());
+  std::ignore = dispatch.Decode<Command>();
+
+  std::size_t size = 0;
+  const auto forward = [&]()
+  {
+    size = forwarder(dispatch.GetCommand<Command>(), output);
+  };
+
+  // The task captures only a pointer, as the posted task of the command server does.
+  const Executor::Task task = [&forward]()
+  {
+    forward();
+  };
+  task();
+
+  dispatchPool.Release(dispatch);
+  return size;
+}
+
+//! Forwards the relay the way the handler did before the views:
+//! decodes the owning command, parsing the payload,
+//! and copies the payload to the notify.
+std::size_t ForwardRelayOwning(const AcCmdCRRelay& command, std::span<std::byte> output)
+{
+  const std::vector<uint8_t> payload(command.data.begin(), command.data.end());
+
+  SinkStream sink(output);
+  sink.Write(command.fromOid)
+    .Write(command.toOid)
+    .Write(command.payloadType)
+    .Write(static_cast<uint16_t>(payload.size()));
+  for (const uint8_t datum : payload)
+    sink.Write(datum);
+  return sink.GetCursor();
+}
+
+//! Forwards the relay through the view borrowing the payload from the command data.
+std::size_t ForwardRelayView(const AcCmdCRRelayView& command, std::span<std::byte> output)
+{
+  const AcCmdCRRelayNotify notify{
+    .fromOid = command.fromOid,
+    .toOid = command.toOid,
+    .payloadType = command.payloadType,
+    .data = command.data};
+
+  SinkStream sink(output);
+  sink.Write(notify);
+  return sink.GetCursor();
+}
+
+//! Forwards the ranch snapshot the way the handler did before the views:
+//! decodes the owning spatial and copies it to the notify.
+std::size_t ForwardRanchSnapshotOwning(const AcCmdCRRanchSnapshot& command, std::span<std::byte> output)
+{
+  RanchCommandRanchSnapshotNotify notify{
+    .ranchIndex = RanchIndex,
+    .type = command.type};
+  if (command.full.ranchIndex != notify.ranchIndex)
+    return 0;
+  notify.full = command.full;
+
+  SinkStream sink(output);
+  sink.Write(notify);
+  return sink.GetCursor();
+}
+
+//! Forwards the ranch snapshot through the view borrowing the spatial from the command data.
+std::size_t ForwardRanchSnapshotView(const AcCmdCRRanchSnapshotView& command, std::span<std::byte> output)
+{
+  const RanchCommandRanchSnapshotNotifyView notify{
+    .ranchIndex = RanchIndex,
+    .type = command.type,
+    .spatial = command.spatial};
+  if (command.ranchIndex != notify.ranchIndex)
+    return 0;
+
+  SinkStream sink(output);
+  sink.Write(notify);
+  return sink.GetCursor();
+}
+
+//! Runs the dispatch of the message and reports the per-message cost,
+//! including the copy to the dispatch, the decoding and the forwarding.
+//! @returns Size of the forwarded message.
+template <typename Command, typename Forwarder>
+std::size_t Run(
+  std::string_view name,
+  std::span<const std::byte> data,
+  std::span<std::byte> output,
+  Forwarder forwarder)
+{
+  std::size_t size = 0;
+
+  const auto begin = std::chrono::steady_clock::now();
+  for (std::size_t iteration = 0; iteration < Iterations; ++iteration)
+    size = Dispatch<Command>(data, output, forwarder);
+  const auto end = std::chrono::steady_clock::now();
+
+  const auto elapsed = std::chrono::duration<double, std::nano>(end - begin).count();
+  std::cout << std::format(
+    "{:<24} {:>10.1f} ns/message\n",
+    name,
+    elapsed / static_cast<double>(Iterations));
+  return size;
+}
+
+//! Benchmarks the owning and the view forwarding of a message
+//! and verifies that both produce the same wire output.
+//! @returns `true` if the outputs match, `false` otherwise.
+template <typename OwningCommand, typename ViewCommand, typename OwningForwarder, typename ViewForwarder>
+bool Benchmark(
+  std::string_view name,
+  std::span<const std::byte> data,
+  OwningForwarder owningForwarder,
+  ViewForwarder viewForwarder)
+{
+  std::vector<std::byte> owningOutput(1024);
+  std::vector<std::byte> viewOutput(1024);
+
+  const auto owningSize = Run<OwningCommand>(
+    std::format("{}/owning", name), data, owningOutput, owningForwarder);
+  const auto viewSize = Run<ViewCommand>(
+    std::format("{}/view", name), data, viewOutput, viewForwarder);
+
+  // The wire output must not change.
+  if (owningSize == 0
+    || owningSize != viewSize
+    || not std::equal(owningOutput.begin(), owningOutput.begin() + owningSize, viewOutput.begin()))
+  {
+    std::cerr << std::format("{}: forwarded messages differ\n", name);
+    return false;
+  }
+
+  std::cout << std::format("{}: {} bytes\n", name, viewSize);
+  return true;
+}
+
+} // namespace
+
+int main()
+{
+  const auto relay = GenerateRelay();
+  const auto ranchSnapshot = GenerateRanchSnapshot();
+
+  std::cout << std::format("{} iterations\n", Iterations);
+
+  const bool relayMatch = Benchmark<AcCmdCRRelay, AcCmdCRRelayView>(
+    "relay", relay, ForwardRelayOwning, ForwardRelayView);
+  const bool ranchSnapshotMatch = Benchmark<AcCmdCRRanchSnapshot, AcCmdCRRanchSnapshotView>(
+    "ranch-snapshot", ranchSnapshot, ForwardRanchSnapshotOwning, ForwardRanchSnapshotView);
+
+  return relayMatch && ranchSnapshotMatch ? 0 : 1;
+}
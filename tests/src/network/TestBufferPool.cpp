@@ -0,0 +1,92 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include <libserver/network/BufferPool.hpp>
+
+#include <cassert>
+
+namespace
+{
+
+//! Test that released buffers are reused with their capacity retained.
+void TestBufferReuse()
+{
+  server::network::BufferPool pool(4, 1024);
+
+  const server::network::Buffer* bufferAddress = nullptr;
+  {
+    const auto buffer = pool.Acquire();
+    assert(buffer->empty());
+
+    buffer->resize(512);
+    bufferAddress = buffer.get();
+  }
+
+  assert(pool.GetIdleBufferCount() == 1);
+
+  const auto buffer = pool.Acquire();
+  assert(buffer.get() == bufferAddress);
+  assert(buffer->empty());
+  assert(buffer->capacity() >= 512);
+  assert(pool.GetIdleBufferCount() == 0);
+}
+
+//! Test that the pool does not retain more buffers than allowed,
+//! nor buffers which grew too large.
+void TestBufferLimits()
+{
+  server::network::BufferPool pool(2, 1024);
+
+  {
+    const auto first = pool.Acquire();
+    const auto second = pool.Acquire();
+    const auto third = pool.Acquire();
+  }
+
+  assert(pool.GetIdleBufferCount() == 2);
+
+  {
+    const auto buffer = pool.Acquire();
+    buffer->resize(4096);
+  }
+
+  assert(pool.GetIdleBufferCount() == 1);
+}
+
+//! Test that a buffer may outlive its pool.
+void TestBufferOutlivesPool()
+{
+  server::network::BufferHandle buffer;
+  {
+    server::network::BufferPool pool;
+    buffer = pool.Acquire();
+  }
+
+  buffer->resize(16);
+  buffer.reset();
+}
+
+} // namespace
+
+int main()
+{
+  TestBufferReuse();
+  TestBufferLimits();
+  TestBufferOutlivesPool();
+}
@@ -0,0 +1,174 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include <libserver/network/Capture.hpp>
+#include <libserver/network/chatter/ChatterProtocol.hpp>
+#include <libserver/network/command/CommandServer.hpp>
+#include <libserver/util/Xor.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+namespace
+{
+
+using namespace server;
+
+std::vector<std::byte> MakeData(std::size_t size, uint8_t seed)
+{
+  std::vector<std::byte> data(size);
+  for (std::size_t idx = 0; idx < size; ++idx)
+    data[idx] = static_cast<std::byte>(seed + idx);
+  return data;
+}
+
+//! Test that the records are read back as they were written.
+void TestRoundTrip(const std::filesystem::path& path)
+{
+  const auto command = MakeData(37, 0x10);
+  const protocol::XorCode code{std::byte{1}, std::byte{2}, std::byte{3}, std::byte{4}};
+
+  {
+    network::CaptureWriter writer(path, network::CaptureProtocol::Command, 10030);
+    writer.WriteConnected(7);
+    writer.WriteCommand(7, 0x12, {});
+    writer.WriteCommand(7, 0x7, command);
+    writer.WriteCodeChanged(7, code);
+    writer.WriteDisconnected(7);
+  }
+
+  network::CaptureReader reader(path);
+  assert(reader.GetHeader().protocol == network::CaptureProtocol::Command);
+  assert(reader.GetHeader().port == 10030);
+
+  std::vector<network::CaptureRecord> records;
+  network::CaptureRecord record;
+  while (reader.Read(record))
+    records.emplace_back(record);
+
+  assert(records.size() == 5);
+  assert(records[0].type == network::CaptureRecord::Type::Connected);
+  assert(records[1].type == network::CaptureRecord::Type::Command);
+  assert(records[1].commandId == 0x12);
+  assert(records[1].data.empty());
+  assert(records[2].commandId == 0x7);
+  assert(records[2].data == command);
+  assert(records[3].type == network::CaptureRecord::Type::CodeChanged);
+  assert(std::ranges::equal(records[3].data, code));
+  assert(records[4].type == network::CaptureRecord::Type::Disconnected);
+
+  for (const auto& captured : records)
+    assert(captured.clientId == 7);
+
+  // The records are ordered by their time.
+  assert(std::ranges::is_sorted(records, {}, &network::CaptureRecord::time));
+}
+
+//! Test that a file which is not a capture is rejected.
+void TestBadFile(const std::filesystem::path& path)
+{
+  {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << "definitely not a capture";
+  }
+
+  bool thrown = false;
+  try
+  {
+    network::CaptureReader reader(path);
+  }
+  catch (const std::runtime_error&)
+  {
+    thrown = true;
+  }
+  assert(thrown);
+}
+
+//! Test that the commands written the way the client sends them
+//! unscramble the way the command server reads them.
+void TestClientCommand()
+{
+  CommandClient sender;
+  CommandClient receiver;
+
+  std::vector<std::byte> stream;
+  sender.WriteClientCommand(0x12, {}, stream);
+  const auto command = MakeData(21, 0x40);
+  sender.WriteClientCommand(0x7, command, stream);
+
+  // The command without data has only the magic and doesn't roll the code.
+  uint32_t magicValue{};
+  std::memcpy(&magicValue, stream.data(), sizeof(magicValue));
+  auto magic = protocol::decode_message_magic(magicValue);
+  assert(magic.id == 0x12);
+  assert(magic.length == sizeof(protocol::MessageMagic));
+
+  std::memcpy(&magicValue, stream.data() + sizeof(magicValue), sizeof(magicValue));
+  magic = protocol::decode_message_magic(magicValue);
+  assert(magic.id == 0x7);
+  assert(stream.size() == 2 * sizeof(magicValue) + magic.length - sizeof(magicValue));
+
+  receiver.RollCode();
+  const auto padding = static_cast<uint32_t>(receiver.GetRollingCodeInt()) & 7;
+  assert(magic.length == sizeof(protocol::MessageMagic) + command.size() + padding);
+
+  std::vector<std::byte> data(stream.begin() + 2 * sizeof(magicValue), stream.end());
+  protocol::ApplyXorCode(receiver.GetRollingCode(), data);
+  assert(std::ranges::equal(std::span(data.data(), command.size()), command));
+}
+
+//! Test that the chatter commands written the way the client sends them
+//! unscramble the way the chatter server reads them.
+void TestClientChatterCommand()
+{
+  const auto command = MakeData(9, 0x80);
+
+  std::vector<std::byte> stream;
+  protocol::WriteClientChatterCommand(0x37, command, stream);
+  assert(stream.size() == sizeof(protocol::ChatterCommandHeader) + command.size());
+
+  util::XorWithKey(protocol::ChatterXorCode, stream);
+
+  protocol::ChatterCommandHeader header{};
+  std::memcpy(&header.length, stream.data(), sizeof(header.length));
+  std::memcpy(&header.commandId, stream.data() + sizeof(header.length), sizeof(header.commandId));
+  assert(header.length == stream.size());
+  assert(header.commandId == 0x37);
+  assert(std::ranges::equal(
+    std::span(stream).subspan(sizeof(protocol::ChatterCommandHeader)),
+    command));
+}
+
+} // namespace
+
+int main()
+{
+  const auto path = std::filesystem::temp_directory_path() / "alicia-test-capture.capture";
+
+  TestRoundTrip(path);
+  TestBadFile(path);
+  TestClientCommand();
+  TestClientChatterCommand();
+
+  std::filesystem::remove(path);
+}
@@ -0,0 +1,152 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+
+#include <libserver/network/CommandDispatch.hpp>
+
+#include <cassert>
+#include <cstring>
+#include <memory_resource>
+#include <string>
+
+namespace
+{
+
+//! A command borrowing from the command data.
+struct BorrowingCommand
+{
+  std::span<const std::byte> data;
+
+  static void Read(BorrowingCommand& command, server::SourceStream& stream)
+  {
+    command.data = stream.ReadView(stream.Size() - stream.GetCursor());
+  }
+};
+
+//! A command counting its live instances.
+struct CountedCommand
+{
+  static inline int liveCount = 0;
+
+  uint32_t value{};
+
+  CountedCommand() { ++liveCount; }
+  ~CountedCommand() { --liveCount; }
+
+  static void Read(CountedCommand& command, server::SourceStream& stream)
+  {
+    stream.Read(command.value);
+  }
+};
+
+//! A command decoding its message to its allocator.
+struct MessageCommand
+{
+  using allocator_type = std::pmr::polymorphic_allocator<>;
+
+  MessageCommand() = default;
+  explicit MessageCommand(const allocator_type& allocator)
+    : message(allocator)
+  {
+  }
+
+  std::pmr::string message;
+
+  static void Read(MessageCommand& command, server::SourceStream& stream)
+  {
+    stream.Read(command.message);
+  }
+};
+
+//! Test that the decoded command borrows from the command data of the dispatch
+//! and is destroyed when the dispatch is released.
+void TestDecode()
+{
+  server::network::CommandDispatchPool pool(4);
+
+  auto& dispatch = pool.Acquire();
+  const auto space = dispatch.PrepareData(8);
+  std::memset(space.data(), 0x7F, space.size());
+  dispatch.CommitData(4);
+  assert(dispatch.GetData().size() == 4);
+
+  assert(dispatch.Decode<CountedCommand>() == 4);
+  assert(CountedCommand::liveCount == 1);
+  assert(dispatch.GetCommand<CountedCommand>().value == 0x7F7F7F7F);
+
+  pool.Release(dispatch);
+  assert(CountedCommand::liveCount == 0);
+
+  auto& borrowingDispatch = pool.Acquire();
+  assert(&borrowingDispatch == &dispatch);
+  std::ignore = borrowingDispatch.PrepareData(4);
+  assert(borrowingDispatch.Decode<BorrowingCommand>() == 4);
+
+  const auto& command = borrowingDispatch.GetCommand<BorrowingCommand>();
+  assert(command.data.data() == borrowingDispatch.GetData().data());
+  assert(command.data.size() == 4);
+  pool.Release(borrowingDispatch);
+}
+
+//! Test that the command allocates from the arena of the dispatch.
+void TestArenaAllocation()
+{
+  server::network::CommandDispatchPool pool(1);
+
+  const std::string message(64, 'a');
+  auto& dispatch = pool.Acquire();
+  const auto space = dispatch.PrepareData(message.size() + 1);
+  std::memcpy(space.data(), message.c_str(), space.size());
+  assert(dispatch.Decode<MessageCommand>() == space.size());
+
+  const auto& command = dispatch.GetCommand<MessageCommand>();
+  assert(command.message == std::string_view(message));
+  assert(command.message.get_allocator().resource() != std::pmr::get_default_resource());
+  pool.Release(dispatch);
+}
+
+//! Test that the pool does not retain more dispatches than allowed.
+void TestPoolLimits()
+{
+  server::network::CommandDispatchPool pool(2);
+
+  auto& first = pool.Acquire();
+  auto& second = pool.Acquire();
+  auto& third = pool.Acquire();
+  assert(&first != &second && &second != &third);
+
+  pool.Release(second);
+  pool.Release(first);
+  pool.Release(third);
+  assert(pool.GetIdleCount() == 2);
+
+  // The retained dispatches are reused.
+  auto& reused = pool.Acquire();
+  assert(&reused == &first);
+  pool.Release(reused);
+}
+
+} // namespace
+
+int main()
+{
+  TestDecode();
+  TestArenaAllocation();
+  TestPoolLimits();
+}
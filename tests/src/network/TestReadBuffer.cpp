@@ -0,0 +1,189 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+
+#include <libserver/network/ReadBuffer.hpp>
+
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+
+namespace
+{
+
+//! Simulates a read of the specified size.
+void Read(server::network::ReadBuffer& buffer, std::size_t size, std::byte value)
+{
+  const auto space = buffer.Prepare();
+  assert(space.size() >= size);
+  std::memset(space.data(), static_cast<int>(value), size);
+  buffer.Commit(size);
+}
+
+//! Test the growth and shrinking of the read size.
+void TestReadSize()
+{
+  server::network::ReadBuffer buffer(16, 64);
+  assert(buffer.GetCapacity() == 0);
+  assert(buffer.GetReadSize() == 16);
+
+  // Full reads double the read size up to the max.
+  Read(buffer, 16, std::byte{1});
+  assert(buffer.GetReadSize() == 32);
+  buffer.Consume(16);
+  Read(buffer, 32, std::byte{1});
+  assert(buffer.GetReadSize() == 64);
+  buffer.Consume(32);
+  Read(buffer, 64, std::byte{1});
+  assert(buffer.GetReadSize() == 64);
+  buffer.Consume(64);
+
+  // Small reads halve the read size down to the min.
+  Read(buffer, 1, std::byte{1});
+  assert(buffer.GetReadSize() == 32);
+  buffer.Consume(1);
+  Read(buffer, 1, std::byte{1});
+  assert(buffer.GetReadSize() == 16);
+  buffer.Consume(1);
+  Read(buffer, 1, std::byte{1});
+  assert(buffer.GetReadSize() == 16);
+  buffer.Consume(1);
+}
+
+//! Test the read size with a partial command pending in front of the prepared space.
+void TestReadSizeAfterPartial()
+{
+  server::network::ReadBuffer buffer(16, 256);
+
+  // Grow the storage and shrink the read size below its capacity.
+  Read(buffer, 16, std::byte{1});
+  buffer.Consume(16);
+  Read(buffer, 32, std::byte{1});
+  buffer.Consume(32);
+  Read(buffer, 64, std::byte{1});
+  buffer.Consume(64);
+  Read(buffer, 1, std::byte{1});
+  buffer.Consume(1);
+  assert(buffer.GetCapacity() == 128);
+  assert(buffer.GetReadSize() == 64);
+
+  // Leave a partial command near the end of the storage.
+  Read(buffer, 40, std::byte{2});
+  Read(buffer, 60, std::byte{2});
+  buffer.Consume(95);
+  assert(buffer.GetReadSize() == 64);
+
+  // Only the space after the partial command is prepared,
+  // a read filling it grows the read size.
+  const auto space = buffer.Prepare();
+  assert(space.size() == 28);
+  buffer.Commit(space.size());
+  assert(buffer.GetReadSize() == 128);
+  assert(buffer.GetData().size() == 33);
+}
+
+//! Test that consumed data rewind the buffer and partial data are kept.
+void TestConsume()
+{
+  server::network::ReadBuffer buffer(16, 16);
+
+  Read(buffer, 10, std::byte{1});
+  const auto* const front = buffer.GetData().data();
+
+  // Consuming everything rewinds the buffer without moving the data.
+  buffer.Consume(10);
+  assert(buffer.GetData().empty());
+  Read(buffer, 10, std::byte{2});
+  assert(buffer.GetData().data() == front);
+
+  // A partial command is kept and the following read is appended to it.
+  buffer.Consume(6);
+  Read(buffer, 4, std::byte{3});
+  auto data = buffer.GetData();
+  assert(data.size() == 8);
+  assert(data[3] == std::byte{2});
+  assert(data[4] == std::byte{3});
+
+  // The partial command stays in place while there is space after it.
+  buffer.Consume(7);
+  Read(buffer, 16, std::byte{4});
+  data = buffer.GetData();
+  assert(data.size() == 17);
+  assert(data.data() != front);
+
+  // Once the space after the partial command runs out,
+  // the partial command is moved to the front.
+  buffer.Consume(16);
+  Read(buffer, 16, std::byte{5});
+  data = buffer.GetData();
+  assert(data.size() == 17);
+  assert(data.data() == front);
+  assert(data[0] == std::byte{4});
+  assert(data[1] == std::byte{5});
+  assert(data[16] == std::byte{5});
+}
+
+//! Test the release of the storage.
+void TestTrim()
+{
+  server::network::ReadBuffer buffer(16, 64);
+  Read(buffer, 16, std::byte{1});
+  assert(buffer.GetCapacity() > 0);
+
+  // Unconsumed data are never released.
+  buffer.Trim();
+  assert(buffer.GetCapacity() > 0);
+  assert(buffer.GetData().size() == 16);
+
+  buffer.Consume(16);
+  buffer.Trim();
+  assert(buffer.GetCapacity() == 0);
+  assert(buffer.GetReadSize() == 16);
+  assert(buffer.GetData().empty());
+}
+
+//! Test that the unconsumed data are limited.
+void TestLimit()
+{
+  server::network::ReadBuffer buffer(8, 8);
+  Read(buffer, 8, std::byte{1});
+  Read(buffer, 1, std::byte{1});
+
+  bool thrown = false;
+  try
+  {
+    std::ignore = buffer.Prepare();
+  }
+  catch (const std::length_error&)
+  {
+    thrown = true;
+  }
+  assert(thrown);
+}
+
+} // namespace
+
+int main()
+{
+  TestReadSize();
+  TestReadSizeAfterPartial();
+  TestConsume();
+  TestTrim();
+  TestLimit();
+}
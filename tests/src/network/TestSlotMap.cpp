@@ -0,0 +1,145 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include <libserver/network/SlotMap.hpp>
+
+#include <cassert>
+#include <thread>
+
+namespace
+{
+
+struct Value
+{
+  server::network::ClientId id{};
+};
+
+std::shared_ptr<Value> MakeValue(server::network::ClientId id)
+{
+  return std::make_shared<Value>(Value{.id = id});
+}
+
+//! Test emplacement, lookup and erasure.
+void TestLookup()
+{
+  server::network::SlotMap<Value> map(4);
+
+  const auto value = map.Emplace(MakeValue);
+  assert(value);
+  assert(value->id != 0);
+  assert(map.GetSize() == 1);
+  assert(map.Get(value->id) == value);
+
+  assert(map.Erase(value->id));
+  assert(not map.Erase(value->id));
+  assert(map.GetSize() == 0);
+  assert(map.Get(value->id) == nullptr);
+
+  // Invalid slot index.
+  assert(map.Get(0xFFFF'FFFF) == nullptr);
+}
+
+//! Test that stale IDs do not resolve to the value reusing the slot.
+void TestStaleId()
+{
+  server::network::SlotMap<Value> map(1);
+
+  const auto first = map.Emplace(MakeValue);
+  const auto firstId = first->id;
+  assert(map.Erase(firstId));
+
+  const auto second = map.Emplace(MakeValue);
+  assert(second);
+  assert(second->id != firstId);
+  assert(map.Get(firstId) == nullptr);
+  assert(not map.Erase(firstId));
+  assert(map.Get(second->id) == second);
+}
+
+//! Test that the generation skips zero when it wraps.
+void TestGenerationWrap()
+{
+  using Map = server::network::SlotMap<Value>;
+
+  static_assert(Map::NextGeneration(1) == 2);
+  static_assert(Map::NextGeneration(0xFFFF'FFFE) == 0xFFFF'FFFF);
+  static_assert(Map::NextGeneration(0xFFFF'FFFF) == 1);
+}
+
+//! Test that the emplacement fails when there is no free slot.
+void TestCapacity()
+{
+  server::network::SlotMap<Value> map(2);
+
+  assert(map.Emplace(MakeValue));
+  assert(map.Emplace(MakeValue));
+  assert(not map.Emplace(MakeValue));
+
+  std::size_t visitedCount = 0;
+  map.ForEach([&visitedCount](const std::shared_ptr<Value>&)
+  {
+    ++visitedCount;
+  });
+  assert(visitedCount == 2);
+}
+
+//! Test that readers always see either no value or the value with the requested ID
+//! while the values are concurrently emplaced and erased.
+void TestConcurrentAccess()
+{
+  constexpr std::size_t Capacity = 8;
+  constexpr std::size_t Iterations = 20000;
+
+  server::network::SlotMap<Value> map(Capacity);
+  std::atomic<server::network::ClientId> lastId = 0;
+  std::atomic<bool> isDone = false;
+
+  std::thread reader([&]()
+  {
+    while (not isDone.load())
+    {
+      const auto id = lastId.load();
+      if (const auto value = map.Get(id))
+        assert(value->id == id);
+    }
+  });
+
+  for (std::size_t iteration = 0; iteration < Iterations; ++iteration)
+  {
+    const auto value = map.Emplace(MakeValue);
+    assert(value);
+    lastId.store(value->id);
+    assert(map.Erase(value->id));
+  }
+
+  isDone.store(true);
+  reader.join();
+  assert(map.GetSize() == 0);
+}
+
+} // namespace
+
+int main()
+{
+  TestLookup();
+  TestStaleId();
+  TestGenerationWrap();
+  TestCapacity();
+  TestConcurrentAccess();
+}
@@ -0,0 +1,119 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+
+#include <libserver/network/TimingWheel.hpp>
+
+#include <algorithm>
+#include <cassert>
+
+namespace
+{
+
+//! Advances the wheel until the client expires.
+//! @returns Count of ticks after which the client expired.
+uint64_t AdvanceUntilExpired(
+  server::network::TimingWheel& wheel,
+  server::network::ClientId clientId)
+{
+  std::vector<server::network::ClientId> expired;
+  for (uint64_t ticks = 1; ticks < 10'000; ++ticks)
+  {
+    wheel.Advance(expired);
+    if (std::ranges::find(expired, clientId) != expired.cend())
+      return ticks;
+  }
+
+  return 0;
+}
+
+//! Test the expiry within a single round of the wheel.
+void TestExpiry()
+{
+  server::network::TimingWheel wheel(8);
+
+  wheel.Schedule(1, 3);
+  assert(wheel.GetSize() == 1);
+  assert(AdvanceUntilExpired(wheel, 1) == 3);
+  assert(wheel.GetSize() == 0);
+
+  // Zero delay expires on the next tick.
+  wheel.Schedule(2, 0);
+  assert(AdvanceUntilExpired(wheel, 2) == 1);
+}
+
+//! Test the expiry after multiple rounds of the wheel.
+void TestRounds()
+{
+  for (const uint64_t delay : {7, 8, 9, 16, 17, 100})
+  {
+    server::network::TimingWheel wheel(8);
+
+    // Offset the wheel, so that the deadlines do not start at the first slot.
+    std::vector<server::network::ClientId> expired;
+    wheel.Advance(expired);
+    wheel.Advance(expired);
+    wheel.Advance(expired);
+
+    wheel.Schedule(1, delay);
+    assert(AdvanceUntilExpired(wheel, 1) == delay);
+    assert(wheel.GetSize() == 0);
+  }
+}
+
+//! Test that the entries sharing a slot expire independently.
+void TestSharedSlot()
+{
+  server::network::TimingWheel wheel(4);
+  wheel.Schedule(1, 2);
+  wheel.Schedule(2, 6);
+  wheel.Schedule(3, 2);
+  assert(wheel.GetSize() == 3);
+
+  std::vector<server::network::ClientId> expired;
+  wheel.Advance(expired);
+  assert(expired.empty());
+
+  wheel.Advance(expired);
+  assert(expired.size() == 2);
+  assert(std::ranges::find(expired, 1) != expired.cend());
+  assert(std::ranges::find(expired, 3) != expired.cend());
+  assert(wheel.GetSize() == 1);
+
+  expired.clear();
+  for (int tick = 0; tick < 3; ++tick)
+  {
+    wheel.Advance(expired);
+    assert(expired.empty());
+  }
+
+  wheel.Advance(expired);
+  assert(expired.size() == 1 && expired.front() == 2);
+  assert(wheel.GetSize() == 0);
+  assert(wheel.GetTick() == 6);
+}
+
+} // namespace
+
+int main()
+{
+  TestExpiry();
+  TestRounds();
+  TestSharedSlot();
+}
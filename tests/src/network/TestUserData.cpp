@@ -0,0 +1,152 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include <libserver/network/Server.hpp>
+
+#include <atomic>
+#include <cassert>
+#include <stdexcept>
+#include <thread>
+
+namespace
+{
+
+namespace asio = server::network::asio;
+
+//! Handler ignoring all the network events.
+class NullEventHandler final
+  : public server::network::EventHandlerInterface
+{
+public:
+  void HandleNetworkTick() override {}
+  void OnClientConnected(server::network::ClientId) override {}
+  void OnClientDisconnected(server::network::ClientId) override {}
+  size_t OnClientData(server::network::ClientId, const std::span<const std::byte>& data) override
+  {
+    return data.size();
+  }
+};
+
+struct ProtocolState
+{
+  uint32_t code{};
+};
+
+struct OtherProtocolState
+{
+  uint32_t code{};
+};
+
+//! Test that the attached state is reachable only through its type
+//! and that it lives as long as the client.
+void TestUserData()
+{
+  asio::io_context ioContext;
+  asio::ip::tcp::acceptor acceptor(ioContext, {asio::ip::address_v4::loopback(), 0});
+  asio::ip::tcp::socket remote(ioContext);
+  asio::ip::tcp::socket local(ioContext);
+  remote.connect(acceptor.local_endpoint());
+  acceptor.accept(local);
+
+  NullEventHandler eventHandler;
+  auto client = std::make_shared<server::network::Client>(
+    0,
+    std::move(local),
+    eventHandler);
+
+  assert(client->GetUserData<ProtocolState>() == nullptr);
+
+  auto& state = client->EmplaceUserData<ProtocolState>(ProtocolState{.code = 1});
+  assert(client->GetUserData<ProtocolState>() == &state);
+  assert(client->GetUserData<ProtocolState>()->code == 1);
+  assert(client->GetUserData<OtherProtocolState>() == nullptr);
+
+  // The state is modified in place.
+  state.code = 2;
+  assert(client->GetUserData<ProtocolState>()->code == 2);
+
+  // The state can be attached only once.
+  bool hasThrown = false;
+  try
+  {
+    client->EmplaceUserData<OtherProtocolState>();
+  }
+  catch (const std::logic_error&)
+  {
+    hasThrown = true;
+  }
+  assert(hasThrown);
+  assert(client->GetUserData<ProtocolState>() == &state);
+  assert(client->GetUserData<OtherProtocolState>() == nullptr);
+
+  // A state shared with the client outlives the handle of the client.
+  const std::shared_ptr<ProtocolState> sharedState(client, &state);
+  client.reset();
+  sharedState->code = 3;
+  assert(sharedState->code == 3);
+}
+
+//! Test that a state attached while another thread reads it
+//! is observed either not attached or fully constructed.
+void TestConcurrentUserData()
+{
+  asio::io_context ioContext;
+  asio::ip::tcp::acceptor acceptor(ioContext, {asio::ip::address_v4::loopback(), 0});
+
+  NullEventHandler eventHandler;
+  for (uint32_t iteration = 1; iteration <= 1000; ++iteration)
+  {
+    asio::ip::tcp::socket remote(ioContext);
+    asio::ip::tcp::socket local(ioContext);
+    remote.connect(acceptor.local_endpoint());
+    acceptor.accept(local);
+
+    const auto client = std::make_shared<server::network::Client>(
+      iteration,
+      std::move(local),
+      eventHandler);
+
+    std::atomic<bool> isReading{false};
+    std::thread reader([&client, &isReading, iteration]()
+    {
+      isReading.store(true, std::memory_order::release);
+
+      const ProtocolState* state = nullptr;
+      while (state == nullptr)
+        state = client->GetUserData<ProtocolState>();
+
+      // The state is published only after it was constructed.
+      assert(state->code == iteration);
+    });
+
+    while (not isReading.load(std::memory_order::acquire))
+      std::this_thread::yield();
+
+    client->EmplaceUserData<ProtocolState>(ProtocolState{.code = iteration});
+    reader.join();
+  }
+}
+
+} // namespace
+
+int main()
+{
+  TestUserData();
+  TestConcurrentUserData();
+}
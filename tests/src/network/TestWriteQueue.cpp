@@ -0,0 +1,157 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include <libserver/network/Server.hpp>
+
+#include <cassert>
+
+namespace
+{
+
+namespace asio = server::network::asio;
+
+//! Handler ignoring all the network events.
+class NullEventHandler final
+  : public server::network::EventHandlerInterface
+{
+public:
+  void HandleNetworkTick() override {}
+  void OnClientConnected(server::network::ClientId) override {}
+  void OnClientDisconnected(server::network::ClientId) override
+  {
+    disconnected = true;
+  }
+  size_t OnClientData(server::network::ClientId, const std::span<const std::byte>& data) override
+  {
+    return data.size();
+  }
+
+  bool disconnected = false;
+};
+
+//! A connected pair of sockets.
+struct Connection
+{
+  explicit Connection(asio::io_context& ioContext)
+    : acceptor(ioContext, {asio::ip::address_v4::loopback(), 0})
+    , local(ioContext)
+    , remote(ioContext)
+  {
+    remote.connect(acceptor.local_endpoint());
+    acceptor.accept(local);
+  }
+
+  asio::ip::tcp::acceptor acceptor;
+  asio::ip::tcp::socket local;
+  asio::ip::tcp::socket remote;
+};
+
+server::network::WriteBuffer MakeBuffer(std::size_t size)
+{
+  auto buffer = server::network::BufferPool::Global().Acquire();
+  buffer->resize(size);
+  return buffer;
+}
+
+//! Test that droppable writes over the limits are superseded or dropped,
+//! and the other writes are queued regardless.
+void TestDroppableWrites()
+{
+  // The I/O context is never run, so the writes stay queued.
+  asio::io_context ioContext;
+  Connection connection(ioContext);
+  NullEventHandler eventHandler;
+
+  const auto client = std::make_shared<server::network::Client>(
+    0,
+    std::move(connection.local),
+    eventHandler,
+    server::network::WriteQueueLimits{
+      .maxWriteCount = 2,
+      .maxByteCount = 0,
+      .overLimitTimeout = std::chrono::hours(1)});
+  client->Begin();
+
+  const auto firstKey = server::network::MakeCoalescingKey(1, 1);
+  const auto secondKey = server::network::MakeCoalescingKey(1, 2);
+  assert(firstKey != 0 && firstKey != secondKey);
+
+  client->QueueWrite(MakeBuffer(10), firstKey);
+  client->QueueWrite(MakeBuffer(20));
+
+  auto metrics = client->GetWriteQueueMetrics();
+  assert(metrics.writeCount == 2);
+  assert(metrics.byteCount == 30);
+
+  // Over the limit, supersedes the write with the same key.
+  client->QueueWrite(MakeBuffer(15), firstKey);
+  metrics = client->GetWriteQueueMetrics();
+  assert(metrics.writeCount == 2);
+  assert(metrics.byteCount == 35);
+  assert(metrics.coalescedWriteCount == 1);
+
+  // Over the limit, there is no write with the same key to supersede.
+  client->QueueWrite(MakeBuffer(15), secondKey);
+  metrics = client->GetWriteQueueMetrics();
+  assert(metrics.writeCount == 2);
+  assert(metrics.droppedWriteCount == 1);
+
+  // Writes which must not be dropped are queued over the limit.
+  client->QueueWrite(MakeBuffer(5));
+  metrics = client->GetWriteQueueMetrics();
+  assert(metrics.writeCount == 3);
+  assert(metrics.byteCount == 40);
+  assert(metrics.peakByteCount == 40);
+}
+
+//! Test that a client whose write queue stays over the limits is disconnected.
+void TestSlowConsumerDisconnect()
+{
+  asio::io_context ioContext;
+  Connection connection(ioContext);
+  NullEventHandler eventHandler;
+
+  const auto client = std::make_shared<server::network::Client>(
+    0,
+    std::move(connection.local),
+    eventHandler,
+    server::network::WriteQueueLimits{
+      .maxWriteCount = 0,
+      .maxByteCount = 16,
+      .overLimitTimeout = std::chrono::milliseconds(0)});
+  client->Begin();
+
+  client->QueueWrite(MakeBuffer(16));
+  client->QueueWrite(MakeBuffer(1));
+
+  // The client ended, further writes are not queued.
+  client->QueueWrite(MakeBuffer(1));
+  assert(client->GetWriteQueueMetrics().writeCount == 2);
+
+  ioContext.run();
+  assert(eventHandler.disconnected);
+}
+
+} // namespace
+
+int main()
+{
+  TestDroppableWrites();
+  TestSlowConsumerDisconnect();
+}
@@ -0,0 +1,192 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include "libserver/network/chatter/proto/ChatterMessageDefinitions.hpp"
+#include "libserver/network/command/proto/LobbyMessageDefinitions.hpp"
+#include "libserver/network/command/proto/RaceMessageDefinitions.hpp"
+#include "libserver/network/command/proto/RanchMessageDefinitions.hpp"
+
+#include <array>
+#include <cassert>
+
+namespace
+{
+
+using namespace server;
+using namespace server::protocol;
+
+using Buffer = std::array<std::byte, 4096>;
+
+//! Writes the command and reads it back.
+//! Checks that the read consumed exactly what was written.
+template <typename T>
+T RoundTrip(const T& command)
+{
+  Buffer buffer{};
+  SinkStream sink(std::span(buffer.data(), buffer.size()));
+  sink.Write(command);
+
+  T decoded{};
+  SourceStream source(std::span(buffer.data(), sink.GetCursor()));
+  source.Read(decoded);
+  assert(source.GetCursor() == sink.GetCursor());
+
+  return decoded;
+}
+
+void TestLobby()
+{
+  AcCmdCLMakeRoom makeRoom{};
+  makeRoom.name = "room";
+  makeRoom.password = "secret";
+  makeRoom.playerCount = 4;
+  makeRoom.gameMode = GameMode::Speed;
+  makeRoom.teamMode = TeamMode::FFA;
+  makeRoom.missionId = 3;
+  makeRoom.unk3 = 1;
+  makeRoom.bitset = AcCmdCLMakeRoom::ModifiedSet::ChangeName;
+  makeRoom.unk4 = 2;
+  const auto decodedMakeRoom = RoundTrip(makeRoom);
+  assert(decodedMakeRoom.name == makeRoom.name);
+  assert(decodedMakeRoom.password == makeRoom.password);
+  assert(decodedMakeRoom.playerCount == makeRoom.playerCount);
+  assert(decodedMakeRoom.missionId == makeRoom.missionId);
+  assert(decodedMakeRoom.unk4 == makeRoom.unk4);
+
+  // The address is sent in the network byte order and read back in the host order.
+  const AcCmdCLEnterRanchOK enterRanchOK{
+    .rancherUid = 7,
+    .otp = 0xCAFE,
+    .ranchAddress = 0x7F000001,
+    .ranchPort = 10031};
+  const auto decodedEnterRanchOK = RoundTrip(enterRanchOK);
+  assert(decodedEnterRanchOK.otp == enterRanchOK.otp);
+  assert(decodedEnterRanchOK.ranchAddress == enterRanchOK.ranchAddress);
+  assert(decodedEnterRanchOK.ranchPort == enterRanchOK.ranchPort);
+
+  const AcCmdCLMakeRoomOK makeRoomOK{
+    .roomUid = 12,
+    .oneTimePassword = 34,
+    .raceServerAddress = 0x0A000002,
+    .raceServerPort = 10032};
+  const auto decodedMakeRoomOK = RoundTrip(makeRoomOK);
+  assert(decodedMakeRoomOK.roomUid == makeRoomOK.roomUid);
+  assert(decodedMakeRoomOK.raceServerAddress == makeRoomOK.raceServerAddress);
+
+  const AcCmdCLCreateNickname createNickname{
+    .nickname = "rider",
+    .character = {.parts = {.charId = 20}},
+    .requestedHorseTid = 20001};
+  const auto decodedCreateNickname = RoundTrip(createNickname);
+  assert(decodedCreateNickname.nickname == createNickname.nickname);
+  assert(decodedCreateNickname.character.parts.charId == 20);
+  assert(decodedCreateNickname.requestedHorseTid == createNickname.requestedHorseTid);
+}
+
+void TestRanch()
+{
+  AcCmdCREnterRanchOK enterRanchOK{
+    .rancherUid = 7,
+    .rancherName = "rancher",
+    .ranchName = "ranch",
+    .horseSlots = 3,
+    .incubator = {}};
+  enterRanchOK.horses.emplace_back(RanchHorse{.horseOid = 1, .horse = {.uid = 100, .name = "horse"}});
+  enterRanchOK.characters.emplace_back(RanchCharacter{.uid = 7, .name = "rancher", .oid = 2});
+  enterRanchOK.characters.emplace_back(RanchCharacter{.uid = 8, .name = "visitor", .oid = 3});
+
+  const auto decodedEnterRanchOK = RoundTrip(enterRanchOK);
+  assert(decodedEnterRanchOK.rancherName == enterRanchOK.rancherName);
+  assert(decodedEnterRanchOK.horses.size() == 1);
+  assert(decodedEnterRanchOK.horses[0].horse.name == "horse");
+  assert(decodedEnterRanchOK.characters.size() == 2);
+  assert(decodedEnterRanchOK.characters[1].uid == 8);
+  assert(decodedEnterRanchOK.characters[1].oid == 3);
+  assert(decodedEnterRanchOK.horseSlots == enterRanchOK.horseSlots);
+
+  AcCmdCRRanchSnapshot snapshot{
+    .type = AcCmdCRRanchSnapshot::Partial,
+    .partial = {.ranchIndex = 3, .time = 100}};
+  const auto decodedSnapshot = RoundTrip(snapshot);
+  assert(decodedSnapshot.type == snapshot.type);
+  assert(decodedSnapshot.partial.ranchIndex == 3);
+  assert(decodedSnapshot.partial.time == 100);
+
+  AcCmdCRRanchChat chat{};
+  chat.message = "hello";
+  chat.unknown = 1;
+  chat.unknown2 = 2;
+  const auto decodedChat = RoundTrip(chat);
+  assert(decodedChat.message == chat.message);
+  assert(decodedChat.unknown2 == chat.unknown2);
+}
+
+void TestRace()
+{
+  const AcCmdCREnterRoom enterRoom{
+    .characterUid = 1,
+    .oneTimePassword = 2,
+    .roomUid = 3};
+  const auto decodedEnterRoom = RoundTrip(enterRoom);
+  assert(decodedEnterRoom.characterUid == 1);
+  assert(decodedEnterRoom.oneTimePassword == 2);
+  assert(decodedEnterRoom.roomUid == 3);
+
+  const AcCmdCRStartRace startRace{.unk0 = {1, 2, 3}};
+  assert(RoundTrip(startRace).unk0 == startRace.unk0);
+}
+
+void TestChatter()
+{
+  const ChatCmdLogin login{
+    .characterUid = 1,
+    .name = "rider",
+    .code = 0xABCD,
+    .guildUid = 0};
+  const auto decodedLogin = RoundTrip(login);
+  assert(decodedLogin.name == login.name);
+  assert(decodedLogin.code == login.code);
+
+  const ChatCmdChannelInfoAckOk channelInfo{
+    .hostname = "127.0.0.1",
+    .port = 10033,
+    .code = 5};
+  const auto decodedChannelInfo = RoundTrip(channelInfo);
+  assert(decodedChannelInfo.hostname == channelInfo.hostname);
+  assert(decodedChannelInfo.port == channelInfo.port);
+  assert(decodedChannelInfo.code == channelInfo.code);
+
+  const ChatCmdChannelChatTrs chat{
+    .messageAuthor = "rider",
+    .message = "hello",
+    .role = ChatCmdChat::Role::User};
+  const auto decodedChat = RoundTrip(chat);
+  assert(decodedChat.messageAuthor == chat.messageAuthor);
+  assert(decodedChat.message == chat.message);
+}
+
+} // namespace
+
+int main()
+{
+  TestLobby();
+  TestRanch();
+  TestRace();
+  TestChatter();
+}
@@ -0,0 +1,56 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include "libserver/network/chatter/ChatterProtocol.hpp"
+#include "libserver/network/command/CommandProtocol.hpp"
+
+#include <cassert>
+
+namespace
+{
+
+using namespace server::protocol;
+
+void TestCommandNames()
+{
+  assert(GetCommandName(Command::AcCmdCLLogin) == "AcCmdCLLogin");
+  assert(GetCommandName(Command::AcCmdUserRaceItemGet) == "AcCmdUserRaceItemGet");
+  // An ID without a command.
+  assert(GetCommandName(static_cast<Command>(0x0)) == "n/a");
+  // IDs outside of the table.
+  assert(GetCommandName(Command::Count) == "n/a");
+  assert(GetCommandName(static_cast<Command>(0xFFFF)) == "n/a");
+}
+
+void TestChatterCommandNames()
+{
+  assert(GetChatterCommandName(ChatterCommand::ChatCmdLogin) == "ChatCmdLogin");
+  assert(GetChatterCommandName(ChatterCommand::ChatCmdChangeLetterOptionAckOk)
+    == "ChatCmdChangeLetterOptionAckOk");
+  assert(GetChatterCommandName(static_cast<ChatterCommand>(0x3A)) == "n/a");
+  assert(GetChatterCommandName(static_cast<ChatterCommand>(0xFFFF)) == "n/a");
+}
+
+} // namespace
+
+int main()
+{
+  TestCommandNames();
+  TestChatterCommandNames();
+}
@@ -0,0 +1,356 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include "libserver/network/command/proto/LobbyMessageDefinitions.hpp"
+#include "libserver/network/command/proto/RaceMessageDefinitions.hpp"
+#include "libserver/network/command/proto/RanchMessageDefinitions.hpp"
+#include "libserver/util/Schema.hpp"
+
+#include <array>
+#include <cassert>
+#include <ranges>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+
+using namespace server;
+using namespace server::protocol;
+
+using Buffer = std::array<std::byte, 1024>;
+
+//! Hand-written serialization of the item, as it was before the schema.
+void WriteItemReference(const Item& item, SinkStream& stream)
+{
+  stream.Write(item.uid)
+    .Write(item.tid)
+    .Write(item.expiresAt)
+    .Write(item.count);
+}
+
+//! Hand-written serialization of the stored item, as it was before the schema.
+void WriteStoredItemReference(const StoredItem& item, SinkStream& stream)
+{
+  stream.Write(item.uid)
+    .Write(item.goodsSq)
+    .Write(item.status)
+    .Write(item.val3)
+    .Write(item.val4)
+    .Write(item.carrots)
+    .Write(item.priceId)
+    .Write(item.sender)
+    .Write(item.message)
+    .Write(item.dateAndTime);
+}
+
+//! Hand-written serialization of the spatial, as it was before the schema.
+void WriteFullSpatialReference(
+  const AcCmdCRRanchSnapshot::FullSpatial& structure,
+  SinkStream& stream)
+{
+  stream.Write(structure.ranchIndex)
+    .Write(structure.time)
+    .Write(structure.action)
+    .Write(structure.timer);
+
+  stream.Write(std::span(structure.member4))
+    .Write(std::span(structure.matrix));
+
+  stream.Write(structure.velocityX)
+    .Write(structure.velocityY)
+    .Write(structure.velocityZ);
+}
+
+//! Hand-written serialization of the storage response, as it was before the schema.
+void WriteGetItemFromStorageOKReference(
+  const AcCmdCRGetItemFromStorageOK& command,
+  SinkStream& stream)
+{
+  stream.Write(command.storageItemUid);
+  stream.Write(static_cast<uint8_t>(command.items.size()));
+  for (const auto& item : command.items)
+  {
+    WriteItemReference(item, stream);
+  }
+  stream.Write(command.updatedCarrots);
+}
+
+//! Writes the value with the schema and with the reference writer
+//! and checks that the output is identical and matches the serialized size.
+//! @returns Size of the serialized value.
+template <typename T, typename Reference>
+std::size_t CheckWrite(const T& value, Reference reference, Buffer& output)
+{
+  Buffer expected{};
+  SinkStream referenceSink(std::span(expected.data(), expected.size()));
+  reference(value, referenceSink);
+
+  output = {};
+  SinkStream sink(std::span(output.data(), output.size()));
+  sink.Write(value);
+
+  assert(sink.GetCursor() == referenceSink.GetCursor());
+  assert(std::ranges::equal(
+    std::span(output.data(), sink.GetCursor()),
+    std::span(expected.data(), referenceSink.GetCursor())));
+
+  if constexpr (T::Schema::IsSized)
+  {
+    assert(T::Schema::SerializedSize(value) >= sink.GetCursor());
+  }
+
+  return sink.GetCursor();
+}
+
+void TestFixedSize()
+{
+  static_assert(Item::Schema::FixedSize == 16);
+  static_assert(AcCmdCRRanchSnapshot::FullSpatial::Schema::FixedSize == 56);
+  static_assert(AcCmdCRRanchSnapshot::PartialSpatial::Schema::FixedSize == 44);
+  static_assert(not StoredItem::Schema::FixedSize.has_value());
+  static_assert(SizedSchemaStruct<AcCmdCRGetItemFromStorageOK>);
+
+  AcCmdCRRanchSnapshot::FullSpatial spatial{
+    .ranchIndex = 3,
+    .time = 0x11223344,
+    .action = 0x0102030405060708,
+    .timer = 0xABCD,
+    .velocityX = 1.5f,
+    .velocityY = -2.0f,
+    .velocityZ = 0.25f};
+  for (std::size_t idx = 0; idx < spatial.member4.size(); ++idx)
+    spatial.member4[idx] = static_cast<std::byte>(idx);
+  for (std::size_t idx = 0; idx < spatial.matrix.size(); ++idx)
+    spatial.matrix[idx] = static_cast<std::byte>(0xF0 + idx);
+
+  Buffer output{};
+  const auto size = CheckWrite(spatial, WriteFullSpatialReference, output);
+  assert(size == AcCmdCRRanchSnapshot::FullSpatial::Schema::SerializedSize(spatial));
+
+  AcCmdCRRanchSnapshot::FullSpatial decoded{};
+  SourceStream source(std::span(output.data(), size));
+  source.Read(decoded);
+
+  assert(source.GetCursor() == size);
+  assert(decoded.ranchIndex == spatial.ranchIndex);
+  assert(decoded.time == spatial.time);
+  assert(decoded.action == spatial.action);
+  assert(decoded.timer == spatial.timer);
+  assert(decoded.member4 == spatial.member4);
+  assert(decoded.matrix == spatial.matrix);
+  assert(decoded.velocityX == spatial.velocityX);
+  assert(decoded.velocityY == spatial.velocityY);
+  assert(decoded.velocityZ == spatial.velocityZ);
+
+  // A fixed-size structure is read in one piece, a truncated source must throw.
+  SourceStream truncated(std::span(output.data(), size - 1));
+  bool thrown = false;
+  try
+  {
+    truncated.Read(decoded);
+  }
+  catch (const std::overflow_error&)
+  {
+    thrown = true;
+  }
+  assert(thrown);
+}
+
+void TestStrings()
+{
+  const StoredItem item{
+    .uid = 1,
+    .goodsSq = 2,
+    .status = StoredItem::Status::Read,
+    .val3 = 4,
+    .val4 = 5,
+    .carrots = 6,
+    .priceId = 7,
+    .sender = "sender",
+    .message = "hello",
+    .dateAndTime = 8};
+
+  Buffer output{};
+  const auto size = CheckWrite(item, WriteStoredItemReference, output);
+  // ASCII strings are sized exactly.
+  assert(size == StoredItem::Schema::SerializedSize(item));
+
+  StoredItem decoded{};
+  SourceStream source(std::span(output.data(), size));
+  source.Read(decoded);
+  assert(source.GetCursor() == size);
+  assert(decoded.sender == item.sender);
+  assert(decoded.message == item.message);
+  assert(decoded.dateAndTime == item.dateAndTime);
+
+  // Non-ASCII strings are bounded from above.
+  StoredItem korean = item;
+  korean.message = "\xEC\x95\x88\xEB\x85\x95";
+  const auto koreanSize = CheckWrite(korean, WriteStoredItemReference, output);
+  assert(koreanSize <= StoredItem::Schema::SerializedSize(korean));
+}
+
+void TestLists()
+{
+  AcCmdCRGetItemFromStorageOK command{
+    .storageItemUid = 0xCAFE,
+    .updatedCarrots = 1000};
+  for (uint32_t idx = 0; idx < 5; ++idx)
+    command.items.emplace_back(Item{.uid = idx, .tid = idx * 10, .count = idx + 1});
+
+  Buffer output{};
+  const auto size = CheckWrite(command, WriteGetItemFromStorageOKReference, output);
+  assert(size == AcCmdCRGetItemFromStorageOK::Schema::SerializedSize(command));
+  assert(size == 4 + 1 + 5 * 16 + 4);
+
+  AcCmdCRGetItemFromStorageOK decoded{};
+  SourceStream source(std::span(output.data(), size));
+  source.Read(decoded);
+  assert(source.GetCursor() == size);
+  assert(decoded.items.size() == command.items.size());
+  assert(decoded.items[4].tid == 40);
+  assert(decoded.updatedCarrots == command.updatedCarrots);
+
+  // The count prefix is a uint8_t, a longer list must not be truncated silently.
+  command.items.resize(256);
+  std::vector<std::byte> large(AcCmdCRGetItemFromStorageOK::Schema::SerializedSize(command));
+  SinkStream sink(std::span(large.data(), large.size()));
+  bool thrown = false;
+  try
+  {
+    sink.Write(command);
+  }
+  catch (const std::overflow_error&)
+  {
+    thrown = true;
+  }
+  assert(thrown);
+}
+
+void TestLogin()
+{
+  // Built the way the client sends it.
+  Buffer input{};
+  SinkStream sink(std::span(input.data(), input.size()));
+  sink.Write(uint16_t{0x10})
+    .Write(uint16_t{0x20})
+    .Write(std::string("login"))
+    .Write(uint32_t{42})
+    .Write(std::string("key"))
+    .Write(uint8_t{1});
+
+  AcCmdCLLogin command{};
+  SourceStream source(std::span(input.data(), sink.GetCursor()));
+  source.Read(command);
+
+  assert(source.GetCursor() == sink.GetCursor());
+  assert(command.constant0 == 0x10);
+  assert(command.constant1 == 0x20);
+  assert(command.loginId == "login");
+  assert(command.memberNo == 42);
+  assert(command.authKey == "key");
+  assert(command.val0 == 1);
+}
+
+void TestViews()
+{
+  const std::array<uint8_t, 5> payload{1, 2, 3, 4, 5};
+  const AcCmdCRRelayNotify notify{
+    .fromOid = 1,
+    .toOid = 2,
+    .payloadType = relay::RelayCommandId::Snapshot,
+    .data = payload};
+
+  Buffer output{};
+  SinkStream sink(std::span(output.data(), output.size()));
+  sink.Write(notify);
+  assert(sink.GetCursor() == AcCmdCRRelayNotify::Schema::SerializedSize(notify));
+  assert(sink.GetCursor() == 2 + 2 + 2 + 2 + payload.size());
+
+  // The request has the same layout as the notify.
+  AcCmdCRRelayView view{};
+  SourceStream source(std::span(output.data(), sink.GetCursor()));
+  source.Read(view);
+  assert(source.GetCursor() == sink.GetCursor());
+  assert(view.fromOid == 1);
+  assert(view.toOid == 2);
+  assert(view.payloadType == relay::RelayCommandId::Snapshot);
+  assert(std::ranges::equal(view.data, payload));
+  // The payload is borrowed from the source, not copied.
+  assert(reinterpret_cast<const std::byte*>(view.data.data()) == output.data() + 8);
+
+  // The view must not reach past the source.
+  SourceStream truncated(std::span(output.data(), sink.GetCursor() - 1));
+  bool thrown = false;
+  try
+  {
+    truncated.Read(view);
+  }
+  catch (const std::overflow_error&)
+  {
+    thrown = true;
+  }
+  assert(thrown);
+}
+
+void TestSnapshotView()
+{
+  AcCmdCRRanchSnapshot::PartialSpatial spatial{
+    .ranchIndex = 7,
+    .time = 100};
+
+  Buffer input{};
+  SinkStream sink(std::span(input.data(), input.size()));
+  sink.Write(AcCmdCRRanchSnapshot::Partial)
+    .Write(spatial);
+
+  AcCmdCRRanchSnapshotView view{};
+  SourceStream source(std::span(input.data(), sink.GetCursor()));
+  source.Read(view);
+  assert(source.GetCursor() == sink.GetCursor());
+  assert(view.type == AcCmdCRRanchSnapshot::Partial);
+  assert(view.ranchIndex == 7);
+  assert(view.spatial.size() == AcCmdCRRanchSnapshot::PartialSpatial::Schema::FixedSize);
+
+  // The notify forwards the spatial as it was received.
+  const RanchCommandRanchSnapshotNotifyView notify{
+    .ranchIndex = 7,
+    .type = view.type,
+    .spatial = view.spatial};
+  Buffer output{};
+  SinkStream notifySink(std::span(output.data(), output.size()));
+  notifySink.Write(notify);
+  assert(notifySink.GetCursor() == RanchCommandRanchSnapshotNotifyView::Schema::SerializedSize(notify));
+  assert(std::ranges::equal(
+    std::span(output.data() + 3, view.spatial.size()),
+    view.spatial));
+}
+
+} // namespace
+
+int main()
+{
+  TestFixedSize();
+  TestStrings();
+  TestLists();
+  TestLogin();
+  TestViews();
+  TestSnapshotView();
+}
@@ -0,0 +1,104 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include "libserver/util/Arena.hpp"
+
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace
+{
+
+//! A structure allocating from the arena.
+struct Allocated
+{
+  using allocator_type = std::pmr::polymorphic_allocator<>;
+
+  Allocated() = default;
+  explicit Allocated(const allocator_type& allocator)
+    : data(allocator)
+  {
+  }
+
+  std::pmr::vector<uint8_t> data;
+};
+
+//! A structure not aware of the arena.
+struct Plain
+{
+  uint32_t value{7};
+  std::vector<uint8_t> data;
+};
+
+void TestNew()
+{
+  static_assert(server::ArenaAllocated<Allocated>);
+  static_assert(not server::ArenaAllocated<Plain>);
+
+  server::Arena arena;
+
+  auto* const allocated = arena.New<Allocated>();
+  allocated->data.resize(128);
+  assert(allocated->data.get_allocator().resource() == &arena.GetResource());
+  std::destroy_at(allocated);
+
+  auto* const plain = arena.New<Plain>();
+  assert(plain->value == 7);
+  std::destroy_at(plain);
+}
+
+void TestRelease()
+{
+  server::Arena arena;
+
+  auto* allocated = arena.New<Allocated>();
+  allocated->data.resize(64);
+  const auto* const first = reinterpret_cast<const std::byte*>(allocated);
+  std::destroy_at(allocated);
+  arena.Release();
+
+  // The arena is rewound to the start of its inline buffer.
+  allocated = arena.New<Allocated>();
+  assert(reinterpret_cast<const std::byte*>(allocated) == first);
+  allocated->data.resize(64);
+  std::destroy_at(allocated);
+  arena.Release();
+
+  // Allocations larger than the inline buffer fall back to the upstream resource.
+  allocated = arena.New<Allocated>();
+  allocated->data.resize(server::Arena::InlineSize * 2);
+  allocated->data.back() = 0xFF;
+  assert(allocated->data.back() == 0xFF);
+  std::destroy_at(allocated);
+  arena.Release();
+
+  allocated = arena.New<Allocated>();
+  assert(reinterpret_cast<const std::byte*>(allocated) == first);
+  std::destroy_at(allocated);
+}
+
+} // namespace
+
+int main()
+{
+  TestNew();
+  TestRelease();
+}
@@ -0,0 +1,192 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include <libserver/util/Executor.hpp>
+
+#include <atomic>
+#include <cassert>
+#include <functional>
+#include <latch>
+#include <vector>
+
+namespace
+{
+
+void TestPostedTasks()
+{
+  constexpr uint32_t TaskCount = 10'000;
+
+  server::Executor executor;
+  executor.Begin(4);
+  assert(executor.GetWorkerCount() == 4);
+
+  std::latch tasksDone(TaskCount);
+  std::atomic<uint32_t> executedTaskCount{0};
+  for (uint32_t taskIdx = 0; taskIdx < TaskCount; ++taskIdx)
+  {
+    executor.Post([&]()
+    {
+      ++executedTaskCount;
+      tasksDone.count_down();
+    });
+  }
+
+  tasksDone.wait();
+  assert(executedTaskCount == TaskCount);
+}
+
+void TestStolenTasks()
+{
+  server::Executor executor;
+  executor.Begin(2);
+
+  // Block one worker with a task which posts more tasks to its own queue,
+  // expect the other worker to steal and execute them.
+  std::latch stolenTasksDone(8);
+  std::latch blockingTaskDone(1);
+  executor.Post([&]()
+  {
+    for (uint32_t taskIdx = 0; taskIdx < 8; ++taskIdx)
+    {
+      executor.Post([&]()
+      {
+        stolenTasksDone.count_down();
+      });
+    }
+
+    stolenTasksDone.wait();
+    blockingTaskDone.count_down();
+  });
+
+  blockingTaskDone.wait();
+}
+
+void TestStrandTasks()
+{
+  constexpr uint32_t TaskCount = 10'000;
+
+  server::Executor executor;
+  executor.Begin(4);
+  server::Executor::Strand strand(executor);
+
+  // The tasks of the strand never run at the same time and run in the order they were posted in.
+  std::latch tasksDone(TaskCount);
+  std::atomic<bool> isRunning{false};
+  std::vector<uint32_t> executedTasks;
+  for (uint32_t taskIdx = 0; taskIdx < TaskCount; ++taskIdx)
+  {
+    strand.Post([&, taskIdx]()
+    {
+      assert(not isRunning.exchange(true));
+      executedTasks.emplace_back(taskIdx);
+      isRunning = false;
+      tasksDone.count_down();
+    });
+  }
+
+  tasksDone.wait();
+  assert(executedTasks.size() == TaskCount);
+  for (uint32_t idx = 0; idx < TaskCount; ++idx)
+    assert(executedTasks[idx] == idx);
+}
+
+void TestTimedTasks()
+{
+  constexpr auto DelayDuration = std::chrono::milliseconds(50);
+
+  server::Executor executor;
+  executor.Begin(2);
+  server::Executor::Strand strand(executor);
+
+  const auto postedAt = server::Executor::Clock::now();
+  std::latch taskDone(2);
+  std::vector<uint32_t> executedTasks;
+
+  // Posted in the reverse order of their time points.
+  strand.PostAt(postedAt + DelayDuration * 2, [&]()
+  {
+    executedTasks.emplace_back(2);
+    taskDone.count_down();
+  });
+  strand.PostAt(postedAt + DelayDuration, [&]()
+  {
+    assert(server::Executor::Clock::now() >= postedAt + DelayDuration);
+    executedTasks.emplace_back(1);
+    taskDone.count_down();
+  });
+
+  taskDone.wait();
+  assert(server::Executor::Clock::now() >= postedAt + DelayDuration * 2);
+  assert((executedTasks == std::vector<uint32_t>{1, 2}));
+}
+
+void TestSaturatedTimedTasks()
+{
+  constexpr auto DelayDuration = std::chrono::milliseconds(10);
+  constexpr auto SaturationDuration = std::chrono::seconds(2);
+
+  server::Executor executor;
+  executor.Begin(1);
+  server::Executor::Strand strand(executor);
+
+  const auto postedAt = server::Executor::Clock::now();
+  std::atomic_bool isTimedTaskDone{false};
+  std::latch saturationDone(1);
+
+  // Keep the only worker busy with a strand which reposts itself
+  // until the timed task runs, or for the saturation duration at most.
+  std::function<void()> saturatingTask;
+  saturatingTask = [&]()
+  {
+    if (isTimedTaskDone.load()
+      || server::Executor::Clock::now() >= postedAt + SaturationDuration)
+    {
+      saturationDone.count_down();
+      return;
+    }
+
+    strand.Post(saturatingTask);
+  };
+  strand.Post(saturatingTask);
+
+  server::Executor::Clock::time_point executedAt{};
+  executor.PostAt(postedAt + DelayDuration, [&]()
+  {
+    executedAt = server::Executor::Clock::now();
+    isTimedTaskDone.store(true);
+  });
+
+  saturationDone.wait();
+  executor.End();
+
+  // Expect the timed task to run while the strand was saturated.
+  assert(isTimedTaskDone.load());
+  assert(executedAt - postedAt < SaturationDuration);
+}
+
+} // namespace
+
+int main()
+{
+  TestPostedTasks();
+  TestStolenTasks();
+  TestStrandTasks();
+  TestTimedTasks();
+  TestSaturatedTimedTasks();
+}
@@ -19,11 +19,18 @@
 
 #include <libserver/util/Locale.hpp>
 
+#ifdef _MSC_VER
+#include <icu.h>
+#else
+#include <unicode/ucnv.h>
+#endif
+
 #include <array>
 #include <cassert>
 #include <locale>
 #include <regex>
 #include <cstdio>
+#include <stdexcept>
 
 namespace
 {
@@ -39,6 +46,156 @@ void TestLocale()
   assert(eucOutput == eucSource);
 }
 
+//! Converts the input with ICU the way the locale conversion did before the conversion tables,
+//! EUC-KR or UTF-8 to UTF-16 to the other encoding.
+std::string IcuConvert(const char* from, const char* to, const std::string& input)
+{
+  UErrorCode error = U_ZERO_ERROR;
+  UConverter* fromConv = ucnv_open(from, &error);
+  UConverter* toConv = ucnv_open(to, &error);
+  assert(U_SUCCESS(error));
+
+  std::u16string unicode(input.length() * 2 + 1, u'\0');
+  const auto unicodeLength = ucnv_toUChars(
+    fromConv,
+    unicode.data(),
+    static_cast<int32_t>(unicode.size()),
+    input.data(),
+    static_cast<int32_t>(input.length()),
+    &error);
+
+  std::string output(UCNV_GET_MAX_BYTES_FOR_STRING(unicodeLength, ucnv_getMaxCharSize(toConv)) + 1, '\0');
+  ucnv_fromUChars(
+    toConv,
+    output.data(),
+    static_cast<int32_t>(output.size()),
+    unicode.data(),
+    unicodeLength,
+    &error);
+
+  ucnv_close(fromConv);
+  ucnv_close(toConv);
+
+  if (error > U_ZERO_ERROR)
+    throw std::runtime_error("ICU conversion failed");
+
+  return {output.data()};
+}
+
+//! Encodes the code unit in UTF-8.
+std::string EncodeUtf8(char32_t codePoint)
+{
+  std::string output;
+  if (codePoint < 0x80)
+  {
+    output += static_cast<char>(codePoint);
+  }
+  else if (codePoint < 0x800)
+  {
+    output += static_cast<char>(0xC0 | codePoint >> 6);
+    output += static_cast<char>(0x80 | (codePoint & 0x3F));
+  }
+  else
+  {
+    output += static_cast<char>(0xE0 | codePoint >> 12);
+    output += static_cast<char>(0x80 | (codePoint >> 6 & 0x3F));
+    output += static_cast<char>(0x80 | (codePoint & 0x3F));
+  }
+  return output;
+}
+
+//! Test the ASCII check over the lengths and positions handled by the different loops.
+void TestAscii()
+{
+  assert(server::locale::IsAscii(""));
+
+  for (std::size_t length = 1; length < 40; ++length)
+  {
+    std::string input(length, 'a');
+    assert(server::locale::IsAscii(input));
+
+    for (std::size_t position = 0; position < length; ++position)
+    {
+      input[position] = static_cast<char>(0x80);
+      assert(not server::locale::IsAscii(input));
+      input[position] = 'a';
+    }
+  }
+}
+
+//! Test that the conversions from EUC-KR match ICU over the whole EUC-KR code table,
+//! including the invalid and unmapped characters.
+void TestEucKrTable()
+{
+  std::string output;
+
+  for (int first = 1; first <= 0xFF; ++first)
+  {
+    // Characters followed by an ASCII character, so that the single-byte
+    // and the truncated characters are covered as well.
+    for (int second = first < 0x80 ? 0x41 : 0x00; second <= 0xFF; ++second)
+    {
+      if (second == 0)
+        continue;
+
+      const std::string input{
+        static_cast<char>(first),
+        static_cast<char>(second),
+        'a'};
+
+      const auto expected = IcuConvert("EUC-KR", "UTF-8", input);
+      server::locale::ToUtf8(input, output);
+      assert(output == expected);
+
+      // Round-trip back.
+      const auto expectedBack = IcuConvert("UTF-8", "EUC-KR", expected);
+      server::locale::FromUtf8(output, output);
+      assert(output == expectedBack);
+
+      if (first < 0x80)
+        break;
+    }
+  }
+}
+
+//! Test that the conversions to EUC-KR match ICU over the whole basic multilingual plane.
+void TestUnicodeTable()
+{
+  std::string output;
+
+  for (char32_t codePoint = 1; codePoint <= 0xFFFF; ++codePoint)
+  {
+    if (codePoint >= 0xD800 && codePoint <= 0xDFFF)
+      continue;
+
+    const auto input = "a" + EncodeUtf8(codePoint);
+    server::locale::FromUtf8(input, output);
+    assert(output == IcuConvert("UTF-8", "EUC-KR", input));
+  }
+
+  // Malformed sequences: overlong, surrogate, truncated, stray continuation
+  // and a character outside of the basic multilingual plane.
+  constexpr std::array malformedInputs = {
+    "a\xC0\x80", "a\xE0\x80\x80", "a\xED\xA0\x80", "a\xEA\xB5", "a\x80" "b", "a\xF0\x9F\x98\x80"};
+
+  for (const auto& input : malformedInputs)
+  {
+    server::locale::FromUtf8(input, output);
+    assert(output == IcuConvert("UTF-8", "EUC-KR", input));
+  }
+}
+
+//! Test that the conversions stop at the null character.
+void TestNullCharacter()
+{
+  const std::string input("ab\0cd", 5);
+  assert(server::locale::ToUtf8(input) == "ab");
+  assert(server::locale::FromUtf8(input) == "ab");
+
+  const std::string koreanInput("\xb1\xb8\0\xb1\xb8", 5);
+  assert(server::locale::ToUtf8(koreanInput) == "\xea\xb5\xac");
+}
+
 void TestNameValidation()
 {
   constexpr std::array validNames = {
@@ -72,5 +229,9 @@ void TestNameValidation()
 int main()
 {
   TestLocale();
+  TestAscii();
+  TestEucKrTable();
+  TestUnicodeTable();
+  TestNullCharacter();
   TestNameValidation();
 }
@@ -0,0 +1,112 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include <libserver/util/Profiler.hpp>
+
+#include <cassert>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+using namespace std::chrono_literals;
+
+void TestHistogram()
+{
+  server::Profiler profiler;
+
+  const auto sectionId = profiler.RegisterSection("section");
+  // Expect the same ID for the same name.
+  assert(profiler.RegisterSection("section") == sectionId);
+  const auto otherSectionId = profiler.RegisterSection("other");
+  assert(otherSectionId != sectionId);
+
+  // 0us, 1us, 3us and 100us fall in the buckets 0, 1, 2 and 7.
+  profiler.Record(sectionId, 500ns);
+  profiler.Record(sectionId, 1us);
+  profiler.Record(sectionId, 3us);
+  profiler.Record(sectionId, 100us);
+
+  auto profile = profiler.Collect();
+  assert(profile.size() == 2);
+  assert(profile[sectionId].name == "section");
+
+  const auto& histogram = profile[sectionId].histogram;
+  assert(histogram.count == 4);
+  assert(histogram.totalDuration == 104500ns);
+  assert(histogram.buckets[0] == 1);
+  assert(histogram.buckets[1] == 1);
+  assert(histogram.buckets[2] == 1);
+  assert(histogram.buckets[7] == 1);
+  assert(histogram.GetMeanDuration() == 26125ns);
+  assert(histogram.GetPercentileDuration(50) == 2us);
+  assert(histogram.GetPercentileDuration(99) == 128us);
+  assert(profile[otherSectionId].histogram.count == 0);
+
+  // Expect only the called sections to be formatted.
+  assert(server::Profiler::Format(profile).size() == 1);
+
+  // Expect the calls in between the profiles after the subtraction.
+  profiler.Record(otherSectionId, 10ms);
+  auto laterProfile = profiler.Collect();
+  server::Profiler::Subtract(laterProfile, profile);
+  assert(laterProfile[sectionId].histogram.count == 0);
+  assert(laterProfile[otherSectionId].histogram.count == 1);
+  assert(laterProfile[otherSectionId].histogram.totalDuration == 10ms);
+}
+
+void TestConcurrentRecords()
+{
+  constexpr uint32_t ThreadCount = 4;
+  constexpr uint32_t RecordCount = 10'000;
+
+  server::Profiler profiler;
+  const auto sectionId = profiler.RegisterSection("section");
+
+  std::vector<std::thread> threads;
+  for (uint32_t threadIdx = 0; threadIdx < ThreadCount; ++threadIdx)
+  {
+    threads.emplace_back([&profiler, sectionId]()
+    {
+      for (uint32_t recordIdx = 0; recordIdx < RecordCount; ++recordIdx)
+        profiler.Record(sectionId, 1us);
+    });
+  }
+
+  // Collect while recording.
+  const auto earlierCount = profiler.Collect()[sectionId].histogram.count;
+  assert(earlierCount <= ThreadCount * RecordCount);
+
+  for (auto& thread : threads)
+    thread.join();
+
+  // Expect the records of all the threads to be merged.
+  const auto profile = profiler.Collect();
+  assert(profile[sectionId].histogram.count == ThreadCount * RecordCount);
+  assert(profile[sectionId].histogram.buckets[1] == ThreadCount * RecordCount);
+}
+
+} // namespace
+
+int main()
+{
+  TestHistogram();
+  TestConcurrentRecords();
+}
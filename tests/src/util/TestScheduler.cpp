@@ -21,6 +21,8 @@
 
 #include <array>
 #include <cassert>
+#include <stdexcept>
+#include <vector>
 
 namespace
 {
@@ -87,10 +89,204 @@ void TestScheduledTasks()
   assert(delayedTaskExecuted && "Task queued for execution with a delay not executed within a timeout");
 }
 
+void TestDrainedTasks()
+{
+  constexpr uint32_t TaskCount = 100;
+
+  server::Scheduler scheduler;
+
+  // Queue the tasks in the reverse order of their time points.
+  const auto now = server::Scheduler::Clock::now();
+  std::vector<uint32_t> executedTasks;
+  for (uint32_t taskIdx = 0; taskIdx < TaskCount; ++taskIdx)
+  {
+    scheduler.Queue([&executedTasks, taskIdx]()
+    {
+      executedTasks.emplace_back(taskIdx);
+    }, now - std::chrono::milliseconds(taskIdx));
+  }
+
+  // Expect all the due tasks to execute in one tick, by their time points.
+  scheduler.Tick();
+  assert(executedTasks.size() == TaskCount);
+  for (uint32_t idx = 0; idx < TaskCount; ++idx)
+    assert(executedTasks[idx] == TaskCount - 1 - idx);
+  assert(scheduler.GetJobCount() == 0);
+
+  // A task re-queueing itself executes once per tick.
+  uint32_t repeatCount = 0;
+  std::function<void()> repeatedTask;
+  repeatedTask = [&]()
+  {
+    ++repeatCount;
+    scheduler.Queue(repeatedTask, now);
+  };
+  scheduler.Queue(repeatedTask, now);
+
+  scheduler.Tick();
+  assert(repeatCount == 1);
+  scheduler.Tick();
+  assert(repeatCount == 2);
+}
+
+void TestCancelledTasks()
+{
+  server::Scheduler scheduler;
+
+  bool cancelledTaskExecuted = false;
+  bool taskExecuted = false;
+
+  const auto cancelledJobId = scheduler.Queue([&cancelledTaskExecuted]()
+  {
+    cancelledTaskExecuted = true;
+  });
+  const auto jobId = scheduler.Queue([&]()
+  {
+    taskExecuted = true;
+  });
+  assert(cancelledJobId != 0 && cancelledJobId != jobId);
+
+  assert(scheduler.Cancel(cancelledJobId));
+  // The job can be cancelled only once.
+  assert(not scheduler.Cancel(cancelledJobId));
+  assert(scheduler.GetJobCount() == 1);
+
+  scheduler.Tick();
+  assert(not cancelledTaskExecuted);
+  assert(taskExecuted);
+
+  // An executed job can not be cancelled.
+  assert(not scheduler.Cancel(jobId));
+
+  // A task can cancel a job due in the same tick.
+  bool laterTaskExecuted = false;
+  server::Scheduler::JobId laterJobId{};
+  scheduler.Queue([&]()
+  {
+    assert(scheduler.Cancel(laterJobId));
+  });
+  laterJobId = scheduler.Queue([&laterTaskExecuted]()
+  {
+    laterTaskExecuted = true;
+  });
+
+  scheduler.Tick();
+  assert(not laterTaskExecuted);
+  assert(scheduler.GetJobCount() == 0);
+}
+
+void TestJobTasks()
+{
+  server::Scheduler scheduler;
+
+  // Expect the task to receive the ID of its job.
+  server::Scheduler::JobId executedJobId{};
+  server::Scheduler::JobId requeuedJobId{};
+  const auto jobId = scheduler.Queue([&](server::Scheduler::JobId currentJobId)
+  {
+    executedJobId = currentJobId;
+    // An executing job can not be cancelled.
+    assert(not scheduler.Cancel(currentJobId));
+
+    // A job queued by the task has an ID of its own.
+    requeuedJobId = scheduler.Queue([](server::Scheduler::JobId) {});
+  });
+  assert(jobId != 0);
+  assert(scheduler.GetJobCount() == 1);
+
+  scheduler.Tick();
+  assert(executedJobId == jobId);
+  assert(requeuedJobId != 0 && requeuedJobId != jobId);
+  assert(scheduler.GetJobCount() == 1);
+
+  // Expect a cancelled job to not execute.
+  assert(scheduler.Cancel(requeuedJobId));
+  executedJobId = 0;
+  scheduler.Tick();
+  assert(executedJobId == 0);
+  assert(scheduler.GetJobCount() == 0);
+}
+
+void TestThrowingTasks()
+{
+  server::Scheduler scheduler;
+
+  bool taskExecuted = false;
+  scheduler.Queue([]()
+  {
+    throw std::runtime_error("task failed");
+  });
+  scheduler.Queue([&taskExecuted]()
+  {
+    taskExecuted = true;
+  });
+
+  // Expect the exception to propagate and the other task to execute on the next tick.
+  bool thrown = false;
+  try
+  {
+    scheduler.Tick();
+  }
+  catch (const std::runtime_error&)
+  {
+    thrown = true;
+  }
+  assert(thrown);
+  assert(not taskExecuted);
+
+  scheduler.Tick();
+  assert(taskExecuted);
+}
+
+void TestWakeupTasks()
+{
+  const auto now = server::Scheduler::Clock::now();
+
+  server::Wakeup wakeup;
+  uint32_t wakeupCount = 0;
+  wakeup.SetHandler([&wakeupCount]()
+  {
+    ++wakeupCount;
+  });
+
+  server::Scheduler scheduler(wakeup);
+  assert(not scheduler.GetNextJobTime().has_value());
+
+  // Expect the first job to wake the owner up.
+  const auto laterJobId = scheduler.Queue([]() {}, now + std::chrono::seconds(2));
+  assert(wakeupCount == 1);
+  assert(scheduler.GetNextJobTime() == now + std::chrono::seconds(2));
+
+  // Expect a job due sooner to wake the owner up, once it took the work.
+  wakeup.Reset();
+  scheduler.Queue([]() {}, now + std::chrono::seconds(1));
+  assert(wakeupCount == 2);
+  assert(scheduler.GetNextJobTime() == now + std::chrono::seconds(1));
+
+  // Expect a job due later to not wake the owner up.
+  wakeup.Reset();
+  const auto latestJobId = scheduler.Queue([]() {}, now + std::chrono::seconds(3));
+  assert(wakeupCount == 2);
+
+  // Expect the cancelled jobs to not be reported.
+  scheduler.Queue([]() {}, now);
+  assert(wakeupCount == 3);
+  scheduler.Tick();
+  assert(scheduler.Cancel(laterJobId));
+  assert(scheduler.GetNextJobTime() == now + std::chrono::seconds(1));
+  assert(scheduler.Cancel(latestJobId));
+  assert(scheduler.GetJobCount() == 1);
+}
+
 } // namespace
 
 int main()
 {
   TestSequencedTasks();
   TestScheduledTasks();
+  TestDrainedTasks();
+  TestCancelledTasks();
+  TestJobTasks();
+  TestThrowingTasks();
+  TestWakeupTasks();
 }
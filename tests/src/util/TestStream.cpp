@@ -21,7 +21,10 @@
 
 #include <boost/asio/streambuf.hpp>
 
+#include <array>
 #include <cassert>
+#include <memory_resource>
+#include <stdexcept>
 
 namespace
 {
@@ -88,9 +91,132 @@ void TestStreams()
   assert(source.GetCursor() == 4 * sizeof(uint32_t) + 1);
 }
 
+//! Test the bulk reads and writes of contiguous ranges and strings.
+void TestBulk()
+{
+  std::array<std::byte, 32> buffer{};
+  server::SinkStream sink(buffer);
+
+  const std::array<uint16_t, 3> values{0x0102, 0x0304, 0x0506};
+  const std::array<std::byte, 2> bytes{std::byte{0xAA}, std::byte{0xBB}};
+  sink.Write(std::span(values))
+    .Write(std::span(bytes))
+    .Write(std::string("abc"))
+    .Write(std::string());
+
+  // The values are written as is, the strings with their null-terminator.
+  assert(sink.GetCursor() == sizeof(values) + sizeof(bytes) + 4 + 1);
+  assert(buffer[0] == std::byte{0x02} && buffer[1] == std::byte{0x01});
+  assert(buffer[6] == std::byte{0xAA} && buffer[7] == std::byte{0xBB});
+  assert(buffer[8] == std::byte{'a'} && buffer[11] == std::byte{0x00});
+  assert(buffer[12] == std::byte{0x00});
+
+  server::SourceStream source(std::span(buffer.data(), sink.GetCursor()));
+  std::array<uint16_t, 3> readValues{};
+  std::array<std::byte, 2> readBytes{};
+  std::string readString;
+  std::string readEmptyString = "not empty";
+  source.Read(std::span(readValues))
+    .Read(std::span(readBytes))
+    .Read(readString)
+    .Read(readEmptyString);
+
+  assert(readValues == values);
+  assert(readBytes == bytes);
+  assert(readString == "abc");
+  assert(readEmptyString.empty());
+  assert(source.GetCursor() == sink.GetCursor());
+}
+
+//! Test that the reads and writes do not overrun the storage.
+void TestBounds()
+{
+  std::array<std::byte, 4> buffer{};
+
+  server::SinkStream sink(buffer);
+  sink.Write(uint16_t{});
+
+  bool thrown = false;
+  try
+  {
+    sink.Write(std::string("abc"));
+  }
+  catch (const std::overflow_error&)
+  {
+    thrown = true;
+  }
+  assert(thrown);
+  assert(sink.GetCursor() == sizeof(uint16_t));
+
+  // String without the null-terminator.
+  buffer.fill(std::byte{'a'});
+  server::SourceStream source(buffer);
+
+  thrown = false;
+  try
+  {
+    std::string value;
+    source.Read(value);
+  }
+  catch (const std::overflow_error&)
+  {
+    thrown = true;
+  }
+  assert(thrown);
+  assert(source.GetCursor() == 0);
+
+  thrown = false;
+  try
+  {
+    std::array<uint32_t, 2> values{};
+    source.Read(std::span(values));
+  }
+  catch (const std::overflow_error&)
+  {
+    thrown = true;
+  }
+  assert(thrown);
+}
+
+//! Perform test of the strings using a polymorphic allocator.
+void TestPmrStrings()
+{
+  std::array<std::byte, 64> buffer{};
+  server::SinkStream sink(buffer);
+
+  const std::pmr::string ascii("hello");
+  // "안녕" in UTF-8.
+  const std::pmr::string korean("\xEC\x95\x88\xEB\x85\x95");
+  sink.Write(ascii)
+    .Write(korean)
+    .Write(std::string("world"));
+
+  std::array<std::byte, 256> arenaBuffer{};
+  std::pmr::monotonic_buffer_resource arena(
+    arenaBuffer.data(), arenaBuffer.size(), std::pmr::null_memory_resource());
+
+  std::pmr::string readAscii(&arena);
+  std::pmr::string readKorean(&arena);
+  std::string readStd;
+
+  server::SourceStream source(std::span(buffer.data(), sink.GetCursor()));
+  source.Read(readAscii)
+    .Read(readKorean)
+    .Read(readStd);
+
+  assert(readAscii == ascii);
+  assert(readKorean == korean);
+  assert(readStd == "world");
+  assert(readKorean.get_allocator().resource() == &arena);
+  assert(source.GetCursor() == sink.GetCursor());
+}
+
 } // namespace
 
 int main()
 {
   TestStreams();
+  TestBulk();
+  TestBounds();
+  TestPmrStrings();
 }
@@ -0,0 +1,102 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include <libserver/util/Wakeup.hpp>
+
+#include <atomic>
+#include <cassert>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+void TestCoalescedSignals()
+{
+  server::Wakeup wakeup;
+
+  // Expect the signal to be kept until a handler is set.
+  wakeup.Signal();
+  assert(wakeup.IsSignalled());
+
+  uint32_t handlerCount = 0;
+  wakeup.SetHandler([&handlerCount]()
+  {
+    ++handlerCount;
+  });
+
+  // Expect the signals to be coalesced until the wakeup is reset.
+  wakeup.Signal();
+  assert(handlerCount == 0);
+  assert(wakeup.Reset());
+  assert(not wakeup.Reset());
+
+  wakeup.Signal();
+  wakeup.Signal();
+  assert(handlerCount == 1);
+
+  // Expect the handler to be invoked again after the reset.
+  assert(wakeup.Reset());
+  wakeup.Signal();
+  assert(handlerCount == 2);
+
+  // Expect the cleared handler to not be invoked.
+  wakeup.SetHandler({});
+  wakeup.Reset();
+  wakeup.Signal();
+  assert(handlerCount == 2);
+  assert(wakeup.IsSignalled());
+}
+
+void TestConcurrentSignals()
+{
+  constexpr uint32_t ThreadCount = 4;
+  constexpr uint32_t SignalCount = 10'000;
+
+  server::Wakeup wakeup;
+  std::atomic_uint32_t handlerCount{0};
+  wakeup.SetHandler([&handlerCount]()
+  {
+    handlerCount.fetch_add(1, std::memory_order::relaxed);
+  });
+
+  std::vector<std::thread> threads;
+  for (uint32_t threadIdx = 0; threadIdx < ThreadCount; ++threadIdx)
+  {
+    threads.emplace_back([&wakeup]()
+    {
+      for (uint32_t signalIdx = 0; signalIdx < SignalCount; ++signalIdx)
+        wakeup.Signal();
+    });
+  }
+
+  for (auto& thread : threads)
+    thread.join();
+
+  // Expect a single invocation, as the wakeup was never reset.
+  assert(handlerCount.load() == 1);
+}
+
+} // namespace
+
+int main()
+{
+  TestCoalescedSignals();
+  TestConcurrentSignals();
+}
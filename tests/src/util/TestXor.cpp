@@ -0,0 +1,133 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include <libserver/util/Xor.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+constexpr std::array Kernels{
+  server::util::XorKernel::Scalar,
+  server::util::XorKernel::Sse2,
+  server::util::XorKernel::Avx2};
+
+//! The byte-by-byte algorithm the kernels must be equivalent to.
+std::vector<std::byte> XorReference(
+  const server::util::XorKey& key,
+  const std::vector<std::byte>& source,
+  std::size_t keyOffset)
+{
+  std::vector<std::byte> result(source.size());
+  for (std::size_t idx = 0; idx < source.size(); ++idx)
+  {
+    result[idx] = source[idx] ^ key[(keyOffset + idx) % 4];
+  }
+  return result;
+}
+
+//! Rolls the key the way the command protocol does.
+server::util::XorKey RollKey(const server::util::XorKey& key)
+{
+  uint32_t code{};
+  std::memcpy(&code, key.data(), sizeof(code));
+  code = 0xA20191CBu - code * 0x20080825u;
+
+  server::util::XorKey rolledKey{};
+  std::memcpy(rolledKey.data(), &code, sizeof(code));
+  return rolledKey;
+}
+
+//! Test that every kernel produces the same output as the reference algorithm,
+//! both in-place and out-of-place, for randomized buffers and keys.
+void TestKernelEquivalence()
+{
+  std::mt19937 random(0x5EED);
+  std::uniform_int_distribution<int> byteDistribution(0, 0xFF);
+  std::uniform_int_distribution<std::size_t> sizeDistribution(0, 300);
+  std::uniform_int_distribution<std::size_t> alignmentDistribution(0, 31);
+
+  server::util::XorKey key{
+    std::byte{0x12}, std::byte{0x34}, std::byte{0x56}, std::byte{0x78}};
+
+  for (std::size_t iteration = 0; iteration < 2000; ++iteration)
+  {
+    key = RollKey(key);
+
+    std::vector<std::byte> source(sizeDistribution(random));
+    for (auto& byte : source)
+      byte = static_cast<std::byte>(byteDistribution(random));
+
+    const std::size_t keyOffset = iteration % 8;
+    const auto expected = XorReference(key, source, keyOffset);
+
+    for (const auto kernel : Kernels)
+    {
+      if (not server::util::IsXorKernelSupported(kernel))
+        continue;
+
+      // Place the data at an unaligned position, so that the heads
+      // and the tails of the data are not aligned to the vector size.
+      const std::size_t alignment = alignmentDistribution(random);
+      std::vector<std::byte> storage(source.size() + alignment * 2);
+      const std::span buffer(storage.data() + alignment, source.size());
+
+      // Out-of-place.
+      server::util::XorWithKey(kernel, key, source, buffer, keyOffset);
+      assert(std::equal(buffer.begin(), buffer.end(), expected.begin()));
+
+      // In-place.
+      std::ranges::copy(source, buffer.begin());
+      server::util::XorWithKey(kernel, key, buffer, buffer, keyOffset);
+      assert(std::equal(buffer.begin(), buffer.end(), expected.begin()));
+
+      // Applying the key again restores the source.
+      server::util::XorWithKey(kernel, key, buffer, buffer, keyOffset);
+      assert(std::equal(buffer.begin(), buffer.end(), source.begin()));
+    }
+
+    // The default kernel.
+    std::vector<std::byte> result(source);
+    server::util::XorWithKey(key, result, keyOffset);
+    assert(result == expected);
+  }
+}
+
+//! Test that the fallback kernel is always supported
+//! and the selected kernel is supported.
+void TestKernelSelection()
+{
+  assert(server::util::IsXorKernelSupported(server::util::XorKernel::Scalar));
+  assert(server::util::IsXorKernelSupported(server::util::GetXorKernel()));
+}
+
+} // namespace
+
+int main()
+{
+  TestKernelSelection();
+  TestKernelEquivalence();
+}